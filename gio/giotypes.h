@@ -128,6 +128,14 @@ typedef struct _GMemoryOutputStream           GMemoryOutputStream;
  **/
 typedef struct _GMount                        GMount; /* Dummy typedef */
 typedef struct _GMountOperation               GMountOperation;
+/**
+ * GKeyFileCache:
+ *
+ * A compiled key file.
+ *
+ * Since: 2.44
+ */
+typedef struct _GKeyFileCache                 GKeyFileCache;
 typedef struct _GNetworkAddress               GNetworkAddress;
 typedef struct _GNetworkMonitor               GNetworkMonitor;
 typedef struct _GNetworkService               GNetworkService;
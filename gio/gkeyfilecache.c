@@ -0,0 +1,842 @@
+/* GIO - GLib Input, Output and Streaming Library
+ *
+ * Copyright © 2014 The GLib developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "gkeyfilecache.h"
+#include <gvdb/gvdb-builder.h>
+#include <gvdb/gvdb-reader.h>
+#include <glib/gstdio.h>
+#include "glibintl.h"
+
+/**
+ * SECTION:gkeyfilecache
+ * @short_description: Precompiled key files
+ * @include: gio/gio.h
+ *
+ * A #GKeyFileCache answers the same queries as a #GKeyFile, but from
+ * a binary image that is mapped into memory instead of being parsed.
+ * This makes it cheap to consult files like desktop entries or
+ * application configuration at every process start.
+ *
+ * An image is written from a loaded #GKeyFile with
+ * g_key_file_cache_compile() and opened with g_key_file_cache_load().
+ * Opening an image only maps it; groups and keys are found by
+ * hashing, without reading the rest of the file.
+ *
+ * Consumers that only read a key file can instead use
+ * g_key_file_cache_new_for_file(), which keeps the image next to the
+ * text file up to date: the image is used as long as it was compiled
+ * from a file with the same modification time, size and flags, and is
+ * rewritten otherwise.
+ *
+ * Since: 2.44
+ */
+
+/* Layout of the image:
+ *
+ *   ""          aay     names of the groups, in file order
+ *   "[source]"  (xtu)   mtime, size and flags of the source file,
+ *                       only for g_key_file_cache_new_for_file()
+ *   group       table   one per group, containing:
+ *     ""        aay     names of the keys, in file order
+ *     key       (ayms)  the value, and the value as a string if it
+ *                       can be interpreted as one
+ *
+ * Group names and keys are never empty and group names never contain
+ * '[', so none of these can clash.  Names and values are stored as
+ * bytestrings since key files are not required to be valid UTF-8.
+ */
+#define SOURCE_KEY "[source]"
+
+struct _GKeyFileCache
+{
+  gint ref_count;
+
+  /* Exactly one of these is set; the key file is only used when
+   * g_key_file_cache_new_for_file() has just parsed the text file.
+   */
+  GvdbTable *table;
+  GKeyFile *key_file;
+};
+
+G_DEFINE_BOXED_TYPE (GKeyFileCache, g_key_file_cache, g_key_file_cache_ref, g_key_file_cache_unref)
+
+static gboolean
+g_key_file_cache_write (GKeyFile     *key_file,
+                        const gchar  *filename,
+                        GVariant     *source,
+                        GError      **error)
+{
+  GHashTable *root;
+  gchar **groups;
+  gboolean success;
+  gsize i, j;
+
+  root = gvdb_hash_table_new (NULL, NULL);
+
+  groups = g_key_file_get_groups (key_file, NULL);
+  gvdb_item_set_value (gvdb_hash_table_insert (root, ""),
+                       g_variant_new_bytestring_array ((const gchar **) groups, -1));
+
+  if (source != NULL)
+    gvdb_item_set_value (gvdb_hash_table_insert (root, SOURCE_KEY), source);
+
+  for (i = 0; groups[i] != NULL; i++)
+    {
+      GHashTable *table;
+      gchar **keys;
+
+      table = gvdb_hash_table_new (root, groups[i]);
+      keys = g_key_file_get_keys (key_file, groups[i], NULL, NULL);
+      gvdb_item_set_value (gvdb_hash_table_insert (table, ""),
+                           g_variant_new_bytestring_array ((const gchar **) keys, -1));
+
+      for (j = 0; keys[j] != NULL; j++)
+        {
+          GError *string_error = NULL;
+          gchar *value, *string;
+
+          value = g_key_file_get_value (key_file, groups[i], keys[j], NULL);
+          string = g_key_file_get_string (key_file, groups[i], keys[j], &string_error);
+
+          /* Invalid escapes still produce a string, along with an error */
+          if (string_error != NULL)
+            {
+              g_clear_pointer (&string, g_free);
+              g_error_free (string_error);
+            }
+
+          gvdb_item_set_value (gvdb_hash_table_insert (table, keys[j]),
+                               g_variant_new ("(^ayms)", value, string));
+          g_free (value);
+          g_free (string);
+        }
+
+      g_strfreev (keys);
+      g_hash_table_unref (table);
+    }
+
+  g_strfreev (groups);
+
+  success = gvdb_table_write_contents (root, filename, FALSE, error);
+  g_hash_table_unref (root);
+
+  return success;
+}
+
+/**
+ * g_key_file_cache_compile:
+ * @key_file: a #GKeyFile
+ * @filename: (type filename): the file to write the image to
+ * @error: return location for a #GError, or %NULL
+ *
+ * Writes the groups, keys and values of @key_file to @filename as an
+ * image that can be opened with g_key_file_cache_load().
+ *
+ * Comments are not included.  Translations are included as far as
+ * they were kept when loading @key_file.
+ *
+ * Returns: %TRUE if the image was written, %FALSE if @error is set
+ *
+ * Since: 2.44
+ */
+gboolean
+g_key_file_cache_compile (GKeyFile     *key_file,
+                          const gchar  *filename,
+                          GError      **error)
+{
+  g_return_val_if_fail (key_file != NULL, FALSE);
+  g_return_val_if_fail (filename != NULL, FALSE);
+  g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+  return g_key_file_cache_write (key_file, filename, NULL, error);
+}
+
+static GKeyFileCache *
+g_key_file_cache_new (GvdbTable *table,
+                      GKeyFile  *key_file)
+{
+  GKeyFileCache *cache;
+
+  cache = g_slice_new (GKeyFileCache);
+  cache->ref_count = 1;
+  cache->table = table;
+  cache->key_file = key_file;
+
+  return cache;
+}
+
+/**
+ * g_key_file_cache_load:
+ * @filename: (type filename): an image written by g_key_file_cache_compile()
+ * @error: return location for a #GError, or %NULL
+ *
+ * Maps the image in @filename into memory.
+ *
+ * Returns: (transfer full): a new #GKeyFileCache, or %NULL on error
+ *
+ * Since: 2.44
+ */
+GKeyFileCache *
+g_key_file_cache_load (const gchar  *filename,
+                       GError      **error)
+{
+  GvdbTable *table;
+
+  g_return_val_if_fail (filename != NULL, NULL);
+  g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+  table = gvdb_table_new (filename, FALSE, error);
+  if (table == NULL)
+    return NULL;
+
+  return g_key_file_cache_new (table, NULL);
+}
+
+/**
+ * g_key_file_cache_new_for_file:
+ * @file: (type filename): the key file to read
+ * @cache_file: (type filename): the image to use for @file
+ * @flags: flags from #GKeyFileFlags
+ * @error: return location for a #GError, or %NULL
+ *
+ * Returns the contents of the key file @file, using the image in
+ * @cache_file if it is up to date.
+ *
+ * The image is up to date if it was written by this function for a
+ * file with the same modification time and size as @file, loaded
+ * with the same @flags.  Otherwise @file is parsed and the image is
+ * rewritten.  Failure to write the image is not an error, so this can
+ * be used by processes that cannot write to @cache_file.
+ *
+ * Returns: (transfer full): a new #GKeyFileCache, or %NULL if @file
+ *     could not be loaded
+ *
+ * Since: 2.44
+ */
+GKeyFileCache *
+g_key_file_cache_new_for_file (const gchar    *file,
+                               const gchar    *cache_file,
+                               GKeyFileFlags   flags,
+                               GError        **error)
+{
+  GKeyFile *key_file;
+  GvdbTable *table;
+  GVariant *source;
+  GStatBuf buf;
+
+  g_return_val_if_fail (file != NULL, NULL);
+  g_return_val_if_fail (cache_file != NULL, NULL);
+  g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+  if (g_stat (file, &buf) != 0)
+    {
+      int errsv = errno;
+      gchar *display_name = g_filename_display_name (file);
+
+      g_set_error (error, G_FILE_ERROR, g_file_error_from_errno (errsv),
+                   _("Error getting information for file '%s': %s"),
+                   display_name, g_strerror (errsv));
+      g_free (display_name);
+
+      return NULL;
+    }
+
+  source = g_variant_ref_sink (g_variant_new ("(xtu)",
+                                              (gint64) buf.st_mtime,
+                                              (guint64) buf.st_size,
+                                              (guint32) flags));
+
+  table = gvdb_table_new (cache_file, FALSE, NULL);
+  if (table != NULL)
+    {
+      GVariant *stored;
+      gboolean up_to_date;
+
+      stored = gvdb_table_get_value (table, SOURCE_KEY);
+      up_to_date = stored != NULL &&
+                   g_variant_is_of_type (stored, G_VARIANT_TYPE ("(xtu)")) &&
+                   g_variant_equal (stored, source);
+
+      if (stored != NULL)
+        g_variant_unref (stored);
+
+      if (up_to_date)
+        {
+          g_variant_unref (source);
+          return g_key_file_cache_new (table, NULL);
+        }
+
+      gvdb_table_unref (table);
+    }
+
+  key_file = g_key_file_new ();
+
+  if (!g_key_file_load_from_file (key_file, file, flags, error))
+    {
+      g_key_file_free (key_file);
+      g_variant_unref (source);
+      return NULL;
+    }
+
+  g_key_file_cache_write (key_file, cache_file, source, NULL);
+  g_variant_unref (source);
+
+  return g_key_file_cache_new (NULL, key_file);
+}
+
+/**
+ * g_key_file_cache_ref:
+ * @cache: a #GKeyFileCache
+ *
+ * Atomically increments the reference count of @cache by one.
+ *
+ * Returns: the passed in #GKeyFileCache
+ *
+ * Since: 2.44
+ */
+GKeyFileCache *
+g_key_file_cache_ref (GKeyFileCache *cache)
+{
+  g_return_val_if_fail (cache != NULL, NULL);
+
+  g_atomic_int_inc (&cache->ref_count);
+
+  return cache;
+}
+
+/**
+ * g_key_file_cache_unref:
+ * @cache: a #GKeyFileCache
+ *
+ * Atomically decrements the reference count of @cache by one.  When
+ * the reference count drops to 0, the image is unmapped.
+ *
+ * Since: 2.44
+ */
+void
+g_key_file_cache_unref (GKeyFileCache *cache)
+{
+  g_return_if_fail (cache != NULL);
+
+  if (g_atomic_int_dec_and_test (&cache->ref_count))
+    {
+      if (cache->table)
+        gvdb_table_unref (cache->table);
+      if (cache->key_file)
+        g_key_file_unref (cache->key_file);
+
+      g_slice_free (GKeyFileCache, cache);
+    }
+}
+
+static GvdbTable *
+g_key_file_cache_lookup_group (GKeyFileCache  *cache,
+                               const gchar    *group_name,
+                               GError        **error)
+{
+  GvdbTable *group;
+
+  group = gvdb_table_get_table (cache->table, group_name);
+
+  if (group == NULL)
+    g_set_error (error, G_KEY_FILE_ERROR,
+                 G_KEY_FILE_ERROR_GROUP_NOT_FOUND,
+                 _("Key file does not have group '%s'"),
+                 group_name);
+
+  return group;
+}
+
+/* Returns the (ayms) entry for @key */
+static GVariant *
+g_key_file_cache_lookup_key (GKeyFileCache  *cache,
+                             const gchar    *group_name,
+                             const gchar    *key,
+                             GError        **error)
+{
+  GvdbTable *group;
+  GVariant *entry;
+
+  group = g_key_file_cache_lookup_group (cache, group_name, error);
+  if (group == NULL)
+    return NULL;
+
+  entry = gvdb_table_get_value (group, key);
+  gvdb_table_unref (group);
+
+  if (entry != NULL && !g_variant_is_of_type (entry, G_VARIANT_TYPE ("(ayms)")))
+    {
+      g_variant_unref (entry);
+      entry = NULL;
+    }
+
+  if (entry == NULL)
+    g_set_error (error, G_KEY_FILE_ERROR,
+                 G_KEY_FILE_ERROR_KEY_NOT_FOUND,
+                 _("Key file does not have key '%s' in group '%s'"),
+                 key, group_name);
+
+  return entry;
+}
+
+/**
+ * g_key_file_cache_get_groups:
+ * @cache: a #GKeyFileCache
+ * @length: (out) (allow-none): return location for the number of returned groups, or %NULL
+ *
+ * Returns all groups in the key file, in the order they appear in the
+ * original file.  See g_key_file_get_groups().
+ *
+ * Returns: (array zero-terminated=1) (transfer full): a newly-allocated %NULL-terminated array of strings.
+ *   Use g_strfreev() to free it.
+ *
+ * Since: 2.44
+ */
+gchar **
+g_key_file_cache_get_groups (GKeyFileCache *cache,
+                             gsize         *length)
+{
+  GVariant *names;
+  gchar **groups;
+
+  g_return_val_if_fail (cache != NULL, NULL);
+
+  if (cache->key_file)
+    return g_key_file_get_groups (cache->key_file, length);
+
+  names = gvdb_table_get_value (cache->table, "");
+
+  if (names == NULL || !g_variant_is_of_type (names, G_VARIANT_TYPE_BYTESTRING_ARRAY))
+    {
+      if (names)
+        g_variant_unref (names);
+
+      if (length)
+        *length = 0;
+
+      return g_new0 (gchar *, 1);
+    }
+
+  groups = g_variant_dup_bytestring_array (names, length);
+  g_variant_unref (names);
+
+  return groups;
+}
+
+/**
+ * g_key_file_cache_get_keys:
+ * @cache: a #GKeyFileCache
+ * @group_name: a group name
+ * @length: (out) (allow-none): return location for the number of keys returned, or %NULL
+ * @error: return location for a #GError, or %NULL
+ *
+ * Returns all keys for the group name @group_name.  See
+ * g_key_file_get_keys().
+ *
+ * Returns: (array zero-terminated=1) (transfer full): a newly-allocated %NULL-terminated array of strings.
+ *     Use g_strfreev() to free it.
+ *
+ * Since: 2.44
+ */
+gchar **
+g_key_file_cache_get_keys (GKeyFileCache  *cache,
+                           const gchar    *group_name,
+                           gsize          *length,
+                           GError        **error)
+{
+  GvdbTable *group;
+  GVariant *names;
+  gchar **keys;
+
+  g_return_val_if_fail (cache != NULL, NULL);
+  g_return_val_if_fail (group_name != NULL, NULL);
+
+  if (cache->key_file)
+    return g_key_file_get_keys (cache->key_file, group_name, length, error);
+
+  group = g_key_file_cache_lookup_group (cache, group_name, error);
+  if (group == NULL)
+    return NULL;
+
+  names = gvdb_table_get_value (group, "");
+  gvdb_table_unref (group);
+
+  if (names == NULL || !g_variant_is_of_type (names, G_VARIANT_TYPE_BYTESTRING_ARRAY))
+    {
+      if (names)
+        g_variant_unref (names);
+
+      if (length)
+        *length = 0;
+
+      return g_new0 (gchar *, 1);
+    }
+
+  keys = g_variant_dup_bytestring_array (names, length);
+  g_variant_unref (names);
+
+  return keys;
+}
+
+/**
+ * g_key_file_cache_has_group:
+ * @cache: a #GKeyFileCache
+ * @group_name: a group name
+ *
+ * Looks whether the key file has the group @group_name.
+ *
+ * Returns: %TRUE if @group_name is a part of @cache, %FALSE otherwise.
+ *
+ * Since: 2.44
+ */
+gboolean
+g_key_file_cache_has_group (GKeyFileCache *cache,
+                            const gchar   *group_name)
+{
+  GvdbTable *group;
+
+  g_return_val_if_fail (cache != NULL, FALSE);
+  g_return_val_if_fail (group_name != NULL, FALSE);
+
+  if (cache->key_file)
+    return g_key_file_has_group (cache->key_file, group_name);
+
+  group = gvdb_table_get_table (cache->table, group_name);
+  if (group == NULL)
+    return FALSE;
+
+  gvdb_table_unref (group);
+
+  return TRUE;
+}
+
+/**
+ * g_key_file_cache_has_key:
+ * @cache: a #GKeyFileCache
+ * @group_name: a group name
+ * @key: a key name
+ * @error: return location for a #GError
+ *
+ * Looks whether the key file has the key @key in the group
+ * @group_name.
+ *
+ * Returns: %TRUE if @key is a part of @group_name, %FALSE otherwise
+ *
+ * Since: 2.44
+ */
+gboolean
+g_key_file_cache_has_key (GKeyFileCache  *cache,
+                          const gchar    *group_name,
+                          const gchar    *key,
+                          GError        **error)
+{
+  GvdbTable *group;
+  gboolean has_key;
+
+  g_return_val_if_fail (cache != NULL, FALSE);
+  g_return_val_if_fail (group_name != NULL, FALSE);
+  g_return_val_if_fail (key != NULL, FALSE);
+
+  if (cache->key_file)
+    return g_key_file_has_key (cache->key_file, group_name, key, error);
+
+  group = g_key_file_cache_lookup_group (cache, group_name, error);
+  if (group == NULL)
+    return FALSE;
+
+  has_key = gvdb_table_has_value (group, key);
+  gvdb_table_unref (group);
+
+  return has_key;
+}
+
+/**
+ * g_key_file_cache_get_value:
+ * @cache: a #GKeyFileCache
+ * @group_name: a group name
+ * @key: a key
+ * @error: return location for a #GError, or %NULL
+ *
+ * Returns the raw value associated with @key under @group_name.
+ * See g_key_file_get_value().
+ *
+ * Returns: a newly allocated string or %NULL if the specified
+ *  key cannot be found.
+ *
+ * Since: 2.44
+ */
+gchar *
+g_key_file_cache_get_value (GKeyFileCache  *cache,
+                            const gchar    *group_name,
+                            const gchar    *key,
+                            GError        **error)
+{
+  GVariant *entry;
+  gchar *value;
+
+  g_return_val_if_fail (cache != NULL, NULL);
+  g_return_val_if_fail (group_name != NULL, NULL);
+  g_return_val_if_fail (key != NULL, NULL);
+
+  if (cache->key_file)
+    return g_key_file_get_value (cache->key_file, group_name, key, error);
+
+  entry = g_key_file_cache_lookup_key (cache, group_name, key, error);
+  if (entry == NULL)
+    return NULL;
+
+  g_variant_get (entry, "(^aym&s)", &value, NULL);
+  g_variant_unref (entry);
+
+  return value;
+}
+
+/**
+ * g_key_file_cache_get_string:
+ * @cache: a #GKeyFileCache
+ * @group_name: a group name
+ * @key: a key
+ * @error: return location for a #GError, or %NULL
+ *
+ * Returns the string value associated with @key under @group_name,
+ * with escape sequences already interpreted.  See
+ * g_key_file_get_string().
+ *
+ * Unlike g_key_file_get_string(), no partial string is returned for
+ * a value with invalid escape sequences.
+ *
+ * Returns: a newly allocated string or %NULL if the specified
+ *   key cannot be found.
+ *
+ * Since: 2.44
+ */
+gchar *
+g_key_file_cache_get_string (GKeyFileCache  *cache,
+                             const gchar    *group_name,
+                             const gchar    *key,
+                             GError        **error)
+{
+  GVariant *entry;
+  const gchar *value;
+  gchar *string;
+
+  g_return_val_if_fail (cache != NULL, NULL);
+  g_return_val_if_fail (group_name != NULL, NULL);
+  g_return_val_if_fail (key != NULL, NULL);
+
+  if (cache->key_file)
+    return g_key_file_get_string (cache->key_file, group_name, key, error);
+
+  entry = g_key_file_cache_lookup_key (cache, group_name, key, error);
+  if (entry == NULL)
+    return NULL;
+
+  g_variant_get (entry, "(^&ayms)", &value, &string);
+
+  if (string == NULL)
+    {
+      if (!g_utf8_validate (value, -1, NULL))
+        g_set_error (error, G_KEY_FILE_ERROR,
+                     G_KEY_FILE_ERROR_UNKNOWN_ENCODING,
+                     _("Key file contains key '%s' which is not UTF-8"),
+                     key);
+      else
+        g_set_error (error, G_KEY_FILE_ERROR,
+                     G_KEY_FILE_ERROR_INVALID_VALUE,
+                     _("Key file contains key '%s' "
+                       "which has a value that cannot be interpreted."),
+                     key);
+    }
+
+  g_variant_unref (entry);
+
+  return string;
+}
+
+/**
+ * g_key_file_cache_get_locale_string:
+ * @cache: a #GKeyFileCache
+ * @group_name: a group name
+ * @key: a key
+ * @locale: (allow-none): a locale identifier or %NULL
+ * @error: return location for a #GError, or %NULL
+ *
+ * Returns the value associated with @key under @group_name
+ * translated in the given @locale if available.  See
+ * g_key_file_get_locale_string().
+ *
+ * Returns: a newly allocated string or %NULL if the specified
+ *   key cannot be found.
+ *
+ * Since: 2.44
+ */
+gchar *
+g_key_file_cache_get_locale_string (GKeyFileCache  *cache,
+                                    const gchar    *group_name,
+                                    const gchar    *key,
+                                    const gchar    *locale,
+                                    GError        **error)
+{
+  gchar **languages;
+  gchar *string;
+  gint i;
+
+  g_return_val_if_fail (cache != NULL, NULL);
+  g_return_val_if_fail (group_name != NULL, NULL);
+  g_return_val_if_fail (key != NULL, NULL);
+
+  if (cache->key_file)
+    return g_key_file_get_locale_string (cache->key_file, group_name,
+                                         key, locale, error);
+
+  if (locale)
+    languages = g_get_locale_variants (locale);
+  else
+    languages = (gchar **) g_get_language_names ();
+
+  string = NULL;
+  for (i = 0; languages[i] != NULL && string == NULL; i++)
+    {
+      gchar *candidate_key;
+
+      candidate_key = g_strdup_printf ("%s[%s]", key, languages[i]);
+      string = g_key_file_cache_get_string (cache, group_name,
+                                            candidate_key, NULL);
+      g_free (candidate_key);
+    }
+
+  if (locale)
+    g_strfreev (languages);
+
+  /* Fall back to the untranslated key */
+  if (string == NULL)
+    string = g_key_file_cache_get_string (cache, group_name, key, error);
+
+  return string;
+}
+
+/**
+ * g_key_file_cache_get_boolean:
+ * @cache: a #GKeyFileCache
+ * @group_name: a group name
+ * @key: a key
+ * @error: return location for a #GError
+ *
+ * Returns the value associated with @key under @group_name as a
+ * boolean.  See g_key_file_get_boolean().
+ *
+ * Returns: the value associated with the key as a boolean,
+ *    or %FALSE if the key was not found or could not be parsed.
+ *
+ * Since: 2.44
+ */
+gboolean
+g_key_file_cache_get_boolean (GKeyFileCache  *cache,
+                              const gchar    *group_name,
+                              const gchar    *key,
+                              GError        **error)
+{
+  gboolean result = FALSE;
+  gchar *value;
+
+  g_return_val_if_fail (cache != NULL, FALSE);
+  g_return_val_if_fail (group_name != NULL, FALSE);
+  g_return_val_if_fail (key != NULL, FALSE);
+
+  if (cache->key_file)
+    return g_key_file_get_boolean (cache->key_file, group_name, key, error);
+
+  value = g_key_file_cache_get_value (cache, group_name, key, error);
+  if (value == NULL)
+    return FALSE;
+
+  if (strcmp (value, "true") == 0 || strcmp (value, "1") == 0)
+    result = TRUE;
+  else if (strcmp (value, "false") == 0 || strcmp (value, "0") == 0)
+    result = FALSE;
+  else
+    g_set_error (error, G_KEY_FILE_ERROR,
+                 G_KEY_FILE_ERROR_INVALID_VALUE,
+                 _("Key file contains key '%s' "
+                   "which has a value that cannot be interpreted."),
+                 key);
+
+  g_free (value);
+
+  return result;
+}
+
+/**
+ * g_key_file_cache_get_integer:
+ * @cache: a #GKeyFileCache
+ * @group_name: a group name
+ * @key: a key
+ * @error: return location for a #GError
+ *
+ * Returns the value associated with @key under @group_name as an
+ * integer.  See g_key_file_get_integer().
+ *
+ * Returns: the value associated with the key as an integer, or
+ *     0 if the key was not found or could not be parsed.
+ *
+ * Since: 2.44
+ */
+gint
+g_key_file_cache_get_integer (GKeyFileCache  *cache,
+                              const gchar    *group_name,
+                              const gchar    *key,
+                              GError        **error)
+{
+  gchar *value, *end;
+  glong long_value;
+  gint result = 0;
+
+  g_return_val_if_fail (cache != NULL, 0);
+  g_return_val_if_fail (group_name != NULL, 0);
+  g_return_val_if_fail (key != NULL, 0);
+
+  if (cache->key_file)
+    return g_key_file_get_integer (cache->key_file, group_name, key, error);
+
+  value = g_key_file_cache_get_value (cache, group_name, key, error);
+  if (value == NULL)
+    return 0;
+
+  errno = 0;
+  long_value = strtol (value, &end, 10);
+
+  if (*value == '\0' || (*end != '\0' && !g_ascii_isspace (*end)) ||
+      errno == ERANGE || (gint) long_value != long_value)
+    g_set_error (error, G_KEY_FILE_ERROR,
+                 G_KEY_FILE_ERROR_INVALID_VALUE,
+                 _("Key file contains key '%s' in group '%s' "
+                   "which has a value that cannot be interpreted."),
+                 key, group_name);
+  else
+    result = long_value;
+
+  g_free (value);
+
+  return result;
+}
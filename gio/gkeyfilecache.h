@@ -0,0 +1,104 @@
+/* GIO - GLib Input, Output and Streaming Library
+ *
+ * Copyright © 2014 The GLib developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __G_KEY_FILE_CACHE_H__
+#define __G_KEY_FILE_CACHE_H__
+
+#if !defined (__GIO_GIO_H_INSIDE__) && !defined (GIO_COMPILATION)
+#error "Only <gio/gio.h> can be included directly."
+#endif
+
+#include <gio/giotypes.h>
+
+G_BEGIN_DECLS
+
+/**
+ * G_TYPE_KEY_FILE_CACHE:
+ *
+ * The #GType for #GKeyFileCache.
+ *
+ * Since: 2.44
+ */
+#define G_TYPE_KEY_FILE_CACHE (g_key_file_cache_get_type ())
+
+GLIB_AVAILABLE_IN_2_44
+GType           g_key_file_cache_get_type          (void) G_GNUC_CONST;
+
+GLIB_AVAILABLE_IN_2_44
+gboolean        g_key_file_cache_compile           (GKeyFile       *key_file,
+                                                    const gchar    *filename,
+                                                    GError        **error);
+GLIB_AVAILABLE_IN_2_44
+GKeyFileCache * g_key_file_cache_load              (const gchar    *filename,
+                                                    GError        **error);
+GLIB_AVAILABLE_IN_2_44
+GKeyFileCache * g_key_file_cache_new_for_file      (const gchar    *file,
+                                                    const gchar    *cache_file,
+                                                    GKeyFileFlags   flags,
+                                                    GError        **error);
+GLIB_AVAILABLE_IN_2_44
+GKeyFileCache * g_key_file_cache_ref               (GKeyFileCache  *cache);
+GLIB_AVAILABLE_IN_2_44
+void            g_key_file_cache_unref             (GKeyFileCache  *cache);
+
+GLIB_AVAILABLE_IN_2_44
+gchar **        g_key_file_cache_get_groups        (GKeyFileCache  *cache,
+                                                    gsize          *length);
+GLIB_AVAILABLE_IN_2_44
+gchar **        g_key_file_cache_get_keys          (GKeyFileCache  *cache,
+                                                    const gchar    *group_name,
+                                                    gsize          *length,
+                                                    GError        **error);
+GLIB_AVAILABLE_IN_2_44
+gboolean        g_key_file_cache_has_group         (GKeyFileCache  *cache,
+                                                    const gchar    *group_name);
+GLIB_AVAILABLE_IN_2_44
+gboolean        g_key_file_cache_has_key           (GKeyFileCache  *cache,
+                                                    const gchar    *group_name,
+                                                    const gchar    *key,
+                                                    GError        **error);
+GLIB_AVAILABLE_IN_2_44
+gchar *         g_key_file_cache_get_value         (GKeyFileCache  *cache,
+                                                    const gchar    *group_name,
+                                                    const gchar    *key,
+                                                    GError        **error);
+GLIB_AVAILABLE_IN_2_44
+gchar *         g_key_file_cache_get_string        (GKeyFileCache  *cache,
+                                                    const gchar    *group_name,
+                                                    const gchar    *key,
+                                                    GError        **error);
+GLIB_AVAILABLE_IN_2_44
+gchar *         g_key_file_cache_get_locale_string (GKeyFileCache  *cache,
+                                                    const gchar    *group_name,
+                                                    const gchar    *key,
+                                                    const gchar    *locale,
+                                                    GError        **error);
+GLIB_AVAILABLE_IN_2_44
+gboolean        g_key_file_cache_get_boolean       (GKeyFileCache  *cache,
+                                                    const gchar    *group_name,
+                                                    const gchar    *key,
+                                                    GError        **error);
+GLIB_AVAILABLE_IN_2_44
+gint            g_key_file_cache_get_integer       (GKeyFileCache  *cache,
+                                                    const gchar    *group_name,
+                                                    const gchar    *key,
+                                                    GError        **error);
+
+G_END_DECLS
+
+#endif /* __G_KEY_FILE_CACHE_H__ */
@@ -432,6 +432,7 @@ initable_init (GInitable     *initable,
   GSubprocess *self = G_SUBPROCESS (initable);
 #ifdef G_OS_UNIX
   ChildData child_data = { { -1, -1, -1 }, 0 };
+  gboolean need_child_setup;
 #endif
   gint *pipe_ptrs[3] = { NULL, NULL, NULL };
   gint pipe_fds[3] = { -1, -1, -1 };
@@ -537,6 +538,18 @@ initable_init (GInitable     *initable,
 #ifdef G_OS_UNIX
   child_data.child_setup_func = self->launcher ? self->launcher->child_setup_func : NULL;
   child_data.child_setup_data = self->launcher ? self->launcher->child_setup_user_data : NULL;
+
+  /* Only ask for a child setup function when there is work for it, so
+   * that g_spawn_async_with_pipes() can avoid fork() otherwise.
+   */
+  need_child_setup = child_data.child_setup_func != NULL;
+  for (i = 0; i < 3; i++)
+    if (child_data.fds[i] != -1)
+      need_child_setup = TRUE;
+  if (child_data.basic_fd_assignments && child_data.basic_fd_assignments->len > 0)
+    need_child_setup = TRUE;
+  if (child_data.needdup_fd_assignments && child_data.needdup_fd_assignments->len > 0)
+    need_child_setup = TRUE;
 #endif
 
   success = g_spawn_async_with_pipes (self->launcher ? self->launcher->cwd : NULL,
@@ -544,7 +557,8 @@ initable_init (GInitable     *initable,
                                       self->launcher ? self->launcher->envp : NULL,
                                       spawn_flags,
 #ifdef G_OS_UNIX
-                                      child_setup, &child_data,
+                                      need_child_setup ? child_setup : NULL,
+                                      need_child_setup ? &child_data : NULL,
 #else
                                       NULL, NULL,
 #endif
@@ -0,0 +1,231 @@
+/* GLib testing framework examples and tests
+ *
+ * This work is provided "as is"; redistribution and modification
+ * in whole or in part, in any medium, physical or electronic is
+ * permitted without restriction.
+ *
+ * This work is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * In no event shall the authors or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ */
+
+#include <gio/gio.h>
+#include <glib/gstdio.h>
+
+static const gchar contents[] =
+  "# comment\n"
+  "[Desktop Entry]\n"
+  "Name=Files\n"
+  "Name[de]=Dateien\n"
+  "Comment=Access\\sand organize files\n"
+  "Terminal=false\n"
+  "X-Count=42\n"
+  "X-Invalid=\\x\n"
+  "\n"
+  "[Desktop Action new-window]\n"
+  "Name=New Window\n"
+  "X-Binary=\xe2\x82\n";
+
+static void
+check_cache (GKeyFileCache *cache,
+             GKeyFile      *key_file)
+{
+  GError *error = NULL;
+  gchar **groups, **expected_groups;
+  gchar **keys, **expected_keys;
+  gsize i, j, n_groups, n_keys;
+
+  groups = g_key_file_cache_get_groups (cache, &n_groups);
+  expected_groups = g_key_file_get_groups (key_file, NULL);
+  g_assert_cmpuint (n_groups, ==, g_strv_length (expected_groups));
+
+  for (i = 0; i < n_groups; i++)
+    {
+      g_assert_cmpstr (groups[i], ==, expected_groups[i]);
+      g_assert (g_key_file_cache_has_group (cache, groups[i]));
+
+      keys = g_key_file_cache_get_keys (cache, groups[i], &n_keys, &error);
+      g_assert_no_error (error);
+      expected_keys = g_key_file_get_keys (key_file, groups[i], NULL, NULL);
+      g_assert_cmpuint (n_keys, ==, g_strv_length (expected_keys));
+
+      for (j = 0; j < n_keys; j++)
+        {
+          GError *expected_error = NULL;
+          gchar *value, *expected_value;
+
+          g_assert_cmpstr (keys[j], ==, expected_keys[j]);
+          g_assert (g_key_file_cache_has_key (cache, groups[i], keys[j], NULL));
+
+          value = g_key_file_cache_get_value (cache, groups[i], keys[j], &error);
+          g_assert_no_error (error);
+          expected_value = g_key_file_get_value (key_file, groups[i], keys[j], NULL);
+          g_assert_cmpstr (value, ==, expected_value);
+          g_free (value);
+          g_free (expected_value);
+
+          value = g_key_file_cache_get_string (cache, groups[i], keys[j], &error);
+          expected_value = g_key_file_get_string (key_file, groups[i], keys[j], &expected_error);
+          if (expected_error)
+            g_assert_error (error, expected_error->domain, expected_error->code);
+          else
+            {
+              g_assert_no_error (error);
+              g_assert_cmpstr (value, ==, expected_value);
+            }
+          g_clear_error (&error);
+          g_clear_error (&expected_error);
+          g_free (value);
+          g_free (expected_value);
+        }
+
+      g_strfreev (keys);
+      g_strfreev (expected_keys);
+    }
+
+  g_strfreev (groups);
+  g_strfreev (expected_groups);
+
+  g_assert (!g_key_file_cache_has_group (cache, "Nonexistent"));
+  g_assert (g_key_file_cache_get_keys (cache, "Nonexistent", NULL, &error) == NULL);
+  g_assert_error (error, G_KEY_FILE_ERROR, G_KEY_FILE_ERROR_GROUP_NOT_FOUND);
+  g_clear_error (&error);
+  g_assert (g_key_file_cache_get_value (cache, "Desktop Entry", "Nonexistent", &error) == NULL);
+  g_assert_error (error, G_KEY_FILE_ERROR, G_KEY_FILE_ERROR_KEY_NOT_FOUND);
+  g_clear_error (&error);
+
+  g_assert (!g_key_file_cache_get_boolean (cache, "Desktop Entry", "Terminal", &error));
+  g_assert_no_error (error);
+  g_key_file_cache_get_boolean (cache, "Desktop Entry", "Name", &error);
+  g_assert_error (error, G_KEY_FILE_ERROR, G_KEY_FILE_ERROR_INVALID_VALUE);
+  g_clear_error (&error);
+  g_assert_cmpint (g_key_file_cache_get_integer (cache, "Desktop Entry", "X-Count", &error), ==, 42);
+  g_assert_no_error (error);
+  g_key_file_cache_get_integer (cache, "Desktop Entry", "Name", &error);
+  g_assert_error (error, G_KEY_FILE_ERROR, G_KEY_FILE_ERROR_INVALID_VALUE);
+  g_clear_error (&error);
+}
+
+static void
+test_compile (void)
+{
+  GKeyFileCache *cache;
+  GKeyFile *key_file;
+  GError *error = NULL;
+  gchar *path, *name;
+
+  key_file = g_key_file_new ();
+  g_key_file_load_from_data (key_file, contents, -1, G_KEY_FILE_KEEP_TRANSLATIONS, &error);
+  g_assert_no_error (error);
+
+  path = g_build_filename (g_get_tmp_dir (), "keyfile-cache-XXXXXX", NULL);
+  g_close (g_mkstemp (path), NULL);
+
+  g_key_file_cache_compile (key_file, path, &error);
+  g_assert_no_error (error);
+
+  cache = g_key_file_cache_load (path, &error);
+  g_assert_no_error (error);
+  check_cache (cache, key_file);
+
+  name = g_key_file_cache_get_locale_string (cache, "Desktop Entry", "Name", "de_DE", &error);
+  g_assert_no_error (error);
+  g_assert_cmpstr (name, ==, "Dateien");
+  g_free (name);
+  name = g_key_file_cache_get_locale_string (cache, "Desktop Entry", "Name", "fr", &error);
+  g_assert_no_error (error);
+  g_assert_cmpstr (name, ==, "Files");
+  g_free (name);
+
+  g_key_file_cache_unref (cache);
+  g_key_file_free (key_file);
+
+  g_unlink (path);
+  g_free (path);
+}
+
+static void
+test_new_for_file (void)
+{
+  GKeyFileCache *cache;
+  GKeyFile *key_file;
+  GError *error = NULL;
+  gchar *path, *cache_path, *value;
+  gint i;
+
+  path = g_build_filename (g_get_tmp_dir (), "keyfile-cache-XXXXXX", NULL);
+  g_close (g_mkstemp (path), NULL);
+  cache_path = g_strconcat (path, ".cache", NULL);
+
+  g_file_set_contents (path, contents, -1, &error);
+  g_assert_no_error (error);
+
+  key_file = g_key_file_new ();
+  g_key_file_load_from_file (key_file, path, G_KEY_FILE_NONE, &error);
+  g_assert_no_error (error);
+
+  /* The first call writes the image, the second one uses it */
+  for (i = 0; i < 2; i++)
+    {
+      cache = g_key_file_cache_new_for_file (path, cache_path, G_KEY_FILE_NONE, &error);
+      g_assert_no_error (error);
+      check_cache (cache, key_file);
+      g_key_file_cache_unref (cache);
+
+      g_assert (g_file_test (cache_path, G_FILE_TEST_EXISTS));
+    }
+
+  g_key_file_free (key_file);
+
+  /* Changing the file invalidates the image */
+  g_file_set_contents (path, "[Desktop Entry]\nName=Changed\n", -1, &error);
+  g_assert_no_error (error);
+
+  cache = g_key_file_cache_new_for_file (path, cache_path, G_KEY_FILE_NONE, &error);
+  g_assert_no_error (error);
+  value = g_key_file_cache_get_string (cache, "Desktop Entry", "Name", &error);
+  g_assert_no_error (error);
+  g_assert_cmpstr (value, ==, "Changed");
+  g_free (value);
+  g_assert (!g_key_file_cache_has_group (cache, "Desktop Action new-window"));
+  g_key_file_cache_unref (cache);
+
+  cache = g_key_file_cache_load (cache_path, &error);
+  g_assert_no_error (error);
+  value = g_key_file_cache_get_string (cache, "Desktop Entry", "Name", &error);
+  g_assert_no_error (error);
+  g_assert_cmpstr (value, ==, "Changed");
+  g_free (value);
+  g_key_file_cache_unref (cache);
+
+  /* A missing file is an error even if the image exists */
+  g_unlink (path);
+  cache = g_key_file_cache_new_for_file (path, cache_path, G_KEY_FILE_NONE, &error);
+  g_assert (cache == NULL);
+  g_assert_error (error, G_FILE_ERROR, G_FILE_ERROR_NOENT);
+  g_clear_error (&error);
+
+  g_unlink (cache_path);
+  g_free (cache_path);
+  g_free (path);
+}
+
+int
+main (int argc, char **argv)
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/keyfile-cache/compile", test_compile);
+  g_test_add_func ("/keyfile-cache/new-for-file", test_new_for_file);
+
+  return g_test_run ();
+}
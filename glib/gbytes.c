@@ -30,6 +30,7 @@
 #include <glib/gtestutils.h>
 #include <glib/gmem.h>
 #include <glib/gmessages.h>
+#include <glib/gthread.h>
 
 #include <string.h>
 
@@ -496,3 +497,548 @@ g_bytes_unref_to_array (GBytes *bytes)
   data = g_bytes_unref_to_data (bytes, &size);
   return g_byte_array_new_take (data, size);
 }
+
+/**
+ * GBytesVector:
+ * @data: the start of the memory region
+ * @size: the length of the memory region in bytes
+ *
+ * One contiguous region of a #GBytesChain, as returned by
+ * g_bytes_chain_get_vectors().
+ *
+ * On UNIX, #GBytesVector has the same layout as struct iovec, so an
+ * array of them can be passed to writev() or sendmsg() directly.
+ *
+ * Since: 2.44
+ */
+
+/**
+ * GBytesChain:
+ *
+ * A #GBytesChain is a sequence of #GBytes that is treated as one
+ * contiguous run of bytes, without copying the data of the individual
+ * #GBytes into one buffer.
+ *
+ * This is useful to assemble a message out of several buffers, for
+ * example a header and a body that come from different places.
+ * g_bytes_chain_get_vectors() exposes the pieces for scatter-gather
+ * I/O, and g_bytes_chain_skip() drops the part that has been written
+ * after a short write.  If a single buffer is needed after all,
+ * g_bytes_chain_flatten() copies the data once and then keeps the
+ * result.
+ *
+ * Unlike #GBytes, a #GBytesChain is mutable and must not be modified
+ * from several threads at once.
+ *
+ * Since: 2.44
+ */
+
+#ifdef G_OS_UNIX
+#include <sys/uio.h>
+
+G_STATIC_ASSERT (sizeof (GBytesVector) == sizeof (struct iovec));
+G_STATIC_ASSERT (G_STRUCT_OFFSET (GBytesVector, data) == G_STRUCT_OFFSET (struct iovec, iov_base));
+G_STATIC_ASSERT (G_STRUCT_OFFSET (GBytesVector, size) == G_STRUCT_OFFSET (struct iovec, iov_len));
+#endif
+
+struct _GBytesChain
+{
+  GPtrArray *bytes;    /* GBytes, owned */
+  GArray *vectors;     /* GBytesVector, one for each of @bytes */
+  gsize size;
+  gint ref_count;
+};
+
+/**
+ * g_bytes_chain_new:
+ *
+ * Creates a new, empty #GBytesChain.
+ *
+ * Returns: (transfer full): a new #GBytesChain
+ *
+ * Since: 2.44
+ */
+GBytesChain *
+g_bytes_chain_new (void)
+{
+  GBytesChain *chain;
+
+  chain = g_slice_new (GBytesChain);
+  chain->bytes = g_ptr_array_new_with_free_func ((GDestroyNotify) g_bytes_unref);
+  chain->vectors = g_array_new (FALSE, FALSE, sizeof (GBytesVector));
+  chain->size = 0;
+  chain->ref_count = 1;
+
+  return chain;
+}
+
+/**
+ * g_bytes_chain_ref:
+ * @chain: a #GBytesChain
+ *
+ * Increase the reference count on @chain.
+ *
+ * Returns: the #GBytesChain
+ *
+ * Since: 2.44
+ */
+GBytesChain *
+g_bytes_chain_ref (GBytesChain *chain)
+{
+  g_return_val_if_fail (chain != NULL, NULL);
+
+  g_atomic_int_inc (&chain->ref_count);
+
+  return chain;
+}
+
+/**
+ * g_bytes_chain_unref:
+ * @chain: (allow-none): a #GBytesChain
+ *
+ * Releases a reference on @chain.  When the last reference is
+ * dropped, the references on all the #GBytes in the chain are released
+ * as well.
+ *
+ * Since: 2.44
+ */
+void
+g_bytes_chain_unref (GBytesChain *chain)
+{
+  if (chain == NULL)
+    return;
+
+  if (g_atomic_int_dec_and_test (&chain->ref_count))
+    {
+      g_ptr_array_unref (chain->bytes);
+      g_array_unref (chain->vectors);
+      g_slice_free (GBytesChain, chain);
+    }
+}
+
+/**
+ * g_bytes_chain_append:
+ * @chain: a #GBytesChain
+ * @bytes: a #GBytes
+ *
+ * Appends the data of @bytes to the end of @chain.  The data is not
+ * copied; a reference on @bytes is held instead.
+ *
+ * Since: 2.44
+ */
+void
+g_bytes_chain_append (GBytesChain *chain,
+                      GBytes      *bytes)
+{
+  GBytesVector vector;
+
+  g_return_if_fail (chain != NULL);
+  g_return_if_fail (bytes != NULL);
+
+  if (bytes->size == 0)
+    return;
+
+  vector.data = bytes->data;
+  vector.size = bytes->size;
+
+  g_ptr_array_add (chain->bytes, g_bytes_ref (bytes));
+  g_array_append_val (chain->vectors, vector);
+  chain->size += bytes->size;
+}
+
+/**
+ * g_bytes_chain_get_size:
+ * @chain: a #GBytesChain
+ *
+ * Gets the total number of bytes in @chain.
+ *
+ * Returns: the size
+ *
+ * Since: 2.44
+ */
+gsize
+g_bytes_chain_get_size (GBytesChain *chain)
+{
+  g_return_val_if_fail (chain != NULL, 0);
+
+  return chain->size;
+}
+
+/**
+ * g_bytes_chain_get_vectors:
+ * @chain: a #GBytesChain
+ * @n_vectors: (out): location to return the number of vectors
+ *
+ * Gets the memory regions making up @chain, in order.  Empty regions
+ * are never included, so @n_vectors is 0 only if @chain is empty.
+ *
+ * The returned array is owned by @chain and stays valid until @chain
+ * is modified.
+ *
+ * Returns: (transfer none) (array length=n_vectors): the vectors
+ *
+ * Since: 2.44
+ */
+const GBytesVector *
+g_bytes_chain_get_vectors (GBytesChain *chain,
+                           guint       *n_vectors)
+{
+  g_return_val_if_fail (chain != NULL, NULL);
+  g_return_val_if_fail (n_vectors != NULL, NULL);
+
+  *n_vectors = chain->vectors->len;
+
+  return (const GBytesVector *) chain->vectors->data;
+}
+
+/**
+ * g_bytes_chain_skip:
+ * @chain: a #GBytesChain
+ * @count: the number of bytes to remove
+ *
+ * Removes @count bytes from the start of @chain, for example the part
+ * of the data that a writev() call managed to write.  #GBytes that
+ * are no longer part of the chain are released.
+ *
+ * Since: 2.44
+ */
+void
+g_bytes_chain_skip (GBytesChain *chain,
+                    gsize        count)
+{
+  GBytesVector *vectors;
+  guint n;
+
+  g_return_if_fail (chain != NULL);
+  g_return_if_fail (count <= chain->size);
+
+  chain->size -= count;
+
+  vectors = (GBytesVector *) chain->vectors->data;
+  for (n = 0; n < chain->vectors->len && vectors[n].size <= count; n++)
+    count -= vectors[n].size;
+
+  if (n > 0)
+    {
+      g_ptr_array_remove_range (chain->bytes, 0, n);
+      g_array_remove_range (chain->vectors, 0, n);
+    }
+
+  /* Keep the first GBytes as it is and only move the vector */
+  if (count > 0)
+    {
+      vectors = (GBytesVector *) chain->vectors->data;
+      vectors[0].data = (const gchar *) vectors[0].data + count;
+      vectors[0].size -= count;
+    }
+}
+
+/**
+ * g_bytes_chain_flatten:
+ * @chain: a #GBytesChain
+ *
+ * Gets the contents of @chain as a single #GBytes.
+ *
+ * If @chain consists of more than one region, the data is copied into
+ * a new buffer, which then replaces the contents of @chain, so that
+ * the copy is only made once.  Otherwise, no data is copied.
+ *
+ * Returns: (transfer full): a #GBytes with the contents of @chain
+ *
+ * Since: 2.44
+ */
+GBytes *
+g_bytes_chain_flatten (GBytesChain *chain)
+{
+  GBytesVector *vectors;
+  GBytes *first;
+  GBytes *flat;
+  gchar *data;
+  guint i;
+
+  g_return_val_if_fail (chain != NULL, NULL);
+
+  vectors = (GBytesVector *) chain->vectors->data;
+
+  if (chain->vectors->len == 0)
+    return g_bytes_new_static (NULL, 0);
+
+  if (chain->vectors->len == 1)
+    {
+      first = g_ptr_array_index (chain->bytes, 0);
+      if (vectors[0].size == first->size)
+        return g_bytes_ref (first);
+
+      return g_bytes_new_from_bytes (first,
+                                     (const gchar *) vectors[0].data - (const gchar *) first->data,
+                                     vectors[0].size);
+    }
+
+  data = g_malloc (chain->size);
+  flat = g_bytes_new_take (data, chain->size);
+
+  for (i = 0; i < chain->vectors->len; i++)
+    {
+      memcpy (data, vectors[i].data, vectors[i].size);
+      data += vectors[i].size;
+    }
+
+  g_ptr_array_remove_range (chain->bytes, 0, chain->bytes->len);
+  g_array_set_size (chain->vectors, 0);
+  chain->size = 0;
+  g_bytes_chain_append (chain, flat);
+
+  return flat;
+}
+
+/**
+ * GBytesPool:
+ *
+ * A #GBytesPool hands out fixed-size buffers and recycles them, which
+ * avoids going through the allocator for every read in I/O code that
+ * continuously needs buffers of the same size.
+ *
+ * Get a buffer with g_bytes_pool_alloc(), fill it, and turn it into a
+ * #GBytes with g_bytes_pool_take().  When the last reference to that
+ * #GBytes is dropped, the buffer goes back into the pool instead of
+ * being freed.  Buffers that end up not being needed can be returned
+ * directly with g_bytes_pool_release().
+ *
+ * The pool keeps at most a given number of unused buffers around; any
+ * buffer that is returned when the pool is full is freed.  A pool is
+ * kept alive for as long as any of its buffers are in use.
+ *
+ * All the functions on #GBytesPool are thread-safe.
+ *
+ * Since: 2.44
+ */
+
+struct _GBytesPool
+{
+  GMutex lock;
+  gpointer free_list;
+  guint n_free;
+  guint max_free;
+  gsize buffer_size;
+  gint ref_count;
+};
+
+/* Each buffer is preceded by a header that points back at its pool.
+ * It is two pointers large, so that the data keeps the alignment that
+ * g_malloc() guarantees.
+ */
+typedef union
+{
+  GBytesPool *pool;
+  gpointer next;
+  gpointer padding[2];
+} GBytesPoolHeader;
+
+#define POOL_HEADER(data) ((GBytesPoolHeader *) (data) - 1)
+
+/**
+ * g_bytes_pool_new:
+ * @buffer_size: the size of the buffers handed out by the pool
+ * @max_free: the maximum number of unused buffers to keep around
+ *
+ * Creates a new #GBytesPool.
+ *
+ * Returns: (transfer full): a new #GBytesPool
+ *
+ * Since: 2.44
+ */
+GBytesPool *
+g_bytes_pool_new (gsize buffer_size,
+                  guint max_free)
+{
+  GBytesPool *pool;
+
+  g_return_val_if_fail (buffer_size > 0, NULL);
+
+  pool = g_slice_new (GBytesPool);
+  g_mutex_init (&pool->lock);
+  pool->free_list = NULL;
+  pool->n_free = 0;
+  pool->max_free = max_free;
+  pool->buffer_size = buffer_size;
+  pool->ref_count = 1;
+
+  return pool;
+}
+
+/**
+ * g_bytes_pool_ref:
+ * @pool: a #GBytesPool
+ *
+ * Increase the reference count on @pool.
+ *
+ * Returns: the #GBytesPool
+ *
+ * Since: 2.44
+ */
+GBytesPool *
+g_bytes_pool_ref (GBytesPool *pool)
+{
+  g_return_val_if_fail (pool != NULL, NULL);
+
+  g_atomic_int_inc (&pool->ref_count);
+
+  return pool;
+}
+
+/**
+ * g_bytes_pool_unref:
+ * @pool: (allow-none): a #GBytesPool
+ *
+ * Releases a reference on @pool.  The pool and its unused buffers are
+ * freed once the last reference is gone and none of its buffers are
+ * in use any longer.
+ *
+ * Since: 2.44
+ */
+void
+g_bytes_pool_unref (GBytesPool *pool)
+{
+  if (pool == NULL)
+    return;
+
+  if (g_atomic_int_dec_and_test (&pool->ref_count))
+    {
+      while (pool->free_list != NULL)
+        {
+          GBytesPoolHeader *header = pool->free_list;
+
+          pool->free_list = header->next;
+          g_free (header);
+        }
+
+      g_mutex_clear (&pool->lock);
+      g_slice_free (GBytesPool, pool);
+    }
+}
+
+/**
+ * g_bytes_pool_get_buffer_size:
+ * @pool: a #GBytesPool
+ *
+ * Gets the size of the buffers handed out by @pool.
+ *
+ * Returns: the buffer size
+ *
+ * Since: 2.44
+ */
+gsize
+g_bytes_pool_get_buffer_size (GBytesPool *pool)
+{
+  g_return_val_if_fail (pool != NULL, 0);
+
+  return pool->buffer_size;
+}
+
+/**
+ * g_bytes_pool_alloc:
+ * @pool: a #GBytesPool
+ *
+ * Gets an unused buffer from @pool, or allocates a new one if there
+ * are none.  The buffer is g_bytes_pool_get_buffer_size() bytes large
+ * and its contents are undefined.
+ *
+ * The buffer must be handed back with either g_bytes_pool_take() or
+ * g_bytes_pool_release().
+ *
+ * Returns: (transfer full): a buffer
+ *
+ * Since: 2.44
+ */
+gpointer
+g_bytes_pool_alloc (GBytesPool *pool)
+{
+  GBytesPoolHeader *header;
+
+  g_return_val_if_fail (pool != NULL, NULL);
+
+  g_mutex_lock (&pool->lock);
+  header = pool->free_list;
+  if (header != NULL)
+    {
+      pool->free_list = header->next;
+      pool->n_free--;
+    }
+  g_mutex_unlock (&pool->lock);
+
+  if (header == NULL)
+    header = g_malloc (sizeof (GBytesPoolHeader) + pool->buffer_size);
+
+  header->pool = g_bytes_pool_ref (pool);
+
+  return header + 1;
+}
+
+/**
+ * g_bytes_pool_release:
+ * @pool: a #GBytesPool
+ * @data: a buffer returned by g_bytes_pool_alloc() on @pool
+ *
+ * Returns @data to @pool without wrapping it in a #GBytes first.
+ *
+ * Since: 2.44
+ */
+void
+g_bytes_pool_release (GBytesPool *pool,
+                      gpointer    data)
+{
+  GBytesPoolHeader *header;
+
+  g_return_if_fail (pool != NULL);
+  g_return_if_fail (data != NULL);
+
+  header = POOL_HEADER (data);
+  g_return_if_fail (header->pool == pool);
+
+  g_mutex_lock (&pool->lock);
+  if (pool->n_free < pool->max_free)
+    {
+      header->next = pool->free_list;
+      pool->free_list = header;
+      pool->n_free++;
+      header = NULL;
+    }
+  g_mutex_unlock (&pool->lock);
+
+  g_free (header);
+
+  g_bytes_pool_unref (pool);
+}
+
+static void
+g_bytes_pool_release_buffer (gpointer data)
+{
+  g_bytes_pool_release (POOL_HEADER (data)->pool, data);
+}
+
+/**
+ * g_bytes_pool_take:
+ * @pool: a #GBytesPool
+ * @data: (transfer full): a buffer returned by g_bytes_pool_alloc() on @pool
+ * @size: the number of bytes of @data to use
+ *
+ * Creates a #GBytes for the first @size bytes of @data.  @data is
+ * returned to @pool when the last reference to the #GBytes is
+ * dropped.
+ *
+ * Returns: (transfer full): a new #GBytes
+ *
+ * Since: 2.44
+ */
+GBytes *
+g_bytes_pool_take (GBytesPool *pool,
+                   gpointer    data,
+                   gsize       size)
+{
+  g_return_val_if_fail (pool != NULL, NULL);
+  g_return_val_if_fail (data != NULL, NULL);
+  g_return_val_if_fail (POOL_HEADER (data)->pool == pool, NULL);
+  g_return_val_if_fail (size <= pool->buffer_size, NULL);
+
+  return g_bytes_new_with_free_func (data, size, g_bytes_pool_release_buffer, data);
+}
@@ -85,6 +85,56 @@ GLIB_AVAILABLE_IN_ALL
 gint            g_bytes_compare                 (gconstpointer   bytes1,
                                                  gconstpointer   bytes2);
 
+typedef struct _GBytesChain GBytesChain;
+typedef struct _GBytesPool  GBytesPool;
+typedef struct _GBytesVector GBytesVector;
+
+struct _GBytesVector
+{
+  gconstpointer data;
+  gsize         size;
+};
+
+GLIB_AVAILABLE_IN_2_44
+GBytesChain *   g_bytes_chain_new               (void);
+GLIB_AVAILABLE_IN_2_44
+GBytesChain *   g_bytes_chain_ref               (GBytesChain    *chain);
+GLIB_AVAILABLE_IN_2_44
+void            g_bytes_chain_unref             (GBytesChain    *chain);
+GLIB_AVAILABLE_IN_2_44
+void            g_bytes_chain_append            (GBytesChain    *chain,
+                                                 GBytes         *bytes);
+GLIB_AVAILABLE_IN_2_44
+gsize           g_bytes_chain_get_size          (GBytesChain    *chain);
+GLIB_AVAILABLE_IN_2_44
+const GBytesVector *
+                g_bytes_chain_get_vectors       (GBytesChain    *chain,
+                                                 guint          *n_vectors);
+GLIB_AVAILABLE_IN_2_44
+void            g_bytes_chain_skip              (GBytesChain    *chain,
+                                                 gsize           count);
+GLIB_AVAILABLE_IN_2_44
+GBytes *        g_bytes_chain_flatten           (GBytesChain    *chain);
+
+GLIB_AVAILABLE_IN_2_44
+GBytesPool *    g_bytes_pool_new                (gsize           buffer_size,
+                                                 guint           max_free);
+GLIB_AVAILABLE_IN_2_44
+GBytesPool *    g_bytes_pool_ref                (GBytesPool     *pool);
+GLIB_AVAILABLE_IN_2_44
+void            g_bytes_pool_unref              (GBytesPool     *pool);
+GLIB_AVAILABLE_IN_2_44
+gsize           g_bytes_pool_get_buffer_size    (GBytesPool     *pool);
+GLIB_AVAILABLE_IN_2_44
+gpointer        g_bytes_pool_alloc              (GBytesPool     *pool);
+GLIB_AVAILABLE_IN_2_44
+void            g_bytes_pool_release            (GBytesPool     *pool,
+                                                 gpointer        data);
+GLIB_AVAILABLE_IN_2_44
+GBytes *        g_bytes_pool_take               (GBytesPool     *pool,
+                                                 gpointer        data,
+                                                 gsize           size);
+
 G_END_DECLS
 
 #endif /* __G_BYTES_H__ */
@@ -168,6 +168,390 @@
 
 G_DEFINE_QUARK (g_convert_error, g_convert_error)
 
+/* Conversions between UTF-8, Latin-1, UTF-16 and UTF-32 are done
+ * without iconv().  None of these converters has any state, so a
+ * converter is just a pointer into fast_converters[], the index of
+ * which encodes the two charsets; g_iconv() and g_iconv_close()
+ * recognize such pointers by their address.
+ */
+typedef enum
+{
+  FAST_CHARSET_UTF8,
+  FAST_CHARSET_LATIN1,
+  FAST_CHARSET_UTF16LE,
+  FAST_CHARSET_UTF16BE,
+  FAST_CHARSET_UTF32LE,
+  FAST_CHARSET_UTF32BE,
+  N_FAST_CHARSETS,
+  FAST_CHARSET_NONE = N_FAST_CHARSETS
+} FastCharset;
+
+static const gchar fast_converters[N_FAST_CHARSETS * N_FAST_CHARSETS];
+
+#define IS_FAST_CONVERTER(cd) \
+  ((guintptr) (cd) >= (guintptr) fast_converters && \
+   (guintptr) (cd) < (guintptr) (fast_converters + sizeof fast_converters))
+
+/* Puts @codeset in the form iconv compares names in: upper case,
+ * without punctuation, and without suffixes such as "//TRANSLIT".
+ * Returns %FALSE if it is too long for @name.
+ */
+static gboolean
+canonicalize_codeset (const gchar *codeset,
+                      gchar       *name,
+                      gsize        name_size)
+{
+  gsize n;
+
+  for (n = 0; *codeset && *codeset != '/'; codeset++)
+    {
+      if (!g_ascii_isalnum (*codeset))
+        continue;
+      if (n == name_size - 1)
+        return FALSE;
+      name[n++] = g_ascii_toupper (*codeset);
+    }
+  name[n] = '\0';
+
+  return TRUE;
+}
+
+static FastCharset
+get_fast_charset (const gchar *codeset)
+{
+  static const struct {
+    const gchar *name;
+    FastCharset  charset;
+  } names[] = {
+    { "UTF8",     FAST_CHARSET_UTF8 },
+    { "ISO88591", FAST_CHARSET_LATIN1 },
+    { "LATIN1",   FAST_CHARSET_LATIN1 },
+    { "UTF16LE",  FAST_CHARSET_UTF16LE },
+    { "UTF16BE",  FAST_CHARSET_UTF16BE },
+    { "UTF32LE",  FAST_CHARSET_UTF32LE },
+    { "UTF32BE",  FAST_CHARSET_UTF32BE }
+  };
+  gchar name[16];
+  gsize i;
+
+  /* Suffixes change the behaviour of iconv() */
+  if (strchr (codeset, '/') != NULL ||
+      !canonicalize_codeset (codeset, name, sizeof name))
+    return FAST_CHARSET_NONE;
+
+  for (i = 0; i < G_N_ELEMENTS (names); i++)
+    if (strcmp (name, names[i].name) == 0)
+      return names[i].charset;
+
+  return FAST_CHARSET_NONE;
+}
+
+/* Decodes one character from the @len bytes at @in.  Returns the
+ * number of bytes used, 0 if the input ends in the middle of the
+ * character, or -1 if it is not valid.
+ */
+static gssize
+fast_decode (FastCharset   charset,
+             const guchar *in,
+             gsize         len,
+             gunichar     *ch)
+{
+  gunichar c, c2;
+  gsize n, i;
+  guchar lo, hi;
+
+  switch (charset)
+    {
+    case FAST_CHARSET_UTF8:
+      c = in[0];
+      if (c < 0x80)
+        {
+          *ch = c;
+          return 1;
+        }
+
+      /* Well-formed UTF-8 as in table 3-7 of the Unicode standard */
+      lo = 0x80;
+      hi = 0xbf;
+      if (c >= 0xc2 && c <= 0xdf)
+        {
+          n = 2;
+          c &= 0x1f;
+        }
+      else if (c >= 0xe0 && c <= 0xef)
+        {
+          n = 3;
+          if (c == 0xe0)
+            lo = 0xa0;
+          else if (c == 0xed)
+            hi = 0x9f;
+          c &= 0x0f;
+        }
+      else if (c >= 0xf0 && c <= 0xf4)
+        {
+          n = 4;
+          if (c == 0xf0)
+            lo = 0x90;
+          else if (c == 0xf4)
+            hi = 0x8f;
+          c &= 0x07;
+        }
+      else
+        return -1;
+
+      /* Like iconv(), treat anything that could still become a
+       * character as incomplete
+       */
+      if (n > len)
+        {
+          for (i = 1; i < len; i++)
+            if ((in[i] & 0xc0) != 0x80)
+              return -1;
+          return 0;
+        }
+
+      for (i = 1; i < n; i++)
+        {
+          if (in[i] < lo || in[i] > hi)
+            return -1;
+          c = (c << 6) | (in[i] & 0x3f);
+          lo = 0x80;
+          hi = 0xbf;
+        }
+
+      *ch = c;
+      return n;
+
+    case FAST_CHARSET_LATIN1:
+      *ch = in[0];
+      return 1;
+
+    case FAST_CHARSET_UTF16LE:
+    case FAST_CHARSET_UTF16BE:
+      if (len < 2)
+        return 0;
+      if (charset == FAST_CHARSET_UTF16LE)
+        c = in[0] | (in[1] << 8);
+      else
+        c = (in[0] << 8) | in[1];
+
+      if (c < 0xd800 || c > 0xdfff)
+        {
+          *ch = c;
+          return 2;
+        }
+      if (c > 0xdbff)
+        return -1;
+
+      if (len < 4)
+        return 0;
+      if (charset == FAST_CHARSET_UTF16LE)
+        c2 = in[2] | (in[3] << 8);
+      else
+        c2 = (in[2] << 8) | in[3];
+      if (c2 < 0xdc00 || c2 > 0xdfff)
+        return -1;
+
+      *ch = 0x10000 + ((c - 0xd800) << 10) + (c2 - 0xdc00);
+      return 4;
+
+    case FAST_CHARSET_UTF32LE:
+    case FAST_CHARSET_UTF32BE:
+      if (len < 4)
+        return 0;
+      if (charset == FAST_CHARSET_UTF32LE)
+        c = in[0] | (in[1] << 8) | (in[2] << 16) | ((gunichar) in[3] << 24);
+      else
+        c = ((gunichar) in[0] << 24) | (in[1] << 16) | (in[2] << 8) | in[3];
+      if (c > 0x10ffff || (c >= 0xd800 && c <= 0xdfff))
+        return -1;
+
+      *ch = c;
+      return 4;
+
+    default:
+      break;
+    }
+
+  g_assert_not_reached ();
+  return -1;
+}
+
+/* Returns the number of bytes needed to encode @ch, or -1 if it
+ * cannot be represented.
+ */
+static gssize
+fast_encoded_length (FastCharset charset,
+                     gunichar    ch)
+{
+  switch (charset)
+    {
+    case FAST_CHARSET_UTF8:
+      return ch < 0x80 ? 1 : ch < 0x800 ? 2 : ch < 0x10000 ? 3 : 4;
+    case FAST_CHARSET_LATIN1:
+      return ch < 0x100 ? 1 : -1;
+    case FAST_CHARSET_UTF16LE:
+    case FAST_CHARSET_UTF16BE:
+      return ch < 0x10000 ? 2 : 4;
+    case FAST_CHARSET_UTF32LE:
+    case FAST_CHARSET_UTF32BE:
+      return 4;
+    default:
+      break;
+    }
+
+  g_assert_not_reached ();
+  return -1;
+}
+
+static void
+put_uint16 (guchar  *out,
+            guint    v,
+            gboolean le)
+{
+  out[le ? 0 : 1] = v & 0xff;
+  out[le ? 1 : 0] = v >> 8;
+}
+
+static void
+fast_encode (FastCharset  charset,
+             gunichar     ch,
+             guchar      *out)
+{
+  gboolean le;
+
+  switch (charset)
+    {
+    case FAST_CHARSET_UTF8:
+      g_unichar_to_utf8 (ch, (gchar *) out);
+      break;
+
+    case FAST_CHARSET_LATIN1:
+      out[0] = ch;
+      break;
+
+    case FAST_CHARSET_UTF16LE:
+    case FAST_CHARSET_UTF16BE:
+      le = charset == FAST_CHARSET_UTF16LE;
+      if (ch < 0x10000)
+        put_uint16 (out, ch, le);
+      else
+        {
+          put_uint16 (out, 0xd800 + ((ch - 0x10000) >> 10), le);
+          put_uint16 (out + 2, 0xdc00 + ((ch - 0x10000) & 0x3ff), le);
+        }
+      break;
+
+    case FAST_CHARSET_UTF32LE:
+    case FAST_CHARSET_UTF32BE:
+      le = charset == FAST_CHARSET_UTF32LE;
+      put_uint16 (out + (le ? 0 : 2), ch & 0xffff, le);
+      put_uint16 (out + (le ? 2 : 0), ch >> 16, le);
+      break;
+
+    default:
+      g_assert_not_reached ();
+    }
+}
+
+/* iconv() for the converters in fast_converters[] */
+static gsize
+fast_iconv (GIConv   converter,
+            gchar  **inbuf,
+            gsize   *inbytes_left,
+            gchar  **outbuf,
+            gsize   *outbytes_left)
+{
+  const guint64 high_bits = G_GUINT64_CONSTANT (0x8080808080808080);
+  gsize index = (const gchar *) converter - fast_converters;
+  FastCharset to = index / N_FAST_CHARSETS;
+  FastCharset from = index % N_FAST_CHARSETS;
+  gboolean bytewise;
+  const guchar *in, *in_end;
+  guchar *out, *out_end;
+  gsize result = 0;
+  gssize in_len, out_len;
+  guint64 word;
+  gunichar ch;
+
+  /* There is no shift state to reset */
+  if (inbuf == NULL || *inbuf == NULL)
+    return 0;
+
+  /* Between UTF-8 and Latin-1, ASCII is copied through */
+  bytewise = (from == FAST_CHARSET_UTF8 || from == FAST_CHARSET_LATIN1) &&
+             (to == FAST_CHARSET_UTF8 || to == FAST_CHARSET_LATIN1);
+
+  in = (const guchar *) *inbuf;
+  in_end = in + *inbytes_left;
+  out = (guchar *) *outbuf;
+  out_end = out + *outbytes_left;
+
+  while (in < in_end)
+    {
+      if (bytewise && *in < 0x80)
+        {
+          const guchar *run_end = in + MIN (in_end - in, out_end - out);
+          const guchar *p = in;
+
+          while (run_end - p >= 8)
+            {
+              memcpy (&word, p, 8);
+              if (word & high_bits)
+                break;
+              p += 8;
+            }
+          while (p < run_end && *p < 0x80)
+            p++;
+
+          if (p == in)
+            {
+              errno = E2BIG;
+              result = (gsize) -1;
+              break;
+            }
+
+          memcpy (out, in, p - in);
+          out += p - in;
+          in = p;
+          continue;
+        }
+
+      in_len = fast_decode (from, in, in_end - in, &ch);
+      if (in_len <= 0)
+        {
+          errno = in_len == 0 ? EINVAL : EILSEQ;
+          result = (gsize) -1;
+          break;
+        }
+
+      out_len = fast_encoded_length (to, ch);
+      if (out_len < 0)
+        {
+          errno = EILSEQ;
+          result = (gsize) -1;
+          break;
+        }
+      if (out_len > out_end - out)
+        {
+          errno = E2BIG;
+          result = (gsize) -1;
+          break;
+        }
+
+      fast_encode (to, ch, out);
+      in += in_len;
+      out += out_len;
+    }
+
+  *inbuf = (gchar *) in;
+  *inbytes_left = in_end - in;
+  *outbuf = (gchar *) out;
+  *outbytes_left = out_end - out;
+
+  return result;
+}
+
 static gboolean
 try_conversion (const char *to_codeset,
 		const char *from_codeset,
@@ -212,6 +596,10 @@ try_to_aliases (const char **to_aliases,
  * 
  * GLib provides g_convert() and g_locale_to_utf8() which are likely
  * more convenient than the raw iconv wrappers.
+ *
+ * Since GLib 2.44, conversions between UTF-8, ISO-8859-1, UTF-16LE,
+ * UTF-16BE, UTF-32LE and UTF-32BE are done by GLib itself, without
+ * going through iconv().
  * 
  * Returns: a "conversion descriptor", or (GIConv)-1 if
  *  opening the converter failed.
@@ -221,6 +609,12 @@ g_iconv_open (const gchar  *to_codeset,
 	      const gchar  *from_codeset)
 {
   iconv_t cd;
+  FastCharset to_fast, from_fast;
+
+  to_fast = get_fast_charset (to_codeset);
+  from_fast = get_fast_charset (from_codeset);
+  if (to_fast != FAST_CHARSET_NONE && from_fast != FAST_CHARSET_NONE)
+    return (GIConv) &fast_converters[to_fast * N_FAST_CHARSETS + from_fast];
   
   if (!try_conversion (to_codeset, from_codeset, &cd))
     {
@@ -276,6 +670,9 @@ g_iconv (GIConv   converter,
 {
   iconv_t cd = (iconv_t)converter;
 
+  if (IS_FAST_CONVERTER (converter))
+    return fast_iconv (converter, inbuf, inbytes_left, outbuf, outbytes_left);
+
   return iconv (cd, inbuf, inbytes_left, outbuf, outbytes_left);
 }
 
@@ -299,15 +696,100 @@ g_iconv_close (GIConv converter)
 {
   iconv_t cd = (iconv_t)converter;
 
+  if (IS_FAST_CONVERTER (converter))
+    return 0;
+
   return iconv_close (cd);
 }
 
+/* Opening an iconv descriptor is expensive, so each thread keeps the
+ * descriptors that g_convert() and friends used most recently.
+ * Descriptors handed out by open_converter() are marked as in use
+ * until close_converter() gives them back.
+ */
+#define ICONV_CACHE_SIZE 8
+
+typedef struct
+{
+  gchar   *to_codeset;
+  gchar   *from_codeset;
+  GIConv   cd;
+  guint    stamp;
+  gboolean in_use;
+} IConvCacheEntry;
+
+typedef struct
+{
+  IConvCacheEntry entries[ICONV_CACHE_SIZE];
+  guint           n_entries;
+  guint           stamp;
+} IConvCache;
+
+/* Resetting an iconv descriptor only resets its shift state.  The
+ * Unicode encodings that read or write a byte order mark also
+ * remember whether they have seen or written it, so their
+ * descriptors can't be reused.
+ */
+static gboolean
+is_cacheable_codeset (const gchar *codeset)
+{
+  gchar name[64];
+
+  if (!canonicalize_codeset (codeset, name, sizeof name))
+    return FALSE;
+
+  if (strcmp (name, "UTF8") == 0)
+    return TRUE;
+
+  return !g_str_has_prefix (name, "UTF") &&
+         !g_str_has_prefix (name, "UCS") &&
+         !g_str_has_prefix (name, "UNICODE");
+}
+
+static void
+iconv_cache_free (gpointer data)
+{
+  IConvCache *cache = data;
+  guint i;
+
+  for (i = 0; i < cache->n_entries; i++)
+    {
+      g_iconv_close (cache->entries[i].cd);
+      g_free (cache->entries[i].to_codeset);
+      g_free (cache->entries[i].from_codeset);
+    }
+
+  g_free (cache);
+}
+
+static GPrivate iconv_cache_private = G_PRIVATE_INIT (iconv_cache_free);
+
 static GIConv
 open_converter (const gchar *to_codeset,
 		const gchar *from_codeset,
 		GError     **error)
 {
+  IConvCache *cache;
   GIConv cd;
+  guint i;
+
+  cache = g_private_get (&iconv_cache_private);
+  if (cache)
+    {
+      for (i = 0; i < cache->n_entries; i++)
+        {
+          IConvCacheEntry *entry = &cache->entries[i];
+
+          if (!entry->in_use &&
+              strcmp (entry->to_codeset, to_codeset) == 0 &&
+              strcmp (entry->from_codeset, from_codeset) == 0)
+            {
+              entry->in_use = TRUE;
+              entry->stamp = ++cache->stamp;
+              return entry->cd;
+            }
+        }
+    }
 
   cd = g_iconv_open (to_codeset, from_codeset);
 
@@ -331,12 +813,64 @@ open_converter (const gchar *to_codeset,
 }
 
 static int
-close_converter (GIConv cd)
+close_converter (GIConv       cd,
+                 const gchar *to_codeset,
+                 const gchar *from_codeset)
 {
-  if (cd == (GIConv) -1)
+  IConvCache *cache;
+  IConvCacheEntry *entry;
+  guint i;
+
+  if (cd == (GIConv) -1 || IS_FAST_CONVERTER (cd))
     return 0;
-  
-  return g_iconv_close (cd);  
+
+  if (!is_cacheable_codeset (to_codeset) ||
+      !is_cacheable_codeset (from_codeset))
+    return g_iconv_close (cd);
+
+  /* Reset the shift state for the next user */
+  g_iconv (cd, NULL, NULL, NULL, NULL);
+
+  cache = g_private_get (&iconv_cache_private);
+  if (cache == NULL)
+    {
+      cache = g_new0 (IConvCache, 1);
+      g_private_set (&iconv_cache_private, cache);
+    }
+
+  for (i = 0; i < cache->n_entries; i++)
+    if (cache->entries[i].cd == cd)
+      {
+        cache->entries[i].in_use = FALSE;
+        return 0;
+      }
+
+  if (cache->n_entries < ICONV_CACHE_SIZE)
+    entry = &cache->entries[cache->n_entries++];
+  else
+    {
+      /* Replace the least recently used descriptor */
+      entry = NULL;
+      for (i = 0; i < cache->n_entries; i++)
+        if (!cache->entries[i].in_use &&
+            (entry == NULL || cache->entries[i].stamp < entry->stamp))
+          entry = &cache->entries[i];
+
+      if (entry == NULL)
+        return g_iconv_close (cd);
+
+      g_iconv_close (entry->cd);
+      g_free (entry->to_codeset);
+      g_free (entry->from_codeset);
+    }
+
+  entry->to_codeset = g_strdup (to_codeset);
+  entry->from_codeset = g_strdup (from_codeset);
+  entry->cd = cd;
+  entry->stamp = ++cache->stamp;
+  entry->in_use = FALSE;
+
+  return 0;
 }
 
 /**
@@ -566,7 +1100,7 @@ g_convert (const gchar *str,
 			      bytes_read, bytes_written,
 			      error);
 
-  close_converter (cd);
+  close_converter (cd, to_codeset, from_codeset);
 
   return res;
 }
@@ -688,7 +1222,7 @@ g_convert_with_fallback (const gchar *str,
 		    bytes_read, &inbytes_remaining, error);
   if (!utf8)
     {
-      close_converter (cd);
+      close_converter (cd, to_codeset, "UTF-8");
       if (bytes_written)
         *bytes_written = 0;
       return NULL;
@@ -800,7 +1334,7 @@ g_convert_with_fallback (const gchar *str,
    */
   memset (outp, 0, NUL_TERMINATOR_LENGTH);
   
-  close_converter (cd);
+  close_converter (cd, to_codeset, "UTF-8");
 
   if (bytes_written)
     *bytes_written = outp - dest;	/* Doesn't include '\0' */
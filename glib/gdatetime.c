@@ -2648,6 +2648,732 @@ g_date_time_format (GDateTime   *datetime,
   return utf8;
 }
 
+/* Compiled formats {{{1 */
+
+typedef struct
+{
+  gchar  spec;          /* conversion character, or 0 for literal text */
+  gchar  pad;           /* '0', ' ' or 0 for no padding */
+  guint8 width;
+  guint8 alt_digits;
+  guint8 colons;
+  guint  offset;        /* literal text, within ->literals */
+  guint  len;
+} FormatOp;
+
+struct _GDateTimeFormatter
+{
+  GArray  *ops;         /* Array of FormatOp */
+  GString *literals;
+  GString *scratch;
+
+  /* Locale data, captured when the format is compiled */
+  gboolean names_loaded;
+  gchar   *weekday_abbr[7];
+  gchar   *weekday_full[7];
+  gchar   *month_abbr[12];
+  gchar   *month_full[12];
+  gchar   *ampm[2][2];  /* [pm][lowercase] */
+  gchar   *alt_digits[10];
+
+  /* Broken-down date of the most recently formatted day */
+  gint32   days;
+  gint     year, month, day;
+  gint     day_of_year, day_of_week;
+  gint     week_numbering_year, week_of_year;
+
+  /* Output for the most recently formatted second */
+  GTimeZone *last_tz;
+  gint64     last_time;
+  gsize      last_len;
+  gchar      last[128];
+};
+
+static gchar *
+locale_string_to_utf8 (const gchar *str,
+                       gboolean     locale_is_utf8)
+{
+  if (locale_is_utf8)
+    return g_strdup (str);
+
+  return g_locale_to_utf8 (str, -1, NULL, NULL, NULL);
+}
+
+static gboolean
+formatter_load_names (GDateTimeFormatter *formatter,
+                      gboolean            locale_is_utf8)
+{
+  GDateTime datetime = { 0, };
+  gint i;
+
+  if (formatter->names_loaded)
+    return TRUE;
+
+  /* 0001-01-01 was a Monday */
+  for (i = 0; i < 7; i++)
+    {
+      datetime.days = 1 + i;
+      formatter->weekday_abbr[i] = locale_string_to_utf8 (WEEKDAY_ABBR (&datetime), locale_is_utf8);
+      formatter->weekday_full[i] = locale_string_to_utf8 (WEEKDAY_FULL (&datetime), locale_is_utf8);
+      if (!formatter->weekday_abbr[i] || !formatter->weekday_full[i])
+        return FALSE;
+    }
+
+  for (i = 0; i < 12; i++)
+    {
+      datetime.days = ymd_to_days (1, i + 1, 1);
+      formatter->month_abbr[i] = locale_string_to_utf8 (MONTH_ABBR (&datetime), locale_is_utf8);
+      formatter->month_full[i] = locale_string_to_utf8 (MONTH_FULL (&datetime), locale_is_utf8);
+      if (!formatter->month_abbr[i] || !formatter->month_full[i])
+        return FALSE;
+    }
+
+  for (i = 0; i < 2; i++)
+    {
+      gchar *ampm;
+
+      datetime.usec = i * 12 * USEC_PER_HOUR;
+      ampm = locale_string_to_utf8 (GET_AMPM (&datetime), locale_is_utf8);
+      if (!ampm)
+        return FALSE;
+
+      formatter->ampm[i][0] = g_utf8_strup (ampm, -1);
+      formatter->ampm[i][1] = g_utf8_strdown (ampm, -1);
+      g_free (ampm);
+    }
+
+  formatter->names_loaded = TRUE;
+
+  return TRUE;
+}
+
+static gboolean
+formatter_load_alt_digits (GDateTimeFormatter *formatter,
+                           gboolean            locale_is_utf8)
+{
+#ifdef HAVE_LANGINFO_OUTDIGIT
+  if (formatter->alt_digits[0] == NULL)
+    {
+      static const nl_item items[10] = {
+        _NL_CTYPE_OUTDIGIT0_MB, _NL_CTYPE_OUTDIGIT1_MB, _NL_CTYPE_OUTDIGIT2_MB,
+        _NL_CTYPE_OUTDIGIT3_MB, _NL_CTYPE_OUTDIGIT4_MB, _NL_CTYPE_OUTDIGIT5_MB,
+        _NL_CTYPE_OUTDIGIT6_MB, _NL_CTYPE_OUTDIGIT7_MB, _NL_CTYPE_OUTDIGIT8_MB,
+        _NL_CTYPE_OUTDIGIT9_MB
+      };
+      gint i;
+
+      for (i = 0; i < 10; i++)
+        {
+          formatter->alt_digits[i] = locale_string_to_utf8 (nl_langinfo (items[i]), locale_is_utf8);
+          if (!formatter->alt_digits[i])
+            return FALSE;
+        }
+    }
+#endif
+
+  return TRUE;
+}
+
+static void
+formatter_add_literal (GDateTimeFormatter *formatter,
+                       const gchar        *text,
+                       gsize               len)
+{
+  FormatOp *last = NULL;
+  FormatOp op = { 0, };
+
+  if (formatter->ops->len)
+    last = &g_array_index (formatter->ops, FormatOp, formatter->ops->len - 1);
+
+  /* Merge with the previous run of literal text */
+  if (last && last->spec == 0 && last->offset + last->len == formatter->literals->len)
+    last->len += len;
+  else
+    {
+      op.offset = formatter->literals->len;
+      op.len = len;
+      g_array_append_val (formatter->ops, op);
+    }
+
+  g_string_append_len (formatter->literals, text, len);
+}
+
+static void
+formatter_add_op (GDateTimeFormatter *formatter,
+                  gchar               spec,
+                  gchar               pad,
+                  guint               width,
+                  gboolean            alt_digits,
+                  guint               colons)
+{
+  FormatOp op = { 0, };
+
+  op.spec = spec;
+  op.pad = pad;
+  op.width = width;
+  op.alt_digits = alt_digits;
+  op.colons = colons;
+  g_array_append_val (formatter->ops, op);
+}
+
+static gboolean
+formatter_compile (GDateTimeFormatter *formatter,
+                   const gchar        *format,
+                   gboolean            locale_is_utf8,
+                   gboolean            nested);
+
+static gboolean
+formatter_compile_locale (GDateTimeFormatter *formatter,
+                          const gchar        *format,
+                          gboolean            locale_is_utf8,
+                          gboolean            nested)
+{
+  gchar *utf8_format;
+  gboolean success;
+
+  /* Locale formats are not expected to refer to each other */
+  if (nested)
+    return FALSE;
+
+  utf8_format = locale_string_to_utf8 (format, locale_is_utf8);
+  if (!utf8_format)
+    return FALSE;
+
+  success = formatter_compile (formatter, utf8_format, locale_is_utf8, TRUE);
+  g_free (utf8_format);
+
+  return success;
+}
+
+/* Mirrors g_date_time_format_locale(), turning each conversion into an
+ * op (and expanding the composite ones) instead of formatting it.
+ */
+static gboolean
+formatter_compile (GDateTimeFormatter *formatter,
+                   const gchar        *format,
+                   gboolean            locale_is_utf8,
+                   gboolean            nested)
+{
+  guint     len;
+  guint     colons;
+  gunichar  c;
+  gboolean  alt_digits;
+  gboolean  pad_set;
+  gchar     pad;
+
+  while (*format)
+    {
+      len = strcspn (format, "%");
+      if (len)
+        formatter_add_literal (formatter, format, len);
+
+      format += len;
+      if (!*format)
+        break;
+
+      g_assert (*format == '%');
+      format++;
+      if (!*format)
+        break;
+
+      colons = 0;
+      alt_digits = FALSE;
+      pad_set = FALSE;
+      pad = 0;
+
+    next_mod:
+      c = g_utf8_get_char (format);
+      format = g_utf8_next_char (format);
+      switch (c)
+        {
+        case 'a':
+        case 'A':
+        case 'b':
+        case 'B':
+        case 'h':
+        case 'p':
+        case 'P':
+          if (!formatter_load_names (formatter, locale_is_utf8))
+            return FALSE;
+          formatter_add_op (formatter, c == 'h' ? 'b' : c, 0, 0, FALSE, 0);
+          break;
+        case 'c':
+          if (!formatter_compile_locale (formatter, PREFERRED_DATE_TIME_FMT,
+                                         locale_is_utf8, nested))
+            return FALSE;
+          break;
+        case 'r':
+          if (!formatter_compile_locale (formatter, PREFERRED_12HR_TIME_FMT,
+                                         locale_is_utf8, nested))
+            return FALSE;
+          break;
+        case 'x':
+          if (!formatter_compile_locale (formatter, PREFERRED_DATE_FMT,
+                                         locale_is_utf8, nested))
+            return FALSE;
+          break;
+        case 'X':
+          if (!formatter_compile_locale (formatter, PREFERRED_TIME_FMT,
+                                         locale_is_utf8, nested))
+            return FALSE;
+          break;
+        case 'C':
+        case 'd':
+        case 'g':
+        case 'H':
+        case 'I':
+        case 'm':
+        case 'M':
+        case 'S':
+        case 'V':
+        case 'y':
+          formatter_add_op (formatter, c, pad_set ? pad : '0', 2, alt_digits, 0);
+          break;
+        case 'e':
+        case 'k':
+        case 'l':
+          formatter_add_op (formatter, c, pad_set ? pad : ' ', 2, alt_digits, 0);
+          break;
+        case 'j':
+          formatter_add_op (formatter, c, pad_set ? pad : '0', 3, alt_digits, 0);
+          break;
+        case 'G':
+        case 'u':
+        case 'w':
+        case 'Y':
+          formatter_add_op (formatter, c, 0, 0, alt_digits, 0);
+          break;
+        case 'F':
+          formatter_add_op (formatter, 'Y', 0, 0, FALSE, 0);
+          formatter_add_literal (formatter, "-", 1);
+          formatter_add_op (formatter, 'm', '0', 2, FALSE, 0);
+          formatter_add_literal (formatter, "-", 1);
+          formatter_add_op (formatter, 'd', '0', 2, FALSE, 0);
+          break;
+        case 'R':
+        case 'T':
+          formatter_add_op (formatter, 'H', '0', 2, FALSE, 0);
+          formatter_add_literal (formatter, ":", 1);
+          formatter_add_op (formatter, 'M', '0', 2, FALSE, 0);
+          if (c == 'T')
+            {
+              formatter_add_literal (formatter, ":", 1);
+              formatter_add_op (formatter, 'S', '0', 2, FALSE, 0);
+            }
+          break;
+        case 'n':
+          formatter_add_literal (formatter, "\n", 1);
+          break;
+        case 't':
+          formatter_add_literal (formatter, "\t", 1);
+          break;
+        case '%':
+          formatter_add_literal (formatter, "%", 1);
+          break;
+        case 's':
+        case 'Z':
+          formatter_add_op (formatter, c, 0, 0, FALSE, 0);
+          break;
+        case 'z':
+          if (colons > 3)
+            return FALSE;
+          formatter_add_op (formatter, c, 0, 0, FALSE, colons);
+          break;
+        case 'O':
+          alt_digits = TRUE;
+          if (!formatter_load_alt_digits (formatter, locale_is_utf8))
+            return FALSE;
+          goto next_mod;
+        case '-':
+          pad_set = TRUE;
+          pad = 0;
+          goto next_mod;
+        case '_':
+          pad_set = TRUE;
+          pad = ' ';
+          goto next_mod;
+        case '0':
+          pad_set = TRUE;
+          pad = '0';
+          goto next_mod;
+        case ':':
+          /* Colons are only allowed before 'z' */
+          if (*format && *format != 'z' && *format != ':')
+            return FALSE;
+          colons++;
+          goto next_mod;
+        default:
+          return FALSE;
+        }
+    }
+
+  return TRUE;
+}
+
+/**
+ * GDateTimeFormatter:
+ *
+ * An opaque structure holding a compiled date/time format.  See
+ * g_date_time_formatter_new().
+ *
+ * Since: 2.44
+ */
+
+/**
+ * g_date_time_formatter_new:
+ * @format: a valid UTF-8 string, containing a format as understood by
+ *     g_date_time_format()
+ *
+ * Compiles @format into a #GDateTimeFormatter, for formatting many
+ * points in time without reparsing the format each time.
+ *
+ * The names, alternative digits and preferred formats of the current
+ * locale are looked up once, when the formatter is created; later
+ * locale changes do not affect it.
+ *
+ * A #GDateTimeFormatter keeps state about the last time it formatted,
+ * so it must not be used from more than one thread at a time.
+ *
+ * Returns: a new #GDateTimeFormatter, or %NULL if @format is invalid.
+ *     Free it with g_date_time_formatter_free().
+ *
+ * Since: 2.44
+ */
+GDateTimeFormatter *
+g_date_time_formatter_new (const gchar *format)
+{
+  GDateTimeFormatter *formatter;
+
+  g_return_val_if_fail (format != NULL, NULL);
+  g_return_val_if_fail (g_utf8_validate (format, -1, NULL), NULL);
+
+  formatter = g_slice_new0 (GDateTimeFormatter);
+  formatter->ops = g_array_new (FALSE, FALSE, sizeof (FormatOp));
+  formatter->literals = g_string_new (NULL);
+  formatter->scratch = g_string_new (NULL);
+
+  if (!formatter_compile (formatter, format, g_get_charset (NULL), FALSE))
+    {
+      g_date_time_formatter_free (formatter);
+      return NULL;
+    }
+
+  return formatter;
+}
+
+/**
+ * g_date_time_formatter_free:
+ * @formatter: a #GDateTimeFormatter
+ *
+ * Frees @formatter.
+ *
+ * Since: 2.44
+ */
+void
+g_date_time_formatter_free (GDateTimeFormatter *formatter)
+{
+  gint i;
+
+  g_return_if_fail (formatter != NULL);
+
+  for (i = 0; i < 7; i++)
+    {
+      g_free (formatter->weekday_abbr[i]);
+      g_free (formatter->weekday_full[i]);
+    }
+  for (i = 0; i < 12; i++)
+    {
+      g_free (formatter->month_abbr[i]);
+      g_free (formatter->month_full[i]);
+    }
+  for (i = 0; i < 4; i++)
+    g_free (formatter->ampm[i / 2][i % 2]);
+  for (i = 0; i < 10; i++)
+    g_free (formatter->alt_digits[i]);
+
+  if (formatter->last_tz)
+    g_time_zone_unref (formatter->last_tz);
+
+  g_array_free (formatter->ops, TRUE);
+  g_string_free (formatter->literals, TRUE);
+  g_string_free (formatter->scratch, TRUE);
+  g_slice_free (GDateTimeFormatter, formatter);
+}
+
+typedef struct
+{
+  gchar *buffer;
+  gsize  size;
+  gsize  len;
+} FormatSink;
+
+/* Keeps counting past the end of the buffer, so that the caller only
+ * has to compare the final length against the buffer size.
+ */
+static inline void
+sink_append (FormatSink  *sink,
+             const gchar *str,
+             gsize        len)
+{
+  if (sink->len + len < sink->size)
+    memcpy (sink->buffer + sink->len, str, len);
+  sink->len += len;
+}
+
+static void
+sink_append_number (FormatSink         *sink,
+                    GDateTimeFormatter *formatter,
+                    const FormatOp     *op,
+                    guint32             number)
+{
+  gchar tmp[10];
+  guint i = 0;
+
+  do
+    {
+      tmp[i++] = '0' + number % 10;
+      number /= 10;
+    }
+  while (number);
+
+  while (op->pad && i < op->width)
+    tmp[i++] = op->pad;
+
+  if (op->alt_digits && formatter->alt_digits[0] != NULL)
+    {
+      while (i--)
+        {
+          if (tmp[i] == ' ')
+            sink_append (sink, " ", 1);
+          else
+            {
+              const gchar *digit = formatter->alt_digits[tmp[i] - '0'];
+              sink_append (sink, digit, strlen (digit));
+            }
+        }
+    }
+  else
+    {
+      while (i--)
+        sink_append (sink, &tmp[i], 1);
+    }
+}
+
+static inline void
+sink_append_string (FormatSink  *sink,
+                    const gchar *str)
+{
+  sink_append (sink, str, strlen (str));
+}
+
+/**
+ * g_date_time_formatter_format_unix:
+ * @formatter: a #GDateTimeFormatter
+ * @tz: a #GTimeZone
+ * @t: the number of seconds since January 1, 1970 UTC
+ * @buffer: (out caller-allocates) (array length=buffer_size): the
+ *     buffer to write the result to
+ * @buffer_size: the size of @buffer, in bytes
+ *
+ * Formats the time @t, as it is in @tz, according to @formatter.
+ *
+ * The result is the same as converting @t to @tz with
+ * g_date_time_new_from_unix_utc() and g_date_time_to_timezone() and
+ * formatting it with g_date_time_format(), but no #GDateTime or string
+ * is allocated.  The broken-down date and the
+ * complete output for the most recent second are cached, so that
+ * formatting a stream of increasing timestamps is cheap.
+ *
+ * The result is written to @buffer in UTF-8, including a terminating
+ * nul byte.  If it does not fit, @buffer is left with an empty string.
+ *
+ * Returns: the length of the result excluding the nul byte, or -1 if
+ *     @t is out of the range of #GDateTime or @buffer is too small
+ *
+ * Since: 2.44
+ */
+gssize
+g_date_time_formatter_format_unix (GDateTimeFormatter *formatter,
+                                   GTimeZone          *tz,
+                                   gint64              t,
+                                   gchar              *buffer,
+                                   gsize               buffer_size)
+{
+  GDateTime datetime = { 0, };
+  FormatSink sink;
+  gint64 local;
+  gint second_of_day;
+  gint hour;
+  guint i;
+
+  g_return_val_if_fail (formatter != NULL, -1);
+  g_return_val_if_fail (tz != NULL, -1);
+  g_return_val_if_fail (buffer != NULL || buffer_size == 0, -1);
+
+  if (buffer_size > 0)
+    buffer[0] = '\0';
+
+  if (formatter->last_tz == tz && formatter->last_time == t)
+    {
+      if (formatter->last_len >= buffer_size)
+        return -1;
+
+      memcpy (buffer, formatter->last, formatter->last_len + 1);
+      return formatter->last_len;
+    }
+
+  /* Keep the arithmetic below from overflowing; the exact range check
+   * is done on the day number. */
+  if (t < -UNIX_EPOCH_START * SEC_PER_DAY ||
+      t > (3652059 - UNIX_EPOCH_START + 1) * SEC_PER_DAY)
+    return -1;
+
+  datetime.tz = tz;
+  datetime.interval = g_time_zone_find_interval (tz, G_TIME_TYPE_UNIVERSAL, t);
+  datetime.ref_count = 1;
+
+  local = t + g_time_zone_get_offset (tz, datetime.interval) + UNIX_EPOCH_START * SEC_PER_DAY;
+  datetime.days = local / SEC_PER_DAY;
+  second_of_day = local % SEC_PER_DAY;
+  datetime.usec = second_of_day * USEC_PER_SECOND;
+
+  if (local < 0 || datetime.days < 1 || 3652059 < datetime.days)
+    return -1;
+
+  if (datetime.days != formatter->days)
+    {
+      g_date_time_get_ymd (&datetime, &formatter->year, &formatter->month, &formatter->day);
+      formatter->day_of_year = g_date_time_get_day_of_year (&datetime);
+      formatter->day_of_week = g_date_time_get_day_of_week (&datetime);
+      formatter->week_numbering_year = g_date_time_get_week_numbering_year (&datetime);
+      formatter->week_of_year = g_date_time_get_week_of_year (&datetime);
+      formatter->days = datetime.days;
+    }
+
+  hour = second_of_day / SECS_PER_HOUR;
+
+  sink.buffer = buffer;
+  sink.size = buffer_size;
+  sink.len = 0;
+
+  for (i = 0; i < formatter->ops->len; i++)
+    {
+      const FormatOp *op = &g_array_index (formatter->ops, FormatOp, i);
+
+      switch (op->spec)
+        {
+        case 0:
+          sink_append (&sink, formatter->literals->str + op->offset, op->len);
+          break;
+        case 'a':
+          sink_append_string (&sink, formatter->weekday_abbr[formatter->day_of_week - 1]);
+          break;
+        case 'A':
+          sink_append_string (&sink, formatter->weekday_full[formatter->day_of_week - 1]);
+          break;
+        case 'b':
+          sink_append_string (&sink, formatter->month_abbr[formatter->month - 1]);
+          break;
+        case 'B':
+          sink_append_string (&sink, formatter->month_full[formatter->month - 1]);
+          break;
+        case 'p':
+          sink_append_string (&sink, formatter->ampm[hour >= 12][0]);
+          break;
+        case 'P':
+          sink_append_string (&sink, formatter->ampm[hour >= 12][1]);
+          break;
+        case 'C':
+          sink_append_number (&sink, formatter, op, formatter->year / 100);
+          break;
+        case 'd':
+        case 'e':
+          sink_append_number (&sink, formatter, op, formatter->day);
+          break;
+        case 'g':
+          sink_append_number (&sink, formatter, op, formatter->week_numbering_year % 100);
+          break;
+        case 'G':
+          sink_append_number (&sink, formatter, op, formatter->week_numbering_year);
+          break;
+        case 'H':
+        case 'k':
+          sink_append_number (&sink, formatter, op, hour);
+          break;
+        case 'I':
+        case 'l':
+          sink_append_number (&sink, formatter, op, (hour + 11) % 12 + 1);
+          break;
+        case 'j':
+          sink_append_number (&sink, formatter, op, formatter->day_of_year);
+          break;
+        case 'm':
+          sink_append_number (&sink, formatter, op, formatter->month);
+          break;
+        case 'M':
+          sink_append_number (&sink, formatter, op, second_of_day / SECS_PER_MINUTE % 60);
+          break;
+        case 'S':
+          sink_append_number (&sink, formatter, op, second_of_day % 60);
+          break;
+        case 'u':
+          sink_append_number (&sink, formatter, op, formatter->day_of_week);
+          break;
+        case 'V':
+          sink_append_number (&sink, formatter, op, formatter->week_of_year);
+          break;
+        case 'w':
+          sink_append_number (&sink, formatter, op, formatter->day_of_week % 7);
+          break;
+        case 'y':
+          sink_append_number (&sink, formatter, op, formatter->year % 100);
+          break;
+        case 'Y':
+          sink_append_number (&sink, formatter, op, formatter->year);
+          break;
+        case 's':
+          {
+            gchar tmp[24];
+            sink_append (&sink, tmp, g_snprintf (tmp, sizeof tmp, "%" G_GINT64_FORMAT, t));
+          }
+          break;
+        case 'z':
+          g_string_truncate (formatter->scratch, 0);
+          format_z (formatter->scratch, g_time_zone_get_offset (tz, datetime.interval), op->colons);
+          sink_append (&sink, formatter->scratch->str, formatter->scratch->len);
+          break;
+        case 'Z':
+          sink_append_string (&sink, g_time_zone_get_abbreviation (tz, datetime.interval));
+          break;
+        default:
+          g_assert_not_reached ();
+        }
+    }
+
+  if (sink.len >= buffer_size)
+    {
+      if (buffer_size > 0)
+        buffer[0] = '\0';
+      return -1;
+    }
+
+  buffer[sink.len] = '\0';
+
+  if (sink.len < sizeof formatter->last)
+    {
+      if (formatter->last_tz != tz)
+        {
+          if (formatter->last_tz)
+            g_time_zone_unref (formatter->last_tz);
+          formatter->last_tz = g_time_zone_ref (tz);
+        }
+      formatter->last_time = t;
+      formatter->last_len = sink.len;
+      memcpy (formatter->last, buffer, sink.len + 1);
+    }
+
+  return sink.len;
+}
 
 /* Epilogue {{{1 */
 /* vim:set foldmethod=marker: */
@@ -98,6 +98,8 @@ typedef gint64 GTimeSpan;
  */
 typedef struct _GDateTime GDateTime;
 
+typedef struct _GDateTimeFormatter GDateTimeFormatter;
+
 GLIB_AVAILABLE_IN_ALL
 void                    g_date_time_unref                               (GDateTime      *datetime);
 GLIB_AVAILABLE_IN_ALL
@@ -259,6 +261,17 @@ GLIB_AVAILABLE_IN_ALL
 gchar *                 g_date_time_format                              (GDateTime      *datetime,
                                                                          const gchar    *format) G_GNUC_MALLOC;
 
+GLIB_AVAILABLE_IN_2_44
+GDateTimeFormatter *    g_date_time_formatter_new                       (const gchar    *format);
+GLIB_AVAILABLE_IN_2_44
+void                    g_date_time_formatter_free                      (GDateTimeFormatter *formatter);
+GLIB_AVAILABLE_IN_2_44
+gssize                  g_date_time_formatter_format_unix               (GDateTimeFormatter *formatter,
+                                                                         GTimeZone      *tz,
+                                                                         gint64          t,
+                                                                         gchar          *buffer,
+                                                                         gsize           buffer_size);
+
 G_END_DECLS
 
 #endif /* __G_DATE_TIME_H__ */
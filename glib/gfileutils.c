@@ -50,6 +50,9 @@
 #include "gfileutils.h"
 
 #include "gstdio.h"
+#include "gbytes.h"
+#include "ghash.h"
+#include "gmappedfile.h"
 #include "glibintl.h"
 
 #ifdef HAVE_LINUX_MAGIC_H /* for btrfs check */
@@ -845,13 +848,11 @@ get_contents_regfile (const gchar  *filename,
   return FALSE;
 }
 
-static gboolean
-get_contents_posix (const gchar  *filename,
-                    gchar       **contents,
-                    gsize        *length,
-                    GError      **error)
+static gint
+open_for_contents (const gchar  *filename,
+                   struct stat  *stat_buf,
+                   GError      **error)
 {
-  struct stat stat_buf;
   gint fd;
 
   /* O_BINARY useful on Cygwin */
@@ -865,11 +866,11 @@ get_contents_posix (const gchar  *filename,
                       _("Failed to open file '%s': %s"),
                       saved_errno);
 
-      return FALSE;
+      return -1;
     }
 
   /* I don't think this will ever fail, aside from ENOMEM, but. */
-  if (fstat (fd, &stat_buf) < 0)
+  if (fstat (fd, stat_buf) < 0)
     {
       int saved_errno = errno;
       set_file_error (error,
@@ -878,13 +879,25 @@ get_contents_posix (const gchar  *filename,
                       saved_errno);
       close (fd);
 
-      return FALSE;
+      return -1;
     }
 
-  if (stat_buf.st_size > 0 && S_ISREG (stat_buf.st_mode))
+  return fd;
+}
+
+/* Reads the contents of @fd and closes it */
+static gboolean
+get_contents_fd (const gchar  *filename,
+                 gint          fd,
+                 struct stat  *stat_buf,
+                 gchar       **contents,
+                 gsize        *length,
+                 GError      **error)
+{
+  if (stat_buf->st_size > 0 && S_ISREG (stat_buf->st_mode))
     {
       gboolean retval = get_contents_regfile (filename,
-					      &stat_buf,
+					      stat_buf,
 					      fd,
 					      contents,
 					      length,
@@ -916,6 +929,22 @@ get_contents_posix (const gchar  *filename,
     }
 }
 
+static gboolean
+get_contents_posix (const gchar  *filename,
+                    gchar       **contents,
+                    gsize        *length,
+                    GError      **error)
+{
+  struct stat stat_buf;
+  gint fd;
+
+  fd = open_for_contents (filename, &stat_buf, error);
+  if (fd < 0)
+    return FALSE;
+
+  return get_contents_fd (filename, fd, &stat_buf, contents, length, error);
+}
+
 #else  /* G_OS_WIN32 */
 
 static gboolean
@@ -988,6 +1017,96 @@ g_file_get_contents (const gchar  *filename,
 #endif
 }
 
+/* Files at least this large are mapped rather than read */
+#define GET_BYTES_MAP_THRESHOLD (1024 * 1024)
+
+/**
+ * g_file_get_bytes:
+ * @filename: (type filename): name of a file to read contents from, in
+ *     the GLib file name encoding
+ * @error: return location for a #GError, or %NULL
+ *
+ * Reads an entire file into a #GBytes.
+ *
+ * Regular files are read with a single read() sized from fstat(), and
+ * files of 1 MiB or more are mapped into memory with #GMappedFile
+ * instead of being copied.  Other files, such as pipes and files in
+ * /proc, are read like g_file_get_contents() does.
+ *
+ * As with #GMappedFile, a mapped file must not be modified in place
+ * while the returned #GBytes is in use; replacing it atomically, for
+ * example with g_file_set_contents(), is fine.
+ *
+ * Errors are reported as by g_file_get_contents().
+ *
+ * Returns: (transfer full): the contents of the file, or %NULL if an
+ *     error occurred
+ *
+ * Since: 2.44
+ **/
+GBytes *
+g_file_get_bytes (const gchar  *filename,
+                  GError      **error)
+{
+  gchar *contents;
+  gsize length;
+#ifndef G_OS_WIN32
+  struct stat stat_buf;
+  gint fd;
+#endif
+
+  g_return_val_if_fail (filename != NULL, NULL);
+  g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+#ifdef G_OS_WIN32
+  {
+    GStatBuf stat_buf;
+
+    if (g_stat (filename, &stat_buf) == 0 &&
+        (stat_buf.st_mode & S_IFMT) == S_IFREG &&
+        stat_buf.st_size >= GET_BYTES_MAP_THRESHOLD)
+      {
+        GMappedFile *file = g_mapped_file_new (filename, FALSE, NULL);
+
+        if (file != NULL)
+          {
+            GBytes *bytes = g_mapped_file_get_bytes (file);
+            g_mapped_file_unref (file);
+            return bytes;
+          }
+      }
+  }
+
+  if (!g_file_get_contents (filename, &contents, &length, error))
+    return NULL;
+#else
+  fd = open_for_contents (filename, &stat_buf, error);
+  if (fd < 0)
+    return NULL;
+
+  if (S_ISREG (stat_buf.st_mode) && stat_buf.st_size >= GET_BYTES_MAP_THRESHOLD)
+    {
+      /* If mapping fails for whatever reason, fall back to reading */
+      GMappedFile *file = g_mapped_file_new_from_fd (fd, FALSE, NULL);
+
+      if (file != NULL)
+        {
+          GBytes *bytes = g_mapped_file_get_bytes (file);
+
+          g_mapped_file_unref (file);
+          close (fd);
+
+          return bytes;
+        }
+    }
+
+  if (!get_contents_fd (filename, fd, &stat_buf, &contents, &length, error))
+    return NULL;
+#endif
+
+  return g_bytes_new_take (contents, length);
+}
+
 static gboolean
 rename_file (const char  *old_name,
 	     const char  *new_name,
@@ -1021,6 +1140,7 @@ static gchar *
 write_to_temp_file (const gchar  *contents,
 		    gssize        length,
 		    const gchar  *dest_file,
+		    gboolean      sync,
 		    GError      **err)
 {
   gchar *tmp_name;
@@ -1079,6 +1199,10 @@ write_to_temp_file (const gchar  *contents,
       length -= s;
     }
 
+  /* Batches sync all their files at once when committing */
+  if (!sync)
+    goto no_fsync;
+
 #ifdef BTRFS_SUPER_MAGIC
   {
     struct statfs buf;
@@ -1118,9 +1242,7 @@ write_to_temp_file (const gchar  *contents,
   }
 #endif
 
-#ifdef BTRFS_SUPER_MAGIC
  no_fsync:
-#endif
 
   errno = 0;
   if (!g_close (fd, err))
@@ -1138,6 +1260,60 @@ write_to_temp_file (const gchar  *contents,
   return retval;
 }
 
+/* Renames @tmp_filename over @filename, removing @tmp_filename on failure */
+static gboolean
+replace_file (const gchar  *tmp_filename,
+              const gchar  *filename,
+              GError      **error)
+{
+  GError *rename_error = NULL;
+
+  if (!rename_file (tmp_filename, filename, &rename_error))
+    {
+#ifndef G_OS_WIN32
+
+      g_unlink (tmp_filename);
+      g_propagate_error (error, rename_error);
+      return FALSE;
+
+#else /* G_OS_WIN32 */
+      
+      /* Renaming failed, but on Windows this may just mean
+       * the file already exists. So if the target file
+       * exists, try deleting it and do the rename again.
+       */
+      if (!g_file_test (filename, G_FILE_TEST_EXISTS))
+	{
+	  g_unlink (tmp_filename);
+	  g_propagate_error (error, rename_error);
+	  return FALSE;
+	}
+
+      g_error_free (rename_error);
+      
+      if (g_unlink (filename) == -1)
+	{
+          int saved_errno = errno;
+          set_file_error (error,
+                          filename,
+		          _("Existing file '%s' could not be removed: g_unlink() failed: %s"),
+                          saved_errno);
+	  g_unlink (tmp_filename);
+	  return FALSE;
+	}
+      
+      if (!rename_file (tmp_filename, filename, error))
+	{
+	  g_unlink (tmp_filename);
+	  return FALSE;
+	}
+
+#endif
+    }
+
+  return TRUE;
+}
+
 /**
  * g_file_set_contents:
  * @filename: (type filename): name of a file to write @contents to, in the GLib file name
@@ -1184,7 +1360,6 @@ g_file_set_contents (const gchar  *filename,
 {
   gchar *tmp_filename;
   gboolean retval;
-  GError *rename_error = NULL;
   
   g_return_val_if_fail (filename != NULL, FALSE);
   g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
@@ -1194,65 +1369,360 @@ g_file_set_contents (const gchar  *filename,
   if (length == -1)
     length = strlen (contents);
 
-  tmp_filename = write_to_temp_file (contents, length, filename, error);
+  tmp_filename = write_to_temp_file (contents, length, filename, TRUE, error);
   
   if (!tmp_filename)
+    return FALSE;
+
+  retval = replace_file (tmp_filename, filename, error);
+
+  g_free (tmp_filename);
+  return retval;
+}
+
+typedef struct
+{
+  gchar *filename;
+  gchar *tmp_filename;
+} GFileWriteBatchEntry;
+
+struct _GFileWriteBatch
+{
+  GArray *entries;
+};
+
+/* Batches at least this large sync whole filesystems rather than files */
+#define WRITE_BATCH_SYNCFS_THRESHOLD 16
+
+static void
+write_batch_entry_clear (GFileWriteBatchEntry *entry)
+{
+  if (entry->tmp_filename)
+    g_unlink (entry->tmp_filename);
+
+  g_free (entry->filename);
+  g_free (entry->tmp_filename);
+}
+
+/**
+ * g_file_write_batch_new:
+ *
+ * Creates a new, empty #GFileWriteBatch.
+ *
+ * A #GFileWriteBatch replaces many files the way g_file_set_contents()
+ * replaces one, but pays for flushing them to disk only once.  The new
+ * contents of each file are written to a temporary file by
+ * g_file_write_batch_add(), and g_file_write_batch_commit() then syncs
+ * all of them together and renames them over their destinations.
+ *
+ * Each file is still replaced atomically, but the batch as a whole is
+ * not: if committing fails or the system crashes part-way through, some
+ * files may have their new contents and others their old contents.
+ *
+ * Returns: (transfer full): a new #GFileWriteBatch; free it with
+ *     g_file_write_batch_free()
+ *
+ * Since: 2.44
+ */
+GFileWriteBatch *
+g_file_write_batch_new (void)
+{
+  GFileWriteBatch *batch;
+
+  batch = g_slice_new (GFileWriteBatch);
+  batch->entries = g_array_new (FALSE, FALSE, sizeof (GFileWriteBatchEntry));
+  g_array_set_clear_func (batch->entries, (GDestroyNotify) write_batch_entry_clear);
+
+  return batch;
+}
+
+/**
+ * g_file_write_batch_free:
+ * @batch: a #GFileWriteBatch
+ *
+ * Frees @batch.  Temporary files of contents that were added but not
+ * committed are removed; their destinations are left untouched.
+ *
+ * Since: 2.44
+ */
+void
+g_file_write_batch_free (GFileWriteBatch *batch)
+{
+  g_return_if_fail (batch != NULL);
+
+  g_array_free (batch->entries, TRUE);
+  g_slice_free (GFileWriteBatch, batch);
+}
+
+/**
+ * g_file_write_batch_add:
+ * @batch: a #GFileWriteBatch
+ * @filename: (type filename): name of a file to write @contents to, in
+ *     the GLib file name encoding
+ * @contents: (array length=length) (element-type guint8): string to
+ *     write to the file
+ * @length: length of @contents, or -1 if @contents is a nul-terminated
+ *     string
+ * @error: return location for a #GError, or %NULL
+ *
+ * Writes @contents to a temporary file next to @filename, to be renamed
+ * over @filename by g_file_write_batch_commit().  The data is not
+ * flushed to disk yet, and @filename is not modified until the batch is
+ * committed.
+ *
+ * Adding the same @filename twice is allowed; the contents added last
+ * win.
+ *
+ * Errors are reported as by g_file_set_contents().
+ *
+ * Returns: %TRUE on success, %FALSE if an error occurred
+ *
+ * Since: 2.44
+ */
+gboolean
+g_file_write_batch_add (GFileWriteBatch  *batch,
+                        const gchar      *filename,
+                        const gchar      *contents,
+                        gssize            length,
+                        GError          **error)
+{
+  GFileWriteBatchEntry entry;
+
+  g_return_val_if_fail (batch != NULL, FALSE);
+  g_return_val_if_fail (filename != NULL, FALSE);
+  g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+  g_return_val_if_fail (contents != NULL || length == 0, FALSE);
+  g_return_val_if_fail (length >= -1, FALSE);
+
+  if (length == -1)
+    length = strlen (contents);
+
+  entry.tmp_filename = write_to_temp_file (contents, length, filename, FALSE, error);
+  if (!entry.tmp_filename)
+    return FALSE;
+
+  entry.filename = g_strdup (filename);
+  g_array_append_val (batch->entries, entry);
+
+  return TRUE;
+}
+
+#if !defined (G_OS_WIN32) && defined (HAVE_FSYNC)
+/* Returns the distinct parent directories of the files in @batch */
+static GPtrArray *
+write_batch_get_dirs (GFileWriteBatch *batch)
+{
+  GHashTable *seen;
+  GPtrArray *dirs;
+  guint i;
+
+  seen = g_hash_table_new (g_str_hash, g_str_equal);
+  dirs = g_ptr_array_new_with_free_func (g_free);
+
+  for (i = 0; i < batch->entries->len; i++)
     {
-      retval = FALSE;
-      goto out;
+      GFileWriteBatchEntry *entry;
+      gchar *dir;
+
+      entry = &g_array_index (batch->entries, GFileWriteBatchEntry, i);
+      dir = g_path_get_dirname (entry->filename);
+
+      if (g_hash_table_contains (seen, dir))
+        {
+          g_free (dir);
+          continue;
+        }
+
+      g_hash_table_add (seen, dir);
+      g_ptr_array_add (dirs, dir);
     }
 
-  if (!rename_file (tmp_filename, filename, &rename_error))
+  g_hash_table_unref (seen);
+
+  return dirs;
+}
+
+#ifdef HAVE_SYNCFS
+/* Syncs every filesystem holding one of @dirs, once each */
+static gboolean
+write_batch_syncfs (GPtrArray  *dirs,
+                    GError    **error)
+{
+  GArray *devs;
+  gboolean retval = TRUE;
+  guint i, j;
+
+  devs = g_array_new (FALSE, FALSE, sizeof (dev_t));
+
+  for (i = 0; i < dirs->len && retval; i++)
     {
-#ifndef G_OS_WIN32
+      const gchar *dir = g_ptr_array_index (dirs, i);
+      struct stat statbuf;
+      gint fd;
 
-      g_unlink (tmp_filename);
-      g_propagate_error (error, rename_error);
-      retval = FALSE;
-      goto out;
+      fd = open (dir, O_RDONLY);
+      if (fd < 0 || fstat (fd, &statbuf) != 0)
+        {
+          int saved_errno = errno;
+          set_file_error (error,
+                          dir, _("Failed to open directory '%s': %s"),
+                          saved_errno);
+          if (fd >= 0)
+            close (fd);
+          retval = FALSE;
+          break;
+        }
 
-#else /* G_OS_WIN32 */
-      
-      /* Renaming failed, but on Windows this may just mean
-       * the file already exists. So if the target file
-       * exists, try deleting it and do the rename again.
-       */
-      if (!g_file_test (filename, G_FILE_TEST_EXISTS))
-	{
-	  g_unlink (tmp_filename);
-	  g_propagate_error (error, rename_error);
-	  retval = FALSE;
-	  goto out;
-	}
+      for (j = 0; j < devs->len; j++)
+        if (g_array_index (devs, dev_t, j) == statbuf.st_dev)
+          break;
 
-      g_error_free (rename_error);
-      
-      if (g_unlink (filename) == -1)
-	{
+      if (j == devs->len)
+        {
+          g_array_append_val (devs, statbuf.st_dev);
+
+          if (syncfs (fd) != 0)
+            {
+              int saved_errno = errno;
+              set_file_error (error,
+                              dir, _("Failed to write files in '%s': syncfs() failed: %s"),
+                              saved_errno);
+              retval = FALSE;
+            }
+        }
+
+      close (fd);
+    }
+
+  g_array_free (devs, TRUE);
+
+  return retval;
+}
+#endif
+
+/* Syncs each temporary file in @batch */
+static gboolean
+write_batch_fsync (GFileWriteBatch  *batch,
+                   GError          **error)
+{
+  guint i;
+
+  for (i = 0; i < batch->entries->len; i++)
+    {
+      GFileWriteBatchEntry *entry;
+      gint fd;
+
+      entry = &g_array_index (batch->entries, GFileWriteBatchEntry, i);
+
+      fd = open (entry->tmp_filename, O_RDONLY|O_BINARY);
+      if (fd < 0 || fsync (fd) != 0)
+        {
           int saved_errno = errno;
           set_file_error (error,
-                          filename,
-		          _("Existing file '%s' could not be removed: g_unlink() failed: %s"),
+                          entry->tmp_filename, _("Failed to write file '%s': fsync() failed: %s"),
                           saved_errno);
-	  g_unlink (tmp_filename);
-	  retval = FALSE;
-	  goto out;
-	}
-      
-      if (!rename_file (tmp_filename, filename, error))
-	{
-	  g_unlink (tmp_filename);
-	  retval = FALSE;
-	  goto out;
-	}
+          if (fd >= 0)
+            close (fd);
+
+          return FALSE;
+        }
+
+      close (fd);
+    }
+
+  return TRUE;
+}
+
+/* Syncs @dirs so that the renames into them are durable; errors are
+ * ignored, since some filesystems refuse fsync() on directories.
+ */
+static void
+write_batch_sync_dirs (GPtrArray *dirs)
+{
+  guint i;
+
+  for (i = 0; i < dirs->len; i++)
+    {
+      gint fd;
+
+      fd = open (g_ptr_array_index (dirs, i), O_RDONLY);
+      if (fd >= 0)
+        {
+          fsync (fd);
+          close (fd);
+        }
+    }
+}
+#endif
 
+/**
+ * g_file_write_batch_commit:
+ * @batch: a #GFileWriteBatch
+ * @error: return location for a #GError, or %NULL
+ *
+ * Flushes all contents added to @batch to disk and then renames each
+ * temporary file over its destination, in the order they were added.
+ *
+ * Small batches are flushed with one fsync() per file; larger ones, on
+ * systems that support it, with one syncfs() per filesystem involved.
+ * Either way this is much cheaper than calling g_file_set_contents()
+ * for each file, which waits for the disk once per file.  The parent
+ * directories are synced after the renames.
+ *
+ * If an error occurs, the files that were not yet renamed keep their
+ * old contents and their temporary files are removed.  In any case
+ * @batch is empty afterwards and may be reused.
+ *
+ * Returns: %TRUE on success, %FALSE if an error occurred
+ *
+ * Since: 2.44
+ */
+gboolean
+g_file_write_batch_commit (GFileWriteBatch  *batch,
+                           GError          **error)
+{
+  gboolean retval = TRUE;
+  guint i;
+#if !defined (G_OS_WIN32) && defined (HAVE_FSYNC)
+  GPtrArray *dirs;
 #endif
+
+  g_return_val_if_fail (batch != NULL, FALSE);
+  g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+#if !defined (G_OS_WIN32) && defined (HAVE_FSYNC)
+  dirs = write_batch_get_dirs (batch);
+
+#ifdef HAVE_SYNCFS
+  if (batch->entries->len >= WRITE_BATCH_SYNCFS_THRESHOLD)
+    retval = write_batch_syncfs (dirs, error);
+  else
+#endif
+    retval = write_batch_fsync (batch, error);
+#endif
+
+  for (i = 0; i < batch->entries->len && retval; i++)
+    {
+      GFileWriteBatchEntry *entry;
+
+      entry = &g_array_index (batch->entries, GFileWriteBatchEntry, i);
+
+      retval = replace_file (entry->tmp_filename, entry->filename, error);
+
+      /* Either renamed or removed by now */
+      g_free (entry->tmp_filename);
+      entry->tmp_filename = NULL;
     }
 
-  retval = TRUE;
-  
- out:
-  g_free (tmp_filename);
+#if !defined (G_OS_WIN32) && defined (HAVE_FSYNC)
+  if (i > 0)
+    write_batch_sync_dirs (dirs);
+
+  g_ptr_array_unref (dirs);
+#endif
+
+  g_array_set_size (batch->entries, 0);
+
   return retval;
 }
 
@@ -24,6 +24,7 @@
 #error "Only <glib.h> can be included directly."
 #endif
 
+#include <glib/gbytes.h>
 #include <glib/gerror.h>
 
 G_BEGIN_DECLS
@@ -91,10 +92,29 @@ gboolean g_file_set_contents (const gchar *filename,
                               const gchar *contents,
                               gssize         length,
                               GError       **error);
+GLIB_AVAILABLE_IN_2_44
+GBytes  *g_file_get_bytes    (const gchar  *filename,
+                              GError      **error);
 GLIB_AVAILABLE_IN_ALL
 gchar   *g_file_read_link    (const gchar  *filename,
                               GError      **error);
 
+typedef struct _GFileWriteBatch GFileWriteBatch;
+
+GLIB_AVAILABLE_IN_2_44
+GFileWriteBatch *g_file_write_batch_new    (void);
+GLIB_AVAILABLE_IN_2_44
+void             g_file_write_batch_free   (GFileWriteBatch  *batch);
+GLIB_AVAILABLE_IN_2_44
+gboolean         g_file_write_batch_add    (GFileWriteBatch  *batch,
+                                            const gchar      *filename,
+                                            const gchar      *contents,
+                                            gssize            length,
+                                            GError          **error);
+GLIB_AVAILABLE_IN_2_44
+gboolean         g_file_write_batch_commit (GFileWriteBatch  *batch,
+                                            GError          **error);
+
 /* Wrapper / workalike for mkdtemp() */
 GLIB_AVAILABLE_IN_2_30
 gchar   *g_mkdtemp            (gchar        *tmpl);
@@ -437,6 +437,8 @@ struct _GKeyFile
 
   GString *parse_buffer; /* Holds up to one line of not-yet-parsed data */
 
+  gchar *contents; /* Backing store for unparsed groups and in-place pairs */
+
   gchar list_separator;
 
   GKeyFileFlags flags;
@@ -460,12 +462,19 @@ struct _GKeyFileGroup
    * increased lookup performance
    */
   GHashTable *lookup_map;
+
+  /* Lines of a loaded file that have been validated but not yet
+   * parsed into key_value_pairs, see g_key_file_group_ensure_parsed()
+   */
+  gchar *unparsed_start;
+  gchar *unparsed_end;
 };
 
 struct _GKeyFileKeyValuePair
 {
   gchar *key;  /* NULL for comments */
   gchar *value;
+  guint in_place : 1; /* key and value point into key_file->contents */
 };
 
 static gint                  find_file_in_data_dirs            (const gchar            *file,
@@ -550,6 +559,12 @@ static void                  g_key_file_parse_data             (GKeyFile
 								const gchar            *data,
 								gsize                   length,
 								GError                **error);
+static void                  g_key_file_parse_contents         (GKeyFile               *key_file,
+								gchar                  *data,
+								gsize                   length,
+								GError                **error);
+static void                  g_key_file_group_ensure_parsed    (GKeyFile               *key_file,
+								GKeyFileGroup          *group);
 static void                  g_key_file_flush_parse_buffer     (GKeyFile               *key_file,
 								GError                **error);
 
@@ -599,6 +614,10 @@ g_key_file_clear (GKeyFile *key_file)
       key_file->group_hash = NULL;
     }
 
+  /* Only after the groups, since pairs may point into the contents */
+  g_free (key_file->contents);
+  key_file->contents = NULL;
+
   g_warn_if_fail (key_file->groups == NULL);
 }
 
@@ -762,29 +781,75 @@ g_key_file_load_from_fd (GKeyFile       *key_file,
   key_file->list_separator = list_separator;
   key_file->flags = flags;
 
-  do
+  /* Read the whole file into one buffer, so that lines can be
+   * terminated in place and groups parsed lazily from a snapshot of
+   * the file.  Files that report no size (as in /proc) are read and
+   * parsed in chunks instead.
+   */
+  if (stat_buf.st_size > 0)
     {
-      bytes_read = read (fd, read_buf, 4096);
+      gsize allocated = stat_buf.st_size;
+      gsize length = 0;
 
-      if (bytes_read == 0)  /* End of File */
-        break;
+      key_file->contents = g_malloc (allocated);
 
-      if (bytes_read < 0)
+      while (TRUE)
         {
-          if (errno == EINTR || errno == EAGAIN)
-            continue;
+          /* The file may have grown since we looked at it */
+          if (length == allocated)
+            {
+              allocated *= 2;
+              key_file->contents = g_realloc (key_file->contents, allocated);
+            }
+
+          bytes_read = read (fd, key_file->contents + length, allocated - length);
 
-          g_set_error_literal (error, G_FILE_ERROR,
-                               g_file_error_from_errno (errno),
-                               g_strerror (errno));
-          return FALSE;
+          if (bytes_read == 0)  /* End of File */
+            break;
+
+          if (bytes_read < 0)
+            {
+              if (errno == EINTR || errno == EAGAIN)
+                continue;
+
+              g_set_error_literal (error, G_FILE_ERROR,
+                                   g_file_error_from_errno (errno),
+                                   g_strerror (errno));
+              return FALSE;
+            }
+
+          length += bytes_read;
         }
 
-      g_key_file_parse_data (key_file,
-			     read_buf, bytes_read,
-			     &key_file_error);
+      g_key_file_parse_contents (key_file, key_file->contents, length,
+                                 &key_file_error);
+    }
+  else
+    {
+      do
+        {
+          bytes_read = read (fd, read_buf, 4096);
+
+          if (bytes_read == 0)  /* End of File */
+            break;
+
+          if (bytes_read < 0)
+            {
+              if (errno == EINTR || errno == EAGAIN)
+                continue;
+
+              g_set_error_literal (error, G_FILE_ERROR,
+                                   g_file_error_from_errno (errno),
+                                   g_strerror (errno));
+              return FALSE;
+            }
+
+          g_key_file_parse_data (key_file,
+                                 read_buf, bytes_read,
+                                 &key_file_error);
+        }
+      while (!key_file_error);
     }
-  while (!key_file_error);
 
   if (key_file_error)
     {
@@ -1177,7 +1242,7 @@ g_key_file_parse_comment (GKeyFile     *key_file,
   
   g_warn_if_fail (key_file->current_group != NULL);
 
-  pair = g_slice_new (GKeyFileKeyValuePair);
+  pair = g_slice_new0 (GKeyFileKeyValuePair);
   pair->key = NULL;
   pair->value = g_strndup (line, length);
   
@@ -1302,7 +1367,7 @@ g_key_file_parse_key_value_pair (GKeyFile     *key_file,
     {
       GKeyFileKeyValuePair *pair;
 
-      pair = g_slice_new (GKeyFileKeyValuePair);
+      pair = g_slice_new0 (GKeyFileKeyValuePair);
       pair->key = key;
       pair->value = value;
 
@@ -1420,6 +1485,208 @@ g_key_file_flush_parse_buffer (GKeyFile  *key_file,
     }
 }
 
+/* Checks, without allocating, that @line would be accepted by
+ * g_key_file_parse_line() in a group other than the start group.
+ * Leading whitespace must already have been stripped.
+ */
+static gboolean
+g_key_file_line_is_valid_in_group (gchar *line)
+{
+  gchar *key_end;
+  gchar saved;
+  gboolean valid;
+
+  if (g_key_file_line_is_comment (line))
+    return TRUE;
+
+  if (!g_key_file_line_is_key_value_pair (line))
+    return FALSE;
+
+  key_end = strchr (line, '=') - 1;
+  while (g_ascii_isspace (*key_end))
+    key_end--;
+  key_end++;
+
+  saved = *key_end;
+  *key_end = '\0';
+  valid = g_key_file_is_key_name (line);
+  *key_end = saved;
+
+  return valid;
+}
+
+/* Adds the key-value pair on @line, which was validated when it was
+ * indexed, to the current group.  The key is terminated in place and
+ * both strings are referenced from the contents instead of copied.
+ */
+static void
+g_key_file_parse_key_value_pair_in_place (GKeyFile *key_file,
+                                          gchar    *line)
+{
+  gchar *key_end, *value_start, *locale;
+
+  key_end = value_start = strchr (line, '=');
+  key_end--;
+  value_start++;
+
+  while (g_ascii_isspace (*key_end))
+    key_end--;
+
+  while (g_ascii_isspace (*value_start))
+    value_start++;
+
+  key_end[1] = '\0';
+
+  locale = key_get_locale (line);
+
+  if (locale == NULL || g_key_file_locale_is_interesting (key_file, locale))
+    {
+      GKeyFileKeyValuePair *pair;
+
+      pair = g_slice_new0 (GKeyFileKeyValuePair);
+      pair->key = line;
+      pair->value = value_start;
+      pair->in_place = TRUE;
+
+      g_key_file_add_key_value_pair (key_file, key_file->current_group, pair);
+    }
+
+  g_free (locale);
+}
+
+/* Parses the lines that g_key_file_parse_contents() left behind
+ * for @group.  Each of them is nul-terminated; a "\r\n" line ending
+ * leaves its '\n' in place after the nul.
+ */
+static void
+g_key_file_group_ensure_parsed (GKeyFile      *key_file,
+                                GKeyFileGroup *group)
+{
+  GKeyFileGroup *current_group;
+  gchar *line, *line_start, *end;
+  gsize length;
+
+  if (group->unparsed_start == NULL)
+    return;
+
+  line = group->unparsed_start;
+  end = group->unparsed_end;
+  group->unparsed_start = NULL;
+  group->unparsed_end = NULL;
+
+  current_group = key_file->current_group;
+  key_file->current_group = group;
+
+  while (line < end)
+    {
+      length = strlen (line);
+
+      line_start = line;
+      while (g_ascii_isspace (*line_start))
+        line_start++;
+
+      if (g_key_file_line_is_comment (line_start))
+        g_key_file_parse_comment (key_file, line, length, NULL);
+      else
+        g_key_file_parse_key_value_pair_in_place (key_file, line_start);
+
+      line += length + 1;
+      if (line < end && *line == '\n')
+        line++;
+    }
+
+  key_file->current_group = current_group;
+}
+
+/* Loads @data, which is a private copy of the whole file, without
+ * copying it line by line.  Lines are terminated in place and checked
+ * as they are found, so errors are reported exactly as by
+ * g_key_file_parse_data(), but the keys of each group other than the
+ * start group are only parsed once the group is looked up.
+ */
+static void
+g_key_file_parse_contents (GKeyFile     *key_file,
+                           gchar        *data,
+                           gsize         length,
+                           GError      **error)
+{
+  GError *parse_error = NULL;
+  GKeyFileGroup *lazy_group = NULL;
+  gchar *line, *line_start, *end_of_line, *end;
+  gsize line_length;
+  guint n_groups;
+
+  line = data;
+  end = data + length;
+
+  while (line < end)
+    {
+      end_of_line = memchr (line, '\n', end - line);
+      if (end_of_line == NULL)
+        break;
+
+      line_length = end_of_line - line;
+      if (line_length > 0 && line[line_length - 1] == '\r')
+        line_length--;
+      line[line_length] = '\0';
+
+      line_start = line;
+      while (g_ascii_isspace (*line_start))
+        line_start++;
+
+      if (g_key_file_line_is_group (line_start))
+        {
+          lazy_group = NULL;
+
+          n_groups = g_hash_table_size (key_file->group_hash);
+          g_key_file_parse_line (key_file, line, line_length, &parse_error);
+
+          /* Groups that are repeated in the file are merged eagerly */
+          if (parse_error == NULL &&
+              g_hash_table_size (key_file->group_hash) > n_groups &&
+              key_file->current_group != key_file->start_group)
+            {
+              lazy_group = key_file->current_group;
+              lazy_group->unparsed_start = end_of_line + 1;
+              lazy_group->unparsed_end = end_of_line + 1;
+            }
+        }
+      else if (lazy_group != NULL &&
+               strlen (line) == line_length &&
+               g_key_file_line_is_valid_in_group (line_start))
+        {
+          lazy_group->unparsed_end = end_of_line + 1;
+        }
+      else
+        {
+          if (lazy_group != NULL)
+            {
+              g_key_file_group_ensure_parsed (key_file, lazy_group);
+              lazy_group = NULL;
+            }
+
+          g_key_file_parse_line (key_file, line, line_length, &parse_error);
+        }
+
+      if (parse_error)
+        {
+          g_propagate_error (error, parse_error);
+          return;
+        }
+
+      line = end_of_line + 1;
+    }
+
+  /* A last line without a newline cannot be terminated in place */
+  if (line < end)
+    {
+      if (lazy_group != NULL)
+        g_key_file_group_ensure_parsed (key_file, lazy_group);
+
+      g_string_append_len (key_file->parse_buffer, line, end - line);
+    }
+}
+
 /**
  * g_key_file_to_data:
  * @key_file: a #GKeyFile
@@ -1456,6 +1723,7 @@ g_key_file_to_data (GKeyFile  *key_file,
       GKeyFileGroup *group;
 
       group = (GKeyFileGroup *) group_node->data;
+      g_key_file_group_ensure_parsed (key_file, group);
 
       /* separate groups by at least an empty line */
       if (data_string->len >= 2 &&
@@ -1753,7 +2021,16 @@ g_key_file_set_value (GKeyFile    *key_file,
         g_key_file_add_key (key_file, group, key, value);
       else
         {
-          g_free (pair->value);
+          /* Stop referring to the contents once the pair is modified */
+          if (pair->in_place)
+            {
+              pair->key = g_strdup (pair->key);
+              g_hash_table_replace (group->lookup_map, pair->key, pair);
+              pair->in_place = FALSE;
+            }
+          else
+            g_free (pair->value);
+
           pair->value = g_strdup (value);
         }
     }
@@ -3111,7 +3388,7 @@ g_key_file_set_key_comment (GKeyFile     *key_file,
 
   /* Now we can add our new comment
    */
-  pair = g_slice_new (GKeyFileKeyValuePair);
+  pair = g_slice_new0 (GKeyFileKeyValuePair);
   pair->key = NULL;
   pair->value = g_key_file_parse_comment_as_value (key_file, comment);
   
@@ -3154,7 +3431,7 @@ g_key_file_set_group_comment (GKeyFile     *key_file,
 
   /* Now we can add our new comment
    */
-  group->comment = g_slice_new (GKeyFileKeyValuePair);
+  group->comment = g_slice_new0 (GKeyFileKeyValuePair);
   group->comment->key = NULL;
   group->comment->value = g_key_file_parse_comment_as_value (key_file, comment);
 
@@ -3187,7 +3464,7 @@ g_key_file_set_top_comment (GKeyFile     *key_file,
   if (comment == NULL)
      return TRUE;
 
-  pair = g_slice_new (GKeyFileKeyValuePair);
+  pair = g_slice_new0 (GKeyFileKeyValuePair);
   pair->key = NULL;
   pair->value = g_key_file_parse_comment_as_value (key_file, comment);
   
@@ -3406,6 +3683,7 @@ g_key_file_get_group_comment (GKeyFile     *key_file,
   group_node = g_key_file_lookup_group_node (key_file, group_name);
   group_node = group_node->next;
   group = (GKeyFileGroup *)group_node->data;  
+  g_key_file_group_ensure_parsed (key_file, group);
   return get_group_comment (key_file, group, error);
 }
 
@@ -3510,7 +3788,7 @@ g_key_file_has_group (GKeyFile    *key_file,
   g_return_val_if_fail (key_file != NULL, FALSE);
   g_return_val_if_fail (group_name != NULL, FALSE);
 
-  return g_key_file_lookup_group (key_file, group_name) != NULL;
+  return g_hash_table_lookup (key_file->group_hash, group_name) != NULL;
 }
 
 /* This code remains from a historical attempt to add a new public API
@@ -3624,8 +3902,11 @@ g_key_file_key_value_pair_free (GKeyFileKeyValuePair *pair)
 {
   if (pair != NULL)
     {
-      g_free (pair->key);
-      g_free (pair->value);
+      if (!pair->in_place)
+        {
+          g_free (pair->key);
+          g_free (pair->value);
+        }
       g_slice_free (GKeyFileKeyValuePair, pair);
     }
 }
@@ -3707,6 +3988,10 @@ g_key_file_remove_group_node (GKeyFile *key_file,
 
   key_file->groups = g_list_remove_link (key_file->groups, group_node);
 
+  /* Lines that were never parsed have nothing to free */
+  group->unparsed_start = NULL;
+  group->unparsed_end = NULL;
+
   tmp = group->key_value_pairs;
   while (tmp != NULL)
     {
@@ -3792,7 +4077,7 @@ g_key_file_add_key (GKeyFile      *key_file,
 {
   GKeyFileKeyValuePair *pair;
 
-  pair = g_slice_new (GKeyFileKeyValuePair);
+  pair = g_slice_new0 (GKeyFileKeyValuePair);
   pair->key = g_strdup (key);
   pair->value = g_strdup (value);
 
@@ -3877,7 +4162,14 @@ static GKeyFileGroup *
 g_key_file_lookup_group (GKeyFile    *key_file,
 			 const gchar *group_name)
 {
-  return (GKeyFileGroup *)g_hash_table_lookup (key_file->group_hash, group_name);
+  GKeyFileGroup *group;
+
+  group = (GKeyFileGroup *)g_hash_table_lookup (key_file->group_hash, group_name);
+
+  if (group != NULL)
+    g_key_file_group_ensure_parsed (key_file, group);
+
+  return group;
 }
 
 static GList *
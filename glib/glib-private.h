@@ -40,6 +40,8 @@ gchar *_glib_get_locale_dir    (void);
 GDir * g_dir_open_with_errno (const gchar *path, guint flags);
 GDir * g_dir_new_from_dirp (gpointer dirp);
 
+void g_get_random_seed (guint32 seed[4]);
+
 #define GLIB_PRIVATE_CALL(symbol) (glib__private__()->symbol)
 
 typedef struct {
@@ -61,6 +63,9 @@ typedef struct {
                                                          guint        flags);
   GDir *                (* g_dir_new_from_dirp)         (gpointer dirp);
 
+  /* See grand.c */
+  void                  (* g_get_random_seed)           (guint32 seed[4]);
+
   /* Add other private functions here, initialize them in glib-private.c */
 } GLibPrivateVTable;
 
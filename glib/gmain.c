@@ -4201,11 +4201,14 @@ g_main_context_add_poll_unlocked (GMainContext *context,
   newrec->fd = fd;
   newrec->priority = priority;
 
+  /* Keep the list sorted by fd number, not by GPollFD address, so
+   * that g_main_context_query() can merge records for the same fd.
+   */
   prevrec = NULL;
   nextrec = context->poll_records;
   while (nextrec)
     {
-      if (nextrec->fd > fd)
+      if (nextrec->fd->fd > fd->fd)
         break;
       prevrec = nextrec;
       nextrec = nextrec->next;
@@ -83,6 +83,7 @@ struct _GMappedFile
   gsize  length;
   gpointer free_func;
   int    ref_count;
+  gsize  map_offset;  /* of contents from the aligned start of the mapping */
 #ifdef G_OS_WIN32
   HANDLE mapping;
 #endif
@@ -94,10 +95,10 @@ g_mapped_file_destroy (GMappedFile *file)
   if (file->length)
     {
 #ifdef HAVE_MMAP
-      munmap (file->contents, file->length);
+      munmap (file->contents - file->map_offset, file->length + file->map_offset);
 #endif
 #ifdef G_OS_WIN32
-      UnmapViewOfFile (file->contents);
+      UnmapViewOfFile (file->contents - file->map_offset);
       CloseHandle (file->mapping);
 #endif
     }
@@ -105,14 +106,67 @@ g_mapped_file_destroy (GMappedFile *file)
   g_slice_free (GMappedFile, file);
 }
 
+/* Mappings have to start at a multiple of this */
+static gsize
+get_map_alignment (void)
+{
+#ifdef G_OS_WIN32
+  SYSTEM_INFO info;
+
+  GetSystemInfo (&info);
+  return info.dwAllocationGranularity;
+#elif defined (HAVE_MMAP)
+  return sysconf (_SC_PAGESIZE);
+#else
+  return 1;
+#endif
+}
+
+#ifdef HAVE_MMAP
+static void
+apply_advice (gchar            *start,
+              gsize             length,
+              GMappedFileFlags  flags)
+{
+#ifdef MADV_WILLNEED
+  if (flags & G_MAPPED_FILE_FLAGS_WILL_NEED)
+    madvise (start, length, MADV_WILLNEED);
+#endif
+#ifdef MADV_SEQUENTIAL
+  if (flags & G_MAPPED_FILE_FLAGS_SEQUENTIAL)
+    madvise (start, length, MADV_SEQUENTIAL);
+#endif
+#ifdef MADV_RANDOM
+  if (flags & G_MAPPED_FILE_FLAGS_RANDOM)
+    madvise (start, length, MADV_RANDOM);
+#endif
+#ifdef MADV_HUGEPAGE
+  if (flags & G_MAPPED_FILE_FLAGS_HUGE_PAGES)
+    madvise (start, length, MADV_HUGEPAGE);
+#endif
+#ifndef MAP_POPULATE
+  /* Without MAP_POPULATE, at least start reading ahead */
+#ifdef MADV_WILLNEED
+  if (flags & G_MAPPED_FILE_FLAGS_POPULATE)
+    madvise (start, length, MADV_WILLNEED);
+#endif
+#endif
+}
+#endif
+
 static GMappedFile*
-mapped_file_new_from_fd (int           fd,
-			 gboolean      writable,
-                         const gchar  *filename,
-                         GError      **error)
+mapped_file_new_from_fd (int               fd,
+                         GMappedFileFlags  flags,
+                         goffset           offset,
+                         gssize            length,
+                         const gchar      *filename,
+                         GError          **error)
 {
   GMappedFile *file;
   struct stat st;
+  gboolean writable = (flags & G_MAPPED_FILE_FLAGS_WRITABLE) != 0;
+  goffset map_start;
+  gsize map_length;
 
   file = g_slice_new0 (GMappedFile);
   file->ref_count = 1;
@@ -136,11 +190,31 @@ mapped_file_new_from_fd (int           fd,
       goto out;
     }
 
+  if (offset > st.st_size ||
+      (length >= 0 && (goffset) length > st.st_size - offset))
+    {
+      gchar *display_filename = filename ? g_filename_display_name (filename) : NULL;
+
+      g_set_error (error,
+                   G_FILE_ERROR,
+                   G_FILE_ERROR_INVAL,
+                   _("Failed to map %s%s%s%s: range lies beyond the end of the file"),
+		   display_filename ? display_filename : "fd",
+		   display_filename ? "' " : "",
+		   display_filename ? display_filename : "",
+		   display_filename ? "'" : "");
+      g_free (display_filename);
+      goto out;
+    }
+
+  if (length < 0)
+    length = st.st_size - offset;
+
   /* mmap() on size 0 will fail with EINVAL, so we avoid calling mmap()
    * in that case -- but only if we have a regular file; we still want
    * attempts to mmap a character device to fail, for example.
    */
-  if (st.st_size == 0 && S_ISREG (st.st_mode))
+  if (length == 0 && S_ISREG (st.st_mode))
     {
       file->length = 0;
       file->contents = NULL;
@@ -149,21 +223,38 @@ mapped_file_new_from_fd (int           fd,
 
   file->contents = MAP_FAILED;
 
+  /* Map from the aligned offset below the requested one */
+  file->map_offset = offset % get_map_alignment ();
+  map_start = offset - file->map_offset;
+  map_length = length + file->map_offset;
+
 #ifdef HAVE_MMAP
-  if (st.st_size > G_MAXSIZE)
+  if ((guint64) length + file->map_offset > G_MAXSIZE)
     {
       errno = EINVAL;
     }
   else
     {      
-      file->length = (gsize) st.st_size;
-      file->contents = (gchar *) mmap (NULL,  file->length,
+      int map_flags = MAP_PRIVATE;
+
+#ifdef MAP_POPULATE
+      if (flags & G_MAPPED_FILE_FLAGS_POPULATE)
+        map_flags |= MAP_POPULATE;
+#endif
+
+      file->length = (gsize) length;
+      file->contents = (gchar *) mmap (NULL, map_length,
 				       writable ? PROT_READ|PROT_WRITE : PROT_READ,
-				       MAP_PRIVATE, fd, 0);
+				       map_flags, fd, map_start);
+      if (file->contents != MAP_FAILED)
+        {
+          apply_advice (file->contents, map_length, flags);
+          file->contents += file->map_offset;
+        }
     }
 #endif
 #ifdef G_OS_WIN32
-  file->length = st.st_size;
+  file->length = length;
   file->mapping = CreateFileMapping ((HANDLE) _get_osfhandle (fd), NULL,
 				     writable ? PAGE_WRITECOPY : PAGE_READONLY,
 				     0, 0,
@@ -172,14 +263,17 @@ mapped_file_new_from_fd (int           fd,
     {
       file->contents = MapViewOfFile (file->mapping,
 				      writable ? FILE_MAP_COPY : FILE_MAP_READ,
-				      0, 0,
-				      0);
+				      (DWORD) ((guint64) map_start >> 32),
+				      (DWORD) map_start,
+				      map_length);
       if (file->contents == NULL)
 	{
 	  file->contents = MAP_FAILED;
 	  CloseHandle (file->mapping);
 	  file->mapping = NULL;
 	}
+      else
+        file->contents += file->map_offset;
     }
 #endif
 
@@ -265,7 +359,75 @@ g_mapped_file_new (const gchar  *filename,
       return NULL;
     }
 
-  file = mapped_file_new_from_fd (fd, writable, filename, error);
+  file = mapped_file_new_from_fd (fd,
+                                  writable ? G_MAPPED_FILE_FLAGS_WRITABLE : G_MAPPED_FILE_FLAGS_NONE,
+                                  0, -1, filename, error);
+
+  close (fd);
+
+  return file;
+}
+
+/**
+ * g_mapped_file_new_full:
+ * @filename: The path of the file to load, in the GLib filename encoding
+ * @flags: #GMappedFileFlags for the mapping
+ * @offset: the offset in the file at which the mapping starts
+ * @length: the number of bytes to map, or -1 to map up to the end of
+ *     the file
+ * @error: return location for a #GError, or %NULL
+ *
+ * Maps the given range of a file into memory, like g_mapped_file_new().
+ *
+ * Only the requested range is mapped; @offset does not have to be page
+ * aligned.  g_mapped_file_get_contents() points at the byte at @offset
+ * and g_mapped_file_get_bytes() exposes just the range, so a large
+ * file can be handed out piecewise as #GBytes.
+ *
+ * If the range does not lie within the file, @error is set to
+ * %G_FILE_ERROR_INVAL.  An empty range of a regular file results in an
+ * empty #GMappedFile.
+ *
+ * @flags may ask for the mapping to be read in up front and give hints
+ * about how it will be accessed; see #GMappedFileFlags.
+ *
+ * Returns: a newly allocated #GMappedFile which must be unref'd
+ *    with g_mapped_file_unref(), or %NULL if the mapping failed.
+ *
+ * Since: 2.44
+ */
+GMappedFile *
+g_mapped_file_new_full (const gchar       *filename,
+                        GMappedFileFlags   flags,
+                        goffset            offset,
+                        gssize             length,
+                        GError           **error)
+{
+  GMappedFile *file;
+  gboolean writable = (flags & G_MAPPED_FILE_FLAGS_WRITABLE) != 0;
+  int fd;
+
+  g_return_val_if_fail (filename != NULL, NULL);
+  g_return_val_if_fail (offset >= 0, NULL);
+  g_return_val_if_fail (!error || *error == NULL, NULL);
+
+  fd = g_open (filename, (writable ? O_RDWR : O_RDONLY) | _O_BINARY, 0);
+  if (fd == -1)
+    {
+      int save_errno = errno;
+      gchar *display_filename = g_filename_display_name (filename);
+
+      g_set_error (error,
+                   G_FILE_ERROR,
+                   g_file_error_from_errno (save_errno),
+                   _("Failed to open file '%s': open() failed: %s"),
+                   display_filename,
+		   g_strerror (save_errno));
+      g_free (display_filename);
+      return NULL;
+    }
+
+  file = mapped_file_new_from_fd (fd, flags, offset, length, filename, error);
 
   close (fd);
 
@@ -301,7 +463,39 @@ g_mapped_file_new_from_fd (gint          fd,
 			   gboolean      writable,
 			   GError      **error)
 {
-  return mapped_file_new_from_fd (fd, writable, NULL, error);
+  return mapped_file_new_from_fd (fd,
+                                  writable ? G_MAPPED_FILE_FLAGS_WRITABLE : G_MAPPED_FILE_FLAGS_NONE,
+                                  0, -1, NULL, error);
+}
+
+/**
+ * g_mapped_file_new_from_fd_full:
+ * @fd: The file descriptor of the file to load
+ * @flags: #GMappedFileFlags for the mapping
+ * @offset: the offset in the file at which the mapping starts
+ * @length: the number of bytes to map, or -1 to map up to the end of
+ *     the file
+ * @error: return location for a #GError, or %NULL
+ *
+ * Maps the given range of the file @fd into memory.  See
+ * g_mapped_file_new_full() for details.
+ *
+ * Returns: a newly allocated #GMappedFile which must be unref'd
+ *    with g_mapped_file_unref(), or %NULL if the mapping failed.
+ *
+ * Since: 2.44
+ */
+GMappedFile *
+g_mapped_file_new_from_fd_full (gint               fd,
+                                GMappedFileFlags   flags,
+                                goffset            offset,
+                                gssize             length,
+                                GError           **error)
+{
+  g_return_val_if_fail (offset >= 0, NULL);
+  g_return_val_if_fail (!error || *error == NULL, NULL);
+
+  return mapped_file_new_from_fd (fd, flags, offset, length, NULL, error);
 }
 
 /**
@@ -31,6 +31,39 @@ G_BEGIN_DECLS
 
 typedef struct _GMappedFile GMappedFile;
 
+/**
+ * GMappedFileFlags:
+ * @G_MAPPED_FILE_FLAGS_NONE: No flags
+ * @G_MAPPED_FILE_FLAGS_WRITABLE: Map the file writable, like the
+ *     @writable argument of g_mapped_file_new()
+ * @G_MAPPED_FILE_FLAGS_POPULATE: Read the whole mapping in before
+ *     returning (MAP_POPULATE), so that accessing it does not fault
+ * @G_MAPPED_FILE_FLAGS_WILL_NEED: Start reading the mapping in the
+ *     background (MADV_WILLNEED)
+ * @G_MAPPED_FILE_FLAGS_SEQUENTIAL: The mapping will be read
+ *     sequentially, so aggressive read-ahead is useful
+ * @G_MAPPED_FILE_FLAGS_RANDOM: The mapping will be accessed in random
+ *     order, so read-ahead is not useful
+ * @G_MAPPED_FILE_FLAGS_HUGE_PAGES: Back the mapping with transparent
+ *     huge pages if the system supports that for files
+ *
+ * Flags for g_mapped_file_new_full().  Apart from
+ * %G_MAPPED_FILE_FLAGS_WRITABLE they are only hints, and they are
+ * ignored on systems that don't support them.
+ *
+ * Since: 2.44
+ */
+typedef enum
+{
+  G_MAPPED_FILE_FLAGS_NONE       = 0,
+  G_MAPPED_FILE_FLAGS_WRITABLE   = 1 << 0,
+  G_MAPPED_FILE_FLAGS_POPULATE   = 1 << 1,
+  G_MAPPED_FILE_FLAGS_WILL_NEED  = 1 << 2,
+  G_MAPPED_FILE_FLAGS_SEQUENTIAL = 1 << 3,
+  G_MAPPED_FILE_FLAGS_RANDOM     = 1 << 4,
+  G_MAPPED_FILE_FLAGS_HUGE_PAGES = 1 << 5
+} GMappedFileFlags;
+
 GLIB_AVAILABLE_IN_ALL
 GMappedFile *g_mapped_file_new          (const gchar  *filename,
 				         gboolean      writable,
@@ -39,6 +72,18 @@ GLIB_AVAILABLE_IN_ALL
 GMappedFile *g_mapped_file_new_from_fd  (gint          fd,
 					 gboolean      writable,
 					 GError      **error) G_GNUC_MALLOC;
+GLIB_AVAILABLE_IN_2_44
+GMappedFile *g_mapped_file_new_full     (const gchar       *filename,
+                                         GMappedFileFlags   flags,
+                                         goffset            offset,
+                                         gssize             length,
+                                         GError           **error) G_GNUC_MALLOC;
+GLIB_AVAILABLE_IN_2_44
+GMappedFile *g_mapped_file_new_from_fd_full (gint               fd,
+                                             GMappedFileFlags   flags,
+                                             goffset            offset,
+                                             gssize             length,
+                                             GError           **error) G_GNUC_MALLOC;
 GLIB_AVAILABLE_IN_ALL
 gsize        g_mapped_file_get_length   (GMappedFile  *file);
 GLIB_AVAILABLE_IN_ALL
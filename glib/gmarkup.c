@@ -110,7 +110,7 @@ typedef enum
 
 typedef struct
 {
-  const char *prev_element;
+  GSList *prev_element;
   const GMarkupParser *prev_parser;
   gpointer prev_user_data;
 } GMarkupRecursionTracker;
@@ -163,7 +163,7 @@ struct _GMarkupParseContext
 
   /* subparser support */
   GSList *subparser_stack; /* (GMarkupRecursionTracker *) */
-  const char *subparser_element;
+  GSList *subparser_element; /* node of tag_stack */
   gpointer held_user_data;
 };
 
@@ -314,7 +314,8 @@ g_markup_parse_context_unref (GMarkupParseContext *context)
 static void
 string_full_free (gpointer ptr)
 {
-  g_string_free (ptr, TRUE);
+  if (ptr)
+    g_string_free (ptr, TRUE);
 }
 
 static void clear_attributes (GMarkupParseContext *context);
@@ -806,6 +807,64 @@ advance_char (GMarkupParseContext *context)
   return TRUE;
 }
 
+/* Equivalent to calling advance_char() until it either fails or
+ * lands on @c, but skips over the text with memchr().
+ */
+static gboolean
+advance_to_char (GMarkupParseContext *context,
+                 gchar                c)
+{
+  const gchar *target, *stop, *p, *nl, *last_nl;
+
+  target = memchr (context->iter, c, context->current_text_end - context->iter);
+  if (target == NULL)
+    target = context->current_text_end;
+
+  /* advance_char() does not look at the byte at current_text_end */
+  stop = MIN (target + 1, context->current_text_end);
+  last_nl = NULL;
+  p = context->iter + 1;
+  while (p < stop && (nl = memchr (p, '\n', stop - p)) != NULL)
+    {
+      context->line_number++;
+      last_nl = nl;
+      p = nl + 1;
+    }
+
+  if (last_nl != NULL)
+    context->char_number = 1 + (target - last_nl);
+  else
+    context->char_number += target - context->iter;
+
+  context->iter = target;
+
+  return target != context->current_text_end;
+}
+
+/* With G_MARKUP_NO_COPY, text that needs neither unescaping nor
+ * line ending normalisation can be passed straight to the caller.
+ */
+static gboolean
+text_is_verbatim (const gchar *text,
+                  const gchar *text_end,
+                  gboolean    *is_ascii)
+{
+  const gchar *p;
+  gchar mask;
+
+  mask = 0;
+  for (p = text; p != text_end; p++)
+    {
+      if (*p == '&' || *p == '\r' || *p == '\0')
+        return FALSE;
+      mask |= *p;
+    }
+
+  *is_ascii = (mask & 0x80) == 0;
+
+  return TRUE;
+}
+
 static inline gboolean
 xml_isspace (char c)
 {
@@ -914,8 +973,19 @@ static void
 push_partial_as_tag (GMarkupParseContext *context)
 {
   GString *str = context->partial_chunk;
+  const gchar *name;
+
+  if (context->flags & G_MARKUP_NO_COPY)
+    {
+      name = g_intern_string (str->str);
+      release_chunk (context, str);
+      str = NULL;
+    }
+  else
+    name = str->str;
+
   /* sadly, this is exported by gmarkup_get_element_stack as-is */
-  context->tag_stack = g_slist_concat (get_list_node (context, str->str), context->tag_stack);
+  context->tag_stack = g_slist_concat (get_list_node (context, (gchar *) name), context->tag_stack);
   context->tag_stack_gstr = g_slist_concat (get_list_node (context, str), context->tag_stack_gstr);
   context->partial_chunk = NULL;
 }
@@ -937,7 +1007,8 @@ pop_tag (GMarkupParseContext *context)
 static void
 possibly_finish_subparser (GMarkupParseContext *context)
 {
-  if (current_element (context) == context->subparser_element)
+  /* Compare the stack nodes, interned names can repeat */
+  if (context->tag_stack == context->subparser_element)
     pop_subparser_stack (context);
 }
 
@@ -1448,12 +1519,7 @@ g_markup_parse_context_parse (GMarkupParseContext  *context,
                 delim = '"';
               }
 
-            do
-              {
-                if (*context->iter == delim)
-                  break;
-              }
-            while (advance_char (context));
+            advance_to_char (context, delim);
           }
           if (context->iter == context->current_text_end)
             {
@@ -1491,12 +1557,45 @@ g_markup_parse_context_parse (GMarkupParseContext  *context,
 
         case STATE_INSIDE_TEXT:
           /* Possible next states: AFTER_OPEN_ANGLE */
-          do
+          advance_to_char (context, '<');
+
+          if ((context->flags & G_MARKUP_NO_COPY) &&
+              context->iter != context->current_text_end &&
+              (context->partial_chunk == NULL || context->partial_chunk->len == 0))
             {
-              if (*context->iter == '<')
-                break;
+              gboolean is_ascii;
+
+              /* The whole text is in this buffer; hand out a slice.
+               * Invalid UTF-8 takes the copying path below, which
+               * reports the error.
+               */
+              if (text_is_verbatim (context->start, context->iter, &is_ascii) &&
+                  (is_ascii || g_utf8_validate (context->start,
+                                                context->iter - context->start,
+                                                NULL)))
+                {
+                  GError *tmp_error = NULL;
+
+                  if (context->parser->text)
+                    (*context->parser->text) (context,
+                                              context->start,
+                                              context->iter - context->start,
+                                              context->user_data,
+                                              &tmp_error);
+
+                  if (tmp_error == NULL)
+                    {
+                      /* advance past open angle and set state. */
+                      advance_char (context);
+                      context->state = STATE_AFTER_OPEN_ANGLE;
+                      /* could begin a passthrough */
+                      context->start = context->iter;
+                    }
+                  else
+                    propagate_error (context, error, tmp_error);
+                  break;
+                }
             }
-          while (advance_char (context));
 
           /* The text hasn't necessarily ended. Merge with
            * partial chunk, leave state unchanged.
@@ -2096,7 +2195,7 @@ g_markup_parse_context_push (GMarkupParseContext *context,
   tracker->prev_parser = context->parser;
   tracker->prev_user_data = context->user_data;
 
-  context->subparser_element = current_element (context);
+  context->subparser_element = context->tag_stack;
   context->parser = parser;
   context->user_data = user_data;
 
@@ -90,6 +90,14 @@ GQuark g_markup_error_quark (void);
  *     attributes and tags, along with their contents.  A qualified
  *     attribute or tag is one that contains ':' in its name (ie: is in
  *     another namespace).  Since: 2.40.
+ * @G_MARKUP_NO_COPY: Avoid copying the document where possible.  Text
+ *     without entity references that is contained in a single buffer
+ *     passed to g_markup_parse_context_parse() is given to the @text
+ *     function as a pointer into that buffer, so it is not nul-terminated.
+ *     Element names are interned with g_intern_string(), so they can be
+ *     compared by pointer and stay valid after the element has ended;
+ *     since interned strings are never freed, only use this for documents
+ *     with a bounded set of element names.  Since: 2.44.
  *
  * Flags that affect the behaviour of the parser.
  */
@@ -98,7 +106,8 @@ typedef enum
   G_MARKUP_DO_NOT_USE_THIS_UNSUPPORTED_FLAG = 1 << 0,
   G_MARKUP_TREAT_CDATA_AS_TEXT              = 1 << 1,
   G_MARKUP_PREFIX_ERROR_POSITION            = 1 << 2,
-  G_MARKUP_IGNORE_QUALIFIED                 = 1 << 3
+  G_MARKUP_IGNORE_QUALIFIED                 = 1 << 3,
+  G_MARKUP_NO_COPY                          = 1 << 4
 } GMarkupParseFlags;
 
 /**
@@ -64,12 +64,15 @@
 #include "gprintfint.h"
 #include "gtestutils.h"
 #include "gthread.h"
+#include "gmain.h"
+#include "gtimer.h"
 #include "gstrfuncs.h"
 #include "gstring.h"
 #include "gpattern.h"
 
 #ifdef G_OS_UNIX
 #include <unistd.h>
+#include <sys/uio.h>
 #endif
 
 #ifdef G_OS_WIN32
@@ -895,6 +898,435 @@ mklevel_prefix (gchar          level_prefix[STRING_BUFFER_SIZE],
   return to_stdout ? 1 : 2;
 }
 
+/* --- asynchronous output --- */
+
+static volatile guint log_async_dropped;
+
+/* Each thread that logs while asynchronous output is enabled gets its
+ * own ring of pending messages.  The thread is the only writer of
+ * @head and whoever holds log_async_drain_lock the only writer of
+ * @tail, so queueing a message needs no lock.  Records are an 8 byte
+ * header followed by the message, padded to 8 bytes; only the message
+ * can wrap around the end of the ring.
+ */
+#ifdef G_OS_UNIX
+typedef struct _GLogRing GLogRing;
+struct _GLogRing
+{
+  gchar         *data;
+  guint          size;
+  volatile guint head;
+  volatile guint tail;
+  volatile gint  dead;
+  GLogRing      *next;
+};
+
+typedef struct
+{
+  guint32 length;
+  guint32 fd;
+} GLogRecord;
+
+#define LOG_ASYNC_DEFAULT_SIZE (64 * 1024)
+#define LOG_ASYNC_MAX_IOV      64
+#define LOG_RECORD_SIZE(len)   (sizeof (GLogRecord) + (((len) + 7) & ~7))
+
+static void log_ring_release (gpointer data);
+
+static volatile gint  log_async_enabled;
+static volatile gint  log_async_idle;
+static guint          log_async_reported;
+static guint          log_async_ring_size;
+static GLogRing      *log_async_rings;
+static GMutex         log_async_rings_lock;
+static GMutex         log_async_drain_lock;
+static GMutex         log_async_wake_lock;
+static GCond          log_async_wake_cond;
+static GPrivate       log_async_ring = G_PRIVATE_INIT (log_ring_release);
+
+static void
+log_ring_release (gpointer data)
+{
+  GLogRing *ring = data;
+
+  /* The flusher frees it once it is drained */
+  g_atomic_int_set (&ring->dead, TRUE);
+}
+
+static void
+log_writev_all (int           fd,
+                struct iovec *iov,
+                gint          n_iov)
+{
+  while (n_iov > 0)
+    {
+      gssize res;
+
+      res = writev (fd, iov, n_iov);
+      if (res < 0)
+        {
+          if (errno == EINTR)
+            continue;
+          return;
+        }
+
+      while (n_iov > 0 && (gsize) res >= iov->iov_len)
+        {
+          res -= iov->iov_len;
+          iov++;
+          n_iov--;
+        }
+
+      if (n_iov > 0)
+        {
+          iov->iov_base = (gchar *) iov->iov_base + res;
+          iov->iov_len -= res;
+        }
+    }
+}
+
+/* Writes out everything queued in @ring, batching consecutive records
+ * for the same descriptor into one writev().  Must hold
+ * log_async_drain_lock, and may not call any GLib function that logs.
+ */
+static void
+log_ring_drain_L (GLogRing *ring)
+{
+  struct iovec iov[LOG_ASYNC_MAX_IOV];
+  guint mask = ring->size - 1;
+  guint head, tail;
+  gint n_iov = 0;
+  int batch_fd = -1;
+
+  head = g_atomic_int_get (&ring->head);
+  tail = ring->tail;
+
+  while (tail != head)
+    {
+      GLogRecord *record;
+      guint start, first;
+
+      record = (GLogRecord *) (ring->data + (tail & mask));
+
+      if (n_iov > LOG_ASYNC_MAX_IOV - 2 || (n_iov > 0 && (int) record->fd != batch_fd))
+        {
+          log_writev_all (batch_fd, iov, n_iov);
+          g_atomic_int_set (&ring->tail, tail);
+          n_iov = 0;
+        }
+
+      batch_fd = record->fd;
+      start = (tail + sizeof (GLogRecord)) & mask;
+      first = MIN (record->length, ring->size - start);
+
+      iov[n_iov].iov_base = ring->data + start;
+      iov[n_iov].iov_len = first;
+      n_iov++;
+
+      if (first < record->length)
+        {
+          iov[n_iov].iov_base = ring->data;
+          iov[n_iov].iov_len = record->length - first;
+          n_iov++;
+        }
+
+      tail += LOG_RECORD_SIZE (record->length);
+    }
+
+  if (n_iov > 0)
+    log_writev_all (batch_fd, iov, n_iov);
+
+  g_atomic_int_set (&ring->tail, tail);
+}
+
+/* Drains all rings and frees those of exited threads.  Must hold
+ * log_async_drain_lock.
+ */
+static void
+log_async_drain_L (void)
+{
+  GLogRing *ring, *next;
+  guint dropped;
+
+  /* New rings are only ever added at the head and only we remove them,
+   * so the list can be walked without holding log_async_rings_lock.
+   */
+  g_mutex_lock (&log_async_rings_lock);
+  ring = log_async_rings;
+  g_mutex_unlock (&log_async_rings_lock);
+
+  for (; ring; ring = next)
+    {
+      next = ring->next;
+
+      log_ring_drain_L (ring);
+
+      if (g_atomic_int_get (&ring->dead) &&
+          g_atomic_int_get (&ring->head) == ring->tail)
+        {
+          GLogRing **link;
+
+          g_mutex_lock (&log_async_rings_lock);
+          for (link = &log_async_rings; *link != ring; link = &(*link)->next)
+            ;
+          *link = ring->next;
+          g_mutex_unlock (&log_async_rings_lock);
+
+          g_free (ring->data);
+          g_free (ring);
+        }
+    }
+
+  dropped = g_atomic_int_get (&log_async_dropped);
+  if (dropped != log_async_reported)
+    {
+      gchar count[FORMAT_UNSIGNED_BUFSIZE];
+
+      format_unsigned (count, dropped - log_async_reported, 10);
+      write_string (2, "GLib-WARNING **: ");
+      write_string (2, count);
+      write_string (2, " log messages were dropped\n");
+      log_async_reported = dropped;
+    }
+}
+
+static gboolean
+log_async_pending (void)
+{
+  GLogRing *ring;
+  gboolean pending = FALSE;
+
+  /* Unlike log_async_drain_L(), we may run concurrently with another
+   * thread that drains and frees dead rings, so hold the lock under
+   * which they are unlinked for the whole walk.
+   */
+  g_mutex_lock (&log_async_rings_lock);
+  for (ring = log_async_rings; ring && !pending; ring = ring->next)
+    pending = g_atomic_int_get (&ring->head) != g_atomic_int_get (&ring->tail);
+  g_mutex_unlock (&log_async_rings_lock);
+
+  return pending;
+}
+
+static gpointer
+log_async_flusher (gpointer data)
+{
+  while (TRUE)
+    {
+      g_mutex_lock (&log_async_drain_lock);
+      log_async_drain_L ();
+      g_mutex_unlock (&log_async_drain_lock);
+
+      /* Producers only take the lock to wake us when we say we are
+       * idle, and they publish their message before checking.
+       */
+      g_mutex_lock (&log_async_wake_lock);
+      g_atomic_int_set (&log_async_idle, TRUE);
+      if (!log_async_pending ())
+        g_cond_wait_until (&log_async_wake_cond, &log_async_wake_lock,
+                           g_get_monotonic_time () + G_USEC_PER_SEC);
+      g_atomic_int_set (&log_async_idle, FALSE);
+      g_mutex_unlock (&log_async_wake_lock);
+    }
+
+  return NULL;
+}
+
+static GLogRing *
+log_async_get_ring (void)
+{
+  GLogRing *ring;
+
+  ring = g_private_get (&log_async_ring);
+  if (ring)
+    return ring;
+
+  ring = g_new0 (GLogRing, 1);
+  ring->size = log_async_ring_size;
+  ring->data = g_malloc (ring->size);
+
+  g_mutex_lock (&log_async_rings_lock);
+  ring->next = log_async_rings;
+  log_async_rings = ring;
+  g_mutex_unlock (&log_async_rings_lock);
+
+  g_private_set (&log_async_ring, ring);
+
+  return ring;
+}
+
+/* Queues @string for the flusher thread.  Returns FALSE if it does
+ * not fit, in which case nothing was queued.
+ */
+static gboolean
+log_async_push (int          fd,
+                const gchar *string,
+                gsize        length)
+{
+  GLogRing *ring;
+  GLogRecord *record;
+  guint mask, head, start, first;
+
+  ring = log_async_get_ring ();
+  mask = ring->size - 1;
+
+  head = ring->head;
+  if (LOG_RECORD_SIZE (length) > ring->size - (head - g_atomic_int_get (&ring->tail)))
+    return FALSE;
+
+  record = (GLogRecord *) (ring->data + (head & mask));
+  record->length = length;
+  record->fd = fd;
+
+  start = (head + sizeof (GLogRecord)) & mask;
+  first = MIN (length, ring->size - start);
+  memcpy (ring->data + start, string, first);
+  memcpy (ring->data, string + first, length - first);
+
+  g_atomic_int_set (&ring->head, head + LOG_RECORD_SIZE (length));
+
+  if (g_atomic_int_get (&log_async_idle))
+    {
+      g_mutex_lock (&log_async_wake_lock);
+      g_cond_signal (&log_async_wake_cond);
+      g_mutex_unlock (&log_async_wake_lock);
+    }
+
+  return TRUE;
+}
+#endif /* G_OS_UNIX */
+
+/**
+ * g_log_async_enable:
+ * @buffer_size: the number of bytes each thread may queue, or 0 for
+ *     the default of 64 kilobytes
+ *
+ * Makes g_log_default_handler() write messages from a background
+ * thread instead of blocking the thread that logs them.
+ *
+ * Each thread queues its messages in a buffer of its own, without
+ * taking any lock, and the background thread writes them out in
+ * batches.  Messages from one thread stay in order; messages from
+ * different threads may be interleaved differently than they were
+ * logged.
+ *
+ * When a thread's buffer is full, debug, informational and other
+ * messages below %G_LOG_LEVEL_WARNING are dropped, and a note with the
+ * number of dropped messages is written to stderr later; see
+ * g_log_async_get_dropped().  Warnings, criticals and errors are never
+ * dropped; they are written synchronously instead.  Fatal messages
+ * are always written synchronously, after all queued messages, so
+ * nothing is lost when the program aborts.  Queued messages are also
+ * written when the program exits normally.
+ *
+ * Asynchronous output cannot be disabled again, and later calls to
+ * this function have no effect.  Child processes created by fork()
+ * without exec() should not use the default handler, since they have
+ * no background thread.  This function has no effect on Windows.
+ *
+ * Since: 2.44
+ */
+void
+g_log_async_enable (gsize buffer_size)
+{
+#ifdef G_OS_UNIX
+  static gsize initialised;
+
+  if (g_once_init_enter (&initialised))
+    {
+      GThread *thread;
+      guint size;
+
+      if (buffer_size == 0)
+        buffer_size = LOG_ASYNC_DEFAULT_SIZE;
+      buffer_size = CLAMP (buffer_size, 256, G_MAXINT / 2);
+      for (size = 256; size < buffer_size; size *= 2)
+        ;
+      log_async_ring_size = size;
+
+      thread = g_thread_try_new ("gmessages", log_async_flusher, NULL, NULL);
+      if (thread)
+        {
+          g_thread_unref (thread);
+          atexit (g_log_async_flush);
+          g_atomic_int_set (&log_async_enabled, TRUE);
+        }
+
+      g_once_init_leave (&initialised, 1);
+    }
+#endif
+}
+
+/**
+ * g_log_async_flush:
+ *
+ * Writes out all messages that were queued by the default log handler
+ * before this call and waits until they have been written.  Does
+ * nothing unless g_log_async_enable() was called.
+ *
+ * Since: 2.44
+ */
+void
+g_log_async_flush (void)
+{
+#ifdef G_OS_UNIX
+  if (!g_atomic_int_get (&log_async_enabled))
+    return;
+
+  g_mutex_lock (&log_async_drain_lock);
+  log_async_drain_L ();
+  g_mutex_unlock (&log_async_drain_lock);
+#endif
+}
+
+/**
+ * g_log_async_get_dropped:
+ *
+ * Gets the number of messages the default log handler dropped because
+ * a thread's buffer was full.  See g_log_async_enable().
+ *
+ * Returns: the number of dropped messages since the program started
+ *
+ * Since: 2.44
+ */
+guint
+g_log_async_get_dropped (void)
+{
+  return g_atomic_int_get (&log_async_dropped);
+}
+
+/* Writes a message formatted by the default handler */
+static void
+log_write (int             fd,
+           const gchar    *string,
+           GLogLevelFlags  log_level)
+{
+#ifdef G_OS_UNIX
+  if (g_atomic_int_get (&log_async_enabled))
+    {
+      gsize length = strlen (string);
+
+      if (!(log_level & G_LOG_FLAG_FATAL) && length <= log_async_ring_size / 2)
+        {
+          if (log_async_push (fd, string, length))
+            return;
+
+          /* The buffer is full */
+          if (!(log_level & ALERT_LEVELS))
+            {
+              g_atomic_int_inc (&log_async_dropped);
+              return;
+            }
+        }
+
+      /* Keep it after anything this thread queued before */
+      g_log_async_flush ();
+    }
+#endif
+
+  write_string (fd, string);
+}
+
 typedef struct {
   gchar          *log_domain;
   GLogLevelFlags  log_level;
@@ -1028,6 +1460,7 @@ g_logv (const gchar   *log_domain,
 
           if ((test_level & G_LOG_FLAG_FATAL) && !masquerade_fatal)
             {
+              g_log_async_flush ();
 #ifdef G_OS_WIN32
               if (win32_keep_fatal_message)
                 {
@@ -1449,7 +1882,7 @@ g_log_default_handler (const gchar   *log_domain,
 
   string = g_string_free (gstring, FALSE);
 
-  write_string (fd, string);
+  log_write (fd, string, log_level);
   g_free (string);
 }
 
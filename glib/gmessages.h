@@ -113,6 +113,13 @@ GLogLevelFlags  g_log_set_fatal_mask    (const gchar    *log_domain,
 GLIB_AVAILABLE_IN_ALL
 GLogLevelFlags  g_log_set_always_fatal  (GLogLevelFlags  fatal_mask);
 
+GLIB_AVAILABLE_IN_2_44
+void            g_log_async_enable      (gsize           buffer_size);
+GLIB_AVAILABLE_IN_2_44
+void            g_log_async_flush       (void);
+GLIB_AVAILABLE_IN_2_44
+guint           g_log_async_get_dropped (void);
+
 /* internal */
 void	_g_log_fallback_handler	(const gchar   *log_domain,
 						 GLogLevelFlags log_level,
@@ -49,6 +49,7 @@
 #include "gmem.h"
 #include "gtestutils.h"
 #include "gthread.h"
+#include "glib-private.h"
 
 #ifdef G_OS_UNIX
 #include <unistd.h>
@@ -76,14 +77,18 @@
  * purposes, it is recommended to use platform-specific APIs such
  * as `/dev/random` on UNIX, or CryptGenRandom() on Windows.
  *
- * GRand uses the Mersenne Twister PRNG, which was originally
+ * By default, GRand uses the Mersenne Twister PRNG, which was originally
  * developed by Makoto Matsumoto and Takuji Nishimura. Further
  * information can be found at
  * [this page](http://www.math.sci.hiroshima-u.ac.jp/~m-mat/MT/emt.html).
+ * Generators created with g_rand_new_full() can instead use
+ * xoshiro256** or PCG64, which have much smaller state, produce a
+ * #gdouble from a single draw and support g_rand_jump() for creating
+ * independent streams, e.g. one per thread.
  *
  * If you just need a random number, you simply call the g_random_*
- * functions, which will create a globally used #GRand and use the
- * according g_rand_* functions internally. Whenever you need a
+ * functions, which will use a #GRand private to the calling thread
+ * and the according g_rand_* functions internally. Whenever you need a
  * stream of reproducible random numbers, you better create a
  * #GRand yourself and use the g_rand_* functions directly, which
  * will also be slightly faster. Initializing a #GRand with a
@@ -117,8 +122,6 @@
  * accessed through the g_rand_* functions.
  **/
 
-G_LOCK_DEFINE_STATIC (global_random);
-
 /* Period parameters */  
 #define N 624
 #define M 397
@@ -162,10 +165,223 @@ get_random_version (void)
 
 struct _GRand
 {
-  guint32 mt[N]; /* the array for the state vector  */
-  guint mti; 
+  GRandAlgorithm algorithm;
+  guint64 s[4];  /* xoshiro256** state, or PCG64 state (s[0] high, s[1] low)
+                  * and increment (s[2] high, s[3] low) */
+  guint mti;
+  guint32 mt[N]; /* the array for the state vector, only allocated for
+                  * G_RAND_ALGORITHM_MT19937 */
 };
 
+static gsize
+rand_size (GRandAlgorithm algorithm)
+{
+  if (algorithm == G_RAND_ALGORITHM_MT19937)
+    return sizeof (GRand);
+
+  return G_STRUCT_OFFSET (GRand, mt);
+}
+
+static GRand *
+rand_alloc (GRandAlgorithm algorithm)
+{
+  GRand *rand = g_malloc0 (rand_size (algorithm));
+  rand->algorithm = algorithm;
+  return rand;
+}
+
+/* 64-bit engines */
+
+static inline guint64
+rotl64 (guint64 x,
+        gint    k)
+{
+  return (x << k) | (x >> (64 - k));
+}
+
+static inline guint64
+rotr64 (guint64 x,
+        guint   k)
+{
+  return (x >> k) | (x << ((- k) & 63));
+}
+
+/* Used to expand a seed into the state of the 64-bit engines */
+static inline guint64
+splitmix64_next (guint64 *x)
+{
+  guint64 z = (*x += G_GUINT64_CONSTANT (0x9e3779b97f4a7c15));
+  z = (z ^ (z >> 30)) * G_GUINT64_CONSTANT (0xbf58476d1ce4e5b9);
+  z = (z ^ (z >> 27)) * G_GUINT64_CONSTANT (0x94d049bb133111eb);
+  return z ^ (z >> 31);
+}
+
+static inline guint64
+xoshiro256ss_next (guint64 *s)
+{
+  guint64 result = rotl64 (s[1] * 5, 7) * 9;
+  guint64 t = s[1] << 17;
+
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+  s[2] ^= t;
+  s[3] = rotl64 (s[3], 45);
+
+  return result;
+}
+
+static void
+xoshiro256ss_jump (guint64 *s)
+{
+  static const guint64 jump[] = {
+    G_GUINT64_CONSTANT (0x180ec6d33cfd0aba), G_GUINT64_CONSTANT (0xd5a61266f0c9392c),
+    G_GUINT64_CONSTANT (0xa9582618e03fc9aa), G_GUINT64_CONSTANT (0x39abdc4529b1661c)
+  };
+  guint64 t[4] = { 0, 0, 0, 0 };
+  gint i, b;
+
+  for (i = 0; i < G_N_ELEMENTS (jump); i++)
+    for (b = 0; b < 64; b++)
+      {
+        if (jump[i] & (G_GUINT64_CONSTANT (1) << b))
+          {
+            t[0] ^= s[0];
+            t[1] ^= s[1];
+            t[2] ^= s[2];
+            t[3] ^= s[3];
+          }
+        xoshiro256ss_next (s);
+      }
+
+  memcpy (s, t, sizeof t);
+}
+
+/* PCG64 (XSL RR 128/64) with 128-bit values as (high, low) pairs */
+#define PCG64_MULT_HIGH G_GUINT64_CONSTANT (0x2360ed051fc65da4)
+#define PCG64_MULT_LOW  G_GUINT64_CONSTANT (0x4385df649fccf645)
+
+static inline guint64
+mul_high64 (guint64 a,
+            guint64 b)
+{
+#ifdef __SIZEOF_INT128__
+  return ((unsigned __int128) a * b) >> 64;
+#else
+  guint64 a_lo = a & 0xffffffff, a_hi = a >> 32;
+  guint64 b_lo = b & 0xffffffff, b_hi = b >> 32;
+  guint64 lo_lo = a_lo * b_lo;
+  guint64 hi_lo = a_hi * b_lo;
+  guint64 lo_hi = a_lo * b_hi;
+  guint64 cross = (lo_lo >> 32) + (hi_lo & 0xffffffff) + lo_hi;
+
+  return a_hi * b_hi + (hi_lo >> 32) + (cross >> 32);
+#endif
+}
+
+/* (*high, *low) = (*high, *low) * (m_high, m_low) + (a_high, a_low) */
+static inline void
+mul_add128 (guint64 *high,
+            guint64 *low,
+            guint64  m_high,
+            guint64  m_low,
+            guint64  a_high,
+            guint64  a_low)
+{
+  guint64 h = mul_high64 (*low, m_low) + *high * m_low + *low * m_high;
+  guint64 l = *low * m_low;
+
+  *low = l + a_low;
+  *high = h + a_high + (*low < l);
+}
+
+static inline guint64
+pcg64_next (guint64 *s)
+{
+  mul_add128 (&s[0], &s[1], PCG64_MULT_HIGH, PCG64_MULT_LOW, s[2], s[3]);
+
+  return rotr64 (s[0] ^ s[1], s[0] >> 58);
+}
+
+/* Advances the generator by 2^64 steps, using the usual O(log n) LCG
+ * jump: the step is squared 64 times and then applied once.
+ */
+static void
+pcg64_jump (guint64 *s)
+{
+  guint64 mult_high = PCG64_MULT_HIGH, mult_low = PCG64_MULT_LOW;
+  guint64 plus_high = s[2], plus_low = s[3];
+  gint i;
+
+  for (i = 0; i < 64; i++)
+    {
+      guint64 m_high = mult_high, m_low = mult_low;
+
+      /* plus = (mult + 1) * plus; mult = mult * mult */
+      m_low += 1;
+      m_high += (m_low == 0);
+      mul_add128 (&plus_high, &plus_low, m_high, m_low, 0, 0);
+      mul_add128 (&mult_high, &mult_low, mult_high, mult_low, 0, 0);
+    }
+
+  mul_add128 (&s[0], &s[1], mult_high, mult_low, plus_high, plus_low);
+}
+
+static void
+rand_seed64 (GRand         *rand,
+             const guint32 *seed,
+             guint          seed_length)
+{
+  guint64 x = seed_length;
+  guint i;
+
+  for (i = 0; i < seed_length; i++)
+    {
+      x ^= seed[i];
+      x = splitmix64_next (&x);
+    }
+
+  for (i = 0; i < 4; i++)
+    rand->s[i] = splitmix64_next (&x);
+
+  switch (rand->algorithm)
+    {
+    case G_RAND_ALGORITHM_XOSHIRO256SS:
+      /* The all-zero state is the one state xoshiro can't leave */
+      if ((rand->s[0] | rand->s[1] | rand->s[2] | rand->s[3]) == 0)
+        rand->s[0] = 1;
+      break;
+
+    case G_RAND_ALGORITHM_PCG64:
+      {
+        guint64 state_high = rand->s[0], state_low = rand->s[1];
+
+        /* Standard PCG initialisation: odd increment, then step,
+         * add the seed and step again. */
+        rand->s[3] |= 1;
+        rand->s[0] = rand->s[1] = 0;
+        pcg64_next (rand->s);
+        rand->s[1] += state_low;
+        rand->s[0] += state_high + (rand->s[1] < state_low);
+        pcg64_next (rand->s);
+      }
+      break;
+
+    default:
+      g_assert_not_reached ();
+    }
+}
+
+static inline guint64
+rand_next64 (GRand *rand)
+{
+  if (rand->algorithm == G_RAND_ALGORITHM_XOSHIRO256SS)
+    return xoshiro256ss_next (rand->s);
+  else
+    return pcg64_next (rand->s);
+}
+
 /**
  * g_rand_new_with_seed:
  * @seed: a value to initialize the random number generator
@@ -177,7 +393,7 @@ struct _GRand
 GRand*
 g_rand_new_with_seed (guint32 seed)
 {
-  GRand *rand = g_new0 (GRand, 1);
+  GRand *rand = rand_alloc (G_RAND_ALGORITHM_MT19937);
   g_rand_set_seed (rand, seed);
   return rand;
 }
@@ -198,26 +414,15 @@ GRand*
 g_rand_new_with_seed_array (const guint32 *seed,
                             guint          seed_length)
 {
-  GRand *rand = g_new0 (GRand, 1);
+  GRand *rand = rand_alloc (G_RAND_ALGORITHM_MT19937);
   g_rand_set_seed_array (rand, seed, seed_length);
   return rand;
 }
 
-/**
- * g_rand_new:
- * 
- * Creates a new random number generator initialized with a seed taken
- * either from `/dev/urandom` (if existing) or from the current time
- * (as a fallback).
- *
- * On Windows, the seed is taken from rand_s().
- * 
- * Returns: the new #GRand
- */
-GRand* 
-g_rand_new (void)
+/* Also used by the tests through the private vtable */
+void
+g_get_random_seed (guint32 seed[4])
 {
-  guint32 seed[4];
 #ifdef G_OS_UNIX
   static gboolean dev_urandom_exists = TRUE;
   GTimeVal now;
@@ -240,7 +445,7 @@ g_rand_new (void)
 	  do
 	    {
 	      errno = 0;
-	      r = fread (seed, sizeof (seed), 1, dev_urandom);
+	      r = fread (seed, 4 * sizeof (guint32), 1, dev_urandom);
 	    }
 	  while G_UNLIKELY (errno == EINTR);
 
@@ -266,7 +471,7 @@ g_rand_new (void)
 #if defined(_MSC_VER) && _MSC_VER >= 1400
   gint i;
 
-  for (i = 0; i < G_N_ELEMENTS (seed); i++)
+  for (i = 0; i < 4; i++)
     rand_s (&seed[i]);
 #else
 #warning Using insecure seed for random number generation because of missing rand_s() in Windows XP
@@ -280,10 +485,88 @@ g_rand_new (void)
 #endif
 
 #endif
+}
+
+/**
+ * g_rand_new:
+ * 
+ * Creates a new random number generator initialized with a seed taken
+ * either from `/dev/urandom` (if existing) or from the current time
+ * (as a fallback).
+ *
+ * On Windows, the seed is taken from rand_s().
+ * 
+ * Returns: the new #GRand
+ */
+GRand* 
+g_rand_new (void)
+{
+  guint32 seed[4];
+
+  g_get_random_seed (seed);
 
   return g_rand_new_with_seed_array (seed, 4);
 }
 
+/**
+ * g_rand_new_full:
+ * @algorithm: the #GRandAlgorithm to use
+ * @seed: (allow-none) (array length=seed_length): an array of seeds to
+ *     initialize the random number generator, or %NULL
+ * @seed_length: the length of @seed
+ *
+ * Creates a new random number generator using @algorithm.
+ *
+ * If @seed is %NULL, the generator is seeded like g_rand_new() does.
+ * Otherwise the same @seed always produces the same sequence for a
+ * given @algorithm.
+ *
+ * Returns: the new #GRand
+ *
+ * Since: 2.44
+ */
+GRand *
+g_rand_new_full (GRandAlgorithm  algorithm,
+                 const guint32  *seed,
+                 guint           seed_length)
+{
+  guint32 random_seed[4];
+  GRand *rand;
+
+  g_return_val_if_fail (algorithm <= G_RAND_ALGORITHM_PCG64, NULL);
+  g_return_val_if_fail (seed == NULL || seed_length >= 1, NULL);
+
+  if (seed == NULL)
+    {
+      g_get_random_seed (random_seed);
+      seed = random_seed;
+      seed_length = G_N_ELEMENTS (random_seed);
+    }
+
+  rand = rand_alloc (algorithm);
+  g_rand_set_seed_array (rand, seed, seed_length);
+
+  return rand;
+}
+
+/**
+ * g_rand_get_algorithm:
+ * @rand_: a #GRand
+ *
+ * Gets the algorithm used by @rand_.
+ *
+ * Returns: the #GRandAlgorithm of @rand_
+ *
+ * Since: 2.44
+ */
+GRandAlgorithm
+g_rand_get_algorithm (GRand *rand)
+{
+  g_return_val_if_fail (rand != NULL, G_RAND_ALGORITHM_MT19937);
+
+  return rand->algorithm;
+}
+
 /**
  * g_rand_free:
  * @rand_: a #GRand
@@ -317,8 +600,8 @@ g_rand_copy (GRand *rand)
 
   g_return_val_if_fail (rand != NULL, NULL);
 
-  new_rand = g_new0 (GRand, 1);
-  memcpy (new_rand, rand, sizeof (GRand));
+  new_rand = g_malloc (rand_size (rand->algorithm));
+  memcpy (new_rand, rand, rand_size (rand->algorithm));
 
   return new_rand;
 }
@@ -336,6 +619,12 @@ g_rand_set_seed (GRand   *rand,
 {
   g_return_if_fail (rand != NULL);
 
+  if (rand->algorithm != G_RAND_ALGORITHM_MT19937)
+    {
+      rand_seed64 (rand, &seed, 1);
+      return;
+    }
+
   switch (get_random_version ())
     {
     case 20:
@@ -391,6 +680,12 @@ g_rand_set_seed_array (GRand         *rand,
   g_return_if_fail (rand != NULL);
   g_return_if_fail (seed_length >= 1);
 
+  if (rand->algorithm != G_RAND_ALGORITHM_MT19937)
+    {
+      rand_seed64 (rand, seed, seed_length);
+      return;
+    }
+
   g_rand_set_seed (rand, 19650218UL);
 
   i=1; j=0;
@@ -427,6 +722,40 @@ g_rand_set_seed_array (GRand         *rand,
   rand->mt[0] = 0x80000000UL; /* MSB is 1; assuring non-zero initial array */ 
 }
 
+static void
+mt_generate (GRand *rand)
+{
+  guint32 y;
+  static const guint32 mag01[2]={0x0, MATRIX_A};
+  /* mag01[x] = x * MATRIX_A  for x=0,1 */
+  int kk;
+
+  /* generate N words at one time */
+  for (kk = 0; kk < N - M; kk++) {
+    y = (rand->mt[kk]&UPPER_MASK)|(rand->mt[kk+1]&LOWER_MASK);
+    rand->mt[kk] = rand->mt[kk+M] ^ (y >> 1) ^ mag01[y & 0x1];
+  }
+  for (; kk < N - 1; kk++) {
+    y = (rand->mt[kk]&UPPER_MASK)|(rand->mt[kk+1]&LOWER_MASK);
+    rand->mt[kk] = rand->mt[kk+(M-N)] ^ (y >> 1) ^ mag01[y & 0x1];
+  }
+  y = (rand->mt[N-1]&UPPER_MASK)|(rand->mt[0]&LOWER_MASK);
+  rand->mt[N-1] = rand->mt[M-1] ^ (y >> 1) ^ mag01[y & 0x1];
+
+  rand->mti = 0;
+}
+
+static inline guint32
+mt_temper (guint32 y)
+{
+  y ^= TEMPERING_SHIFT_U(y);
+  y ^= TEMPERING_SHIFT_S(y) & TEMPERING_MASK_B;
+  y ^= TEMPERING_SHIFT_T(y) & TEMPERING_MASK_C;
+  y ^= TEMPERING_SHIFT_L(y);
+
+  return y;
+}
+
 /**
  * g_rand_boolean:
  * @rand_: a #GRand
@@ -448,41 +777,23 @@ g_rand_set_seed_array (GRand         *rand,
 guint32
 g_rand_int (GRand *rand)
 {
-  guint32 y;
-  static const guint32 mag01[2]={0x0, MATRIX_A};
-  /* mag01[x] = x * MATRIX_A  for x=0,1 */
-
   g_return_val_if_fail (rand != NULL, 0);
 
-  if (rand->mti >= N) { /* generate N words at one time */
-    int kk;
-    
-    for (kk = 0; kk < N - M; kk++) {
-      y = (rand->mt[kk]&UPPER_MASK)|(rand->mt[kk+1]&LOWER_MASK);
-      rand->mt[kk] = rand->mt[kk+M] ^ (y >> 1) ^ mag01[y & 0x1];
-    }
-    for (; kk < N - 1; kk++) {
-      y = (rand->mt[kk]&UPPER_MASK)|(rand->mt[kk+1]&LOWER_MASK);
-      rand->mt[kk] = rand->mt[kk+(M-N)] ^ (y >> 1) ^ mag01[y & 0x1];
-    }
-    y = (rand->mt[N-1]&UPPER_MASK)|(rand->mt[0]&LOWER_MASK);
-    rand->mt[N-1] = rand->mt[M-1] ^ (y >> 1) ^ mag01[y & 0x1];
-    
-    rand->mti = 0;
-  }
-  
-  y = rand->mt[rand->mti++];
-  y ^= TEMPERING_SHIFT_U(y);
-  y ^= TEMPERING_SHIFT_S(y) & TEMPERING_MASK_B;
-  y ^= TEMPERING_SHIFT_T(y) & TEMPERING_MASK_C;
-  y ^= TEMPERING_SHIFT_L(y);
-  
-  return y; 
+  if (rand->algorithm != G_RAND_ALGORITHM_MT19937)
+    return rand_next64 (rand) >> 32;
+
+  if (rand->mti >= N)
+    mt_generate (rand);
+
+  return mt_temper (rand->mt[rand->mti++]);
 }
 
 /* transform [0..2^32] -> [0..1] */
 #define G_RAND_DOUBLE_TRANSFORM 2.3283064365386962890625e-10
 
+/* transform [0..2^53] -> [0..1] */
+#define G_RAND_DOUBLE_TRANSFORM_53 1.1102230246251565404236316680908203125e-16
+
 /**
  * g_rand_int_range:
  * @rand_: a #GRand
@@ -580,9 +891,17 @@ g_rand_int_range (GRand  *rand,
 gdouble 
 g_rand_double (GRand *rand)
 {    
+  gdouble retval;
+
+  g_return_val_if_fail (rand != NULL, 0.0);
+
+  /* The 64-bit engines fill the mantissa from a single draw */
+  if (rand->algorithm != G_RAND_ALGORITHM_MT19937)
+    return (rand_next64 (rand) >> 11) * G_RAND_DOUBLE_TRANSFORM_53;
+
   /* We set all 52 bits after the point for this, not only the first
      32. Thats why we need two calls to g_rand_int */
-  gdouble retval = g_rand_int (rand) * G_RAND_DOUBLE_TRANSFORM;
+  retval = g_rand_int (rand) * G_RAND_DOUBLE_TRANSFORM;
   retval = (retval + g_rand_int (rand)) * G_RAND_DOUBLE_TRANSFORM;
 
   /* The following might happen due to very bad rounding luck, but
@@ -616,16 +935,177 @@ g_rand_double_range (GRand   *rand,
   return r * end - (r - 1) * begin;
 }
 
+/**
+ * g_rand_fill_int:
+ * @rand_: a #GRand
+ * @values: (array length=n_values) (out caller-allocates): the array
+ *     to fill
+ * @n_values: the number of values to generate
+ *
+ * Fills @values with random #guint32 values equally distributed over
+ * the range [0..2^32-1].
+ *
+ * The values are the same as @n_values calls to g_rand_int() would
+ * return, but are generated in a tight loop without per-value
+ * function call overhead.
+ *
+ * Since: 2.44
+ */
+void
+g_rand_fill_int (GRand   *rand,
+                 guint32 *values,
+                 gsize    n_values)
+{
+  gsize i;
+
+  g_return_if_fail (rand != NULL);
+  g_return_if_fail (values != NULL || n_values == 0);
+
+  switch (rand->algorithm)
+    {
+    case G_RAND_ALGORITHM_MT19937:
+      i = 0;
+      while (i < n_values)
+        {
+          gsize n, j;
+
+          if (rand->mti >= N)
+            mt_generate (rand);
+
+          n = MIN (n_values - i, N - rand->mti);
+          for (j = 0; j < n; j++)
+            values[i + j] = mt_temper (rand->mt[rand->mti + j]);
+
+          rand->mti += n;
+          i += n;
+        }
+      break;
+
+    case G_RAND_ALGORITHM_XOSHIRO256SS:
+      {
+        guint64 s[4];
+
+        memcpy (s, rand->s, sizeof s);
+        for (i = 0; i < n_values; i++)
+          values[i] = xoshiro256ss_next (s) >> 32;
+        memcpy (rand->s, s, sizeof s);
+      }
+      break;
+
+    case G_RAND_ALGORITHM_PCG64:
+      {
+        guint64 s[4];
+
+        memcpy (s, rand->s, sizeof s);
+        for (i = 0; i < n_values; i++)
+          values[i] = pcg64_next (s) >> 32;
+        memcpy (rand->s, s, sizeof s);
+      }
+      break;
+    }
+}
+
+/**
+ * g_rand_fill_double:
+ * @rand_: a #GRand
+ * @values: (array length=n_values) (out caller-allocates): the array
+ *     to fill
+ * @n_values: the number of values to generate
+ *
+ * Fills @values with random #gdouble values equally distributed over
+ * the range [0..1).
+ *
+ * The values are the same as @n_values calls to g_rand_double() would
+ * return, but are generated in a tight loop without per-value
+ * function call overhead.
+ *
+ * Since: 2.44
+ */
+void
+g_rand_fill_double (GRand   *rand,
+                    gdouble *values,
+                    gsize    n_values)
+{
+  gsize i;
+
+  g_return_if_fail (rand != NULL);
+  g_return_if_fail (values != NULL || n_values == 0);
+
+  switch (rand->algorithm)
+    {
+    case G_RAND_ALGORITHM_MT19937:
+      for (i = 0; i < n_values; i++)
+        values[i] = g_rand_double (rand);
+      break;
+
+    case G_RAND_ALGORITHM_XOSHIRO256SS:
+      {
+        guint64 s[4];
+
+        memcpy (s, rand->s, sizeof s);
+        for (i = 0; i < n_values; i++)
+          values[i] = (xoshiro256ss_next (s) >> 11) * G_RAND_DOUBLE_TRANSFORM_53;
+        memcpy (rand->s, s, sizeof s);
+      }
+      break;
+
+    case G_RAND_ALGORITHM_PCG64:
+      {
+        guint64 s[4];
+
+        memcpy (s, rand->s, sizeof s);
+        for (i = 0; i < n_values; i++)
+          values[i] = (pcg64_next (s) >> 11) * G_RAND_DOUBLE_TRANSFORM_53;
+        memcpy (rand->s, s, sizeof s);
+      }
+      break;
+    }
+}
+
+/**
+ * g_rand_jump:
+ * @rand_: a #GRand using %G_RAND_ALGORITHM_XOSHIRO256SS or
+ *     %G_RAND_ALGORITHM_PCG64
+ *
+ * Advances @rand_ as if a very large number of values had been drawn
+ * from it: 2^128 for xoshiro256** and 2^64 for PCG64.
+ *
+ * This is used to create non-overlapping streams from a single seed.
+ * For example, to give each of several threads its own generator, seed
+ * one #GRand, then repeatedly g_rand_copy() it and call g_rand_jump()
+ * on the original.
+ *
+ * The Mersenne Twister does not support jumping ahead.
+ *
+ * Since: 2.44
+ */
+void
+g_rand_jump (GRand *rand)
+{
+  g_return_if_fail (rand != NULL);
+  g_return_if_fail (rand->algorithm != G_RAND_ALGORITHM_MT19937);
+
+  if (rand->algorithm == G_RAND_ALGORITHM_XOSHIRO256SS)
+    xoshiro256ss_jump (rand->s);
+  else
+    pcg64_jump (rand->s);
+}
+
+/* Each thread gets its own generator, so g_random_* never contend */
+static GPrivate thread_random = G_PRIVATE_INIT ((GDestroyNotify) g_rand_free);
+
 static GRand *
-get_global_random (void)
+get_thread_random (void)
 {
-  static GRand *global_random;
+  GRand *rand = g_private_get (&thread_random);
 
-  /* called while locked */
-  if (!global_random)
-    global_random = g_rand_new ();
+  if G_UNLIKELY (rand == NULL)
+    {
+      rand = g_rand_new ();
+      g_private_set (&thread_random, rand);
+    }
 
-  return global_random;
+  return rand;
 }
 
 /**
@@ -647,11 +1127,7 @@ get_global_random (void)
 guint32
 g_random_int (void)
 {
-  guint32 result;
-  G_LOCK (global_random);
-  result = g_rand_int (get_global_random ());
-  G_UNLOCK (global_random);
-  return result;
+  return g_rand_int (get_thread_random ());
 }
 
 /**
@@ -668,11 +1144,7 @@ gint32
 g_random_int_range (gint32 begin,
                     gint32 end)
 {
-  gint32 result;
-  G_LOCK (global_random);
-  result = g_rand_int_range (get_global_random (), begin, end);
-  G_UNLOCK (global_random);
-  return result;
+  return g_rand_int_range (get_thread_random (), begin, end);
 }
 
 /**
@@ -685,11 +1157,7 @@ g_random_int_range (gint32 begin,
 gdouble 
 g_random_double (void)
 {
-  double result;
-  G_LOCK (global_random);
-  result = g_rand_double (get_global_random ());
-  G_UNLOCK (global_random);
-  return result;
+  return g_rand_double (get_thread_random ());
 }
 
 /**
@@ -706,24 +1174,22 @@ gdouble
 g_random_double_range (gdouble begin,
                        gdouble end)
 {
-  double result;
-  G_LOCK (global_random);
-  result = g_rand_double_range (get_global_random (), begin, end);
-  G_UNLOCK (global_random);
-  return result;
+  return g_rand_double_range (get_thread_random (), begin, end);
 }
 
 /**
  * g_random_set_seed:
- * @seed: a value to reinitialize the global random number generator
+ * @seed: a value to reinitialize the random number generator of the
+ *     calling thread
  * 
- * Sets the seed for the global random number generator, which is used
- * by the g_random_* functions, to @seed.
+ * Sets the seed for the random number generator used by the g_random_*
+ * functions, to @seed.
+ *
+ * Since 2.44, every thread has its own generator, and this only
+ * reseeds the one of the calling thread.
  */
 void
 g_random_set_seed (guint32 seed)
 {
-  G_LOCK (global_random);
-  g_rand_set_seed (get_global_random (), seed);
-  G_UNLOCK (global_random);
+  g_rand_set_seed (get_thread_random (), seed);
 }
@@ -35,6 +35,26 @@ G_BEGIN_DECLS
 
 typedef struct _GRand           GRand;
 
+/**
+ * GRandAlgorithm:
+ * @G_RAND_ALGORITHM_MT19937: the Mersenne Twister, as used by
+ *     g_rand_new() and the g_random_* functions
+ * @G_RAND_ALGORITHM_XOSHIRO256SS: xoshiro256**, a fast generator with
+ *     256 bits of state
+ * @G_RAND_ALGORITHM_PCG64: PCG64 (XSL RR 128/64), a permuted 128-bit
+ *     linear congruential generator
+ *
+ * The algorithms available to g_rand_new_full().
+ *
+ * Since: 2.44
+ */
+typedef enum
+{
+  G_RAND_ALGORITHM_MT19937,
+  G_RAND_ALGORITHM_XOSHIRO256SS,
+  G_RAND_ALGORITHM_PCG64
+} GRandAlgorithm;
+
 /* GRand - a good and fast random number generator: Mersenne Twister
  * see http://www.math.sci.hiroshima-u.ac.jp/~m-mat/MT/emt.html for more info.
  * The range functions return a value in the intervall [begin, end).
@@ -51,6 +71,12 @@ GRand*  g_rand_new_with_seed_array (const guint32 *seed,
 				    guint seed_length);
 GLIB_AVAILABLE_IN_ALL
 GRand*  g_rand_new            (void);
+GLIB_AVAILABLE_IN_2_44
+GRand*  g_rand_new_full       (GRandAlgorithm  algorithm,
+                               const guint32  *seed,
+                               guint           seed_length);
+GLIB_AVAILABLE_IN_2_44
+GRandAlgorithm g_rand_get_algorithm (GRand *rand_);
 GLIB_AVAILABLE_IN_ALL
 void    g_rand_free           (GRand   *rand_);
 GLIB_AVAILABLE_IN_ALL
@@ -77,6 +103,16 @@ GLIB_AVAILABLE_IN_ALL
 gdouble g_rand_double_range   (GRand   *rand_,
 			       gdouble  begin,
 			       gdouble  end);
+GLIB_AVAILABLE_IN_2_44
+void    g_rand_fill_int       (GRand   *rand_,
+                               guint32 *values,
+                               gsize    n_values);
+GLIB_AVAILABLE_IN_2_44
+void    g_rand_fill_double    (GRand   *rand_,
+                               gdouble *values,
+                               gsize    n_values);
+GLIB_AVAILABLE_IN_2_44
+void    g_rand_jump           (GRand   *rand_);
 GLIB_AVAILABLE_IN_ALL
 void    g_random_set_seed     (guint32  seed);
 
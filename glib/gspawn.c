@@ -41,6 +41,17 @@
 #include <sys/resource.h>
 #endif /* HAVE_SYS_RESOURCE_H */
 
+/* Only use posix_spawn() if it tells us when the exec fails */
+#if defined (HAVE_SPAWN_H) && defined (HAVE_POSIX_SPAWN) && \
+    defined (HAVE_POSIX_SPAWN_EXEC_ERRORS)
+#include <spawn.h>
+#define POSIX_SPAWN_AVAILABLE
+#endif
+
+#ifdef HAVE_CRT_EXTERNS_H
+#include <crt_externs.h> /* for _NSGetEnviron */
+#endif
+
 #include "gspawn.h"
 #include "gthread.h"
 #include "glib/gstdio.h"
@@ -55,6 +66,17 @@
 #include "glibintl.h"
 #include "glib-unix.h"
 
+#ifdef POSIX_SPAWN_AVAILABLE
+#ifdef HAVE__NSGETENVIRON
+#define environ (*_NSGetEnviron())
+#else
+/* According to the Single Unix Specification, environ is not
+ * in any system header, although unistd.h often declares it.
+ */
+extern char **environ;
+#endif
+#endif
+
 /**
  * SECTION:spawn
  * @Short_description: process launching
@@ -587,6 +609,15 @@ g_spawn_sync (const gchar          *working_directory,
  * CreateProcess(). There is no sensible thing @child_setup
  * could be used for on Windows so it is ignored and not called.
  *
+ * On POSIX platforms, if @child_setup and @working_directory are %NULL,
+ * %G_SPAWN_DO_NOT_REAP_CHILD is set and %G_SPAWN_SEARCH_PATH_FROM_ENVP
+ * is not, the child is created with posix_spawn() rather than fork()
+ * where available. This avoids copying the page tables of the parent,
+ * which makes spawning from processes with a large address space much
+ * cheaper. Closing the parent's descriptors requires support from the
+ * C library for this; otherwise %G_SPAWN_LEAVE_DESCRIPTORS_OPEN is
+ * needed as well.
+ *
  * If non-%NULL, @child_pid will on Unix be filled with the child's
  * process ID. You can use the process ID to send signals to the child,
  * or to use g_child_watch_add() (or waitpid()) if you specified the
@@ -1289,6 +1320,170 @@ read_ints (int      fd,
   return TRUE;
 }
 
+#ifdef POSIX_SPAWN_AVAILABLE
+/* Starts the child with posix_spawn(), which glibc and most other
+ * libcs implement with vfork() or clone(CLONE_VM), so the cost does not
+ * grow with the size of the parent.  This handles the subset of
+ * fork_exec_with_pipes() that needs no code to run in the child.
+ *
+ * Returns FALSE if the request can't be done this way, in which case
+ * nothing has happened and the caller should fork() instead.  Otherwise
+ * returns TRUE with *spawn_errno set to 0 on success or to the error
+ * that posix_spawn() reported.
+ */
+static gboolean
+do_posix_spawn (gchar    **argv,
+                gchar    **envp,
+                gboolean   close_descriptors,
+                gboolean   search_path,
+                gboolean   stdout_to_null,
+                gboolean   stderr_to_null,
+                gboolean   child_inherits_stdin,
+                gboolean   file_and_argv_zero,
+                gint      *stdin_pipe,
+                gint      *stdout_pipe,
+                gint      *stderr_pipe,
+                GPid      *child_pid,
+                gint      *spawn_errno)
+{
+  posix_spawnattr_t attr;
+  posix_spawn_file_actions_t file_actions;
+  gint child_fds[3];
+  gint *pipes[3];
+  const gchar *file;
+  gchar **argv_pass;
+  sigset_t default_signals;
+  pid_t pid;
+  gint i;
+  gint r;
+
+#ifndef HAVE_POSIX_SPAWN_FILE_ACTIONS_ADDCLOSEFROM_NP
+  if (close_descriptors)
+    return FALSE;
+#endif
+
+  file = argv[0];
+  argv_pass = file_and_argv_zero ? argv + 1 : argv;
+
+  /* Without a slash, posix_spawnp() searches PATH like we do, except
+   * for its fallback when PATH is unset.
+   */
+  if (search_path && strchr (file, '/') == NULL && g_getenv ("PATH") == NULL)
+    return FALSE;
+
+  child_fds[0] = stdin_pipe[0];
+  child_fds[1] = stdout_pipe[1];
+  child_fds[2] = stderr_pipe[1];
+
+  /* dup2() onto itself would not clear FD_CLOEXEC everywhere */
+  for (i = 0; i < 3; i++)
+    if (child_fds[i] >= 0 && child_fds[i] < 3)
+      return FALSE;
+
+  if (*file == '\0')
+    {
+      *spawn_errno = ENOENT;
+      return TRUE;
+    }
+
+  r = posix_spawnattr_init (&attr);
+  if (r != 0)
+    {
+      *spawn_errno = r;
+      return TRUE;
+    }
+
+  r = posix_spawn_file_actions_init (&file_actions);
+  if (r != 0)
+    {
+      posix_spawnattr_destroy (&attr);
+      *spawn_errno = r;
+      return TRUE;
+    }
+
+  /* Reset the same signal handlers that the fork() path does */
+  sigemptyset (&default_signals);
+  sigaddset (&default_signals, SIGCHLD);
+  sigaddset (&default_signals, SIGINT);
+  sigaddset (&default_signals, SIGTERM);
+  sigaddset (&default_signals, SIGHUP);
+  sigaddset (&default_signals, SIGPIPE);
+
+  r = posix_spawnattr_setsigdefault (&attr, &default_signals);
+  if (r == 0)
+    r = posix_spawnattr_setflags (&attr, POSIX_SPAWN_SETSIGDEF);
+
+  /* Redirect pipes as required */
+  if (r != 0)
+    ;
+  else if (child_fds[0] >= 0)
+    r = posix_spawn_file_actions_adddup2 (&file_actions, child_fds[0], 0);
+  else if (!child_inherits_stdin)
+    r = posix_spawn_file_actions_addopen (&file_actions, 0, "/dev/null", O_RDONLY, 0);
+
+  if (r != 0)
+    ;
+  else if (child_fds[1] >= 0)
+    r = posix_spawn_file_actions_adddup2 (&file_actions, child_fds[1], 1);
+  else if (stdout_to_null)
+    r = posix_spawn_file_actions_addopen (&file_actions, 1, "/dev/null", O_WRONLY, 0);
+
+  if (r != 0)
+    ;
+  else if (child_fds[2] >= 0)
+    r = posix_spawn_file_actions_adddup2 (&file_actions, child_fds[2], 2);
+  else if (stderr_to_null)
+    r = posix_spawn_file_actions_addopen (&file_actions, 2, "/dev/null", O_WRONLY, 0);
+
+  /* Close both ends of our pipes in the child once they have been
+   * duplicated, or everything but stdin, stdout and stderr.
+   */
+  pipes[0] = stdin_pipe;
+  pipes[1] = stdout_pipe;
+  pipes[2] = stderr_pipe;
+
+#ifdef HAVE_POSIX_SPAWN_FILE_ACTIONS_ADDCLOSEFROM_NP
+  if (r == 0 && close_descriptors)
+    r = posix_spawn_file_actions_addclosefrom_np (&file_actions, 3);
+  else
+#endif
+  for (i = 0; i < 3 && r == 0; i++)
+    {
+      if (pipes[i][0] >= 0)
+        r = posix_spawn_file_actions_addclose (&file_actions, pipes[i][0]);
+      if (pipes[i][1] >= 0 && r == 0)
+        r = posix_spawn_file_actions_addclose (&file_actions, pipes[i][1]);
+    }
+
+  if (r == 0)
+    {
+      if (envp == NULL)
+        envp = environ;
+
+      /* Don't search when it contains a slash. */
+      if (search_path && strchr (file, '/') == NULL)
+        r = posix_spawnp (&pid, file, &file_actions, &attr, argv_pass, envp);
+      else
+        r = posix_spawn (&pid, file, &file_actions, &attr, argv_pass, envp);
+    }
+
+  posix_spawn_file_actions_destroy (&file_actions);
+  posix_spawnattr_destroy (&attr);
+
+  /* Scripts without a #! line are run with /bin/sh by g_execute();
+   * posix_spawn() no longer does that, so let the fork() path retry.
+   */
+  if (r == ENOEXEC)
+    return FALSE;
+
+  if (r == 0)
+    *child_pid = pid;
+  *spawn_errno = r;
+
+  return TRUE;
+}
+#endif
+
 static gboolean
 fork_exec_with_pipes (gboolean              intermediate_child,
                       const gchar          *working_directory,
@@ -1319,12 +1514,6 @@ fork_exec_with_pipes (gboolean              intermediate_child,
   guint pipe_flags = cloexec_pipes ? FD_CLOEXEC : 0;
   gint status;
   
-  if (!g_unix_open_pipe (child_err_report_pipe, pipe_flags, error))
-    return FALSE;
-
-  if (intermediate_child && !g_unix_open_pipe (child_pid_report_pipe, pipe_flags, error))
-    goto cleanup_and_fail;
-  
   if (standard_input && !g_unix_open_pipe (stdin_pipe, pipe_flags, error))
     goto cleanup_and_fail;
   
@@ -1334,6 +1523,65 @@ fork_exec_with_pipes (gboolean              intermediate_child,
   if (standard_error && !g_unix_open_pipe (stderr_pipe, FD_CLOEXEC, error))
     goto cleanup_and_fail;
 
+#ifdef POSIX_SPAWN_AVAILABLE
+  /* Without an intermediate child or anything to run in the child
+   * before exec(), we don't need to copy the parent at all.
+   */
+  if (!intermediate_child && !working_directory && !child_setup &&
+      !search_path_from_envp)
+    {
+      gint spawn_errno;
+
+      if (do_posix_spawn (argv,
+                          envp,
+                          close_descriptors,
+                          search_path,
+                          stdout_to_null,
+                          stderr_to_null,
+                          child_inherits_stdin,
+                          file_and_argv_zero,
+                          stdin_pipe,
+                          stdout_pipe,
+                          stderr_pipe,
+                          &pid,
+                          &spawn_errno))
+        {
+          if (spawn_errno != 0)
+            {
+              g_set_error (error,
+                           G_SPAWN_ERROR,
+                           exec_err_to_g_error (spawn_errno),
+                           _("Failed to execute child process \"%s\" (%s)"),
+                           argv[0],
+                           g_strerror (spawn_errno));
+              goto cleanup_and_fail;
+            }
+
+          close_and_invalidate (&stdin_pipe[0]);
+          close_and_invalidate (&stdout_pipe[1]);
+          close_and_invalidate (&stderr_pipe[1]);
+
+          if (child_pid)
+            *child_pid = pid;
+
+          if (standard_input)
+            *standard_input = stdin_pipe[1];
+          if (standard_output)
+            *standard_output = stdout_pipe[0];
+          if (standard_error)
+            *standard_error = stderr_pipe[0];
+
+          return TRUE;
+        }
+    }
+#endif
+
+  if (!g_unix_open_pipe (child_err_report_pipe, pipe_flags, error))
+    goto cleanup_and_fail;
+
+  if (intermediate_child && !g_unix_open_pipe (child_pid_report_pipe, pipe_flags, error))
+    goto cleanup_and_fail;
+
   pid = fork ();
 
   if (pid < 0)
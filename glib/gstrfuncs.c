@@ -35,6 +35,7 @@
 #include <string.h>
 #include <locale.h>
 #include <errno.h>
+#include <float.h>
 #include <ctype.h>              /* For tolower() */
 
 #ifdef HAVE_XLOCALE_H
@@ -591,6 +592,598 @@ g_strconcat (const gchar *string1, ...)
   return concat;
 }
 
+/* Locale independent fast paths for the common cases of
+ * g_ascii_strtod(), g_ascii_dtostr() and g_ascii_strtoll().
+ * Anything they cannot handle exactly goes to the C library.
+ */
+
+#define FAST_ISSPACE(c)  ((c) == ' ' || (c) == '\f' || (c) == '\n' || \
+                          (c) == '\r' || (c) == '\t' || (c) == '\v')
+#define FAST_ISDIGIT(c)  ((c) >= '0' && (c) <= '9')
+
+/* Parses [+-]?[0-9]{1,18} in base 10, which can neither overflow
+ * nor need locale data.  Returns FALSE if the string is something
+ * else, without touching the out arguments.
+ */
+static gboolean
+ascii_parse_decimal_fast (const gchar  *nptr,
+                          const gchar **endptr,
+                          guint         base,
+                          guint64      *value,
+                          gboolean     *negative)
+{
+  const gchar *p, *digits;
+  guint64 v;
+
+  if (base != 10 && base != 0)
+    return FALSE;
+
+  p = nptr;
+  while (FAST_ISSPACE (*p))
+    p++;
+
+  *negative = FALSE;
+  if (*p == '-')
+    {
+      *negative = TRUE;
+      p++;
+    }
+  else if (*p == '+')
+    p++;
+
+  /* Octal and hexadecimal prefixes */
+  if (base == 0 && *p == '0')
+    return FALSE;
+
+  digits = p;
+  v = 0;
+  while (FAST_ISDIGIT (*p))
+    {
+      if (p - digits == 18)
+        return FALSE;
+      v = v * 10 + (*p - '0');
+      p++;
+    }
+
+  if (p == digits)
+    return FALSE;
+
+  if (endptr)
+    *endptr = p;
+  *value = v;
+
+  return TRUE;
+}
+
+/* Exact decimal to double conversion if the significand fits in 53 bits
+ * and the power of ten is exactly representable (Clinger's fast path):
+ * the result is a single correctly rounded multiplication or division.
+ * That only holds if the FPU does not use excess precision.
+ */
+#if defined (FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0 && DBL_MANT_DIG == 53
+#define USE_FAST_STRTOD
+#endif
+
+#ifdef USE_FAST_STRTOD
+static const gdouble exact_powers_of_ten[] = {
+  1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static gboolean
+ascii_strtod_fast (const gchar  *nptr,
+                   gchar       **endptr,
+                   gdouble      *result)
+{
+  const gchar *p, *q;
+  gboolean negative, seen_digits;
+  guint64 mantissa;
+  gint n_digits, exponent, e;
+  gboolean exp_negative;
+  gdouble value;
+
+  p = nptr;
+  while (FAST_ISSPACE (*p))
+    p++;
+
+  negative = FALSE;
+  if (*p == '-')
+    {
+      negative = TRUE;
+      p++;
+    }
+  else if (*p == '+')
+    p++;
+
+  /* Hexadecimal floats */
+  if (p[0] == '0' && (p[1] == 'x' || p[1] == 'X'))
+    return FALSE;
+
+  mantissa = 0;
+  n_digits = 0;
+  exponent = 0;
+  seen_digits = FALSE;
+
+  for (; FAST_ISDIGIT (*p); p++)
+    {
+      seen_digits = TRUE;
+      if (mantissa == 0 && *p == '0')
+        continue;
+      if (n_digits++ == 19)
+        return FALSE;
+      mantissa = mantissa * 10 + (*p - '0');
+    }
+
+  if (*p == '.')
+    {
+      for (p++; FAST_ISDIGIT (*p); p++)
+        {
+          seen_digits = TRUE;
+          exponent--;
+          if (mantissa == 0 && *p == '0')
+            continue;
+          if (n_digits++ == 19)
+            return FALSE;
+          mantissa = mantissa * 10 + (*p - '0');
+        }
+    }
+
+  /* Infinities, NANs and garbage */
+  if (!seen_digits)
+    return FALSE;
+
+  if (*p == 'e' || *p == 'E')
+    {
+      q = p + 1;
+      exp_negative = FALSE;
+      if (*q == '-')
+        {
+          exp_negative = TRUE;
+          q++;
+        }
+      else if (*q == '+')
+        q++;
+
+      if (FAST_ISDIGIT (*q))
+        {
+          for (e = 0; FAST_ISDIGIT (*q); q++)
+            {
+              if (e > 1000)
+                return FALSE;
+              e = e * 10 + (*q - '0');
+            }
+          exponent += exp_negative ? -e : e;
+          p = q;
+        }
+    }
+
+  if (mantissa > (G_GUINT64_CONSTANT (1) << 53))
+    return FALSE;
+
+  if (mantissa == 0)
+    exponent = 0;
+
+  /* 123e25 is 123000e22, which is still exact */
+  while (exponent > 22)
+    {
+      mantissa *= 10;
+      exponent--;
+      if (mantissa > (G_GUINT64_CONSTANT (1) << 53))
+        return FALSE;
+    }
+
+  if (exponent < -22)
+    return FALSE;
+
+  value = (gdouble) mantissa;
+  if (exponent < 0)
+    value /= exact_powers_of_ten[-exponent];
+  else
+    value *= exact_powers_of_ten[exponent];
+
+  if (endptr)
+    *endptr = (gchar *) p;
+  *result = negative ? -value : value;
+
+  return TRUE;
+}
+#endif /* USE_FAST_STRTOD */
+
+/* Shortest representation of a double, using the Grisu2 algorithm
+ * from Florian Loitsch, "Printing Floating-Point Numbers Quickly and
+ * Accurately with Integers" (PLDI 2010).  The digits always convert
+ * back to the same double, and are the shortest such digits for all
+ * but a tiny fraction of inputs.
+ */
+typedef struct
+{
+  guint64 f;
+  gint e;
+} DiyFp;
+
+#define DIY_FP_HIDDEN_BIT       (G_GUINT64_CONSTANT (1) << 52)
+#define DIY_FP_SIGNIFICAND_MASK (DIY_FP_HIDDEN_BIT - 1)
+
+/* Normalised 64-bit approximations of 10^-348, 10^-340, ..., 10^340 */
+static const DiyFp cached_powers_of_ten[] = {
+  { G_GUINT64_CONSTANT (0xfa8fd5a0081c0288), -1220 },
+  { G_GUINT64_CONSTANT (0xbaaee17fa23ebf76), -1193 },
+  { G_GUINT64_CONSTANT (0x8b16fb203055ac76), -1166 },
+  { G_GUINT64_CONSTANT (0xcf42894a5dce35ea), -1140 },
+  { G_GUINT64_CONSTANT (0x9a6bb0aa55653b2d), -1113 },
+  { G_GUINT64_CONSTANT (0xe61acf033d1a45df), -1087 },
+  { G_GUINT64_CONSTANT (0xab70fe17c79ac6ca), -1060 },
+  { G_GUINT64_CONSTANT (0xff77b1fcbebcdc4f), -1034 },
+  { G_GUINT64_CONSTANT (0xbe5691ef416bd60c), -1007 },
+  { G_GUINT64_CONSTANT (0x8dd01fad907ffc3c),  -980 },
+  { G_GUINT64_CONSTANT (0xd3515c2831559a83),  -954 },
+  { G_GUINT64_CONSTANT (0x9d71ac8fada6c9b5),  -927 },
+  { G_GUINT64_CONSTANT (0xea9c227723ee8bcb),  -901 },
+  { G_GUINT64_CONSTANT (0xaecc49914078536d),  -874 },
+  { G_GUINT64_CONSTANT (0x823c12795db6ce57),  -847 },
+  { G_GUINT64_CONSTANT (0xc21094364dfb5637),  -821 },
+  { G_GUINT64_CONSTANT (0x9096ea6f3848984f),  -794 },
+  { G_GUINT64_CONSTANT (0xd77485cb25823ac7),  -768 },
+  { G_GUINT64_CONSTANT (0xa086cfcd97bf97f4),  -741 },
+  { G_GUINT64_CONSTANT (0xef340a98172aace5),  -715 },
+  { G_GUINT64_CONSTANT (0xb23867fb2a35b28e),  -688 },
+  { G_GUINT64_CONSTANT (0x84c8d4dfd2c63f3b),  -661 },
+  { G_GUINT64_CONSTANT (0xc5dd44271ad3cdba),  -635 },
+  { G_GUINT64_CONSTANT (0x936b9fcebb25c996),  -608 },
+  { G_GUINT64_CONSTANT (0xdbac6c247d62a584),  -582 },
+  { G_GUINT64_CONSTANT (0xa3ab66580d5fdaf6),  -555 },
+  { G_GUINT64_CONSTANT (0xf3e2f893dec3f126),  -529 },
+  { G_GUINT64_CONSTANT (0xb5b5ada8aaff80b8),  -502 },
+  { G_GUINT64_CONSTANT (0x87625f056c7c4a8b),  -475 },
+  { G_GUINT64_CONSTANT (0xc9bcff6034c13053),  -449 },
+  { G_GUINT64_CONSTANT (0x964e858c91ba2655),  -422 },
+  { G_GUINT64_CONSTANT (0xdff9772470297ebd),  -396 },
+  { G_GUINT64_CONSTANT (0xa6dfbd9fb8e5b88f),  -369 },
+  { G_GUINT64_CONSTANT (0xf8a95fcf88747d94),  -343 },
+  { G_GUINT64_CONSTANT (0xb94470938fa89bcf),  -316 },
+  { G_GUINT64_CONSTANT (0x8a08f0f8bf0f156b),  -289 },
+  { G_GUINT64_CONSTANT (0xcdb02555653131b6),  -263 },
+  { G_GUINT64_CONSTANT (0x993fe2c6d07b7fac),  -236 },
+  { G_GUINT64_CONSTANT (0xe45c10c42a2b3b06),  -210 },
+  { G_GUINT64_CONSTANT (0xaa242499697392d3),  -183 },
+  { G_GUINT64_CONSTANT (0xfd87b5f28300ca0e),  -157 },
+  { G_GUINT64_CONSTANT (0xbce5086492111aeb),  -130 },
+  { G_GUINT64_CONSTANT (0x8cbccc096f5088cc),  -103 },
+  { G_GUINT64_CONSTANT (0xd1b71758e219652c),   -77 },
+  { G_GUINT64_CONSTANT (0x9c40000000000000),   -50 },
+  { G_GUINT64_CONSTANT (0xe8d4a51000000000),   -24 },
+  { G_GUINT64_CONSTANT (0xad78ebc5ac620000),     3 },
+  { G_GUINT64_CONSTANT (0x813f3978f8940984),    30 },
+  { G_GUINT64_CONSTANT (0xc097ce7bc90715b3),    56 },
+  { G_GUINT64_CONSTANT (0x8f7e32ce7bea5c70),    83 },
+  { G_GUINT64_CONSTANT (0xd5d238a4abe98068),   109 },
+  { G_GUINT64_CONSTANT (0x9f4f2726179a2245),   136 },
+  { G_GUINT64_CONSTANT (0xed63a231d4c4fb27),   162 },
+  { G_GUINT64_CONSTANT (0xb0de65388cc8ada8),   189 },
+  { G_GUINT64_CONSTANT (0x83c7088e1aab65db),   216 },
+  { G_GUINT64_CONSTANT (0xc45d1df942711d9a),   242 },
+  { G_GUINT64_CONSTANT (0x924d692ca61be758),   269 },
+  { G_GUINT64_CONSTANT (0xda01ee641a708dea),   295 },
+  { G_GUINT64_CONSTANT (0xa26da3999aef774a),   322 },
+  { G_GUINT64_CONSTANT (0xf209787bb47d6b85),   348 },
+  { G_GUINT64_CONSTANT (0xb454e4a179dd1877),   375 },
+  { G_GUINT64_CONSTANT (0x865b86925b9bc5c2),   402 },
+  { G_GUINT64_CONSTANT (0xc83553c5c8965d3d),   428 },
+  { G_GUINT64_CONSTANT (0x952ab45cfa97a0b3),   455 },
+  { G_GUINT64_CONSTANT (0xde469fbd99a05fe3),   481 },
+  { G_GUINT64_CONSTANT (0xa59bc234db398c25),   508 },
+  { G_GUINT64_CONSTANT (0xf6c69a72a3989f5c),   534 },
+  { G_GUINT64_CONSTANT (0xb7dcbf5354e9bece),   561 },
+  { G_GUINT64_CONSTANT (0x88fcf317f22241e2),   588 },
+  { G_GUINT64_CONSTANT (0xcc20ce9bd35c78a5),   614 },
+  { G_GUINT64_CONSTANT (0x98165af37b2153df),   641 },
+  { G_GUINT64_CONSTANT (0xe2a0b5dc971f303a),   667 },
+  { G_GUINT64_CONSTANT (0xa8d9d1535ce3b396),   694 },
+  { G_GUINT64_CONSTANT (0xfb9b7cd9a4a7443c),   720 },
+  { G_GUINT64_CONSTANT (0xbb764c4ca7a44410),   747 },
+  { G_GUINT64_CONSTANT (0x8bab8eefb6409c1a),   774 },
+  { G_GUINT64_CONSTANT (0xd01fef10a657842c),   800 },
+  { G_GUINT64_CONSTANT (0x9b10a4e5e9913129),   827 },
+  { G_GUINT64_CONSTANT (0xe7109bfba19c0c9d),   853 },
+  { G_GUINT64_CONSTANT (0xac2820d9623bf429),   880 },
+  { G_GUINT64_CONSTANT (0x80444b5e7aa7cf85),   907 },
+  { G_GUINT64_CONSTANT (0xbf21e44003acdd2d),   933 },
+  { G_GUINT64_CONSTANT (0x8e679c2f5e44ff8f),   960 },
+  { G_GUINT64_CONSTANT (0xd433179d9c8cb841),   986 },
+  { G_GUINT64_CONSTANT (0x9e19db92b4e31ba9),  1013 },
+  { G_GUINT64_CONSTANT (0xeb96bf6ebadf77d9),  1039 },
+  { G_GUINT64_CONSTANT (0xaf87023b9bf0ee6b),  1066 }
+};
+
+static const guint32 powers_of_ten_32[] = {
+  1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+};
+
+static DiyFp
+diy_fp_multiply (DiyFp x,
+                 DiyFp y)
+{
+  const guint64 mask_32 = 0xffffffff;
+  guint64 a, b, c, d, ac, bc, ad, bd, tmp;
+  DiyFp r;
+
+  a = x.f >> 32;
+  b = x.f & mask_32;
+  c = y.f >> 32;
+  d = y.f & mask_32;
+  ac = a * c;
+  bc = b * c;
+  ad = a * d;
+  bd = b * d;
+  tmp = (bd >> 32) + (ad & mask_32) + (bc & mask_32);
+  tmp += G_GUINT64_CONSTANT (1) << 31; /* round */
+
+  r.f = ac + (ad >> 32) + (bc >> 32) + (tmp >> 32);
+  r.e = x.e + y.e + 64;
+
+  return r;
+}
+
+static DiyFp
+diy_fp_normalize (DiyFp x)
+{
+  while (!(x.f & (G_GUINT64_CONSTANT (1) << 63)))
+    {
+      x.f <<= 1;
+      x.e--;
+    }
+
+  return x;
+}
+
+static void
+grisu_round (gchar   *buffer,
+             gint     len,
+             guint64  delta,
+             guint64  rest,
+             guint64  ten_kappa,
+             guint64  wp_w)
+{
+  while (rest < wp_w && delta - rest >= ten_kappa &&
+         (rest + ten_kappa < wp_w || wp_w - rest > rest + ten_kappa - wp_w))
+    {
+      buffer[len - 1]--;
+      rest += ten_kappa;
+    }
+}
+
+static gint
+grisu_digit_gen (DiyFp    w,
+                 DiyFp    mp,
+                 guint64  delta,
+                 gchar   *buffer,
+                 gint    *k)
+{
+  DiyFp one;
+  guint64 wp_w, p2, rest;
+  guint32 p1, d;
+  gint kappa, len;
+
+  one.f = G_GUINT64_CONSTANT (1) << -mp.e;
+  one.e = mp.e;
+  wp_w = mp.f - w.f;
+  p1 = (guint32) (mp.f >> -one.e);
+  p2 = mp.f & (one.f - 1);
+
+  for (kappa = 1; kappa < 10 && p1 >= powers_of_ten_32[kappa]; kappa++)
+    ;
+
+  len = 0;
+  while (kappa > 0)
+    {
+      d = p1 / powers_of_ten_32[kappa - 1];
+      p1 %= powers_of_ten_32[kappa - 1];
+      if (d || len)
+        buffer[len++] = '0' + d;
+      kappa--;
+
+      rest = ((guint64) p1 << -one.e) + p2;
+      if (rest <= delta)
+        {
+          *k += kappa;
+          grisu_round (buffer, len, delta, rest,
+                       (guint64) powers_of_ten_32[kappa] << -one.e, wp_w);
+          return len;
+        }
+    }
+
+  while (TRUE)
+    {
+      p2 *= 10;
+      delta *= 10;
+      d = (guint32) (p2 >> -one.e);
+      if (d || len)
+        buffer[len++] = '0' + d;
+      p2 &= one.f - 1;
+      kappa--;
+
+      if (p2 < delta)
+        {
+          *k += kappa;
+          grisu_round (buffer, len, delta, p2, one.f,
+                       -kappa < 10 ? wp_w * powers_of_ten_32[-kappa] : 0);
+          return len;
+        }
+    }
+}
+
+/* Writes the digits of the positive, finite @value to @buffer, and
+ * returns their number; the value is digits * 10^@k.
+ */
+static gint
+grisu2 (gdouble  value,
+        gchar   *buffer,
+        gint    *k)
+{
+  union { gdouble d; guint64 u; } bits;
+  DiyFp v, w, plus, minus, c_mk;
+  gdouble dk;
+  gint biased_e, ki, index;
+
+  bits.d = value;
+  biased_e = (gint) ((bits.u >> 52) & 0x7ff);
+  v.f = bits.u & DIY_FP_SIGNIFICAND_MASK;
+  if (biased_e != 0)
+    {
+      v.f += DIY_FP_HIDDEN_BIT;
+      v.e = biased_e - 1075;
+    }
+  else
+    v.e = -1074;
+
+  /* The boundaries half way to the neighbouring doubles */
+  plus.f = (v.f << 1) + 1;
+  plus.e = v.e - 1;
+  while (!(plus.f & (DIY_FP_HIDDEN_BIT << 1)))
+    {
+      plus.f <<= 1;
+      plus.e--;
+    }
+  plus.f <<= 64 - 52 - 2;
+  plus.e -= 64 - 52 - 2;
+
+  if (v.f == DIY_FP_HIDDEN_BIT)
+    {
+      minus.f = (v.f << 2) - 1;
+      minus.e = v.e - 2;
+    }
+  else
+    {
+      minus.f = (v.f << 1) - 1;
+      minus.e = v.e - 1;
+    }
+  minus.f <<= minus.e - plus.e;
+  minus.e = plus.e;
+
+  /* Pick a power of ten that brings the product into [-60, -32] */
+  dk = (-61 - plus.e) * 0.30102999566398114 + 347;
+  ki = (gint) dk;
+  if (dk - ki > 0.0)
+    ki++;
+  index = (ki >> 3) + 1;
+  *k = -(-348 + index * 8);
+  c_mk = cached_powers_of_ten[index];
+
+  w = diy_fp_multiply (diy_fp_normalize (v), c_mk);
+  plus = diy_fp_multiply (plus, c_mk);
+  minus = diy_fp_multiply (minus, c_mk);
+  minus.f++;
+  plus.f--;
+
+  return grisu_digit_gen (w, plus, plus.f - minus.f, buffer, k);
+}
+
+/* Formats @value like printf("%.17g"), but with the shortest digits
+ * that convert back to @value.  Returns FALSE for infinities, NANs
+ * and values that need more than 15 significant digits.
+ */
+static gboolean
+ascii_dtostr_fast (gchar   *buffer,
+                   gint     buf_len,
+                   gdouble  value)
+{
+  gchar digits[20], out[G_ASCII_DTOSTR_BUF_SIZE];
+  gchar *o;
+  gint n_digits, k, exp10, i;
+
+  if (value != value || value - value != 0.0)
+    return FALSE;
+
+  o = out;
+  if (value < 0 || (value == 0 && 1 / value < 0))
+    {
+      *o++ = '-';
+      value = -value;
+    }
+
+  if (value == 0)
+    {
+      digits[0] = '0';
+      n_digits = 1;
+      k = 0;
+    }
+  else
+    {
+      n_digits = grisu2 (value, digits, &k);
+
+      /* Grisu2 is not always the closest at full precision; leave
+       * those to printf(), which rounds correctly.
+       */
+      if (n_digits > 15)
+        return FALSE;
+
+      while (n_digits > 1 && digits[n_digits - 1] == '0')
+        {
+          n_digits--;
+          k++;
+        }
+    }
+
+  exp10 = n_digits + k - 1;
+
+  if (exp10 < -4 || exp10 >= 17)
+    {
+      /* d.ddde+XX */
+      *o++ = digits[0];
+      if (n_digits > 1)
+        {
+          *o++ = '.';
+          memcpy (o, digits + 1, n_digits - 1);
+          o += n_digits - 1;
+        }
+      *o++ = 'e';
+      if (exp10 < 0)
+        {
+          *o++ = '-';
+          exp10 = -exp10;
+        }
+      else
+        *o++ = '+';
+      if (exp10 >= 100)
+        *o++ = '0' + exp10 / 100;
+      *o++ = '0' + (exp10 / 10) % 10;
+      *o++ = '0' + exp10 % 10;
+    }
+  else if (k >= 0)
+    {
+      /* ddd000 */
+      memcpy (o, digits, n_digits);
+      o += n_digits;
+      for (i = 0; i < k; i++)
+        *o++ = '0';
+    }
+  else if (exp10 >= 0)
+    {
+      /* dd.ddd */
+      memcpy (o, digits, exp10 + 1);
+      o += exp10 + 1;
+      *o++ = '.';
+      memcpy (o, digits + exp10 + 1, n_digits - exp10 - 1);
+      o += n_digits - exp10 - 1;
+    }
+  else
+    {
+      /* 0.000ddd */
+      *o++ = '0';
+      *o++ = '.';
+      for (i = -1; i > exp10; i--)
+        *o++ = '0';
+      memcpy (o, digits, n_digits);
+      o += n_digits;
+    }
+  *o = '\0';
+
+  if (buf_len > 0)
+    g_strlcpy (buffer, out, buf_len);
+
+  return TRUE;
+}
+
 /**
  * g_strtod:
  * @nptr:    the string to convert to a numeric value.
@@ -681,11 +1274,19 @@ g_ascii_strtod (const gchar *nptr,
                 gchar      **endptr)
 {
 #ifdef USE_XLOCALE
+#ifdef USE_FAST_STRTOD
+  gdouble val;
+#endif
 
   g_return_val_if_fail (nptr != NULL, 0);
 
   errno = 0;
 
+#ifdef USE_FAST_STRTOD
+  if (ascii_strtod_fast (nptr, endptr, &val))
+    return val;
+#endif
+
   return strtod_l (nptr, endptr, get_C_locale ());
 
 #else
@@ -703,6 +1304,14 @@ g_ascii_strtod (const gchar *nptr,
 
   g_return_val_if_fail (nptr != NULL, 0);
 
+#ifdef USE_FAST_STRTOD
+  if (ascii_strtod_fast (nptr, endptr, &val))
+    {
+      errno = 0;
+      return val;
+    }
+#endif
+
   fail_pos = NULL;
 
 #ifndef __BIONIC__
@@ -860,6 +1469,11 @@ g_ascii_strtod (const gchar *nptr,
  * guaranteed that the size of the resulting string will never
  * be larger than @G_ASCII_DTOSTR_BUF_SIZE bytes.
  *
+ * The output has the layout of the "%.17g" printf() format, but since
+ * GLib 2.44 no more digits than needed are used for values that can be
+ * written with at most 15 significant digits, so 0.1 is converted to
+ * "0.1" rather than "0.10000000000000001".
+ *
  * Returns: The pointer to the buffer with the converted string.
  **/
 gchar *
@@ -867,6 +1481,11 @@ g_ascii_dtostr (gchar       *buffer,
                 gint         buf_len,
                 gdouble      d)
 {
+  g_return_val_if_fail (buffer != NULL, NULL);
+
+  if (ascii_dtostr_fast (buffer, buf_len, d))
+    return buffer;
+
   return g_ascii_formatd (buffer, buf_len, "%.17g", d);
 }
 
@@ -1151,12 +1770,17 @@ g_ascii_strtoull (const gchar *nptr,
                   gchar      **endptr,
                   guint        base)
 {
-#ifdef USE_XLOCALE
-  return strtoull_l (nptr, endptr, base, get_C_locale ());
-#else
   gboolean negative;
   guint64 result;
 
+  g_return_val_if_fail (nptr != NULL, 0);
+
+  if (ascii_parse_decimal_fast (nptr, (const gchar **) endptr, base, &result, &negative))
+    return negative ? -result : result;
+
+#ifdef USE_XLOCALE
+  return strtoull_l (nptr, endptr, base, get_C_locale ());
+#else
   result = g_parse_long_long (nptr, (const gchar **) endptr, base, &negative);
 
   /* Return the result of the appropriate sign.  */
@@ -1198,12 +1822,17 @@ g_ascii_strtoll (const gchar *nptr,
                  gchar      **endptr,
                  guint        base)
 {
-#ifdef USE_XLOCALE
-  return strtoll_l (nptr, endptr, base, get_C_locale ());
-#else
   gboolean negative;
   guint64 result;
 
+  g_return_val_if_fail (nptr != NULL, 0);
+
+  if (ascii_parse_decimal_fast (nptr, (const gchar **) endptr, base, &result, &negative))
+    return negative ? - (gint64) result : (gint64) result;
+
+#ifdef USE_XLOCALE
+  return strtoll_l (nptr, endptr, base, get_C_locale ());
+#else
   result = g_parse_long_long (nptr, (const gchar **) endptr, base, &negative);
 
   if (negative && result > (guint64) G_MININT64)
@@ -1441,6 +2070,43 @@ g_strlcat (gchar       *dest,
 }
 #endif /* ! HAVE_STRLCPY */
 
+/* Maps the ASCII letters in [@str, @str + @len) to the other case,
+ * eight bytes at a time.  A byte is flipped if it is at least @first,
+ * at most @last, and not part of a multibyte sequence; the tests are
+ * done by adding to the low seven bits of every byte and looking at
+ * the carries into bit 7, which cannot spill into the next byte.
+ */
+static void
+ascii_case_map (gchar *str,
+                gsize  len,
+                gchar  first,
+                gchar  last)
+{
+  const guint64 ones = G_GUINT64_CONSTANT (0x0101010101010101);
+  const guint64 high_bits = ones * 0x80;
+  guint64 word, low, ge_first, gt_last, mask;
+  gchar *end = str + len;
+
+  while (end - str >= 8)
+    {
+      memcpy (&word, str, 8);
+      low = word & ~high_bits;
+      ge_first = low + ones * (0x80 - first);
+      gt_last = low + ones * (0x80 - last - 1);
+      mask = ge_first & ~gt_last & ~word & high_bits;
+      if (mask)
+        {
+          word ^= mask >> 2;
+          memcpy (str, &word, 8);
+        }
+      str += 8;
+    }
+
+  for (; str < end; str++)
+    if (*str >= first && *str <= last)
+      *str ^= 0x20;
+}
+
 /**
  * g_ascii_strdown:
  * @str: a string
@@ -1457,16 +2123,18 @@ gchar*
 g_ascii_strdown (const gchar *str,
                  gssize       len)
 {
-  gchar *result, *s;
+  gchar *result;
 
   g_return_val_if_fail (str != NULL, NULL);
 
   if (len < 0)
     len = strlen (str);
 
+  /* g_strndup() pads with nuls after an embedded nul, and those
+   * are left alone by the case mapping.
+   */
   result = g_strndup (str, len);
-  for (s = result; *s; s++)
-    *s = g_ascii_tolower (*s);
+  ascii_case_map (result, len, 'A', 'Z');
 
   return result;
 }
@@ -1487,7 +2155,7 @@ gchar*
 g_ascii_strup (const gchar *str,
                gssize       len)
 {
-  gchar *result, *s;
+  gchar *result;
 
   g_return_val_if_fail (str != NULL, NULL);
 
@@ -1495,8 +2163,7 @@ g_ascii_strup (const gchar *str,
     len = strlen (str);
 
   result = g_strndup (str, len);
-  for (s = result; *s; s++)
-    *s = g_ascii_toupper (*s);
+  ascii_case_map (result, len, 'a', 'z');
 
   return result;
 }
@@ -1748,10 +2415,14 @@ g_ascii_strcasecmp (const gchar *s1,
 
   while (*s1 && *s2)
     {
-      c1 = (gint)(guchar) TOLOWER (*s1);
-      c2 = (gint)(guchar) TOLOWER (*s2);
-      if (c1 != c2)
-        return (c1 - c2);
+      /* Most bytes are simply equal; only fold the others */
+      if (*s1 != *s2)
+        {
+          c1 = (gint)(guchar) TOLOWER (*s1);
+          c2 = (gint)(guchar) TOLOWER (*s2);
+          if (c1 != c2)
+            return (c1 - c2);
+        }
       s1++; s2++;
     }
 
@@ -1791,10 +2462,13 @@ g_ascii_strncasecmp (const gchar *s1,
   while (n && *s1 && *s2)
     {
       n -= 1;
-      c1 = (gint)(guchar) TOLOWER (*s1);
-      c2 = (gint)(guchar) TOLOWER (*s2);
-      if (c1 != c2)
-        return (c1 - c2);
+      if (*s1 != *s2)
+        {
+          c1 = (gint)(guchar) TOLOWER (*s1);
+          c2 = (gint)(guchar) TOLOWER (*s2);
+          if (c1 != c2)
+            return (c1 - c2);
+        }
       s1++; s2++;
     }
 
@@ -2233,6 +2907,68 @@ g_strchomp (gchar *string)
   return string;
 }
 
+/* Shared by g_strsplit() and g_strsplit_inplace(); @string is only
+ * written to if @copy is %FALSE.
+ */
+static gchar **
+strsplit_internal (gchar       *string,
+                   const gchar *delimiter,
+                   gint         max_tokens,
+                   gboolean     copy)
+{
+  gchar **str_array;
+  gchar *remainder, *s;
+  gsize delimiter_len;
+  guint n, allocated;
+  gboolean empty;
+
+  if (max_tokens < 1)
+    max_tokens = G_MAXINT;
+
+  /* Checked up front, the first byte may be a delimiter we overwrite */
+  empty = (*string == '\0');
+  delimiter_len = strlen (delimiter);
+  allocated = 8;
+  str_array = g_new (gchar *, allocated);
+  n = 0;
+
+  remainder = string;
+  while (--max_tokens)
+    {
+      if (delimiter_len == 1)
+        s = strchr (remainder, delimiter[0]);
+      else
+        s = strstr (remainder, delimiter);
+
+      if (s == NULL)
+        break;
+
+      /* Leave room for the last token and the terminator */
+      if (n + 2 >= allocated)
+        {
+          allocated *= 2;
+          str_array = g_renew (gchar *, str_array, allocated);
+        }
+
+      if (copy)
+        str_array[n++] = g_strndup (remainder, s - remainder);
+      else
+        {
+          *s = '\0';
+          str_array[n++] = remainder;
+        }
+
+      remainder = s + delimiter_len;
+    }
+
+  if (!empty)
+    str_array[n++] = copy ? g_strdup (remainder) : remainder;
+
+  str_array[n] = NULL;
+
+  return str_array;
+}
+
 /**
  * g_strsplit:
  * @string: a string to split
@@ -2265,51 +3001,45 @@ g_strsplit (const gchar *string,
             const gchar *delimiter,
             gint         max_tokens)
 {
-  GSList *string_list = NULL, *slist;
-  gchar **str_array, *s;
-  guint n = 0;
-  const gchar *remainder;
-
   g_return_val_if_fail (string != NULL, NULL);
   g_return_val_if_fail (delimiter != NULL, NULL);
   g_return_val_if_fail (delimiter[0] != '\0', NULL);
 
-  if (max_tokens < 1)
-    max_tokens = G_MAXINT;
-
-  remainder = string;
-  s = strstr (remainder, delimiter);
-  if (s)
-    {
-      gsize delimiter_len = strlen (delimiter);
-
-      while (--max_tokens && s)
-        {
-          gsize len;
-
-          len = s - remainder;
-          string_list = g_slist_prepend (string_list,
-                                         g_strndup (remainder, len));
-          n++;
-          remainder = s + delimiter_len;
-          s = strstr (remainder, delimiter);
-        }
-    }
-  if (*string)
-    {
-      n++;
-      string_list = g_slist_prepend (string_list, g_strdup (remainder));
-    }
-
-  str_array = g_new (gchar*, n + 1);
-
-  str_array[n--] = NULL;
-  for (slist = string_list; slist; slist = slist->next)
-    str_array[n--] = slist->data;
+  return strsplit_internal ((gchar *) string, delimiter, max_tokens, TRUE);
+}
 
-  g_slist_free (string_list);
+/**
+ * g_strsplit_inplace:
+ * @string: a string to split
+ * @delimiter: a string which specifies the places at which to split
+ *     the string
+ * @max_tokens: the maximum number of pieces to split @string into.
+ *     If this is less than 1, the string is split completely.
+ *
+ * Splits @string like g_strsplit() does, but without copying the
+ * pieces: the first byte of each delimiter that separates two tokens
+ * is overwritten with a nul, and the returned array points into
+ * @string.
+ *
+ * This is useful for splitting large buffers into many tokens, for
+ * instance lines, where allocating a string per token would dominate.
+ * The tokens are only valid as long as @string is.
+ *
+ * Returns: (transfer container): a newly-allocated %NULL-terminated
+ *    array of pointers into @string. Use g_free() to free it.
+ *
+ * Since: 2.44
+ */
+gchar **
+g_strsplit_inplace (gchar       *string,
+                    const gchar *delimiter,
+                    gint         max_tokens)
+{
+  g_return_val_if_fail (string != NULL, NULL);
+  g_return_val_if_fail (delimiter != NULL, NULL);
+  g_return_val_if_fail (delimiter[0] != '\0', NULL);
 
-  return str_array;
+  return strsplit_internal (string, delimiter, max_tokens, FALSE);
 }
 
 /**
@@ -2622,26 +3352,27 @@ g_strstr_len (const gchar *haystack,
     {
       const gchar *p = haystack;
       gsize needle_len = strlen (needle);
-      const gchar *end;
-      gsize i;
+      const gchar *end, *nul;
 
       if (needle_len == 0)
         return (gchar *)haystack;
 
+      /* The search stops at a nul in the haystack */
+      nul = memchr (haystack, '\0', haystack_len);
+      if (nul != NULL)
+        haystack_len = nul - haystack;
+
       if (haystack_len < needle_len)
         return NULL;
 
       end = haystack + haystack_len - needle_len;
 
-      while (p <= end && *p)
+      /* Let memchr() find the candidates */
+      while (p <= end &&
+             (p = memchr (p, needle[0], end - p + 1)) != NULL)
         {
-          for (i = 0; i < needle_len; i++)
-            if (p[i] != needle[i])
-              goto next;
-
-          return (gchar *)p;
-
-        next:
+          if (memcmp (p + 1, needle + 1, needle_len - 1) == 0)
+            return (gchar *)p;
           p++;
         }
 
@@ -273,6 +273,10 @@ GLIB_AVAILABLE_IN_ALL
 gchar **	      g_strsplit_set   (const gchar *string,
 					const gchar *delimiters,
 					gint         max_tokens) G_GNUC_MALLOC;
+GLIB_AVAILABLE_IN_2_44
+gchar **              g_strsplit_inplace (gchar       *string,
+                                          const gchar *delimiter,
+                                          gint         max_tokens);
 GLIB_AVAILABLE_IN_ALL
 gchar*                g_strjoinv       (const gchar  *separator,
 					gchar       **str_array) G_GNUC_MALLOC;
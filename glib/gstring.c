@@ -36,6 +36,7 @@
 
 #include "gstring.h"
 
+#include "garray.h"
 #include "gprintf.h"
 
 
@@ -148,12 +149,14 @@ g_string_new (const gchar *init)
     string = g_string_sized_new (2);
   else
     {
-      gint len;
+      gsize len;
 
       len = strlen (init);
       string = g_string_sized_new (len + 2);
 
-      g_string_append_len (string, init, len);
+      /* Copy the nul too; no need for the checks in g_string_insert_len() */
+      memcpy (string->str, init, len + 1);
+      string->len = len;
     }
 
   return string;
@@ -187,7 +190,11 @@ g_string_new_len (const gchar *init,
       string = g_string_sized_new (len);
 
       if (init)
-        g_string_append_len (string, init, len);
+        {
+          memcpy (string->str, init, len);
+          string->str[len] = '\0';
+          string->len = len;
+        }
 
       return string;
     }
@@ -235,6 +242,9 @@ g_string_free (GString  *string,
  * #GBytes.  The #GString structure itself is deallocated, and it is
  * therefore invalid to use @string after invoking this function.
  *
+ * The character data is not copied, so this is a cheap way to turn
+ * a string that was built up piece by piece into an immutable buffer.
+ *
  * Note that while #GString ensures that its buffer always has a
  * trailing nul character (not reflected in its "len"), the returned
  * #GBytes does not include this extra nul; i.e. it has length exactly
@@ -1264,3 +1274,428 @@ g_string_append_printf (GString     *string,
   g_string_append_vprintf (string, format, args);
   va_end (args);
 }
+
+/**
+ * GStringBuilder:
+ *
+ * A #GStringBuilder assembles a long string out of many edits that are
+ * not all at the end.  Prepending to or inserting into a #GString
+ * moves everything after the insertion point every time, which makes
+ * building a large document front-to-back or from the middle out
+ * quadratic.  A #GStringBuilder keeps the text in a list of chunks of
+ * a few kilobytes each instead, so an edit only moves data within one
+ * chunk.
+ *
+ * Unlike a #GString, the text in a #GStringBuilder is not contiguous
+ * and can not be accessed directly.  Once it is complete, it is joined
+ * into a #GString with g_string_builder_free_to_string() or into a
+ * #GBytes with g_string_builder_free_to_bytes(), copying it once.
+ *
+ * Since: 2.44
+ */
+
+#define BUILDER_CHUNK_SIZE 4096
+
+typedef struct
+{
+  gsize len;
+  gsize allocated_len;
+  gchar data[1];
+} GStringBuilderChunk;
+
+struct _GStringBuilder
+{
+  GPtrArray *chunks;
+  gsize len;
+};
+
+static GStringBuilderChunk *
+builder_chunk_new (const gchar *data,
+                   gsize        len)
+{
+  GStringBuilderChunk *chunk;
+  gsize allocated_len;
+
+  allocated_len = MAX (len, BUILDER_CHUNK_SIZE);
+  chunk = g_malloc (G_STRUCT_OFFSET (GStringBuilderChunk, data) + allocated_len);
+  chunk->len = len;
+  chunk->allocated_len = allocated_len;
+  memcpy (chunk->data, data, len);
+
+  return chunk;
+}
+
+/* Finds the chunk holding byte @pos, scanning from whichever end is
+ * closer.  @pos == builder->len maps to the end of the last chunk.
+ */
+static guint
+builder_find_chunk (GStringBuilder *builder,
+                    gsize           pos,
+                    gsize          *offset)
+{
+  GStringBuilderChunk *chunk;
+  gsize start;
+  guint i;
+
+  if (pos <= builder->len / 2)
+    {
+      for (i = 0; ; i++)
+        {
+          chunk = g_ptr_array_index (builder->chunks, i);
+          if (pos < chunk->len)
+            break;
+          pos -= chunk->len;
+        }
+    }
+  else
+    {
+      start = builder->len;
+      for (i = builder->chunks->len - 1; ; i--)
+        {
+          chunk = g_ptr_array_index (builder->chunks, i);
+          start -= chunk->len;
+          if (pos >= start)
+            break;
+        }
+      pos -= start;
+    }
+
+  *offset = pos;
+
+  return i;
+}
+
+/**
+ * g_string_builder_new:
+ *
+ * Creates a new, empty #GStringBuilder.
+ *
+ * Returns: a new #GStringBuilder
+ *
+ * Since: 2.44
+ */
+GStringBuilder *
+g_string_builder_new (void)
+{
+  GStringBuilder *builder;
+
+  builder = g_slice_new (GStringBuilder);
+  builder->chunks = g_ptr_array_new_with_free_func (g_free);
+  builder->len = 0;
+
+  return builder;
+}
+
+/**
+ * g_string_builder_free:
+ * @builder: a #GStringBuilder
+ *
+ * Frees @builder and the text in it.
+ *
+ * Since: 2.44
+ */
+void
+g_string_builder_free (GStringBuilder *builder)
+{
+  g_return_if_fail (builder != NULL);
+
+  g_ptr_array_unref (builder->chunks);
+  g_slice_free (GStringBuilder, builder);
+}
+
+/**
+ * g_string_builder_free_to_string:
+ * @builder: (transfer full): a #GStringBuilder
+ *
+ * Joins the text in @builder into a new #GString and frees @builder.
+ *
+ * Returns: (transfer full): a new #GString
+ *
+ * Since: 2.44
+ */
+GString *
+g_string_builder_free_to_string (GStringBuilder *builder)
+{
+  GStringBuilderChunk *chunk;
+  GString *string;
+  guint i;
+
+  g_return_val_if_fail (builder != NULL, NULL);
+
+  string = g_string_sized_new (builder->len);
+  for (i = 0; i < builder->chunks->len; i++)
+    {
+      chunk = g_ptr_array_index (builder->chunks, i);
+      g_string_append_len (string, chunk->data, chunk->len);
+    }
+
+  g_string_builder_free (builder);
+
+  return string;
+}
+
+/**
+ * g_string_builder_free_to_bytes:
+ * @builder: (transfer full): a #GStringBuilder
+ *
+ * Joins the text in @builder into a new #GBytes and frees @builder.
+ *
+ * Returns: (transfer full): a new #GBytes
+ *
+ * Since: 2.44
+ */
+GBytes *
+g_string_builder_free_to_bytes (GStringBuilder *builder)
+{
+  g_return_val_if_fail (builder != NULL, NULL);
+
+  return g_string_free_to_bytes (g_string_builder_free_to_string (builder));
+}
+
+/**
+ * g_string_builder_get_length:
+ * @builder: a #GStringBuilder
+ *
+ * Gets the length of the text in @builder, in bytes.
+ *
+ * Returns: the length
+ *
+ * Since: 2.44
+ */
+gsize
+g_string_builder_get_length (GStringBuilder *builder)
+{
+  g_return_val_if_fail (builder != NULL, 0);
+
+  return builder->len;
+}
+
+/**
+ * g_string_builder_insert_len:
+ * @builder: a #GStringBuilder
+ * @pos: position in @builder where insertion should
+ *       happen, or -1 for at the end
+ * @val: bytes to insert
+ * @len: number of bytes of @val to insert, or -1 if @val is
+ *       nul-terminated
+ *
+ * Inserts @len bytes of @val into @builder at @pos, like
+ * g_string_insert_len() does for a #GString.
+ *
+ * Since: 2.44
+ */
+void
+g_string_builder_insert_len (GStringBuilder *builder,
+                             gssize          pos,
+                             const gchar    *val,
+                             gssize          len)
+{
+  GStringBuilderChunk *chunk, *prev;
+  gsize offset;
+  guint i;
+
+  g_return_if_fail (builder != NULL);
+  g_return_if_fail (len == 0 || val != NULL);
+
+  if (len < 0)
+    len = strlen (val);
+
+  if (pos < 0)
+    pos = builder->len;
+  else
+    g_return_if_fail (pos <= builder->len);
+
+  if (len == 0)
+    return;
+
+  if (builder->chunks->len == 0)
+    {
+      g_ptr_array_add (builder->chunks, builder_chunk_new (val, len));
+      builder->len = len;
+      return;
+    }
+
+  i = builder_find_chunk (builder, pos, &offset);
+  chunk = g_ptr_array_index (builder->chunks, i);
+
+  /* At a chunk boundary, prefer appending to the previous chunk */
+  if (offset == 0 && i > 0)
+    {
+      prev = g_ptr_array_index (builder->chunks, i - 1);
+      if (prev->allocated_len - prev->len >= len)
+        {
+          chunk = prev;
+          offset = prev->len;
+          i--;
+        }
+    }
+
+  if (chunk->allocated_len - chunk->len >= len)
+    {
+      memmove (chunk->data + offset + len, chunk->data + offset, chunk->len - offset);
+      memcpy (chunk->data + offset, val, len);
+      chunk->len += len;
+    }
+  else if (offset == 0)
+    g_ptr_array_insert (builder->chunks, i, builder_chunk_new (val, len));
+  else
+    {
+      /* Split off the part after @pos, then add @val after the rest */
+      if (offset < chunk->len)
+        {
+          g_ptr_array_insert (builder->chunks, i + 1,
+                              builder_chunk_new (chunk->data + offset, chunk->len - offset));
+          chunk->len = offset;
+        }
+
+      if (chunk->allocated_len - chunk->len >= len)
+        {
+          memcpy (chunk->data + chunk->len, val, len);
+          chunk->len += len;
+        }
+      else
+        g_ptr_array_insert (builder->chunks, i + 1, builder_chunk_new (val, len));
+    }
+
+  builder->len += len;
+}
+
+/**
+ * g_string_builder_insert:
+ * @builder: a #GStringBuilder
+ * @pos: the position to insert the copy of the string, or -1 for at
+ *       the end
+ * @val: the string to insert
+ *
+ * Inserts a copy of a string into @builder at @pos.
+ *
+ * Since: 2.44
+ */
+void
+g_string_builder_insert (GStringBuilder *builder,
+                         gssize          pos,
+                         const gchar    *val)
+{
+  g_string_builder_insert_len (builder, pos, val, -1);
+}
+
+/**
+ * g_string_builder_append:
+ * @builder: a #GStringBuilder
+ * @val: the string to append
+ *
+ * Adds a string onto the end of @builder.
+ *
+ * Since: 2.44
+ */
+void
+g_string_builder_append (GStringBuilder *builder,
+                         const gchar    *val)
+{
+  g_string_builder_insert_len (builder, -1, val, -1);
+}
+
+/**
+ * g_string_builder_append_len:
+ * @builder: a #GStringBuilder
+ * @val: bytes to append
+ * @len: number of bytes of @val to use, or -1 if @val is nul-terminated
+ *
+ * Appends @len bytes of @val to @builder.
+ *
+ * Since: 2.44
+ */
+void
+g_string_builder_append_len (GStringBuilder *builder,
+                             const gchar    *val,
+                             gssize          len)
+{
+  g_string_builder_insert_len (builder, -1, val, len);
+}
+
+/**
+ * g_string_builder_prepend:
+ * @builder: a #GStringBuilder
+ * @val: the string to prepend
+ *
+ * Adds a string onto the start of @builder.
+ *
+ * Since: 2.44
+ */
+void
+g_string_builder_prepend (GStringBuilder *builder,
+                          const gchar    *val)
+{
+  g_string_builder_insert_len (builder, 0, val, -1);
+}
+
+/**
+ * g_string_builder_prepend_len:
+ * @builder: a #GStringBuilder
+ * @val: bytes to prepend
+ * @len: number of bytes of @val to use, or -1 if @val is nul-terminated
+ *
+ * Prepends @len bytes of @val to @builder.
+ *
+ * Since: 2.44
+ */
+void
+g_string_builder_prepend_len (GStringBuilder *builder,
+                              const gchar    *val,
+                              gssize          len)
+{
+  g_string_builder_insert_len (builder, 0, val, len);
+}
+
+/**
+ * g_string_builder_erase:
+ * @builder: a #GStringBuilder
+ * @pos: the position of the content to remove
+ * @len: the number of bytes to remove, or -1 to remove all
+ *       following bytes
+ *
+ * Removes @len bytes from @builder, starting at position @pos.
+ *
+ * Since: 2.44
+ */
+void
+g_string_builder_erase (GStringBuilder *builder,
+                        gssize          pos,
+                        gssize          len)
+{
+  GStringBuilderChunk *chunk;
+  gsize offset, n;
+  guint i;
+
+  g_return_if_fail (builder != NULL);
+  g_return_if_fail (pos >= 0);
+  g_return_if_fail (pos <= builder->len);
+
+  if (len < 0)
+    len = builder->len - pos;
+  else
+    g_return_if_fail (pos + len <= builder->len);
+
+  if (len == 0)
+    return;
+
+  i = builder_find_chunk (builder, pos, &offset);
+
+  while (len > 0)
+    {
+      chunk = g_ptr_array_index (builder->chunks, i);
+      n = MIN ((gsize) len, chunk->len - offset);
+
+      memmove (chunk->data + offset, chunk->data + offset + n, chunk->len - offset - n);
+      chunk->len -= n;
+      builder->len -= n;
+      len -= n;
+
+      if (chunk->len == 0)
+        g_ptr_array_remove_index (builder->chunks, i);
+      else
+        i++;
+
+      offset = 0;
+    }
+}
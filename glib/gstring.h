@@ -174,6 +174,46 @@ g_string_append_c_inline (GString *gstring,
 #endif /* G_CAN_INLINE */
 
 
+typedef struct _GStringBuilder GStringBuilder;
+
+GLIB_AVAILABLE_IN_2_44
+GStringBuilder * g_string_builder_new            (void);
+GLIB_AVAILABLE_IN_2_44
+void             g_string_builder_free           (GStringBuilder *builder);
+GLIB_AVAILABLE_IN_2_44
+GString *        g_string_builder_free_to_string (GStringBuilder *builder);
+GLIB_AVAILABLE_IN_2_44
+GBytes *         g_string_builder_free_to_bytes  (GStringBuilder *builder);
+GLIB_AVAILABLE_IN_2_44
+gsize            g_string_builder_get_length     (GStringBuilder *builder);
+GLIB_AVAILABLE_IN_2_44
+void             g_string_builder_append         (GStringBuilder *builder,
+                                                  const gchar    *val);
+GLIB_AVAILABLE_IN_2_44
+void             g_string_builder_append_len     (GStringBuilder *builder,
+                                                  const gchar    *val,
+                                                  gssize          len);
+GLIB_AVAILABLE_IN_2_44
+void             g_string_builder_prepend        (GStringBuilder *builder,
+                                                  const gchar    *val);
+GLIB_AVAILABLE_IN_2_44
+void             g_string_builder_prepend_len    (GStringBuilder *builder,
+                                                  const gchar    *val,
+                                                  gssize          len);
+GLIB_AVAILABLE_IN_2_44
+void             g_string_builder_insert         (GStringBuilder *builder,
+                                                  gssize          pos,
+                                                  const gchar    *val);
+GLIB_AVAILABLE_IN_2_44
+void             g_string_builder_insert_len     (GStringBuilder *builder,
+                                                  gssize          pos,
+                                                  const gchar    *val,
+                                                  gssize          len);
+GLIB_AVAILABLE_IN_2_44
+void             g_string_builder_erase          (GStringBuilder *builder,
+                                                  gssize          pos,
+                                                  gssize          len);
+
 GLIB_DEPRECATED
 GString *g_string_down (GString *string);
 GLIB_DEPRECATED
@@ -32,8 +32,8 @@
 
 #include "gstringchunk.h"
 
-#include "ghash.h"
 #include "gslist.h"
+#include "gmem.h"
 #include "gmessages.h"
 
 #include "gutils.h"
@@ -61,7 +61,11 @@
  *
  * To add strings to a #GStringChunk, but without duplicating strings
  * which are already in the #GStringChunk, use
- * g_string_chunk_insert_const().
+ * g_string_chunk_insert_const(), or g_string_chunk_insert_const_len()
+ * for input that is not nul-terminated.
+ *
+ * g_string_chunk_get_usage() tells how much memory a #GStringChunk
+ * uses, and how much was saved by not storing duplicates.
  *
  * To free the entire #GStringChunk use g_string_chunk_free(). It is
  * not possible to free individual strings.
@@ -73,13 +77,30 @@
  * An opaque data structure representing String Chunks.
  * It should only be accessed by using the following functions.
  */
+/* The strings added with the _const() functions are kept in an open
+ * addressing table that remembers their hash and length, so lookups
+ * need neither a nul-terminated key nor a strlen().
+ */
+typedef struct
+{
+  const gchar *string;
+  gsize        len;
+  guint        hash;
+} GStringChunkEntry;
+
 struct _GStringChunk
 {
-  GHashTable *const_table;
+  GStringChunkEntry *const_table;
+  guint       const_table_shift;  /* 32 - log2 (table size) */
+  gsize       const_table_size;
+  gsize       n_const;
   GSList     *storage_list;
   gsize       storage_next;
   gsize       this_size;
   gsize       default_size;
+  gsize       allocated;
+  gsize       used;
+  gsize       saved;
 };
 
 #define MY_MAXSIZE ((gsize)-1)
@@ -123,10 +144,16 @@ g_string_chunk_new (gsize size)
   actual_size = nearest_power (1, size);
 
   new_chunk->const_table  = NULL;
+  new_chunk->const_table_shift = 0;
+  new_chunk->const_table_size = 0;
+  new_chunk->n_const      = 0;
   new_chunk->storage_list = NULL;
   new_chunk->storage_next = actual_size;
   new_chunk->default_size = actual_size;
   new_chunk->this_size    = actual_size;
+  new_chunk->allocated    = 0;
+  new_chunk->used         = 0;
+  new_chunk->saved        = 0;
 
   return new_chunk;
 }
@@ -147,8 +174,7 @@ g_string_chunk_free (GStringChunk *chunk)
   if (chunk->storage_list)
     g_slist_free_full (chunk->storage_list, g_free);
 
-  if (chunk->const_table)
-    g_hash_table_destroy (chunk->const_table);
+  g_free (chunk->const_table);
 
   g_free (chunk);
 }
@@ -178,7 +204,13 @@ g_string_chunk_clear (GStringChunk *chunk)
     }
 
   if (chunk->const_table)
-      g_hash_table_remove_all (chunk->const_table);
+    memset (chunk->const_table, 0,
+            chunk->const_table_size * sizeof (GStringChunkEntry));
+  chunk->n_const = 0;
+
+  chunk->allocated = 0;
+  chunk->used = 0;
+  chunk->saved = 0;
 }
 
 /**
@@ -236,22 +268,190 @@ gchar*
 g_string_chunk_insert_const (GStringChunk *chunk,
                              const gchar  *string)
 {
-  char* lookup;
+  g_return_val_if_fail (chunk != NULL, NULL);
+
+  return g_string_chunk_insert_const_len (chunk, string, -1);
+}
+
+static inline gsize
+const_table_index (GStringChunk *chunk,
+                   guint         hash)
+{
+  /* Fibonacci hashing; the top bits mix all bits of the hash */
+  return (guint32) (hash * 2654435769u) >> chunk->const_table_shift;
+}
+
+static void
+const_table_resize (GStringChunk *chunk)
+{
+  GStringChunkEntry *old_table = chunk->const_table;
+  gsize old_size = chunk->const_table_size;
+  gsize i, j;
+
+  if (old_size == 0)
+    {
+      chunk->const_table_size = 64;
+      chunk->const_table_shift = 32 - 6;
+    }
+  else
+    {
+      chunk->const_table_size = old_size * 2;
+      chunk->const_table_shift--;
+    }
+
+  chunk->const_table = g_new0 (GStringChunkEntry, chunk->const_table_size);
+
+  for (i = 0; i < old_size; i++)
+    if (old_table[i].string != NULL)
+      {
+        j = const_table_index (chunk, old_table[i].hash);
+        while (chunk->const_table[j].string != NULL)
+          j = (j + 1) & (chunk->const_table_size - 1);
+        chunk->const_table[j] = old_table[i];
+      }
+
+  g_free (old_table);
+}
+
+/**
+ * g_string_chunk_insert_const_len:
+ * @chunk: a #GStringChunk
+ * @string: bytes to insert
+ * @len: number of bytes of @string to insert, or -1 to insert a
+ *     nul-terminated string
+ *
+ * Adds a nul-terminated copy of the first @len bytes of @string to the
+ * #GStringChunk, unless the same bytes have already been added with
+ * g_string_chunk_insert_const() or one of its variants.
+ *
+ * This is like g_string_chunk_insert_const(), but @string does not
+ * need to be nul-terminated, so tokens can be interned straight from
+ * an input buffer.
+ *
+ * Returns: a pointer to the new or existing copy of @string
+ *     within the #GStringChunk
+ *
+ * Since: 2.44
+ */
+gchar *
+g_string_chunk_insert_const_len (GStringChunk *chunk,
+                                 const gchar  *string,
+                                 gssize        len)
+{
+  const signed char *p, *end;
+  guint32 h;
 
   g_return_val_if_fail (chunk != NULL, NULL);
 
-  if (!chunk->const_table)
-    chunk->const_table = g_hash_table_new (g_str_hash, g_str_equal);
+  if (len < 0)
+    len = strlen (string);
+
+  /* Same as g_str_hash() */
+  h = 5381;
+  for (p = (const signed char *) string, end = p + len; p < end; p++)
+    h = (h << 5) + h + *p;
+
+  return g_string_chunk_insert_const_with_hash (chunk, string, len, h);
+}
 
-  lookup = (char*) g_hash_table_lookup (chunk->const_table, (gchar *)string);
+/**
+ * g_string_chunk_insert_const_with_hash:
+ * @chunk: a #GStringChunk
+ * @string: bytes to insert
+ * @len: number of bytes of @string to insert, or -1 to insert a
+ *     nul-terminated string
+ * @hash: the hash of the bytes
+ *
+ * Like g_string_chunk_insert_const_len(), but uses a precomputed
+ * hash, for instance one that a tokenizer computed while scanning
+ * its input.
+ *
+ * @hash must be the value that g_str_hash() returns for a
+ * nul-terminated copy of the bytes; that is, starting from 5381,
+ * h = h * 33 + c for every byte c, taken as a signed char.
+ *
+ * Returns: a pointer to the new or existing copy of @string
+ *     within the #GStringChunk
+ *
+ * Since: 2.44
+ */
+gchar *
+g_string_chunk_insert_const_with_hash (GStringChunk *chunk,
+                                       const gchar  *string,
+                                       gssize        len,
+                                       guint         hash)
+{
+  GStringChunkEntry *entry;
+  gchar *copy;
+  gsize i;
 
-  if (!lookup)
+  g_return_val_if_fail (chunk != NULL, NULL);
+
+  if (len < 0)
+    len = strlen (string);
+
+  /* Keep the load factor at most 3/4 */
+  if ((chunk->n_const + 1) * 4 > chunk->const_table_size * 3)
+    const_table_resize (chunk);
+
+  i = const_table_index (chunk, hash);
+  for (entry = &chunk->const_table[i];
+       entry->string != NULL;
+       entry = &chunk->const_table[i])
     {
-      lookup = g_string_chunk_insert (chunk, string);
-      g_hash_table_insert (chunk->const_table, lookup, lookup);
+      if (entry->hash == hash && entry->len == len &&
+          memcmp (entry->string, string, len) == 0)
+        {
+          chunk->saved += len + 1;
+          return (gchar *) entry->string;
+        }
+
+      i = (i + 1) & (chunk->const_table_size - 1);
     }
 
-  return lookup;
+  copy = g_string_chunk_insert_len (chunk, string, len);
+
+  entry->string = copy;
+  entry->len = len;
+  entry->hash = hash;
+  chunk->n_const++;
+
+  return copy;
+}
+
+/**
+ * g_string_chunk_get_usage:
+ * @chunk: a #GStringChunk
+ * @allocated: (out) (allow-none): return location for the number of
+ *     bytes allocated for string storage
+ * @used: (out) (allow-none): return location for the number of bytes
+ *     taken by the strings, including their nul terminators
+ * @saved: (out) (allow-none): return location for the number of bytes
+ *     that g_string_chunk_insert_const() and its variants did not need
+ *     to store because the string was already present
+ *
+ * Reports the memory used by @chunk since it was created or last
+ * cleared.  The difference between @allocated and @used is the space
+ * left unused at the end of the blocks; @saved compared to @used gives
+ * the deduplication ratio.  The lookup table used for deduplication is
+ * not included.
+ *
+ * Since: 2.44
+ */
+void
+g_string_chunk_get_usage (GStringChunk *chunk,
+                          gsize        *allocated,
+                          gsize        *used,
+                          gsize        *saved)
+{
+  g_return_if_fail (chunk != NULL);
+
+  if (allocated)
+    *allocated = chunk->allocated;
+  if (used)
+    *used = chunk->used;
+  if (saved)
+    *saved = chunk->saved;
 }
 
 /**
@@ -299,6 +499,7 @@ g_string_chunk_insert_len (GStringChunk *chunk,
 
       chunk->this_size = new_size;
       chunk->storage_next = 0;
+      chunk->allocated += new_size;
     }
 
   pos = ((gchar *) chunk->storage_list->data) + chunk->storage_next;
@@ -308,6 +509,7 @@ g_string_chunk_insert_len (GStringChunk *chunk,
   memcpy (pos, string, size);
 
   chunk->storage_next += size + 1;
+  chunk->used += size + 1;
 
   return pos;
 }
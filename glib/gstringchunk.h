@@ -51,6 +51,20 @@ gchar*        g_string_chunk_insert_len   (GStringChunk *chunk,
 GLIB_AVAILABLE_IN_ALL
 gchar*        g_string_chunk_insert_const (GStringChunk *chunk,
                                            const gchar  *string);
+GLIB_AVAILABLE_IN_2_44
+gchar*        g_string_chunk_insert_const_len       (GStringChunk *chunk,
+                                                     const gchar  *string,
+                                                     gssize        len);
+GLIB_AVAILABLE_IN_2_44
+gchar*        g_string_chunk_insert_const_with_hash (GStringChunk *chunk,
+                                                     const gchar  *string,
+                                                     gssize        len,
+                                                     guint         hash);
+GLIB_AVAILABLE_IN_2_44
+void          g_string_chunk_get_usage              (GStringChunk *chunk,
+                                                     gsize        *allocated,
+                                                     gsize        *used,
+                                                     gsize        *saved);
 
 G_END_DECLS
 
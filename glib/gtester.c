@@ -181,6 +181,16 @@ test_log_msg (GTestLogMsg *msg)
       test_log_printfe ("%s%s\n", sindent (log_indent + 2), msg->strings[0]);
       test_log_printfe ("%s</performance>\n", sindent (log_indent));
       break;
+    case G_TEST_LOG_BENCHMARK:
+      test_log_printfe ("%s<performance minimize=\"1\" maximize=\"0\" value=\"%.16Lg\" "
+                        "iterations=\"%.0Lf\" samples=\"%.0Lf\" min=\"%.16Lg\" p10=\"%.16Lg\" "
+                        "p90=\"%.16Lg\" max=\"%.16Lg\" mean=\"%.16Lg\" stddev=\"%.16Lg\">\n",
+                        sindent (log_indent), msg->nums[0], msg->nums[1], msg->nums[2],
+                        msg->nums[3], msg->nums[4], msg->nums[5], msg->nums[6],
+                        msg->nums[7], msg->nums[8]);
+      test_log_printfe ("%s%s\n", sindent (log_indent + 2), msg->strings[0]);
+      test_log_printfe ("%s</performance>\n", sindent (log_indent));
+      break;
     case G_TEST_LOG_MESSAGE:
       test_log_printfe ("%s<message>\n%s\n%s</message>\n", sindent (log_indent), msg->strings[0], sindent (log_indent));
       break;
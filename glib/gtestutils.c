@@ -646,6 +646,7 @@ g_test_log_type_name (GTestLogType log_type)
     case G_TEST_LOG_MESSAGE:            return "message";
     case G_TEST_LOG_START_SUITE:        return "start suite";
     case G_TEST_LOG_STOP_SUITE:         return "stop suite";
+    case G_TEST_LOG_BENCHMARK:          return "benchmark";
     }
   return "???";
 }
@@ -766,6 +767,12 @@ g_test_log (GTestLogType lbit,
       else if (g_test_verbose())
         g_print ("(MAXPERF:%s)\n", string1);
       break;
+    case G_TEST_LOG_BENCHMARK:
+      if (test_tap_log)
+        g_print ("# benchmark: %s\n", string1);
+      else if (g_test_verbose())
+        g_print ("(BENCHMARK:%s)\n", string1);
+      break;
     case G_TEST_LOG_MESSAGE:
     case G_TEST_LOG_ERROR:
       if (test_tap_log)
@@ -1860,6 +1867,240 @@ g_test_add_data_func_full (const char     *testpath,
                      (GTestFixtureFunc) data_free_func);
 }
 
+typedef struct
+{
+  GTestBenchmarkFunc func;
+  gconstpointer      data;
+} GTestBenchmark;
+
+/* Each sample runs for at least this long, in seconds */
+#define BENCHMARK_SAMPLE_TIME  0.01
+/* Stop taking samples after this long, once there are enough */
+#define BENCHMARK_TOTAL_TIME   1.0
+#define BENCHMARK_MIN_SAMPLES  5
+#define BENCHMARK_MAX_SAMPLES  50
+
+static gdouble
+benchmark_run (GTestBenchmark *bench,
+               guint64         n_iterations,
+               GTimer         *timer)
+{
+  g_timer_start (timer);
+  bench->func (bench->data, n_iterations);
+  return g_timer_elapsed (timer, NULL);
+}
+
+static gint
+benchmark_compare (gconstpointer a,
+                   gconstpointer b)
+{
+  gdouble da = *(const gdouble *) a;
+  gdouble db = *(const gdouble *) b;
+
+  return da < db ? -1 : da > db;
+}
+
+/* @samples must be sorted */
+static gdouble
+benchmark_percentile (const gdouble *samples,
+                      guint          n_samples,
+                      gdouble        fraction)
+{
+  gdouble pos = fraction * (n_samples - 1);
+  guint i = (guint) pos;
+
+  if (i + 1 >= n_samples)
+    return samples[n_samples - 1];
+
+  return samples[i] + (samples[i + 1] - samples[i]) * (pos - i);
+}
+
+/* libglib does not link against libm */
+static gdouble
+benchmark_sqrt (gdouble x)
+{
+  gdouble r, next;
+
+  if (x <= 0)
+    return 0;
+
+  /* Newton's method, decreasing monotonically from above */
+  r = MAX (x, 1);
+  while ((next = (r + x / r) / 2) < r)
+    r = next;
+
+  return r;
+}
+
+static gchar *
+benchmark_format_time (gdouble seconds)
+{
+  if (seconds < 1e-6)
+    return g_strdup_printf ("%.1f ns", seconds * 1e9);
+  else if (seconds < 1e-3)
+    return g_strdup_printf ("%.2f us", seconds * 1e6);
+  else if (seconds < 1)
+    return g_strdup_printf ("%.2f ms", seconds * 1e3);
+  else
+    return g_strdup_printf ("%.3f s", seconds);
+}
+
+static void
+benchmark_test (gconstpointer data)
+{
+  GTestBenchmark *bench = (GTestBenchmark *) data;
+  gdouble samples[BENCHMARK_MAX_SAMPLES];
+  guint n_samples = 0;
+  guint64 n_iterations = 1;
+  gdouble elapsed, total, mean, stddev;
+  gdouble median, p10, p90;
+  gchar *s_median, *s_p10, *s_p90, *s_stddev;
+  long double largs[9];
+  gchar *blurb;
+  GTimer *timer;
+  guint i;
+
+  /* Outside of perf mode, just check that the benchmark works */
+  if (!g_test_perf ())
+    {
+      bench->func (bench->data, 1);
+      return;
+    }
+
+  timer = g_timer_new ();
+
+  /* Find an iteration count that makes a sample long enough to time
+   * reliably; these runs also warm up caches and the code itself.
+   */
+  while (TRUE)
+    {
+      elapsed = benchmark_run (bench, n_iterations, timer);
+      if (elapsed >= BENCHMARK_SAMPLE_TIME || n_iterations >= G_MAXUINT64 / 100)
+        break;
+
+      if (elapsed <= BENCHMARK_SAMPLE_TIME / 100)
+        n_iterations *= 100;
+      else
+        n_iterations = MAX (n_iterations + 1,
+                            n_iterations * 1.2 * BENCHMARK_SAMPLE_TIME / elapsed);
+    }
+
+  /* One more warm-up run at the final count */
+  benchmark_run (bench, n_iterations, timer);
+
+  total = 0;
+  while (n_samples < BENCHMARK_MAX_SAMPLES &&
+         (n_samples < BENCHMARK_MIN_SAMPLES || total < BENCHMARK_TOTAL_TIME))
+    {
+      elapsed = benchmark_run (bench, n_iterations, timer);
+      total += elapsed;
+      samples[n_samples++] = elapsed / n_iterations;
+    }
+
+  g_timer_destroy (timer);
+
+  qsort (samples, n_samples, sizeof (gdouble), benchmark_compare);
+
+  mean = 0;
+  for (i = 0; i < n_samples; i++)
+    mean += samples[i];
+  mean /= n_samples;
+
+  stddev = 0;
+  for (i = 0; i < n_samples; i++)
+    stddev += (samples[i] - mean) * (samples[i] - mean);
+  stddev = benchmark_sqrt (stddev / (n_samples - 1));
+
+  median = benchmark_percentile (samples, n_samples, 0.5);
+  p10 = benchmark_percentile (samples, n_samples, 0.1);
+  p90 = benchmark_percentile (samples, n_samples, 0.9);
+
+  s_median = benchmark_format_time (median);
+  s_p10 = benchmark_format_time (p10);
+  s_p90 = benchmark_format_time (p90);
+  s_stddev = benchmark_format_time (stddev);
+  blurb = g_strdup_printf ("median %s per iteration (p10 %s, p90 %s, stddev %s; "
+                           "%u samples of %" G_GUINT64_FORMAT " iterations)",
+                           s_median, s_p10, s_p90, s_stddev,
+                           n_samples, n_iterations);
+
+  largs[0] = median;
+  largs[1] = n_iterations;
+  largs[2] = n_samples;
+  largs[3] = samples[0];
+  largs[4] = p10;
+  largs[5] = p90;
+  largs[6] = samples[n_samples - 1];
+  largs[7] = mean;
+  largs[8] = stddev;
+  g_test_log (G_TEST_LOG_BENCHMARK, blurb, NULL, G_N_ELEMENTS (largs), largs);
+
+  g_free (blurb);
+  g_free (s_median);
+  g_free (s_p10);
+  g_free (s_p90);
+  g_free (s_stddev);
+}
+
+/**
+ * GTestBenchmarkFunc:
+ * @user_data: the data provided when registering the benchmark
+ * @n_iterations: how many times to perform the measured operation
+ *
+ * The type used for benchmarks added with g_test_add_benchmark().
+ * The function should perform the operation being measured
+ * @n_iterations times, and do as little else as possible, since the
+ * whole call is timed.
+ *
+ * Since: 2.44
+ */
+
+/**
+ * g_test_add_benchmark:
+ * @testpath: /-separated test case path name for the benchmark
+ * @test_data: data argument for @bench_func
+ * @bench_func: the benchmark function to invoke
+ *
+ * Creates a new test case that measures how long @bench_func takes per
+ * iteration.
+ *
+ * When performance tests are enabled with `-m perf`, the benchmark is
+ * first called with increasing iteration counts until one call takes
+ * long enough to time reliably, which also serves as warm-up.  It is
+ * then called repeatedly with that count for about a second, taking at
+ * least 5 and at most 50 samples, and the median, 10th and 90th
+ * percentiles, minimum, maximum, mean and standard deviation of the
+ * time per iteration are reported.
+ *
+ * The report is a minimized performance result, like
+ * g_test_minimized_result() with the median as its value, that also
+ * carries the other figures.  gtester records them as attributes of the
+ * `<performance>` element of the test case, so they can be extracted
+ * from its XML log and compared across runs.
+ *
+ * Otherwise @bench_func is called once with an iteration count of 1,
+ * so that the benchmark is still exercised by ordinary test runs.
+ *
+ * Since: 2.44
+ */
+void
+g_test_add_benchmark (const char         *testpath,
+                      gconstpointer       test_data,
+                      GTestBenchmarkFunc  bench_func)
+{
+  GTestBenchmark *bench;
+
+  g_return_if_fail (testpath != NULL);
+  g_return_if_fail (testpath[0] == '/');
+  g_return_if_fail (bench_func != NULL);
+
+  bench = g_new (GTestBenchmark, 1);
+  bench->func = bench_func;
+  bench->data = test_data;
+
+  g_test_add_data_func_full (testpath, bench, benchmark_test, g_free);
+}
+
 static gboolean
 g_test_suite_case_exists (GTestSuite *suite,
                           const char *test_path)
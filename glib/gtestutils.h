@@ -34,6 +34,8 @@ typedef struct GTestCase  GTestCase;
 typedef struct GTestSuite GTestSuite;
 typedef void (*GTestFunc)        (void);
 typedef void (*GTestDataFunc)    (gconstpointer user_data);
+typedef void (*GTestBenchmarkFunc) (gconstpointer user_data,
+                                    guint64       n_iterations);
 typedef void (*GTestFixtureFunc) (gpointer      fixture,
                                   gconstpointer user_data);
 
@@ -141,6 +143,11 @@ void    g_test_add_data_func_full       (const char     *testpath,
                                          GTestDataFunc   test_func,
                                          GDestroyNotify  data_free_func);
 
+GLIB_AVAILABLE_IN_2_44
+void    g_test_add_benchmark            (const char     *testpath,
+                                         gconstpointer   test_data,
+                                         GTestBenchmarkFunc bench_func);
+
 /* tell about failure */
 GLIB_AVAILABLE_IN_2_30
 void    g_test_fail                     (void);
@@ -334,7 +341,8 @@ typedef enum {
   G_TEST_LOG_MAX_RESULT,        /* s:blurb d:result */
   G_TEST_LOG_MESSAGE,           /* s:blurb */
   G_TEST_LOG_START_SUITE,
-  G_TEST_LOG_STOP_SUITE
+  G_TEST_LOG_STOP_SUITE,
+  G_TEST_LOG_BENCHMARK          /* s:blurb d:median d:iterations d:samples d:min d:p10 d:p90 d:max d:mean d:stddev */
 } GTestLogType;
 
 typedef struct {
@@ -470,6 +470,203 @@ g_rw_lock_get_impl (GRWLock *lock)
   return impl;
 }
 
+/* The "big reader" flavour of GRWLock trades memory and writer
+ * latency for read-side scalability.  Instead of one reader count that
+ * every reader bounces between CPUs, each lock has an array of
+ * cacheline-sized reader counters and a thread only ever touches the
+ * one its identity hashes to.  A reader increments its counter and
+ * then checks that no writer is active or waiting; a writer announces
+ * itself in @writers and then waits until every counter has drained.
+ * Both sides use full barriers, so either the reader sees the writer
+ * and backs off, or the writer sees the reader and waits for it.
+ *
+ * Writers have preference: as long as any writer is waiting, new
+ * readers block.  Sleeping on either side goes through @wait_mutex and
+ * @wait_cond; that only happens while a writer is around, which is
+ * expected to be rare for this kind of lock.
+ *
+ * Big reader locks are distinguished from the pthread ones by setting
+ * the lowest bit in the pointer kept in the #GRWLock.
+ */
+
+#define G_BR_LOCK_MAX_SLOTS 64
+#define G_BR_LOCK_CACHELINE 64
+
+typedef struct
+{
+  gint readers;
+  gchar padding[G_BR_LOCK_CACHELINE - sizeof (gint)];
+} GBRLockSlot;
+
+typedef struct
+{
+  GBRLockSlot      slots[G_BR_LOCK_MAX_SLOTS];
+  guint            slot_mask;
+  gint             writers;
+  pthread_mutex_t  writer_mutex;
+  pthread_mutex_t  wait_mutex;
+  pthread_cond_t   wait_cond;
+  gpointer         allocation;
+} GBRLock;
+
+#define G_RW_LOCK_IS_BIG_READER(impl) ((gsize) (impl) & 1)
+#define G_RW_LOCK_BIG_READER(impl) ((GBRLock *) ((gsize) (impl) & ~(gsize) 1))
+
+static GBRLock *
+g_br_lock_new (void)
+{
+  gpointer allocation;
+  GBRLock *lock;
+  guint n_slots;
+  glong n_cpus;
+
+  /* Align the slots to cache lines so readers on different CPUs don't
+   * share them.
+   */
+  allocation = calloc (1, sizeof (GBRLock) + G_BR_LOCK_CACHELINE);
+  if G_UNLIKELY (allocation == NULL)
+    g_thread_abort (errno, "calloc");
+
+  lock = (GBRLock *) (((gsize) allocation + G_BR_LOCK_CACHELINE - 1) & ~(gsize) (G_BR_LOCK_CACHELINE - 1));
+  lock->allocation = allocation;
+
+  n_cpus = sysconf (_SC_NPROCESSORS_ONLN);
+  for (n_slots = 1; n_slots < n_cpus && n_slots < G_BR_LOCK_MAX_SLOTS; n_slots *= 2)
+    ;
+  lock->slot_mask = n_slots - 1;
+
+  pthread_mutex_init (&lock->writer_mutex, NULL);
+  pthread_mutex_init (&lock->wait_mutex, NULL);
+  pthread_cond_init (&lock->wait_cond, NULL);
+
+  return lock;
+}
+
+static void
+g_br_lock_free (GBRLock *lock)
+{
+  pthread_cond_destroy (&lock->wait_cond);
+  pthread_mutex_destroy (&lock->wait_mutex);
+  pthread_mutex_destroy (&lock->writer_mutex);
+  free (lock->allocation);
+}
+
+static inline gint *
+g_br_lock_get_slot (GBRLock *lock)
+{
+  gsize self = (gsize) pthread_self ();
+
+  /* pthread_t is usually a pointer into the thread's stack area, so
+   * mix the bits before picking a slot.  The slot has to stay the same
+   * between lock and unlock, which rules out sched_getcpu().
+   */
+  self ^= self >> 16;
+  self *= 0x45d9f3b;
+  self ^= self >> 16;
+
+  return &lock->slots[self & lock->slot_mask].readers;
+}
+
+static void
+g_br_lock_wake (GBRLock *lock)
+{
+  pthread_mutex_lock (&lock->wait_mutex);
+  pthread_cond_broadcast (&lock->wait_cond);
+  pthread_mutex_unlock (&lock->wait_mutex);
+}
+
+static gboolean
+g_br_lock_readers_drained (GBRLock *lock)
+{
+  guint i;
+
+  for (i = 0; i <= lock->slot_mask; i++)
+    if (g_atomic_int_get (&lock->slots[i].readers) != 0)
+      return FALSE;
+
+  return TRUE;
+}
+
+static gboolean
+g_br_lock_reader_trylock (GBRLock *lock)
+{
+  gint *slot = g_br_lock_get_slot (lock);
+
+  g_atomic_int_inc (slot);
+
+  if G_LIKELY (g_atomic_int_get (&lock->writers) == 0)
+    return TRUE;
+
+  /* A writer is active or waiting; back off and let it proceed */
+  if (g_atomic_int_dec_and_test (slot))
+    g_br_lock_wake (lock);
+
+  return FALSE;
+}
+
+static void
+g_br_lock_reader_lock (GBRLock *lock)
+{
+  while (!g_br_lock_reader_trylock (lock))
+    {
+      pthread_mutex_lock (&lock->wait_mutex);
+      while (g_atomic_int_get (&lock->writers) != 0)
+        pthread_cond_wait (&lock->wait_cond, &lock->wait_mutex);
+      pthread_mutex_unlock (&lock->wait_mutex);
+    }
+}
+
+static void
+g_br_lock_reader_unlock (GBRLock *lock)
+{
+  if (g_atomic_int_dec_and_test (g_br_lock_get_slot (lock)) &&
+      g_atomic_int_get (&lock->writers) != 0)
+    g_br_lock_wake (lock);
+}
+
+static void
+g_br_lock_writer_lock (GBRLock *lock)
+{
+  /* Announce ourselves first, so that no new readers get in while we
+   * queue up behind other writers.
+   */
+  g_atomic_int_inc (&lock->writers);
+  pthread_mutex_lock (&lock->writer_mutex);
+
+  if (!g_br_lock_readers_drained (lock))
+    {
+      pthread_mutex_lock (&lock->wait_mutex);
+      while (!g_br_lock_readers_drained (lock))
+        pthread_cond_wait (&lock->wait_cond, &lock->wait_mutex);
+      pthread_mutex_unlock (&lock->wait_mutex);
+    }
+}
+
+static void
+g_br_lock_writer_unlock (GBRLock *lock)
+{
+  pthread_mutex_unlock (&lock->writer_mutex);
+
+  if (g_atomic_int_dec_and_test (&lock->writers))
+    g_br_lock_wake (lock);
+}
+
+static gboolean
+g_br_lock_writer_trylock (GBRLock *lock)
+{
+  if (pthread_mutex_trylock (&lock->writer_mutex) != 0)
+    return FALSE;
+
+  g_atomic_int_inc (&lock->writers);
+
+  if (g_br_lock_readers_drained (lock))
+    return TRUE;
+
+  g_br_lock_writer_unlock (lock);
+
+  return FALSE;
+}
+
 /**
  * g_rw_lock_init:
  * @rw_lock: an uninitialized #GRWLock
@@ -507,6 +704,41 @@ g_rw_lock_init (GRWLock *rw_lock)
   rw_lock->p = g_rw_lock_impl_new ();
 }
 
+/**
+ * g_rw_lock_init_big_reader:
+ * @rw_lock: an uninitialized #GRWLock
+ *
+ * Initializes a #GRWLock that is optimised for data that is read very
+ * often from many threads at once, and only rarely written.
+ *
+ * Readers of a lock initialised with g_rw_lock_init() all update the
+ * same shared state, which limits how well read-mostly data structures
+ * scale with the number of CPUs.  A "big reader" lock spreads readers
+ * out over several cache lines instead, so that taking a read lock
+ * from different threads does not cause contention.  The price is
+ * more memory per lock (a few kilobytes) and more expensive writer
+ * locking, which has to look at every reader.
+ *
+ * Writers take precedence over readers: once a writer is waiting, new
+ * readers block until it is done.  As a consequence, taking a reader
+ * lock recursively can deadlock.
+ *
+ * The lock is used with the normal #GRWLock functions and must be
+ * freed with g_rw_lock_clear().  Unlike a plain #GRWLock, a big reader
+ * lock can not be statically allocated; it must be initialised with
+ * this function.
+ *
+ * On platforms where no special implementation is available, this is
+ * the same as g_rw_lock_init().
+ *
+ * Since: 2.44
+ */
+void
+g_rw_lock_init_big_reader (GRWLock *rw_lock)
+{
+  rw_lock->p = (gpointer) ((gsize) g_br_lock_new () | 1);
+}
+
 /**
  * g_rw_lock_clear:
  * @rw_lock: an initialized #GRWLock
@@ -524,7 +756,10 @@ g_rw_lock_init (GRWLock *rw_lock)
 void
 g_rw_lock_clear (GRWLock *rw_lock)
 {
-  g_rw_lock_impl_free (rw_lock->p);
+  if (G_RW_LOCK_IS_BIG_READER (rw_lock->p))
+    g_br_lock_free (G_RW_LOCK_BIG_READER (rw_lock->p));
+  else
+    g_rw_lock_impl_free (rw_lock->p);
 }
 
 /**
@@ -540,7 +775,12 @@ g_rw_lock_clear (GRWLock *rw_lock)
 void
 g_rw_lock_writer_lock (GRWLock *rw_lock)
 {
-  pthread_rwlock_wrlock (g_rw_lock_get_impl (rw_lock));
+  pthread_rwlock_t *impl = g_rw_lock_get_impl (rw_lock);
+
+  if G_UNLIKELY (G_RW_LOCK_IS_BIG_READER (impl))
+    g_br_lock_writer_lock (G_RW_LOCK_BIG_READER (impl));
+  else
+    pthread_rwlock_wrlock (impl);
 }
 
 /**
@@ -558,7 +798,12 @@ g_rw_lock_writer_lock (GRWLock *rw_lock)
 gboolean
 g_rw_lock_writer_trylock (GRWLock *rw_lock)
 {
-  if (pthread_rwlock_trywrlock (g_rw_lock_get_impl (rw_lock)) != 0)
+  pthread_rwlock_t *impl = g_rw_lock_get_impl (rw_lock);
+
+  if G_UNLIKELY (G_RW_LOCK_IS_BIG_READER (impl))
+    return g_br_lock_writer_trylock (G_RW_LOCK_BIG_READER (impl));
+
+  if (pthread_rwlock_trywrlock (impl) != 0)
     return FALSE;
 
   return TRUE;
@@ -578,7 +823,12 @@ g_rw_lock_writer_trylock (GRWLock *rw_lock)
 void
 g_rw_lock_writer_unlock (GRWLock *rw_lock)
 {
-  pthread_rwlock_unlock (g_rw_lock_get_impl (rw_lock));
+  pthread_rwlock_t *impl = g_rw_lock_get_impl (rw_lock);
+
+  if G_UNLIKELY (G_RW_LOCK_IS_BIG_READER (impl))
+    g_br_lock_writer_unlock (G_RW_LOCK_BIG_READER (impl));
+  else
+    pthread_rwlock_unlock (impl);
 }
 
 /**
@@ -597,7 +847,12 @@ g_rw_lock_writer_unlock (GRWLock *rw_lock)
 void
 g_rw_lock_reader_lock (GRWLock *rw_lock)
 {
-  pthread_rwlock_rdlock (g_rw_lock_get_impl (rw_lock));
+  pthread_rwlock_t *impl = g_rw_lock_get_impl (rw_lock);
+
+  if G_UNLIKELY (G_RW_LOCK_IS_BIG_READER (impl))
+    g_br_lock_reader_lock (G_RW_LOCK_BIG_READER (impl));
+  else
+    pthread_rwlock_rdlock (impl);
 }
 
 /**
@@ -615,7 +870,12 @@ g_rw_lock_reader_lock (GRWLock *rw_lock)
 gboolean
 g_rw_lock_reader_trylock (GRWLock *rw_lock)
 {
-  if (pthread_rwlock_tryrdlock (g_rw_lock_get_impl (rw_lock)) != 0)
+  pthread_rwlock_t *impl = g_rw_lock_get_impl (rw_lock);
+
+  if G_UNLIKELY (G_RW_LOCK_IS_BIG_READER (impl))
+    return g_br_lock_reader_trylock (G_RW_LOCK_BIG_READER (impl));
+
+  if (pthread_rwlock_tryrdlock (impl) != 0)
     return FALSE;
 
   return TRUE;
@@ -635,7 +895,12 @@ g_rw_lock_reader_trylock (GRWLock *rw_lock)
 void
 g_rw_lock_reader_unlock (GRWLock *rw_lock)
 {
-  pthread_rwlock_unlock (g_rw_lock_get_impl (rw_lock));
+  pthread_rwlock_t *impl = g_rw_lock_get_impl (rw_lock);
+
+  if G_UNLIKELY (G_RW_LOCK_IS_BIG_READER (impl))
+    g_br_lock_reader_unlock (G_RW_LOCK_BIG_READER (impl));
+  else
+    pthread_rwlock_unlock (impl);
 }
 
 /* {{{1 GCond */
@@ -1255,6 +1520,18 @@ g_system_thread_set_name (const gchar *name)
   __atomic_exchange_4((ptr), (new), __ATOMIC_RELEASE)
 #define store_release(ptr, new) \
   __atomic_store_4((ptr), (new), __ATOMIC_RELEASE)
+#define load_relaxed(ptr) \
+  __atomic_load_4((ptr), __ATOMIC_RELAXED)
+#define store_relaxed(ptr, new) \
+  __atomic_store_4((ptr), (new), __ATOMIC_RELAXED)
+
+#if defined(__i386__) || defined(__x86_64__)
+#define cpu_relax() __asm__ __volatile__ ("pause" ::: "memory")
+#elif defined(__aarch64__) || (defined(__arm__) && defined(__ARM_ARCH_7A__))
+#define cpu_relax() __asm__ __volatile__ ("yield" ::: "memory")
+#else
+#define cpu_relax() __asm__ __volatile__ ("" ::: "memory")
+#endif
 
 /* Our strategy for the mutex is pretty simple:
  *
@@ -1278,12 +1555,84 @@ g_system_thread_set_name (const gchar *name)
  * wait.  We must always ensure that we mark a value >1 while we are
  * waiting in order to instruct the holder to do a wake operation on
  * unlock.
+ *
+ * Most critical sections are only a few dozen nanoseconds long, which
+ * is much shorter than the round trip through FUTEX_WAIT and
+ * FUTEX_WAKE.  On SMP systems we therefore spin for a little while
+ * before going to sleep, hoping that the holder releases the lock in
+ * the meantime.  The second word of the mutex (unused otherwise)
+ * keeps a running average of how many spins it took to acquire it in
+ * the past; we spin for at most about twice that, bounded by
+ * MUTEX_SPIN_MAX.  Only successful spins feed the average, while
+ * failed ones let it decay, so mutexes with short hold times converge
+ * on a short spin and those that are held for long drop back to the
+ * minimum instead of spinning in vain.
  */
 
+#define MUTEX_SPIN_MAX 100
+
+static gint g_mutex_spin_enabled = -1;
+
+static gboolean
+g_mutex_should_spin (void)
+{
+  gint enabled = load_relaxed (&g_mutex_spin_enabled);
+
+  if G_UNLIKELY (enabled < 0)
+    {
+      /* Spinning on a uniprocessor only delays the holder */
+      enabled = sysconf (_SC_NPROCESSORS_ONLN) > 1;
+      store_relaxed (&g_mutex_spin_enabled, enabled);
+    }
+
+  return enabled;
+}
+
+static gboolean
+g_mutex_spin (GMutex *mutex)
+{
+  guint spins, max_spins, count;
+  gboolean acquired = FALSE;
+
+  spins = load_relaxed (&mutex->i[1]);
+  max_spins = MIN (MUTEX_SPIN_MAX, spins * 2 + 10);
+
+  for (count = 1; count <= max_spins; count++)
+    {
+      cpu_relax ();
+
+      /* Only attempt the atomic operation once the lock looks free, so
+       * that spinners don't keep stealing the cacheline from the holder.
+       */
+      if (load_relaxed (&mutex->i[0]) == 0)
+        {
+          guint zero = 0;
+
+          if (compare_exchange_acquire (&mutex->i[0], &zero, 1))
+            {
+              acquired = TRUE;
+              break;
+            }
+        }
+    }
+
+  /* Move the average an eighth of the way towards the number of spins
+   * it took, or towards zero if spinning didn't help.  Races between
+   * concurrent updates only affect the heuristic.
+   */
+  if (acquired)
+    store_relaxed (&mutex->i[1], (gint) spins + ((gint) count - (gint) spins) / 8);
+  else
+    store_relaxed (&mutex->i[1], spins - (spins + 7) / 8);
+
+  return acquired;
+}
+
 void
 g_mutex_init (GMutex *mutex)
 {
   mutex->i[0] = 0;
+  mutex->i[1] = 0;
 }
 
 void
@@ -1299,6 +1648,14 @@ g_mutex_clear (GMutex *mutex)
 static void __attribute__((noinline))
 g_mutex_lock_slowpath (GMutex *mutex)
 {
+  /* If we take the lock while spinning, it is set to 1 rather than 2.
+   * That is fine even if other threads are already sleeping: whoever
+   * unlocked it saw a value >1 and woke one of them, and that thread
+   * will set it back to 2 before it goes to sleep again.
+   */
+  if (g_mutex_should_spin () && g_mutex_spin (mutex))
+    return;
+
   /* Set to 2 to indicate contention.  If it was zero before then we
    * just acquired the lock.
    *
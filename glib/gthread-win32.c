@@ -224,6 +224,13 @@ g_rw_lock_init (GRWLock *lock)
   g_thread_impl_vtable.InitializeSRWLock (lock);
 }
 
+void
+g_rw_lock_init_big_reader (GRWLock *lock)
+{
+  /* SRW locks already keep readers cheap enough */
+  g_rw_lock_init (lock);
+}
+
 void
 g_rw_lock_clear (GRWLock *lock)
 {
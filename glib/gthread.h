@@ -172,6 +172,8 @@ void            g_mutex_unlock                  (GMutex         *mutex);
 
 GLIB_AVAILABLE_IN_2_32
 void            g_rw_lock_init                  (GRWLock        *rw_lock);
+GLIB_AVAILABLE_IN_2_44
+void            g_rw_lock_init_big_reader       (GRWLock        *rw_lock);
 GLIB_AVAILABLE_IN_2_32
 void            g_rw_lock_clear                 (GRWLock        *rw_lock);
 GLIB_AVAILABLE_IN_2_32
@@ -182,12 +182,33 @@ struct _GTimeZone
   gchar   *name;
   GArray  *t_info;         /* Array of TransitionInfo */
   GArray  *transitions;    /* Array of Transition */
+  guint   *year_table;     /* Transitions before each table bucket */
+  gint     last_interval;  /* Interval found by the previous lookup */
   gint     ref_count;
 };
 
+/* The year table splits the range 1901..2242 into buckets of 2^25
+ * seconds (a little over a year).  Each entry holds the number of
+ * transitions before the start of its bucket, so that an interval
+ * lookup only has to search the handful of transitions that fall
+ * within a single bucket.
+ */
+#define YEAR_TABLE_SHIFT 25
+#define YEAR_TABLE_START (-((gint64) 1 << 31))
+#define YEAR_TABLE_SIZE  320
+#define YEAR_TABLE_END   (YEAR_TABLE_START + ((gint64) YEAR_TABLE_SIZE << YEAR_TABLE_SHIFT))
+
 G_LOCK_DEFINE_STATIC (time_zones);
 static GHashTable/*<string?, GTimeZone>*/ *time_zones;
 
+/* Strong references to the most recently requested named zones, so
+ * that a program which repeatedly creates and drops the same zone
+ * does not reload its tzfile every time.  Protected by time_zones.
+ */
+#define N_RECENT_ZONES 8
+static GTimeZone *recent_zones[N_RECENT_ZONES];
+static guint      recent_zones_next;
+
 #define MIN_TZYEAR 1916 /* Daylight Savings started in WWI */
 #define MAX_TZYEAR 2999 /* And it's not likely ever to go away, but
                            there's no point in getting carried
@@ -240,6 +261,7 @@ again:
         }
       if (tz->transitions != NULL)
         g_array_free (tz->transitions, TRUE);
+      g_free (tz->year_table);
       g_free (tz->name);
 
       g_slice_free (GTimeZone, tz);
@@ -1277,6 +1299,51 @@ rules_from_identifier (const gchar   *identifier,
 }
 
 /* Construction {{{1 */
+static void
+init_year_table (GTimeZone *tz)
+{
+  guint n_transitions;
+  guint bucket, i;
+
+  if (tz->transitions == NULL || tz->transitions->len == 0)
+    return;
+
+  n_transitions = tz->transitions->len;
+  tz->year_table = g_new (guint, YEAR_TABLE_SIZE);
+
+  for (bucket = 0, i = 0; bucket < YEAR_TABLE_SIZE; bucket++)
+    {
+      gint64 start = YEAR_TABLE_START + ((gint64) bucket << YEAR_TABLE_SHIFT);
+
+      while (i < n_transitions &&
+             g_array_index (tz->transitions, Transition, i).time <= start)
+        i++;
+
+      tz->year_table[bucket] = i;
+    }
+}
+
+/* Called with time_zones held.  Returns a zone that dropped out of
+ * the recent list and must be unreffed once the lock is released.
+ */
+static GTimeZone *
+remember_zone (GTimeZone *tz)
+{
+  GTimeZone *evicted;
+  guint i;
+
+  for (i = 0; i < N_RECENT_ZONES; i++)
+    if (recent_zones[i] == tz)
+      return NULL;
+
+  evicted = recent_zones[recent_zones_next];
+  recent_zones[recent_zones_next] = tz;
+  recent_zones_next = (recent_zones_next + 1) % N_RECENT_ZONES;
+  g_atomic_int_inc (&tz->ref_count);
+
+  return evicted;
+}
+
 /**
  * g_time_zone_new:
  * @identifier: (allow-none): a timezone identifier
@@ -1353,6 +1420,7 @@ GTimeZone *
 g_time_zone_new (const gchar *identifier)
 {
   GTimeZone *tz = NULL;
+  GTimeZone *evicted = NULL;
   TimeZoneRule *rules;
   gint rules_num;
 
@@ -1366,7 +1434,12 @@ g_time_zone_new (const gchar *identifier)
       if (tz)
         {
           g_atomic_int_inc (&tz->ref_count);
+          evicted = remember_zone (tz);
           G_UNLOCK (time_zones);
+
+          if (evicted)
+            g_time_zone_unref (evicted);
+
           return tz;
         }
     }
@@ -1431,14 +1504,22 @@ g_time_zone_new (const gchar *identifier)
 #endif
     }
 
+  init_year_table (tz);
+
   if (tz->t_info != NULL)
     {
       if (identifier)
-        g_hash_table_insert (time_zones, tz->name, tz);
+        {
+          g_hash_table_insert (time_zones, tz->name, tz);
+          evicted = remember_zone (tz);
+        }
     }
   g_atomic_int_inc (&tz->ref_count);
   G_UNLOCK (time_zones);
 
+  if (evicted)
+    g_time_zone_unref (evicted);
+
   return tz;
 }
 
@@ -1594,6 +1675,48 @@ interval_valid (GTimeZone *tz,
   return interval <= tz->transitions->len;
 }
 
+/* Returns the interval containing the UTC time @time_, i.e. the number
+ * of transitions at or before it.
+ */
+static gint
+find_interval_utc (GTimeZone *tz,
+                   gint64     time_)
+{
+  guint lo, hi;
+
+  /* Consecutive lookups usually land in the same interval */
+  lo = g_atomic_int_get (&tz->last_interval);
+  if (interval_valid (tz, lo) &&
+      interval_start (tz, lo) <= time_ && time_ <= interval_end (tz, lo))
+    return lo;
+
+  lo = 0;
+  hi = tz->transitions->len;
+
+  if (tz->year_table && YEAR_TABLE_START <= time_ && time_ < YEAR_TABLE_END)
+    {
+      guint bucket = (time_ - YEAR_TABLE_START) >> YEAR_TABLE_SHIFT;
+
+      lo = tz->year_table[bucket];
+      if (bucket + 1 < YEAR_TABLE_SIZE)
+        hi = tz->year_table[bucket + 1];
+    }
+
+  while (lo < hi)
+    {
+      guint mid = lo + (hi - lo) / 2;
+
+      if (TRANSITION(mid).time <= time_)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+  g_atomic_int_set (&tz->last_interval, lo);
+
+  return lo;
+}
+
 /* g_time_zone_find_interval() {{{1 */
 
 /**
@@ -1636,11 +1759,8 @@ g_time_zone_adjust_time (GTimeZone *tz,
 
   intervals = tz->transitions->len;
 
-  /* find the interval containing *time UTC
-   * TODO: this could be binary searched (or better) */
-  for (i = 0; i <= intervals; i++)
-    if (*time_ <= interval_end (tz, i))
-      break;
+  /* find the interval containing *time UTC */
+  i = find_interval_utc (tz, *time_);
 
   g_assert (interval_start (tz, i) <= *time_ && *time_ <= interval_end (tz, i));
 
@@ -1727,9 +1847,7 @@ g_time_zone_find_interval (GTimeZone *tz,
   if (tz->transitions == NULL)
     return 0;
   intervals = tz->transitions->len;
-  for (i = 0; i <= intervals; i++)
-    if (time_ <= interval_end (tz, i))
-      break;
+  i = find_interval_utc (tz, time_);
 
   if (type == G_TIME_TYPE_UNIVERSAL)
     return i;
@@ -851,6 +851,39 @@ GLIB_AVAILABLE_IN_ALL
 gchar *g_utf8_collate_key_for_filename (const gchar *str,
                                         gssize       len) G_GNUC_MALLOC;
 
+/**
+ * GUnicodeCollatorFlags:
+ * @G_UNICODE_COLLATOR_NONE: produce keys like g_utf8_collate_key()
+ * @G_UNICODE_COLLATOR_FILENAME: produce keys like
+ *     g_utf8_collate_key_for_filename()
+ *
+ * Flags passed to g_unicode_collator_new().
+ *
+ * Since: 2.44
+ */
+typedef enum
+{
+  G_UNICODE_COLLATOR_NONE     = 0,
+  G_UNICODE_COLLATOR_FILENAME = 1 << 0
+} GUnicodeCollatorFlags;
+
+typedef struct _GUnicodeCollator GUnicodeCollator;
+
+GLIB_AVAILABLE_IN_2_44
+GUnicodeCollator *g_unicode_collator_new     (GUnicodeCollatorFlags  flags);
+GLIB_AVAILABLE_IN_2_44
+void              g_unicode_collator_free    (GUnicodeCollator      *collator);
+GLIB_AVAILABLE_IN_2_44
+gsize             g_unicode_collator_get_key (GUnicodeCollator      *collator,
+                                              const gchar           *str,
+                                              gssize                 len,
+                                              gchar                 *key,
+                                              gsize                  key_size);
+GLIB_AVAILABLE_IN_2_44
+void              g_unicode_collator_sort    (GUnicodeCollator      *collator,
+                                              const gchar          **strings,
+                                              gsize                  n_strings);
+
 
 /* private */
 gchar *_g_utf8_make_valid (const gchar *name);
@@ -30,6 +30,8 @@
 #endif
 
 #include "gmem.h"
+#include "gqsort.h"
+#include "gslice.h"
 #include "gunicode.h"
 #include "gunicodeprivate.h"
 #include "gstring.h"
@@ -59,6 +61,25 @@ msc_strxfrm_wrapper (char       *string1,
 #define strxfrm msc_strxfrm_wrapper
 #endif
 
+#if defined(__STDC_ISO_10646__) && !defined(HAVE_CARBON) && \
+    defined(HAVE_NEWLOCALE) && defined(HAVE_WCSXFRM_L)
+#define USE_COLLATOR_LOCALE 1
+#endif
+
+struct _GUnicodeCollator
+{
+  GUnicodeCollatorFlags flags;
+  GString *key;         /* the key being built */
+  GString *append;      /* suffix of filename keys */
+#ifdef USE_COLLATOR_LOCALE
+  locale_t locale;
+#endif
+#if defined(__STDC_ISO_10646__) && !defined(HAVE_CARBON)
+  wchar_t *xfrm_buf;
+  gsize    xfrm_buf_len;
+#endif
+};
+
 /**
  * g_utf8_collate:
  * @str1: a UTF-8 encoded string
@@ -350,84 +371,101 @@ carbon_collate_key_for_filename (const gchar *str,
 
 #endif /* HAVE_CARBON */
 
-/**
- * g_utf8_collate_key:
- * @str: a UTF-8 encoded string.
- * @len: length of @str, in bytes, or -1 if @str is nul-terminated.
- *
- * Converts a string into a collation key that can be compared
- * with other collation keys produced by the same function using 
- * strcmp(). 
- *
- * The results of comparing the collation keys of two strings 
- * with strcmp() will always be the same as comparing the two 
- * original keys with g_utf8_collate().
- * 
- * Note that this function depends on the [current locale][setlocale].
- * 
- * Returns: a newly allocated string. This string should
- *   be freed with g_free() when you are done with it.
- **/
-gchar *
-g_utf8_collate_key (const gchar *str,
-		    gssize       len)
+#if defined(__STDC_ISO_10646__) && !defined(HAVE_CARBON)
+static gsize
+collator_wcsxfrm (GUnicodeCollator *collator,
+                  wchar_t          *dest,
+                  const wchar_t    *src,
+                  gsize             n)
 {
-  gchar *result;
-
-#ifdef HAVE_CARBON
+#ifdef USE_COLLATOR_LOCALE
+  if (collator && collator->locale != (locale_t) 0)
+    return wcsxfrm_l (dest, src, n, collator->locale);
+#endif
 
-  g_return_val_if_fail (str != NULL, NULL);
-  result = carbon_collate_key (str, len);
+  return wcsxfrm (dest, src, n);
+}
+#endif
 
-#elif defined(__STDC_ISO_10646__)
+#ifndef HAVE_CARBON
+/* Appends the collation key of @str to @result.  @collator is
+ * optional; if given, its locale and buffers are used.  Carbon builds
+ * use carbon_collate_key() directly instead.
+ */
+static void
+collate_key_append (GUnicodeCollator *collator,
+                    GString          *result,
+                    const gchar      *str,
+                    gssize            len)
+{
+#ifdef __STDC_ISO_10646__
 
   gsize xfrm_len;
   gunichar *str_norm;
-  wchar_t *result_wc;
+  wchar_t *xfrm_buf;
+  gsize xfrm_buf_len;
   gsize i;
   gsize result_len = 0;
-
-  g_return_val_if_fail (str != NULL, NULL);
+  gsize old_len;
 
   str_norm = _g_utf8_normalize_wc (str, len, G_NORMALIZE_ALL_COMPOSE);
 
-  xfrm_len = wcsxfrm (NULL, (wchar_t *)str_norm, 0);
-  result_wc = g_new (wchar_t, xfrm_len + 1);
-  wcsxfrm (result_wc, (wchar_t *)str_norm, xfrm_len + 1);
+  if (collator)
+    {
+      xfrm_buf = collator->xfrm_buf;
+      xfrm_buf_len = collator->xfrm_buf_len;
+    }
+  else
+    {
+      xfrm_buf = NULL;
+      xfrm_buf_len = 0;
+    }
+
+  xfrm_len = collator_wcsxfrm (collator, xfrm_buf, (wchar_t *)str_norm, xfrm_buf_len);
+  if (xfrm_len >= xfrm_buf_len)
+    {
+      xfrm_buf_len = xfrm_len + 1;
+      xfrm_buf = g_renew (wchar_t, xfrm_buf, xfrm_buf_len);
+      collator_wcsxfrm (collator, xfrm_buf, (wchar_t *)str_norm, xfrm_buf_len);
+    }
 
   for (i = 0; i < xfrm_len; i++)
-    result_len += utf8_encode (NULL, result_wc[i]);
+    result_len += utf8_encode (NULL, xfrm_buf[i]);
 
-  result = g_malloc (result_len + 1);
-  result_len = 0;
+  old_len = result->len;
+  g_string_set_size (result, old_len + result_len);
+  result_len = old_len;
   for (i = 0; i < xfrm_len; i++)
-    result_len += utf8_encode (result + result_len, result_wc[i]);
+    result_len += utf8_encode (result->str + result_len, xfrm_buf[i]);
 
-  result[result_len] = '\0';
+  if (collator)
+    {
+      collator->xfrm_buf = xfrm_buf;
+      collator->xfrm_buf_len = xfrm_buf_len;
+    }
+  else
+    g_free (xfrm_buf);
 
-  g_free (result_wc);
   g_free (str_norm);
 
-  return result;
 #else /* !__STDC_ISO_10646__ */
 
   gsize xfrm_len;
   const gchar *charset;
   gchar *str_norm;
-
-  g_return_val_if_fail (str != NULL, NULL);
+  gsize old_len = result->len;
+  gboolean done = FALSE;
 
   str_norm = g_utf8_normalize (str, len, G_NORMALIZE_ALL_COMPOSE);
 
-  result = NULL;
-
   if (g_get_charset (&charset))
     {
       xfrm_len = strxfrm (NULL, str_norm, 0);
       if (xfrm_len >= 0 && xfrm_len < G_MAXINT - 2)
         {
-          result = g_malloc (xfrm_len + 1);
-          strxfrm (result, str_norm, xfrm_len + 1);
+          g_string_set_size (result, old_len + xfrm_len);
+          strxfrm (result->str + old_len, str_norm, xfrm_len + 1);
+          done = TRUE;
         }
     }
   else
@@ -445,69 +483,92 @@ g_utf8_collate_key (const gchar *str,
 	}
       if (str_locale)
 	{
-	  result = g_malloc (xfrm_len + 2);
-	  result[0] = 'A';
-	  strxfrm (result + 1, str_locale, xfrm_len + 1);
-	  
+	  g_string_set_size (result, old_len + xfrm_len + 1);
+	  result->str[old_len] = 'A';
+	  strxfrm (result->str + old_len + 1, str_locale, xfrm_len + 1);
+	  done = TRUE;
+
 	  g_free (str_locale);
 	}
     }
     
-  if (!result) 
+  if (!done)
     {
-      xfrm_len = strlen (str_norm);
-      result = g_malloc (xfrm_len + 2);
-      result[0] = 'B';
-      memcpy (result + 1, str_norm, xfrm_len);
-      result[xfrm_len+1] = '\0';
+      g_string_append_c (result, 'B');
+      g_string_append (result, str_norm);
     }
 
   g_free (str_norm);
 #endif /* __STDC_ISO_10646__ */
-
-  return result;
 }
-
-/* This is a collation key that is very very likely to sort before any
- * collation key that libc strxfrm generates. We use this before any
- * special case (dot or number) to make sure that its sorted before
- * anything else.
- */
-#define COLLATION_SENTINEL "\1\1\1"
+#endif /* !HAVE_CARBON */
 
 /**
- * g_utf8_collate_key_for_filename:
+ * g_utf8_collate_key:
  * @str: a UTF-8 encoded string.
  * @len: length of @str, in bytes, or -1 if @str is nul-terminated.
  *
  * Converts a string into a collation key that can be compared
- * with other collation keys produced by the same function using strcmp(). 
- * 
- * In order to sort filenames correctly, this function treats the dot '.' 
- * as a special case. Most dictionary orderings seem to consider it
- * insignificant, thus producing the ordering "event.c" "eventgenerator.c"
- * "event.h" instead of "event.c" "event.h" "eventgenerator.c". Also, we
- * would like to treat numbers intelligently so that "file1" "file10" "file5"
- * is sorted as "file1" "file5" "file10".
+ * with other collation keys produced by the same function using 
+ * strcmp(). 
+ *
+ * The results of comparing the collation keys of two strings 
+ * with strcmp() will always be the same as comparing the two 
+ * original keys with g_utf8_collate().
  * 
  * Note that this function depends on the [current locale][setlocale].
  *
+ * To compute many keys, for instance to sort a list, use a
+ * #GUnicodeCollator, which can reuse its buffers between keys.
+ * 
  * Returns: a newly allocated string. This string should
  *   be freed with g_free() when you are done with it.
- *
- * Since: 2.8
- */
+ **/
 gchar *
-g_utf8_collate_key_for_filename (const gchar *str,
-				 gssize       len)
+g_utf8_collate_key (const gchar *str,
+		    gssize       len)
 {
-#ifndef HAVE_CARBON
+#ifdef HAVE_CARBON
+
+  g_return_val_if_fail (str != NULL, NULL);
+
+  return carbon_collate_key (str, len);
+
+#else
+
   GString *result;
-  GString *append;
+
+  g_return_val_if_fail (str != NULL, NULL);
+
+  result = g_string_new (NULL);
+  collate_key_append (NULL, result, str, len);
+
+  return g_string_free (result, FALSE);
+
+#endif
+}
+
+/* This is a collation key that is very very likely to sort before any
+ * collation key that libc strxfrm generates. We use this before any
+ * special case (dot or number) to make sure that its sorted before
+ * anything else.
+ */
+#define COLLATION_SENTINEL "\1\1\1"
+
+#ifndef HAVE_CARBON
+/* Appends the filename collation key of @str to @result, using
+ * @append as scratch space.
+ */
+static void
+collate_key_for_filename_append (GUnicodeCollator *collator,
+                                 GString          *result,
+                                 GString          *append,
+                                 const gchar      *str,
+                                 gssize            len)
+{
   const gchar *p;
   const gchar *prev;
   const gchar *end;
-  gchar *collate_key;
   gint digits;
   gint leading_zeros;
 
@@ -560,9 +621,6 @@ g_utf8_collate_key_for_filename (const gchar *str,
   if (len < 0)
     len = strlen (str);
 
-  result = g_string_sized_new (len * 2);
-  append = g_string_sized_new (0);
-
   end = str + len;
 
   /* No need to use utf8 functions, since we're only looking for ascii chars */
@@ -572,11 +630,7 @@ g_utf8_collate_key_for_filename (const gchar *str,
 	{
 	case '.':
 	  if (prev != p) 
-	    {
-	      collate_key = g_utf8_collate_key (prev, p - prev);
-	      g_string_append (result, collate_key);
-	      g_free (collate_key);
-	    }
+	    collate_key_append (collator, result, prev, p - prev);
 	  
 	  g_string_append (result, COLLATION_SENTINEL "\1");
 	  
@@ -595,11 +649,7 @@ g_utf8_collate_key_for_filename (const gchar *str,
 	case '8':
 	case '9':
 	  if (prev != p) 
-	    {
-	      collate_key = g_utf8_collate_key (prev, p - prev);
-	      g_string_append (result, collate_key);
-	      g_free (collate_key);
-	    }
+	    collate_key_append (collator, result, prev, p - prev);
 	  
 	  g_string_append (result, COLLATION_SENTINEL "\2");
 	  
@@ -663,13 +713,50 @@ g_utf8_collate_key_for_filename (const gchar *str,
     }
   
   if (prev != p) 
-    {
-      collate_key = g_utf8_collate_key (prev, p - prev);
-      g_string_append (result, collate_key);
-      g_free (collate_key);
-    }
+    collate_key_append (collator, result, prev, p - prev);
   
   g_string_append (result, append->str);
+}
+#endif /* !HAVE_CARBON */
+
+/**
+ * g_utf8_collate_key_for_filename:
+ * @str: a UTF-8 encoded string.
+ * @len: length of @str, in bytes, or -1 if @str is nul-terminated.
+ *
+ * Converts a string into a collation key that can be compared
+ * with other collation keys produced by the same function using strcmp(). 
+ * 
+ * In order to sort filenames correctly, this function treats the dot '.' 
+ * as a special case. Most dictionary orderings seem to consider it
+ * insignificant, thus producing the ordering "event.c" "eventgenerator.c"
+ * "event.h" instead of "event.c" "event.h" "eventgenerator.c". Also, we
+ * would like to treat numbers intelligently so that "file1" "file10" "file5"
+ * is sorted as "file1" "file5" "file10".
+ * 
+ * Note that this function depends on the [current locale][setlocale].
+ *
+ * Returns: a newly allocated string. This string should
+ *   be freed with g_free() when you are done with it.
+ *
+ * Since: 2.8
+ */
+gchar *
+g_utf8_collate_key_for_filename (const gchar *str,
+				 gssize       len)
+{
+#ifndef HAVE_CARBON
+  GString *result;
+  GString *append;
+
+  if (len < 0)
+    len = strlen (str);
+
+  result = g_string_sized_new (len * 2);
+  append = g_string_sized_new (0);
+
+  collate_key_for_filename_append (NULL, result, append, str, len);
+
   g_string_free (append, TRUE);
 
   return g_string_free (result, FALSE);
@@ -677,3 +764,227 @@ g_utf8_collate_key_for_filename (const gchar *str,
   return carbon_collate_key_for_filename (str, len);
 #endif
 }
+
+
+/**
+ * GUnicodeCollator:
+ *
+ * An opaque structure that computes collation keys.  Unlike
+ * g_utf8_collate_key(), a collator keeps its working buffers between
+ * keys and can write keys to memory provided by the caller, which
+ * makes it the better choice for computing many keys.
+ *
+ * A #GUnicodeCollator must not be used by more than one thread at a
+ * time.
+ *
+ * Since: 2.44
+ */
+
+typedef struct
+{
+  const gchar *key;
+  const gchar *string;
+  gsize        key_offset;
+} CollateSortItem;
+
+/**
+ * g_unicode_collator_new:
+ * @flags: flags for the collator
+ *
+ * Creates a new #GUnicodeCollator for the [current locale][setlocale].
+ *
+ * The keys it produces are the same as those of g_utf8_collate_key(),
+ * or of g_utf8_collate_key_for_filename() if @flags contains
+ * %G_UNICODE_COLLATOR_FILENAME.  Where the C library allows it, the
+ * collator keeps using the collation rules of the locale that was
+ * current when it was created, even if the locale changes later.
+ *
+ * Returns: a new #GUnicodeCollator.  Free with g_unicode_collator_free().
+ *
+ * Since: 2.44
+ */
+GUnicodeCollator *
+g_unicode_collator_new (GUnicodeCollatorFlags flags)
+{
+  GUnicodeCollator *collator;
+
+  collator = g_slice_new0 (GUnicodeCollator);
+  collator->flags = flags;
+  collator->key = g_string_new (NULL);
+  collator->append = g_string_new (NULL);
+
+#ifdef USE_COLLATOR_LOCALE
+  collator->locale = newlocale (LC_COLLATE_MASK, setlocale (LC_COLLATE, NULL),
+                                (locale_t) 0);
+#endif
+
+  return collator;
+}
+
+/**
+ * g_unicode_collator_free:
+ * @collator: a #GUnicodeCollator
+ *
+ * Frees @collator.
+ *
+ * Since: 2.44
+ */
+void
+g_unicode_collator_free (GUnicodeCollator *collator)
+{
+  g_return_if_fail (collator != NULL);
+
+#ifdef USE_COLLATOR_LOCALE
+  if (collator->locale != (locale_t) 0)
+    freelocale (collator->locale);
+#endif
+#if defined(__STDC_ISO_10646__) && !defined(HAVE_CARBON)
+  g_free (collator->xfrm_buf);
+#endif
+
+  g_string_free (collator->key, TRUE);
+  g_string_free (collator->append, TRUE);
+
+  g_slice_free (GUnicodeCollator, collator);
+}
+
+/* Appends the key of @str to @result, followed by a nul */
+static void
+collator_append_key (GUnicodeCollator *collator,
+                     GString          *result,
+                     const gchar      *str,
+                     gssize            len)
+{
+#ifdef HAVE_CARBON
+  gchar *key;
+
+  if (collator->flags & G_UNICODE_COLLATOR_FILENAME)
+    key = carbon_collate_key_for_filename (str, len);
+  else
+    key = carbon_collate_key (str, len);
+
+  g_string_append (result, key);
+  g_free (key);
+#else
+  if (collator->flags & G_UNICODE_COLLATOR_FILENAME)
+    {
+      g_string_truncate (collator->append, 0);
+      collate_key_for_filename_append (collator, result, collator->append,
+                                       str, len);
+    }
+  else
+    collate_key_append (collator, result, str, len);
+#endif
+
+  g_string_append_c (result, '\0');
+}
+
+/**
+ * g_unicode_collator_get_key:
+ * @collator: a #GUnicodeCollator
+ * @str: a UTF-8 encoded string
+ * @len: length of @str, in bytes, or -1 if @str is nul-terminated
+ * @key: (allow-none): buffer to write the key to
+ * @key_size: size of @key, in bytes
+ *
+ * Computes the collation key of @str.  If the key and its nul
+ * terminator fit in the @key_size bytes at @key, they are written
+ * there; otherwise the contents of @key are unspecified.
+ *
+ * Like strxfrm(), this returns the length of the key so that the
+ * caller can retry with a larger buffer.  Passing a @key_size of 0
+ * only computes the length.  Keys can be compared with strcmp().
+ *
+ * Returns: the length of the key in bytes, not counting the nul
+ *     terminator
+ *
+ * Since: 2.44
+ */
+gsize
+g_unicode_collator_get_key (GUnicodeCollator *collator,
+                            const gchar      *str,
+                            gssize            len,
+                            gchar            *key,
+                            gsize             key_size)
+{
+  gsize key_len;
+
+  g_return_val_if_fail (collator != NULL, 0);
+  g_return_val_if_fail (str != NULL, 0);
+  g_return_val_if_fail (key != NULL || key_size == 0, 0);
+
+  g_string_truncate (collator->key, 0);
+  collator_append_key (collator, collator->key, str, len);
+  key_len = collator->key->len - 1;
+
+  if (key_len < key_size)
+    memcpy (key, collator->key->str, key_len + 1);
+
+  return key_len;
+}
+
+static gint
+compare_sort_items (gconstpointer a,
+                    gconstpointer b,
+                    gpointer      user_data)
+{
+  const CollateSortItem *item_a = a;
+  const CollateSortItem *item_b = b;
+
+  return strcmp (item_a->key, item_b->key);
+}
+
+/**
+ * g_unicode_collator_sort:
+ * @collator: a #GUnicodeCollator
+ * @strings: (array length=n_strings): an array of UTF-8 encoded strings
+ * @n_strings: the number of elements in @strings
+ *
+ * Sorts @strings in place, in the order given by the collation keys
+ * of @collator.  Strings with the same key keep their relative order.
+ *
+ * The key of each string is computed only once, and all keys are
+ * stored together in a single buffer, so this is much faster than
+ * sorting with g_utf8_collate() and cheaper than calling
+ * g_utf8_collate_key() for every string.
+ *
+ * Since: 2.44
+ */
+void
+g_unicode_collator_sort (GUnicodeCollator  *collator,
+                         const gchar      **strings,
+                         gsize              n_strings)
+{
+  CollateSortItem *items;
+  GString *keys;
+  gsize i;
+
+  g_return_if_fail (collator != NULL);
+  g_return_if_fail (strings != NULL || n_strings == 0);
+
+  if (n_strings < 2)
+    return;
+
+  items = g_new (CollateSortItem, n_strings);
+  keys = g_string_sized_new (n_strings * 16);
+
+  for (i = 0; i < n_strings; i++)
+    {
+      items[i].string = strings[i];
+      items[i].key_offset = keys->len;
+      collator_append_key (collator, keys, strings[i], -1);
+    }
+
+  /* Only take pointers once the buffer has stopped moving */
+  for (i = 0; i < n_strings; i++)
+    items[i].key = keys->str + items[i].key_offset;
+
+  g_qsort_with_data (items, n_strings, sizeof (CollateSortItem),
+                     compare_sort_items, NULL);
+
+  for (i = 0; i < n_strings; i++)
+    strings[i] = items[i].string;
+
+  g_string_free (keys, TRUE);
+  g_free (items);
+}
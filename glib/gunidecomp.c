@@ -44,10 +44,12 @@
 #include "config.h"
 
 #include <stdlib.h>
+#include <string.h>
 
 #include "gunicode.h"
 #include "gunidecomp.h"
 #include "gmem.h"
+#include "gstrfuncs.h"
 #include "gunicomp.h"
 #include "gunicodeprivate.h"
 
@@ -490,6 +492,90 @@ _g_utf8_normalize_wc (const gchar    *str,
   return wc_buffer;
 }
 
+/* Returns %TRUE if the @len bytes at @str are valid UTF-8 that is
+ * already in the normal form for @mode, so that normalizing it would
+ * give back the same bytes.  Like the NFC_QC property of the Unicode
+ * standard this can answer "maybe", by returning %FALSE for some text
+ * that is normalized; that text goes through the full
+ * decompose/reorder/compose pipeline.
+ *
+ * For the decomposed forms the check is exact: no character may have
+ * a decomposition and the combining marks must be in canonical order.
+ * For the composed forms we only accept characters below U+0300, which
+ * covers ASCII and Latin-1.  None of them has a combining class, can be
+ * the second character of a composition or is excluded from
+ * composition, so they are stable unless followed by a combining mark,
+ * which sends us to the slow path anyway.
+ */
+static gboolean
+normalize_quick_check (const gchar    *str,
+                       gsize           len,
+                       GNormalizeMode  mode)
+{
+  const guint64 high_bits = G_GUINT64_CONSTANT (0x8080808080808080);
+  gboolean do_compat = (mode == G_NORMALIZE_NFKC ||
+			mode == G_NORMALIZE_NFKD);
+  gboolean do_compose = (mode == G_NORMALIZE_NFC ||
+			 mode == G_NORMALIZE_NFKC);
+  const gchar *p = str;
+  const gchar *end = str + len;
+  int last_cc = 0;
+
+  while (p < end)
+    {
+      gunichar wc;
+      guint64 word;
+
+      if ((guchar) *p < 0x80)
+        {
+          p++;
+          last_cc = 0;
+
+          /* ASCII runs are always normalized; skip them a word at a time */
+          while (end - p >= 8)
+            {
+              memcpy (&word, p, 8);
+              if (word & high_bits)
+                break;
+              p += 8;
+            }
+
+          continue;
+        }
+
+      wc = g_utf8_get_char_validated (p, end - p);
+      if (wc == (gunichar) -1 || wc == (gunichar) -2)
+        return FALSE;
+
+      if (do_compose)
+        {
+          if (wc >= 0x300)
+            return FALSE;
+
+          if (do_compat &&
+              find_decomposition (wc, TRUE) != find_decomposition (wc, FALSE))
+            return FALSE;
+        }
+      else
+        {
+          int cc;
+
+          if ((wc >= SBase && wc < SBase + SCount) ||
+              find_decomposition (wc, do_compat) != NULL)
+            return FALSE;
+
+          cc = COMBINING_CLASS (wc);
+          if (cc != 0 && cc < last_cc)
+            return FALSE;
+          last_cc = cc;
+        }
+
+      p = g_utf8_next_char (p);
+    }
+
+  return TRUE;
+}
+
 /**
  * g_utf8_normalize:
  * @str: a UTF-8 encoded string.
@@ -531,9 +617,22 @@ g_utf8_normalize (const gchar    *str,
 		  gssize          len,
 		  GNormalizeMode  mode)
 {
-  gunichar *result_wc = _g_utf8_normalize_wc (str, len, mode);
+  gunichar *result_wc;
   gchar *result;
+  gsize n;
+
+  if (len < 0)
+    n = strlen (str);
+  else
+    {
+      const gchar *nul = memchr (str, '\0', len);
+      n = nul ? (gsize) (nul - str) : (gsize) len;
+    }
+
+  if (normalize_quick_check (str, n, mode))
+    return g_strndup (str, n);
 
+  result_wc = _g_utf8_normalize_wc (str, len, mode);
   result = g_ucs4_to_utf8 (result_wc, -1, NULL, NULL, NULL);
   g_free (result_wc);
 
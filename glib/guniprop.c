@@ -26,6 +26,7 @@
 
 #include "gmem.h"
 #include "gstring.h"
+#include "gstrfuncs.h"
 #include "gtestutils.h"
 #include "gtypes.h"
 #include "gunicode.h"
@@ -748,6 +749,49 @@ output_special_case (gchar *out_buffer,
   return len;
 }
 
+/* Returns the number of bytes in @str before the first nul, looking
+ * at no more than @max_len bytes if it is not negative.
+ */
+static gsize
+utf8_byte_length (const gchar *str,
+                  gssize       max_len)
+{
+  const gchar *nul;
+
+  if (max_len < 0)
+    return strlen (str);
+
+  nul = memchr (str, '\0', max_len);
+
+  return nul ? nul - str : max_len;
+}
+
+/* Returns the length of the run of ASCII characters at the start of
+ * the @len bytes at @str, checking a word at a time.
+ */
+static gsize
+ascii_prefix_length (const gchar *str,
+                     gsize        len)
+{
+  const guint64 high_bits = G_GUINT64_CONSTANT (0x8080808080808080);
+  const gchar *p = str;
+  const gchar *end = str + len;
+  guint64 word;
+
+  while (end - p >= 8)
+    {
+      memcpy (&word, p, 8);
+      if (word & high_bits)
+        break;
+      p += 8;
+    }
+
+  while (p < end && (guchar) *p < 0x80)
+    p++;
+
+  return p - str;
+}
+
 static gsize
 real_toupper (const gchar *str,
 	      gssize       max_len,
@@ -761,10 +805,21 @@ real_toupper (const gchar *str,
 
   while ((max_len < 0 || p < str + max_len) && *p)
     {
-      gunichar c = g_utf8_get_char (p);
-      int t = TYPE (c);
+      gunichar c;
+      int t;
       gunichar val;
 
+      if (locale_type == LOCALE_NORMAL && (guchar) *p < 0x80)
+        {
+          if (out_buffer)
+            out_buffer[len] = g_ascii_toupper (*p);
+          len++;
+          p++;
+          continue;
+        }
+
+      c = g_utf8_get_char (p);
+      t = TYPE (c);
       last = p;
       p = g_utf8_next_char (p);
 
@@ -888,7 +943,16 @@ g_utf8_strup (const gchar *str,
   g_return_val_if_fail (str != NULL, NULL);
 
   locale_type = get_locale_type ();
-  
+
+  /* Pure ASCII needs no tables and maps to the same length */
+  if (locale_type == LOCALE_NORMAL)
+    {
+      gsize n = utf8_byte_length (str, len);
+
+      if (ascii_prefix_length (str, n) == n)
+        return g_ascii_strup (str, n);
+    }
+
   /*
    * We use a two pass approach to keep memory management simple
    */
@@ -934,10 +998,21 @@ real_tolower (const gchar *str,
 
   while ((max_len < 0 || p < str + max_len) && *p)
     {
-      gunichar c = g_utf8_get_char (p);
-      int t = TYPE (c);
+      gunichar c;
+      int t;
       gunichar val;
 
+      if (locale_type == LOCALE_NORMAL && (guchar) *p < 0x80)
+        {
+          if (out_buffer)
+            out_buffer[len] = g_ascii_tolower (*p);
+          len++;
+          p++;
+          continue;
+        }
+
+      c = g_utf8_get_char (p);
+      t = TYPE (c);
       last = p;
       p = g_utf8_next_char (p);
 
@@ -1076,7 +1151,15 @@ g_utf8_strdown (const gchar *str,
   g_return_val_if_fail (str != NULL, NULL);
 
   locale_type = get_locale_type ();
-  
+
+  if (locale_type == LOCALE_NORMAL)
+    {
+      gsize n = utf8_byte_length (str, len);
+
+      if (ascii_prefix_length (str, n) == n)
+        return g_ascii_strdown (str, n);
+    }
+
   /*
    * We use a two pass approach to keep memory management simple
    */
@@ -1114,18 +1197,46 @@ g_utf8_casefold (const gchar *str,
 {
   GString *result;
   const char *p;
+  const char *str_end;
+  gsize n, ascii_len;
 
   g_return_val_if_fail (str != NULL, NULL);
 
-  result = g_string_new (NULL);
+  /* ASCII characters fold to their lowercase form */
+  n = utf8_byte_length (str, len);
+  ascii_len = ascii_prefix_length (str, n);
+  if (ascii_len == n)
+    return g_ascii_strdown (str, n);
+
+  result = g_string_sized_new (n);
   p = str;
-  while ((len < 0 || p < str + len) && *p)
+  str_end = str + n;
+  while (p < str_end)
     {
-      gunichar ch = g_utf8_get_char (p);
-
+      gunichar ch;
       int start = 0;
       int end = G_N_ELEMENTS (casefold_table);
 
+      if (ascii_len > 0)
+        {
+          gsize i, old_len = result->len;
+
+          g_string_append_len (result, p, ascii_len);
+          for (i = old_len; i < result->len; i++)
+            result->str[i] = g_ascii_tolower (result->str[i]);
+          p += ascii_len;
+          ascii_len = 0;
+          continue;
+        }
+
+      if ((guchar) *p < 0x80)
+        {
+          ascii_len = ascii_prefix_length (p, str_end - p);
+          continue;
+        }
+
+      ch = g_utf8_get_char (p);
+
       if (ch >= casefold_table[start].ch &&
           ch <= casefold_table[end - 1].ch)
 	{
@@ -1557,27 +1557,26 @@ unicode_unescape (const gchar  *src,
   return TRUE;
 }
 
-static AST *
-string_parse (TokenStream  *stream,
-              va_list      *app,
-              GError      **error)
+/* < private >
+ * string_unescape:
+ * @token: a quoted string token, including the quotes
+ * @ref: the location of @token, for error reporting
+ * @error: a pointer to a %NULL #GError pointer, or %NULL
+ *
+ * Removes the quotes from @token and expands any escape sequences.
+ *
+ * Returns: a newly allocated string, or %NULL on error
+ */
+static gchar *
+string_unescape (const gchar  *token,
+                 SourceRef    *ref,
+                 GError      **error)
 {
-  static const ASTClass string_class = {
-    string_get_pattern,
-    maybe_wrapper, string_get_value,
-    string_free
-  };
-  String *string;
-  SourceRef ref;
-  gchar *token;
   gsize length;
   gchar quote;
   gchar *str;
   gint i, j;
 
-  token_stream_start_ref (stream, &ref);
-  token = token_stream_get (stream);
-  token_stream_end_ref (stream, &ref);
   length = strlen (token);
   quote = token[0];
 
@@ -1589,10 +1588,9 @@ string_parse (TokenStream  *stream,
     switch (token[i])
       {
       case '\0':
-        parser_set_error (error, &ref, NULL,
+        parser_set_error (error, ref, NULL,
                           G_VARIANT_PARSE_ERROR_UNTERMINATED_STRING_CONSTANT,
                           "unterminated string constant");
-        g_free (token);
         g_free (str);
         return NULL;
 
@@ -1600,26 +1598,23 @@ string_parse (TokenStream  *stream,
         switch (token[++i])
           {
           case '\0':
-            parser_set_error (error, &ref, NULL,
+            parser_set_error (error, ref, NULL,
                               G_VARIANT_PARSE_ERROR_UNTERMINATED_STRING_CONSTANT,
                               "unterminated string constant");
-            g_free (token);
             g_free (str);
             return NULL;
 
           case 'u':
-            if (!unicode_unescape (token, &i, str, &j, 4, &ref, error))
+            if (!unicode_unescape (token, &i, str, &j, 4, ref, error))
               {
-                g_free (token);
                 g_free (str);
                 return NULL;
               }
             continue;
 
           case 'U':
-            if (!unicode_unescape (token, &i, str, &j, 8, &ref, error))
+            if (!unicode_unescape (token, &i, str, &j, 8, ref, error))
               {
-                g_free (token);
                 g_free (str);
                 return NULL;
               }
@@ -1639,8 +1634,35 @@ string_parse (TokenStream  *stream,
         str[j++] = token[i++];
       }
   str[j++] = '\0';
+
+  return str;
+}
+
+static AST *
+string_parse (TokenStream  *stream,
+              va_list      *app,
+              GError      **error)
+{
+  static const ASTClass string_class = {
+    string_get_pattern,
+    maybe_wrapper, string_get_value,
+    string_free
+  };
+  String *string;
+  SourceRef ref;
+  gchar *token;
+  gchar *str;
+
+  token_stream_start_ref (stream, &ref);
+  token = token_stream_get (stream);
+  token_stream_end_ref (stream, &ref);
+
+  str = string_unescape (token, &ref, error);
   g_free (token);
 
+  if (str == NULL)
+    return NULL;
+
   string = g_slice_new (String);
   string->ast.class = &string_class;
   string->string = str;
@@ -2315,6 +2337,513 @@ parse (TokenStream  *stream,
   return result;
 }
 
+/*
+ * Fast path for known types.
+ *
+ * When the caller gives a definite type, most text (and in particular
+ * the large, mechanically-generated text produced by g_variant_print())
+ * can be parsed in a single pass, without building an AST or doing any
+ * type inference.  The functions below walk the same token stream as
+ * the full parser but construct the values directly, using
+ * GVariantBuilder for containers.
+ *
+ * They only handle the common subset of the language: numbers in plain
+ * decimal notation, booleans, strings, arrays, dictionaries and tuples.
+ * Anything else (maybes, variants, type annotations, bytestrings, ...)
+ * and any kind of error causes them to return %NULL, in which case the
+ * input is parsed again from the start by the full parser.  This keeps
+ * error reporting exactly the same as before.
+ */
+static GVariant *fast_parse (TokenStream        *stream,
+                             const GVariantType *type);
+
+/* Size of the serialised form of a fixed-sized basic type, or 0 */
+static gsize
+fast_fixed_size (gchar type_char)
+{
+  switch (type_char)
+    {
+    case 'b': case 'y':
+      return 1;
+
+    case 'n': case 'q':
+      return 2;
+
+    case 'i': case 'u': case 'h':
+      return 4;
+
+    case 'x': case 't': case 'd':
+      return 8;
+
+    default:
+      return 0;
+    }
+}
+
+/* < private >
+ * fast_parse_fixed:
+ * @stream: a #TokenStream
+ * @type_char: one of the fixed-sized basic types "bynqiuxthd"
+ * @data: location to write the value to, in serialised form
+ *
+ * Parses a boolean or a number into its serialised form (native
+ * endianness, fast_fixed_size() gives the size) so that
+ * arrays of these can be built up without an instance per element.
+ */
+static gboolean
+fast_parse_fixed (TokenStream *stream,
+                  gchar        type_char,
+                  gpointer     data)
+{
+  const gchar *token;
+  gboolean negative;
+  guint64 abs_val;
+  gsize length;
+  gsize i;
+
+  if (type_char == 'b')
+    {
+      if (token_stream_consume (stream, "true"))
+        *(guchar *) data = TRUE;
+      else if (token_stream_consume (stream, "false"))
+        *(guchar *) data = FALSE;
+      else
+        return FALSE;
+
+      return TRUE;
+    }
+
+  if (!token_stream_is_numeric (stream))
+    return FALSE;
+
+  token = stream->this;
+  length = stream->stream - stream->this;
+
+  if (type_char == 'd')
+    {
+      gchar buffer[G_ASCII_DTOSTR_BUF_SIZE];
+      gdouble dbl_val;
+      gchar *end;
+
+      if (length >= sizeof buffer)
+        return FALSE;
+
+      memcpy (buffer, token, length);
+      buffer[length] = '\0';
+
+      errno = 0;
+      dbl_val = g_ascii_strtod (buffer, &end);
+      if ((dbl_val != 0.0 && errno == ERANGE) || *end != '\0')
+        return FALSE;
+
+      *(gdouble *) data = dbl_val;
+      token_stream_next (stream);
+
+      return TRUE;
+    }
+
+  /* only plain decimal: anything with a leading '+' or '0' (which
+   * g_ascii_strtoull() would take as octal or hex) is left to the full
+   * parser.
+   */
+  negative = token[0] == '-';
+  i = negative;
+
+  if (i == length || (token[i] == '0' && i + 1 != length))
+    return FALSE;
+
+  abs_val = 0;
+  for (; i < length; i++)
+    {
+      guint digit;
+
+      if (!g_ascii_isdigit (token[i]))
+        return FALSE;
+
+      digit = token[i] - '0';
+      if (abs_val > (G_MAXUINT64 - digit) / 10)
+        return FALSE;
+
+      abs_val = abs_val * 10 + digit;
+    }
+
+  if (abs_val == 0)
+    negative = FALSE;
+
+  /* same range checks as number_get_value() */
+  switch (type_char)
+    {
+    case 'y':
+      if (negative || abs_val > G_MAXUINT8)
+        return FALSE;
+      *(guchar *) data = abs_val;
+      break;
+
+    case 'n':
+      if (abs_val - negative > G_MAXINT16)
+        return FALSE;
+      *(gint16 *) data = negative ? -abs_val : abs_val;
+      break;
+
+    case 'q':
+      if (negative || abs_val > G_MAXUINT16)
+        return FALSE;
+      *(guint16 *) data = abs_val;
+      break;
+
+    case 'i':
+    case 'h':
+      if (abs_val - negative > G_MAXINT32)
+        return FALSE;
+      *(gint32 *) data = negative ? -abs_val : abs_val;
+      break;
+
+    case 'u':
+      if (negative || abs_val > G_MAXUINT32)
+        return FALSE;
+      *(guint32 *) data = abs_val;
+      break;
+
+    case 'x':
+      if (abs_val - negative > G_MAXINT64)
+        return FALSE;
+      *(gint64 *) data = negative ? -abs_val : abs_val;
+      break;
+
+    case 't':
+      if (negative)
+        return FALSE;
+      *(guint64 *) data = abs_val;
+      break;
+
+    default:
+      g_assert_not_reached ();
+    }
+
+  token_stream_next (stream);
+
+  return TRUE;
+}
+
+static GVariant *
+fast_parse_basic_fixed (TokenStream        *stream,
+                        const GVariantType *type)
+{
+  gchar type_char;
+  guint64 data;
+  GVariant *value;
+  GBytes *bytes;
+
+  type_char = *g_variant_type_peek_string (type);
+
+  if (!fast_parse_fixed (stream, type_char, &data))
+    return NULL;
+
+  bytes = g_bytes_new (&data, fast_fixed_size (type_char));
+  value = g_variant_new_from_bytes (type, bytes, TRUE);
+  g_bytes_unref (bytes);
+
+  return value;
+}
+
+static GVariant *
+fast_parse_string (TokenStream        *stream,
+                   const GVariantType *type)
+{
+  const gchar *token;
+  gsize length;
+  GVariant *value;
+  gchar *str;
+
+  if (!token_stream_peek (stream, '\'') && !token_stream_peek (stream, '"'))
+    return NULL;
+
+  token = stream->this;
+  length = stream->stream - stream->this;
+
+  if (memchr (token, '\\', length) == NULL)
+    {
+      /* without escapes, the token ends at the matching quote */
+      if (length < 2 || token[length - 1] != token[0])
+        return NULL;
+
+      str = g_strndup (token + 1, length - 2);
+    }
+  else
+    {
+      SourceRef ref = { 0, };
+      gchar *copy;
+
+      copy = g_strndup (token, length);
+      str = string_unescape (copy, &ref, NULL);
+      g_free (copy);
+
+      if (str == NULL)
+        return NULL;
+    }
+
+  switch (*g_variant_type_peek_string (type))
+    {
+    case 's':
+      if (!g_utf8_validate (str, -1, NULL))
+        {
+          g_free (str);
+          return NULL;
+        }
+      value = g_variant_new_take_string (str);
+      break;
+
+    case 'o':
+      value = g_variant_is_object_path (str) ?
+              g_variant_new_object_path (str) : NULL;
+      g_free (str);
+      break;
+
+    case 'g':
+      value = g_variant_is_signature (str) ?
+              g_variant_new_signature (str) : NULL;
+      g_free (str);
+      break;
+
+    default:
+      g_assert_not_reached ();
+    }
+
+  if (value != NULL)
+    token_stream_next (stream);
+
+  return value;
+}
+
+static GVariant *
+fast_parse_fixed_array (TokenStream        *stream,
+                        const GVariantType *type)
+{
+  GByteArray *array;
+  GVariant *value;
+  GBytes *bytes;
+  gchar element;
+  gsize size;
+
+  if (!token_stream_consume (stream, "["))
+    return NULL;
+
+  element = *g_variant_type_peek_string (g_variant_type_element (type));
+  size = fast_fixed_size (element);
+  array = g_byte_array_new ();
+
+  if (!token_stream_consume (stream, "]"))
+    while (TRUE)
+      {
+        guint64 data;
+
+        if (!fast_parse_fixed (stream, element, &data))
+          {
+            g_byte_array_unref (array);
+            return NULL;
+          }
+
+        g_byte_array_append (array, (guint8 *) &data, size);
+
+        if (token_stream_consume (stream, "]"))
+          break;
+
+        if (!token_stream_consume (stream, ","))
+          {
+            g_byte_array_unref (array);
+            return NULL;
+          }
+      }
+
+  bytes = g_byte_array_free_to_bytes (array);
+  value = g_variant_new_from_bytes (type, bytes, TRUE);
+  g_bytes_unref (bytes);
+
+  return value;
+}
+
+static GVariant *
+fast_parse_array (TokenStream        *stream,
+                  const GVariantType *type)
+{
+  const GVariantType *element;
+  GVariantBuilder builder;
+  GVariant *child;
+
+  element = g_variant_type_element (type);
+
+  if (fast_fixed_size (*g_variant_type_peek_string (element)))
+    return fast_parse_fixed_array (stream, type);
+
+  g_variant_builder_init (&builder, type);
+
+  if (g_variant_type_is_dict_entry (element))
+    {
+      /* dictionaries, only in the {key: value, ...} form */
+      if (!token_stream_consume (stream, "{"))
+        goto error;
+
+      if (!token_stream_consume (stream, "}"))
+        while (TRUE)
+          {
+            GVariant *key, *value;
+
+            if (!(key = fast_parse (stream, g_variant_type_key (element))))
+              goto error;
+
+            if (!token_stream_consume (stream, ":") ||
+                !(value = fast_parse (stream, g_variant_type_value (element))))
+              {
+                g_variant_unref (g_variant_ref_sink (key));
+                goto error;
+              }
+
+            g_variant_builder_add_value (&builder,
+                                         g_variant_new_dict_entry (key, value));
+
+            if (token_stream_consume (stream, "}"))
+              break;
+
+            if (!token_stream_consume (stream, ","))
+              goto error;
+          }
+    }
+  else
+    {
+      if (!token_stream_consume (stream, "["))
+        goto error;
+
+      if (!token_stream_consume (stream, "]"))
+        while (TRUE)
+          {
+            if (!(child = fast_parse (stream, element)))
+              goto error;
+
+            g_variant_builder_add_value (&builder, child);
+
+            if (token_stream_consume (stream, "]"))
+              break;
+
+            if (!token_stream_consume (stream, ","))
+              goto error;
+          }
+    }
+
+  return g_variant_builder_end (&builder);
+
+ error:
+  g_variant_builder_clear (&builder);
+
+  return NULL;
+}
+
+static GVariant *
+fast_parse_tuple (TokenStream        *stream,
+                  const GVariantType *type)
+{
+  const GVariantType *item;
+  GVariantBuilder builder;
+  GVariant *child;
+
+  if (!token_stream_consume (stream, "("))
+    return NULL;
+
+  g_variant_builder_init (&builder, type);
+
+  /* the first item is always followed by a comma, the rest are
+   * separated by commas (see tuple_parse())
+   */
+  for (item = g_variant_type_first (type); item; item = g_variant_type_next (item))
+    {
+      if (!(child = fast_parse (stream, item)))
+        goto error;
+
+      g_variant_builder_add_value (&builder, child);
+
+      if ((item == g_variant_type_first (type) || g_variant_type_next (item)) &&
+          !token_stream_consume (stream, ","))
+        goto error;
+    }
+
+  if (!token_stream_consume (stream, ")"))
+    goto error;
+
+  return g_variant_builder_end (&builder);
+
+ error:
+  g_variant_builder_clear (&builder);
+
+  return NULL;
+}
+
+static GVariant *
+fast_parse_dict_entry (TokenStream        *stream,
+                       const GVariantType *type)
+{
+  GVariant *key, *value;
+
+  /* only in the {key, value} form */
+  if (!token_stream_consume (stream, "{"))
+    return NULL;
+
+  if (!(key = fast_parse (stream, g_variant_type_key (type))))
+    return NULL;
+
+  if (!token_stream_consume (stream, ",") ||
+      !(value = fast_parse (stream, g_variant_type_value (type))))
+    {
+      g_variant_unref (g_variant_ref_sink (key));
+      return NULL;
+    }
+
+  if (!token_stream_consume (stream, "}"))
+    {
+      g_variant_unref (g_variant_ref_sink (key));
+      g_variant_unref (g_variant_ref_sink (value));
+      return NULL;
+    }
+
+  return g_variant_new_dict_entry (key, value);
+}
+
+static GVariant *
+fast_parse (TokenStream        *stream,
+            const GVariantType *type)
+{
+  switch (*g_variant_type_peek_string (type))
+    {
+    case G_VARIANT_CLASS_ARRAY:
+      return fast_parse_array (stream, type);
+
+    case G_VARIANT_CLASS_TUPLE:
+      return fast_parse_tuple (stream, type);
+
+    case G_VARIANT_CLASS_DICT_ENTRY:
+      return fast_parse_dict_entry (stream, type);
+
+    case G_VARIANT_CLASS_BOOLEAN:
+    case G_VARIANT_CLASS_BYTE:
+    case G_VARIANT_CLASS_INT16:
+    case G_VARIANT_CLASS_UINT16:
+    case G_VARIANT_CLASS_INT32:
+    case G_VARIANT_CLASS_UINT32:
+    case G_VARIANT_CLASS_INT64:
+    case G_VARIANT_CLASS_UINT64:
+    case G_VARIANT_CLASS_HANDLE:
+    case G_VARIANT_CLASS_DOUBLE:
+      return fast_parse_basic_fixed (stream, type);
+
+    case G_VARIANT_CLASS_STRING:
+    case G_VARIANT_CLASS_OBJECT_PATH:
+    case G_VARIANT_CLASS_SIGNATURE:
+      return fast_parse_string (stream, type);
+
+    default:
+      /* maybes and variants need the full parser */
+      return NULL;
+    }
+}
+
 /**
  * g_variant_parse:
  * @type: (allow-none): a #GVariantType, or %NULL
@@ -2343,7 +2872,8 @@ parse (TokenStream  *stream,
  * type.  This may result in additional parse errors (in the case that
  * the parsed value doesn't fit the type) but may also result in fewer
  * errors (in the case that the type would have been ambiguous, such as
- * with empty arrays).
+ * with empty arrays).  Giving a definite @type also allows large inputs
+ * to be parsed considerably faster.
  *
  * In the event that the parsing is successful, the resulting #GVariant
  * is returned.
@@ -2374,6 +2904,35 @@ g_variant_parse (const GVariantType  *type,
   stream.stream = text;
   stream.end = limit;
 
+  if (type != NULL && g_variant_type_is_definite (type))
+    {
+      result = fast_parse (&stream, type);
+
+      if (result != NULL)
+        {
+          g_variant_ref_sink (result);
+
+          if (endptr != NULL)
+            {
+              *endptr = stream.stream;
+              return result;
+            }
+
+          while (stream.stream != limit && g_ascii_isspace (*stream.stream))
+            stream.stream++;
+
+          if (stream.stream == limit || *stream.stream == '\0')
+            return result;
+
+          /* let the full parser report the trailing garbage */
+          g_variant_unref (result);
+          result = NULL;
+        }
+
+      stream.stream = text;
+      stream.this = NULL;
+    }
+
   if ((ast = parse (&stream, NULL, error)))
     {
       if (type == NULL)
@@ -1440,8 +1440,127 @@ g_variant_serialiser_needed_size (GVariantTypeInfo         *type_info,
   g_assert_not_reached ();
 }
 
+/* < private >
+ * g_variant_serialiser_array_size:
+ * @body_size: the size of the (aligned) serialised children
+ * @ends: (allow-none): the end offsets of the children
+ * @n_ends: the number of items in @ends
+ *
+ * Determines the total size of a variable-sized array whose children
+ * have already been written, back to back with the required alignment
+ * padding, into @body_size bytes.  The difference between the result
+ * and @body_size is the space needed for the framing offsets, which can
+ * then be filled in with g_variant_serialiser_write_array_offsets().
+ *
+ * Arrays with fixed-sized elements have no framing offsets and the
+ * total size is always @body_size; pass %NULL for @ends in that case.
+ */
+gsize
+g_variant_serialiser_array_size (gsize        body_size,
+                                 const gsize *ends,
+                                 gsize        n_ends)
+{
+  if (ends == NULL)
+    return body_size;
+
+  return gvs_calculate_total_size (body_size, n_ends);
+}
+
+/* < private >
+ * g_variant_serialiser_write_array_offsets:
+ * @data: the serialised data of a variable-sized array
+ * @size: the total size of @data, from g_variant_serialiser_array_size()
+ * @ends: the end offsets of the children
+ * @n_ends: the number of items in @ends
+ *
+ * Writes the framing offsets of a variable-sized array to the end of
+ * @data.  This is the same encoding produced by
+ * g_variant_serialiser_serialise() and allows arrays to be serialised
+ * incrementally without first collecting the children.
+ */
+void
+g_variant_serialiser_write_array_offsets (guchar      *data,
+                                          gsize        size,
+                                          const gsize *ends,
+                                          gsize        n_ends)
+{
+  guchar *offset_ptr;
+  gsize offset_size;
+  gsize i;
+
+  offset_size = gvs_get_offset_size (size);
+  offset_ptr = data + size - offset_size * n_ends;
+
+  for (i = 0; i < n_ends; i++)
+    {
+      gvs_write_unaligned_le (offset_ptr, ends[i], offset_size);
+      offset_ptr += offset_size;
+    }
+}
+
 /* Byteswapping {{{2 */
 
+/* < private >
+ * gvs_byteswap_fixed_array:
+ * @data: the serialised data of the array
+ * @size: the size of @data
+ * @element_size: the size of each element: 2, 4 or 8
+ *
+ * Byte-swaps an array of fixed-sized numbers in a single pass over the
+ * data.  This is used in place of visiting each child individually,
+ * which would cost a typeinfo ref/unref per element.  The loops are
+ * simple enough to be vectorised by the compiler.
+ *
+ * If @size is not a multiple of @element_size then the array has no
+ * children (see gvs_fixed_sized_array_n_children()) and nothing is
+ * done.
+ */
+static void
+gvs_byteswap_fixed_array (guchar *data,
+                          gsize   size,
+                          gsize   element_size)
+{
+  gsize n_elements, i;
+
+  if (size % element_size)
+    return;
+
+  n_elements = size / element_size;
+
+  switch (element_size)
+    {
+    case 2:
+      {
+        guint16 *ptr = (guint16 *) data;
+
+        for (i = 0; i < n_elements; i++)
+          ptr[i] = GUINT16_SWAP_LE_BE (ptr[i]);
+      }
+      break;
+
+    case 4:
+      {
+        guint32 *ptr = (guint32 *) data;
+
+        for (i = 0; i < n_elements; i++)
+          ptr[i] = GUINT32_SWAP_LE_BE (ptr[i]);
+      }
+      break;
+
+    case 8:
+      {
+        guint64 *ptr = (guint64 *) data;
+
+        for (i = 0; i < n_elements; i++)
+          ptr[i] = GUINT64_SWAP_LE_BE (ptr[i]);
+      }
+      break;
+
+    default:
+      g_assert_not_reached ();
+    }
+}
+
 /* < private >
  * g_variant_serialised_byteswap:
  * @value: a #GVariantSerialised
@@ -1454,6 +1573,7 @@ g_variant_serialised_byteswap (GVariantSerialised serialised)
 {
   gsize fixed_size;
   guint alignment;
+  gsize children, i;
 
   g_variant_serialised_check (serialised);
 
@@ -1508,23 +1628,39 @@ g_variant_serialised_byteswap (GVariantSerialised serialised)
       }
     }
 
-  /* else, we have a container that potentially contains
-   * some children that need to be byteswapped.
+  /* arrays of fixed-sized numbers (eg: 'an', 'at', 'ad') are just a
+   * contiguous run of integers, so swap them all in one go.
    */
-  else
+  if (g_variant_type_info_get_type_char (serialised.type_info) ==
+      G_VARIANT_TYPE_INFO_CHAR_ARRAY)
     {
-      gsize children, i;
+      gsize element_fixed_size;
+      guint element_alignment;
 
-      children = g_variant_serialised_n_children (serialised);
-      for (i = 0; i < children; i++)
-        {
-          GVariantSerialised child;
+      g_variant_type_info_query_element (serialised.type_info,
+                                         &element_alignment,
+                                         &element_fixed_size);
 
-          child = g_variant_serialised_get_child (serialised, i);
-          g_variant_serialised_byteswap (child);
-          g_variant_type_info_unref (child.type_info);
+      if (element_alignment + 1 == element_fixed_size)
+        {
+          gvs_byteswap_fixed_array (serialised.data, serialised.size,
+                                    element_fixed_size);
+          return;
         }
     }
+
+  /* else, we have a container that potentially contains
+   * some children that need to be byteswapped.
+   */
+  children = g_variant_serialised_n_children (serialised);
+  for (i = 0; i < children; i++)
+    {
+      GVariantSerialised child;
+
+      child = g_variant_serialised_get_child (serialised, i);
+      g_variant_serialised_byteswap (child);
+      g_variant_type_info_unref (child.type_info);
+    }
 }
 
 /* Normal form checking {{{2 */
@@ -53,6 +53,14 @@ void                            g_variant_serialiser_serialise          (GVarian
                                                                          const gpointer           *children,
                                                                          gsize                     n_children);
 
+gsize                           g_variant_serialiser_array_size         (gsize                     body_size,
+                                                                         const gsize              *ends,
+                                                                         gsize                     n_ends);
+void                            g_variant_serialiser_write_array_offsets(guchar                   *data,
+                                                                         gsize                     size,
+                                                                         const gsize              *ends,
+                                                                         gsize                     n_ends);
+
 /* misc */
 GLIB_AVAILABLE_IN_ALL
 gboolean                        g_variant_serialised_is_normal          (GVariantSerialised        value);
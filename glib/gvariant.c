@@ -30,6 +30,7 @@
 #include <glib/gslice.h>
 #include <glib/ghash.h>
 #include <glib/gmem.h>
+#include <glib/garray.h>
 
 #include <string.h>
 
@@ -3124,6 +3125,16 @@ struct stack_builder
    */
   guint trusted : 1;
 
+  /* for definite array types, children are serialised directly into
+   * this buffer as they are added instead of being kept in 'children'.
+   * 'ends' records the end offset of each child when the element type
+   * is variable-sized (and is NULL otherwise).
+   */
+  GByteArray *serialised;
+  GArray *ends;
+  gsize element_fixed_size;
+  guint element_alignment;
+
   gsize magic;
 };
 
@@ -3145,6 +3156,32 @@ struct heap_builder
                                   GVSB(b)->magic == GVSB_MAGIC)
 #define is_valid_heap_builder(b) (GVHB(b)->magic == GVHB_MAGIC)
 
+/*< private >
+ * g_variant_builder_init_serialised:
+ * @builder: a #GVariantBuilder for a definite array type
+ *
+ * Switches @builder to serialised mode: the element type is known in
+ * advance, so each child can be serialised into place as soon as it is
+ * added.  This avoids holding a tree of child #GVariant instances (and
+ * a second pass over them in g_variant_get_data()) for large arrays.
+ */
+static void
+g_variant_builder_init_serialised (struct stack_builder *builder)
+{
+  GVariantTypeInfo *element_info;
+
+  element_info = g_variant_type_info_get (builder->expected_type);
+  g_variant_type_info_query (element_info,
+                             &builder->element_alignment,
+                             &builder->element_fixed_size);
+  g_variant_type_info_unref (element_info);
+
+  builder->serialised = g_byte_array_new ();
+
+  if (builder->element_fixed_size == 0)
+    builder->ends = g_array_new (FALSE, FALSE, sizeof (gsize));
+}
+
 /**
  * g_variant_builder_new:
  * @type: a container type
@@ -3261,8 +3298,16 @@ g_variant_builder_clear (GVariantBuilder *builder)
 
   g_variant_type_free (GVSB(builder)->type);
 
-  for (i = 0; i < GVSB(builder)->offset; i++)
-    g_variant_unref (GVSB(builder)->children[i]);
+  if (GVSB(builder)->serialised)
+    g_byte_array_unref (GVSB(builder)->serialised);
+
+  if (GVSB(builder)->ends)
+    g_array_unref (GVSB(builder)->ends);
+
+  /* in serialised mode there are no children to release */
+  if (GVSB(builder)->children)
+    for (i = 0; i < GVSB(builder)->offset; i++)
+      g_variant_unref (GVSB(builder)->children[i]);
 
   g_free (GVSB(builder)->children);
 
@@ -3342,6 +3387,12 @@ g_variant_builder_init (GVariantBuilder    *builder,
         g_variant_type_element (GVSB(builder)->type);
       GVSB(builder)->min_items = 0;
       GVSB(builder)->max_items = -1;
+
+      if (g_variant_type_is_definite (type))
+        {
+          g_variant_builder_init_serialised (GVSB(builder));
+          GVSB(builder)->allocated_children = 0;
+        }
       break;
 
     case G_VARIANT_CLASS_MAYBE:
@@ -3398,6 +3449,91 @@ g_variant_builder_make_room (struct stack_builder *builder)
     }
 }
 
+/*< private >
+ * g_variant_builder_append_serialised:
+ * @builder: a #GVariantBuilder in serialised mode
+ * @value: a #GVariant of the element type of the array
+ *
+ * Writes the serialised form of @value (with any alignment padding
+ * that is needed in front of it) to the end of the buffer of @builder
+ * and records its end offset if the array needs framing offsets.
+ *
+ * @value is consumed: no reference to it is held after this call.
+ */
+static void
+g_variant_builder_append_serialised (struct stack_builder *builder,
+                                     GVariant             *value)
+{
+  gsize start, offset, size;
+
+  g_variant_ref_sink (value);
+
+  start = builder->serialised->len;
+  offset = (start + builder->element_alignment) &
+           ~(gsize) builder->element_alignment;
+  size = g_variant_get_size (value);
+
+  g_byte_array_set_size (builder->serialised, offset + size);
+  memset (builder->serialised->data + start, 0, offset - start);
+  g_variant_store (value, builder->serialised->data + offset);
+
+  if (builder->ends)
+    {
+      gsize end = offset + size;
+
+      g_array_append_val (builder->ends, end);
+    }
+
+  g_variant_unref (value);
+}
+
+/*< private >
+ * g_variant_builder_end_serialised:
+ * @builder: a #GVariantBuilder in serialised mode
+ * @type: the type of the array
+ *
+ * Appends the framing offsets (if any) to the data collected by
+ * g_variant_builder_append_serialised() and wraps it up as a
+ * serialised #GVariant without copying.
+ *
+ * Returns: (transfer none): a new floating #GVariant of type @type
+ */
+static GVariant *
+g_variant_builder_end_serialised (struct stack_builder *builder,
+                                  const GVariantType   *type)
+{
+  const gsize *ends = NULL;
+  gsize n_ends = 0;
+  gsize body_size;
+  gsize size;
+  GVariant *value;
+  GBytes *bytes;
+
+  if (builder->ends)
+    {
+      ends = (const gsize *) builder->ends->data;
+      n_ends = builder->ends->len;
+    }
+
+  body_size = builder->serialised->len;
+  size = g_variant_serialiser_array_size (body_size, ends, n_ends);
+
+  if (size != body_size)
+    {
+      g_byte_array_set_size (builder->serialised, size);
+      g_variant_serialiser_write_array_offsets (builder->serialised->data,
+                                                size, ends, n_ends);
+    }
+
+  bytes = g_byte_array_free_to_bytes (builder->serialised);
+  builder->serialised = NULL;
+
+  value = g_variant_new_from_bytes (type, bytes, builder->trusted);
+  g_bytes_unref (bytes);
+
+  return value;
+}
+
 /**
  * g_variant_builder_add_value:
  * @builder: a #GVariantBuilder
@@ -3442,6 +3578,16 @@ g_variant_builder_add_value (GVariantBuilder *builder,
         GVSB(builder)->prev_item_type =
           g_variant_type_next (GVSB(builder)->prev_item_type);
     }
+  else if (GVSB(builder)->serialised)
+    {
+      /* the child is not kept, so don't point into its type.  the
+       * array type is definite, so this is exactly the same type.
+       */
+      GVSB(builder)->prev_item_type = GVSB(builder)->expected_type;
+      g_variant_builder_append_serialised (GVSB(builder), value);
+      GVSB(builder)->offset++;
+      return;
+    }
   else
     GVSB(builder)->prev_item_type = g_variant_get_type (value);
 
@@ -3609,13 +3755,18 @@ g_variant_builder_end (GVariantBuilder *builder)
   else
     g_assert_not_reached ();
 
-  value = g_variant_new_from_children (my_type,
-                                       g_renew (GVariant *,
-                                                GVSB(builder)->children,
-                                                GVSB(builder)->offset),
-                                       GVSB(builder)->offset,
-                                       GVSB(builder)->trusted);
-  GVSB(builder)->children = NULL;
+  if (GVSB(builder)->serialised)
+    value = g_variant_builder_end_serialised (GVSB(builder), my_type);
+  else
+    {
+      value = g_variant_new_from_children (my_type,
+                                           g_renew (GVariant *,
+                                                    GVSB(builder)->children,
+                                                    GVSB(builder)->offset),
+                                           GVSB(builder)->offset,
+                                           GVSB(builder)->trusted);
+      GVSB(builder)->children = NULL;
+    }
   GVSB(builder)->offset = 0;
 
   g_variant_builder_clear (builder);
@@ -27,6 +27,8 @@
 #include <glib/gslice.h>
 #include <glib/ghash.h>
 
+#include <string.h>
+
 /* < private >
  * GVariantTypeInfo:
  *
@@ -47,6 +49,11 @@
  * container GVariantTypeInfo structures will exist for "(asv)" and
  * for "as" (note that "s" and "v" always exist in the static array).
  *
+ * The exception to this are a handful of very commonly used container
+ * types (such as "as" and "a{sv}").  Once created, these are kept for
+ * the life of the process so that they can be looked up, referenced and
+ * unreferenced without taking the global lock.
+ *
  * The trickiest part of GVariantTypeInfo (and in fact, the major reason
  * for its existence) is the storage of somewhat magical constants that
  * allow for O(1) lookups of items in tuples.  This is described below.
@@ -710,6 +717,47 @@ g_variant_type_info_member_info (GVariantTypeInfo *info,
 static GRecMutex g_variant_type_info_lock;
 static GHashTable *g_variant_type_info_table;
 
+/* Container types that are used so often (D-Bus, GSettings, ...) that
+ * their infos are never freed once created.  Each slot holds one extra
+ * reference that is never dropped, so the refcount of these infos can
+ * never reach zero and they can be used without holding the lock.
+ *
+ * The element types of the arrays are included as well, since they are
+ * kept alive by the array anyway.
+ */
+static const gchar g_variant_type_info_common_types[][6] = {
+  "as", "ay", "av", "ao", "aay", "a{sv}", "{sv}", "a{ss}", "{ss}"
+};
+static GVariantTypeInfo *g_variant_type_info_common_infos[G_N_ELEMENTS (g_variant_type_info_common_types)];
+
+/* < private >
+ * g_variant_type_info_common_index:
+ * @type: a container #GVariantType
+ *
+ * Returns the index of @type in g_variant_type_info_common_types, or
+ * -1 if @type is not one of the common types.
+ */
+static gint
+g_variant_type_info_common_index (const GVariantType *type)
+{
+  const gchar *type_string;
+  gsize length;
+  guint i;
+
+  length = g_variant_type_get_string_length (type);
+  if (length >= sizeof g_variant_type_info_common_types[0])
+    return -1;
+
+  type_string = g_variant_type_peek_string (type);
+
+  for (i = 0; i < G_N_ELEMENTS (g_variant_type_info_common_types); i++)
+    if (g_variant_type_info_common_types[i][length] == '\0' &&
+        memcmp (g_variant_type_info_common_types[i], type_string, length) == 0)
+      return i;
+
+  return -1;
+}
+
 /* < private >
  * g_variant_type_info_get:
  * @type: a #GVariantType
@@ -737,6 +785,18 @@ g_variant_type_info_get (const GVariantType *type)
     {
       GVariantTypeInfo *info;
       gchar *type_string;
+      gint common;
+
+      common = g_variant_type_info_common_index (type);
+
+      if (common >= 0)
+        {
+          info = g_atomic_pointer_get (&g_variant_type_info_common_infos[common]);
+
+          /* common infos are never freed, so no lock is needed */
+          if (info != NULL)
+            return g_variant_type_info_ref (info);
+        }
 
       type_string = g_variant_type_dup_string (type);
 
@@ -771,6 +831,10 @@ g_variant_type_info_get (const GVariantType *type)
       else
         g_variant_type_info_ref (info);
 
+      if (common >= 0 && g_variant_type_info_common_infos[common] == NULL)
+        g_atomic_pointer_set (&g_variant_type_info_common_infos[common],
+                              g_variant_type_info_ref (info));
+
       g_rec_mutex_unlock (&g_variant_type_info_lock);
       g_variant_type_info_check (info, 0);
       g_free (type_string);
@@ -831,6 +895,23 @@ g_variant_type_info_unref (GVariantTypeInfo *info)
   if (info->container_class)
     {
       ContainerInfo *container = (ContainerInfo *) info;
+      gint ref_count;
+
+      /* The lock is only needed if this may be the last reference,
+       * since that is the only case where the info is removed from the
+       * table.  New references can only come from someone already
+       * holding one or from the table (under the lock), so a count
+       * above one can safely be decremented without it.
+       */
+      ref_count = g_atomic_int_get (&container->ref_count);
+      while (ref_count > 1)
+        {
+          if (g_atomic_int_compare_and_exchange (&container->ref_count,
+                                                 ref_count, ref_count - 1))
+            return;
+
+          ref_count = g_atomic_int_get (&container->ref_count);
+        }
 
       g_rec_mutex_lock (&g_variant_type_info_lock);
       if (g_atomic_int_dec_and_test (&container->ref_count))
@@ -863,5 +944,16 @@ g_variant_type_info_unref (GVariantTypeInfo *info)
 void
 g_variant_type_info_assert_no_infos (void)
 {
-  g_assert (g_variant_type_info_table == NULL);
+  guint n_common = 0;
+  guint i;
+
+  /* the common infos are kept forever, so they are allowed to remain */
+  for (i = 0; i < G_N_ELEMENTS (g_variant_type_info_common_infos); i++)
+    if (g_variant_type_info_common_infos[i] != NULL)
+      n_common++;
+
+  if (n_common == 0)
+    g_assert (g_variant_type_info_table == NULL);
+  else
+    g_assert_cmpint (g_hash_table_size (g_variant_type_info_table), ==, n_common);
 }
@@ -331,6 +331,112 @@ test_null (void)
   g_assert (size == 0);
 }
 
+static void
+test_chain (void)
+{
+  const GBytesVector *vectors;
+  GBytesChain *chain;
+  GBytes *head, *body, *empty, *flat;
+  guint n_vectors;
+
+  chain = g_bytes_chain_new ();
+  g_assert_cmpuint (g_bytes_chain_get_size (chain), ==, 0);
+  vectors = g_bytes_chain_get_vectors (chain, &n_vectors);
+  g_assert_cmpuint (n_vectors, ==, 0);
+
+  head = g_bytes_new_static ("head:", 5);
+  body = g_bytes_new_static (NYAN, N_NYAN);
+  empty = g_bytes_new_static (NULL, 0);
+
+  g_bytes_chain_append (chain, head);
+  g_bytes_chain_append (chain, empty);
+  g_bytes_chain_append (chain, body);
+  g_assert_cmpuint (g_bytes_chain_get_size (chain), ==, 5 + N_NYAN);
+
+  /* No copies, and empty GBytes are left out */
+  vectors = g_bytes_chain_get_vectors (chain, &n_vectors);
+  g_assert_cmpuint (n_vectors, ==, 2);
+  g_assert (vectors[0].data == g_bytes_get_data (head, NULL));
+  g_assert_cmpuint (vectors[0].size, ==, 5);
+  g_assert (vectors[1].data == NYAN);
+  g_assert_cmpuint (vectors[1].size, ==, N_NYAN);
+
+  /* Skipping part of the first region only moves the vector */
+  g_bytes_chain_skip (chain, 3);
+  vectors = g_bytes_chain_get_vectors (chain, &n_vectors);
+  g_assert_cmpuint (n_vectors, ==, 2);
+  g_assert (memcmp (vectors[0].data, "d:", 2) == 0);
+  g_assert_cmpuint (vectors[0].size, ==, 2);
+  g_assert_cmpuint (g_bytes_chain_get_size (chain), ==, 2 + N_NYAN);
+
+  /* Flattening copies once, then keeps the result */
+  flat = g_bytes_chain_flatten (chain);
+  g_assert_cmpuint (g_bytes_get_size (flat), ==, 2 + N_NYAN);
+  g_assert (memcmp (g_bytes_get_data (flat, NULL), "d:nyannyan", 2 + N_NYAN) == 0);
+  vectors = g_bytes_chain_get_vectors (chain, &n_vectors);
+  g_assert_cmpuint (n_vectors, ==, 1);
+  g_assert (vectors[0].data == g_bytes_get_data (flat, NULL));
+  g_bytes_unref (flat);
+
+  /* Skip across a region boundary, then flatten without copying */
+  g_bytes_chain_append (chain, body);
+  g_bytes_chain_skip (chain, 2 + N_NYAN + 4);
+  vectors = g_bytes_chain_get_vectors (chain, &n_vectors);
+  g_assert_cmpuint (n_vectors, ==, 1);
+  g_assert (vectors[0].data == NYAN + 4);
+  flat = g_bytes_chain_flatten (chain);
+  g_assert (g_bytes_get_data (flat, NULL) == NYAN + 4);
+  g_assert_cmpuint (g_bytes_get_size (flat), ==, 4);
+  g_bytes_unref (flat);
+
+  g_bytes_chain_skip (chain, 4);
+  g_assert_cmpuint (g_bytes_chain_get_size (chain), ==, 0);
+  vectors = g_bytes_chain_get_vectors (chain, &n_vectors);
+  g_assert_cmpuint (n_vectors, ==, 0);
+  flat = g_bytes_chain_flatten (chain);
+  g_assert_cmpuint (g_bytes_get_size (flat), ==, 0);
+  g_bytes_unref (flat);
+
+  g_bytes_chain_unref (chain);
+  g_bytes_unref (head);
+  g_bytes_unref (body);
+  g_bytes_unref (empty);
+}
+
+static void
+test_pool (void)
+{
+  GBytesPool *pool;
+  GBytes *bytes, *sub;
+  gpointer data, other;
+
+  pool = g_bytes_pool_new (64, 1);
+  g_assert_cmpuint (g_bytes_pool_get_buffer_size (pool), ==, 64);
+
+  data = g_bytes_pool_alloc (pool);
+  memset (data, 'x', 64);
+  bytes = g_bytes_pool_take (pool, data, 10);
+  g_assert (g_bytes_get_data (bytes, NULL) == data);
+  g_assert_cmpuint (g_bytes_get_size (bytes), ==, 10);
+
+  /* The buffer only goes back once the last reference is gone */
+  sub = g_bytes_new_from_bytes (bytes, 2, 4);
+  g_bytes_unref (bytes);
+  other = g_bytes_pool_alloc (pool);
+  g_assert (other != data);
+  g_bytes_unref (sub);
+  g_bytes_pool_release (pool, other);
+
+  /* Only one unused buffer is kept, and it is recycled */
+  other = g_bytes_pool_alloc (pool);
+  g_assert (other == data);
+
+  /* The pool outlives its last reference while buffers are in use */
+  g_bytes_pool_unref (pool);
+  bytes = g_bytes_pool_take (pool, other, 64);
+  g_bytes_unref (bytes);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -353,6 +459,8 @@ main (int argc, char *argv[])
   g_test_add_func ("/bytes/to-array/two-refs", test_to_array_two_refs);
   g_test_add_func ("/bytes/to-array/non-malloc", test_to_array_non_malloc);
   g_test_add_func ("/bytes/null", test_null);
+  g_test_add_func ("/bytes/chain", test_chain);
+  g_test_add_func ("/bytes/pool", test_pool);
 
   return g_test_run ();
 }
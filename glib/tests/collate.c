@@ -103,6 +103,162 @@ test_collate_file (gconstpointer d)
   do_collate (TRUE, TRUE, test);
 }
 
+static void
+test_collator_key (gconstpointer d)
+{
+  const CollateTest *test = d;
+  GUnicodeCollator *collator, *file_collator;
+  gchar buf[256];
+  gchar *key;
+  gsize len;
+  gint i;
+
+  collator = g_unicode_collator_new (G_UNICODE_COLLATOR_NONE);
+  file_collator = g_unicode_collator_new (G_UNICODE_COLLATOR_FILENAME);
+
+  for (i = 0; test->input[i]; i++)
+    {
+      key = g_utf8_collate_key (test->input[i], -1);
+      len = g_unicode_collator_get_key (collator, test->input[i], -1, NULL, 0);
+      g_assert_cmpuint (len, ==, strlen (key));
+      g_assert_cmpuint (len, <, sizeof buf);
+      g_assert_cmpuint (g_unicode_collator_get_key (collator, test->input[i], -1,
+                                                    buf, sizeof buf), ==, len);
+      g_assert_cmpstr (buf, ==, key);
+
+      /* A buffer that is too small is left alone */
+      memset (buf, 'x', sizeof buf);
+      g_assert_cmpuint (g_unicode_collator_get_key (collator, test->input[i], -1,
+                                                    buf, len), ==, len);
+      g_assert (buf[len] == 'x');
+      g_free (key);
+
+      key = g_utf8_collate_key_for_filename (test->input[i], -1);
+      len = g_unicode_collator_get_key (file_collator, test->input[i], -1,
+                                        buf, sizeof buf);
+      g_assert_cmpuint (len, ==, strlen (key));
+      g_assert_cmpstr (buf, ==, key);
+      g_free (key);
+
+      key = g_utf8_collate_key_for_filename (test->input[i], 3);
+      len = g_unicode_collator_get_key (file_collator, test->input[i], 3,
+                                        buf, sizeof buf);
+      g_assert_cmpstr (buf, ==, key);
+      g_free (key);
+    }
+
+  g_unicode_collator_free (collator);
+  g_unicode_collator_free (file_collator);
+}
+
+static void
+check_collator_sort (gboolean           for_file,
+                     const CollateTest *test)
+{
+  GUnicodeCollator *collator;
+  const gchar **strings;
+  gchar *key, *prev_key;
+  gsize n, i;
+
+  collator = g_unicode_collator_new (for_file ? G_UNICODE_COLLATOR_FILENAME
+                                              : G_UNICODE_COLLATOR_NONE);
+
+  n = g_strv_length ((gchar **) test->input);
+  strings = g_memdup (test->input, n * sizeof (gchar *));
+  g_unicode_collator_sort (collator, strings, n);
+
+  /* Whatever the locale, the keys must be in order */
+  prev_key = NULL;
+  for (i = 0; i < n; i++)
+    {
+      if (for_file)
+        key = g_utf8_collate_key_for_filename (strings[i], -1);
+      else
+        key = g_utf8_collate_key (strings[i], -1);
+      if (prev_key)
+        g_assert_cmpint (strcmp (prev_key, key), <=, 0);
+      g_free (prev_key);
+      prev_key = key;
+    }
+  g_free (prev_key);
+
+  if (!missing_locale)
+    {
+      for (i = 0; i < n; i++)
+        {
+          if (for_file)
+            g_assert_cmpstr (strings[i], ==, test->file_sorted[i]);
+          else
+            g_assert_cmpstr (strings[i], ==, test->sorted[i]);
+        }
+    }
+
+  g_free (strings);
+  g_unicode_collator_free (collator);
+}
+
+static void
+test_collator_sort (gconstpointer d)
+{
+  check_collator_sort (FALSE, d);
+  check_collator_sort (TRUE, d);
+}
+
+static void
+test_collator_perf (void)
+{
+  GUnicodeCollator *collator;
+  GPtrArray *names;
+  const gchar **strings;
+  GArray *lines;
+  Line line;
+  GTimer *timer;
+  gdouble keys_time, collator_time;
+  guint i, n = 100000;
+
+  names = g_ptr_array_new_with_free_func (g_free);
+  for (i = 0; i < n; i++)
+    g_ptr_array_add (names, g_strdup_printf ("File %u - Copy (%u).txt",
+                                             g_test_rand_int_range (0, 1000),
+                                             i % 97));
+
+  timer = g_timer_new ();
+
+  lines = g_array_sized_new (FALSE, FALSE, sizeof (Line), n);
+  g_array_set_clear_func (lines, (GDestroyNotify)clear_line);
+  g_timer_start (timer);
+  for (i = 0; i < n; i++)
+    {
+      line.str = names->pdata[i];
+      line.key = g_utf8_collate_key_for_filename (line.str, -1);
+      g_array_append_val (lines, line);
+    }
+  qsort (lines->data, lines->len, sizeof (Line), compare_key);
+  keys_time = g_timer_elapsed (timer, NULL);
+
+  strings = g_memdup (names->pdata, n * sizeof (gchar *));
+  g_timer_start (timer);
+  collator = g_unicode_collator_new (G_UNICODE_COLLATOR_FILENAME);
+  g_unicode_collator_sort (collator, strings, n);
+  g_unicode_collator_free (collator);
+  collator_time = g_timer_elapsed (timer, NULL);
+
+  for (i = 0; i < n; i++)
+    g_assert (strings[i] == g_array_index (lines, Line, i).str ||
+              strcmp (strings[i], g_array_index (lines, Line, i).str) == 0);
+
+  g_test_message ("sorting %u file names with g_utf8_collate_key_for_filename(): %.3f s",
+                  n, keys_time);
+  g_test_minimized_result (collator_time,
+                           "sorting %u file names with g_unicode_collator_sort(): %.3f s",
+                           n, collator_time);
+
+  g_free (strings);
+  g_array_free (lines, TRUE);
+  g_ptr_array_unref (names);
+  g_timer_destroy (timer);
+}
+
 const gchar *input0[] = {
   "z",
   "c",
@@ -288,8 +444,17 @@ main (int argc, char *argv[])
       path = g_strdup_printf ("/unicode/collate-filename/%d", i);
       g_test_add_data_func (path, &test[i], test_collate_file);
       g_free (path);
+      path = g_strdup_printf ("/unicode/collator-key/%d", i);
+      g_test_add_data_func (path, &test[i], test_collator_key);
+      g_free (path);
+      path = g_strdup_printf ("/unicode/collator-sort/%d", i);
+      g_test_add_data_func (path, &test[i], test_collator_sort);
+      g_free (path);
     }
 
+  if (g_test_perf ())
+    g_test_add_func ("/unicode/collator-perf", test_collator_perf);
+
   return g_test_run ();
 }
 
@@ -25,6 +25,7 @@
 #undef G_DISABLE_ASSERT
 #undef G_LOG_DOMAIN
 
+#include <errno.h>
 #include <string.h>
 
 #include <glib.h>
@@ -700,6 +701,165 @@ test_no_conv (void)
   g_error_free (error);
 }
 
+static const gchar *builtin_charsets[] = {
+  "UTF-8", "ISO-8859-1", "UTF-16LE", "UTF-16BE", "UTF-32LE", "UTF-32BE"
+};
+
+static void
+check_builtin_conversion (const gchar *str,
+                          gsize        len,
+                          const gchar *to_codeset,
+                          const gchar *from_codeset)
+{
+  gchar *to_iconv, *from_iconv;
+  gchar *out1, *out2;
+  gsize read1 = 0, read2 = 0, written1 = 0, written2 = 0;
+  GError *error1 = NULL, *error2 = NULL;
+
+  /* The trailing slashes make GLib use iconv() */
+  to_iconv = g_strconcat (to_codeset, "//", NULL);
+  from_iconv = g_strconcat (from_codeset, "//", NULL);
+
+  out1 = g_convert (str, len, to_codeset, from_codeset,
+                    &read1, &written1, &error1);
+  out2 = g_convert (str, len, to_iconv, from_iconv,
+                    &read2, &written2, &error2);
+
+  if (error2 && error2->code == G_CONVERT_ERROR_NO_CONVERSION)
+    {
+      g_clear_error (&error1);
+      g_clear_error (&error2);
+    }
+  else
+    {
+      if (error2)
+        g_assert_error (error1, error2->domain, error2->code);
+      else
+        g_assert_no_error (error1);
+      g_assert_cmpuint (read1, ==, read2);
+      if (!error2)
+        {
+          g_assert_cmpuint (written1, ==, written2);
+          g_assert (memcmp (out1, out2, written1) == 0);
+        }
+      g_clear_error (&error1);
+      g_clear_error (&error2);
+    }
+
+  g_free (out1);
+  g_free (out2);
+  g_free (to_iconv);
+  g_free (from_iconv);
+}
+
+static void
+test_builtin_converters (void)
+{
+#define PIECE(s) { s, sizeof (s) - 1 }
+  static const struct {
+    const gchar *str;
+    gsize        len;
+  } pieces[] = {
+    PIECE ("a"), PIECE ("Hello world "), PIECE ("\xc3\xa9"), PIECE ("\xe2\x82\xac"),
+    PIECE ("\xf0\x9f\x98\x80"), PIECE ("\xc2\x80"), PIECE ("\xef\xbf\xbf"),
+    PIECE ("\xf4\x8f\xbf\xbf"),
+    /* invalid as UTF-8 */
+    PIECE ("\xc0\xaf"), PIECE ("\xed\xa0\x80"), PIECE ("\xf4\x90"),
+    PIECE ("\xff"), PIECE ("\x80"), PIECE ("\xe2\x82"), PIECE ("\xf0\x9f"),
+    /* surrogates in UTF-16 and out of range values in UTF-32 */
+    PIECE ("\x00\xd8"), PIECE ("\xd8\x00"), PIECE ("\x00\xdc"),
+    PIECE ("\x00\x00\x11\x00"), PIECE ("\x00"), PIECE ("\x00\x00")
+  };
+#undef PIECE
+  const gchar *to, *from;
+  GString *str;
+  GIConv cd;
+  gchar buf[3], *in, *out;
+  gsize in_left, out_left;
+  GError *error = NULL;
+  gint i, j, k, n;
+
+  for (n = 0; n < 2000; n++)
+    {
+      str = g_string_new (NULL);
+      k = g_test_rand_int_range (1, 8);
+      for (i = 0; i < k; i++)
+        {
+          j = g_test_rand_int_range (0, G_N_ELEMENTS (pieces));
+          g_string_append_len (str, pieces[j].str, pieces[j].len);
+        }
+
+      to = builtin_charsets[g_test_rand_int_range (0, G_N_ELEMENTS (builtin_charsets))];
+      from = builtin_charsets[g_test_rand_int_range (0, G_N_ELEMENTS (builtin_charsets))];
+      check_builtin_conversion (str->str, str->len, to, from);
+
+      /* Cut anywhere, to get partial characters at the end */
+      check_builtin_conversion (str->str, g_test_rand_int_range (0, str->len + 1), to, from);
+
+      g_string_free (str, TRUE);
+    }
+
+  /* Unlike some iconv() implementations, code points above U+10FFFF
+   * are not accepted as UTF-8
+   */
+  out = g_convert ("a\xf4\x90\x80\x80", -1, "UTF-8", "UTF-8", &in_left, NULL, &error);
+  g_assert_error (error, G_CONVERT_ERROR, G_CONVERT_ERROR_ILLEGAL_SEQUENCE);
+  g_assert_cmpuint (in_left, ==, 1);
+  g_assert (out == NULL);
+  g_clear_error (&error);
+
+  /* Names are matched like iconv does */
+  cd = g_iconv_open ("utf16le", "Latin-1");
+  g_assert (cd != (GIConv) -1);
+
+  /* Output that does not fit stops before the character */
+  in = "\xe9t\xe9";
+  in_left = 3;
+  out = buf;
+  out_left = sizeof buf;
+  g_assert_cmpint (g_iconv (cd, &in, &in_left, &out, &out_left), ==, -1);
+  g_assert_cmpint (errno, ==, E2BIG);
+  g_assert_cmpuint (in_left, ==, 2);
+  g_assert_cmpuint (out_left, ==, 1);
+  g_assert (memcmp (buf, "\xe9\x00", 2) == 0);
+  g_assert_cmpint (g_iconv (cd, NULL, NULL, NULL, NULL), ==, 0);
+
+  g_assert_cmpint (g_iconv_close (cd), ==, 0);
+}
+
+static void
+test_convert_perf (void)
+{
+  const gchar *str = "Some short text, with one \xc3\xa9";
+  gchar *out;
+  GTimer *timer;
+  gdouble elapsed;
+  gint i, n = 200000;
+
+  timer = g_timer_new ();
+
+  for (i = 0; i < n; i++)
+    {
+      out = g_convert (str, -1, "ISO-8859-1", "UTF-8", NULL, NULL, NULL);
+      g_free (out);
+    }
+  elapsed = g_timer_elapsed (timer, NULL);
+  g_test_minimized_result (elapsed * 1e9 / n, "UTF-8 to Latin-1: %.0f ns per string",
+                           elapsed * 1e9 / n);
+
+  g_timer_start (timer);
+  for (i = 0; i < n; i++)
+    {
+      out = g_convert (str, -1, "ISO-8859-15", "UTF-8", NULL, NULL, NULL);
+      g_free (out);
+    }
+  elapsed = g_timer_elapsed (timer, NULL);
+  g_test_minimized_result (elapsed * 1e9 / n, "UTF-8 to ISO-8859-15: %.0f ns per string",
+                           elapsed * 1e9 / n);
+
+  g_timer_destroy (timer);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -712,6 +872,10 @@ main (int argc, char *argv[])
   g_test_add_func ("/conversion/unicode", test_unicode_conversions);
   g_test_add_func ("/conversion/filename-utf8", test_filename_utf8);
   g_test_add_func ("/conversion/filename-display", test_filename_display);
+  g_test_add_func ("/conversion/builtin", test_builtin_converters);
+
+  if (g_test_perf ())
+    g_test_add_func ("/conversion/perf", test_convert_perf);
 
   return g_test_run ();
 }
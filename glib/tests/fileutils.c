@@ -788,6 +788,280 @@ test_set_contents (void)
   g_free (name);
 }
 
+static void
+test_get_bytes (void)
+{
+  GError *error = NULL;
+  GBytes *bytes;
+  gchar *dir;
+  gchar *name;
+  gchar *big;
+  gsize big_len = 3 * 1024 * 1024 + 17;
+  gsize i;
+  gboolean ret;
+
+  dir = g_dir_make_tmp ("fileutils-XXXXXX", &error);
+  g_assert_no_error (error);
+
+  /* Small file, read */
+  name = g_build_filename (dir, "small", NULL);
+  ret = g_file_set_contents (name, "hello", -1, &error);
+  g_assert_no_error (error);
+  g_assert (ret);
+
+  bytes = g_file_get_bytes (name, &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (g_bytes_get_size (bytes), ==, 5);
+  g_assert (memcmp (g_bytes_get_data (bytes, NULL), "hello", 5) == 0);
+  g_bytes_unref (bytes);
+
+  /* Empty file */
+  ret = g_file_set_contents (name, "", 0, &error);
+  g_assert_no_error (error);
+  g_assert (ret);
+
+  bytes = g_file_get_bytes (name, &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (g_bytes_get_size (bytes), ==, 0);
+  g_bytes_unref (bytes);
+  g_remove (name);
+  g_free (name);
+
+  /* Large file, mapped; it stays valid when the file is replaced */
+  big = g_malloc (big_len);
+  for (i = 0; i < big_len; i++)
+    big[i] = i * 7;
+
+  name = g_build_filename (dir, "big", NULL);
+  ret = g_file_set_contents (name, big, big_len, &error);
+  g_assert_no_error (error);
+  g_assert (ret);
+
+  bytes = g_file_get_bytes (name, &error);
+  g_assert_no_error (error);
+  ret = g_file_set_contents (name, "replaced", -1, &error);
+  g_assert_no_error (error);
+  g_assert (ret);
+  g_assert_cmpuint (g_bytes_get_size (bytes), ==, big_len);
+  g_assert (memcmp (g_bytes_get_data (bytes, NULL), big, big_len) == 0);
+  g_bytes_unref (bytes);
+  g_remove (name);
+  g_free (name);
+  g_free (big);
+
+#ifdef G_OS_UNIX
+  /* Not a regular file; fstat() reports no size */
+  if (g_file_test ("/proc/self/stat", G_FILE_TEST_EXISTS))
+    {
+      bytes = g_file_get_bytes ("/proc/self/stat", &error);
+      g_assert_no_error (error);
+      g_assert_cmpuint (g_bytes_get_size (bytes), >, 0);
+      g_bytes_unref (bytes);
+    }
+#endif
+
+  name = g_build_filename (dir, "nonexistent", NULL);
+  bytes = g_file_get_bytes (name, &error);
+  g_assert_error (error, G_FILE_ERROR, G_FILE_ERROR_NOENT);
+  g_assert (bytes == NULL);
+  g_clear_error (&error);
+  g_free (name);
+
+  g_rmdir (dir);
+  g_free (dir);
+}
+
+/* Checks that @dir contains exactly @n_files files */
+static void
+assert_n_files (const gchar *dir,
+                guint        n_files)
+{
+  GDir *d;
+  guint n = 0;
+
+  d = g_dir_open (dir, 0, NULL);
+  g_assert (d != NULL);
+  while (g_dir_read_name (d) != NULL)
+    n++;
+  g_dir_close (d);
+
+  g_assert_cmpuint (n, ==, n_files);
+}
+
+static void
+test_write_batch (gconstpointer data)
+{
+  guint n_files = GPOINTER_TO_UINT (data);
+  GFileWriteBatch *batch;
+  GError *error = NULL;
+  gchar *dir;
+  gchar *name;
+  gchar *contents;
+  gchar *buf;
+  gboolean ret;
+  guint i;
+
+  dir = g_dir_make_tmp ("fileutils-XXXXXX", &error);
+  g_assert_no_error (error);
+
+  /* Half the files exist beforehand */
+  for (i = 0; i < n_files; i += 2)
+    {
+      name = g_strdup_printf ("%s/file%u", dir, i);
+      ret = g_file_set_contents (name, "old", -1, &error);
+      g_assert_no_error (error);
+      g_assert (ret);
+      g_free (name);
+    }
+
+  batch = g_file_write_batch_new ();
+
+  for (i = 0; i < n_files; i++)
+    {
+      name = g_strdup_printf ("%s/file%u", dir, i);
+      contents = g_strdup_printf ("new %u", i);
+      ret = g_file_write_batch_add (batch, name, contents, -1, &error);
+      g_assert_no_error (error);
+      g_assert (ret);
+      g_free (contents);
+      g_free (name);
+    }
+
+  /* Nothing is replaced before committing */
+  name = g_strdup_printf ("%s/file0", dir);
+  ret = g_file_get_contents (name, &buf, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpstr (buf, ==, "old");
+  g_free (buf);
+  g_free (name);
+
+  ret = g_file_write_batch_commit (batch, &error);
+  g_assert_no_error (error);
+  g_assert (ret);
+
+  for (i = 0; i < n_files; i++)
+    {
+      name = g_strdup_printf ("%s/file%u", dir, i);
+      contents = g_strdup_printf ("new %u", i);
+      ret = g_file_get_contents (name, &buf, NULL, &error);
+      g_assert_no_error (error);
+      g_assert_cmpstr (buf, ==, contents);
+      g_free (buf);
+      g_free (contents);
+      g_free (name);
+    }
+
+  /* No temporary files are left behind */
+  assert_n_files (dir, n_files);
+
+  /* Uncommitted contents are dropped on free */
+  name = g_strdup_printf ("%s/file0", dir);
+  ret = g_file_write_batch_add (batch, name, "dropped", -1, &error);
+  g_assert_no_error (error);
+  g_assert (ret);
+  assert_n_files (dir, n_files + 1);
+  g_file_write_batch_free (batch);
+  assert_n_files (dir, n_files);
+
+  ret = g_file_get_contents (name, &buf, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpstr (buf, ==, "new 0");
+  g_free (buf);
+  g_free (name);
+
+  for (i = 0; i < n_files; i++)
+    {
+      name = g_strdup_printf ("%s/file%u", dir, i);
+      g_remove (name);
+      g_free (name);
+    }
+  g_rmdir (dir);
+  g_free (dir);
+}
+
+static void
+test_write_batch_errors (void)
+{
+  GFileWriteBatch *batch;
+  GError *error = NULL;
+  gchar *dir;
+  gchar *name;
+  gchar *buf;
+  gboolean ret;
+
+  dir = g_dir_make_tmp ("fileutils-XXXXXX", &error);
+  g_assert_no_error (error);
+
+  batch = g_file_write_batch_new ();
+
+  name = g_build_filename (dir, "nonexistent", "file", NULL);
+  ret = g_file_write_batch_add (batch, name, "a", -1, &error);
+  g_assert_error (error, G_FILE_ERROR, G_FILE_ERROR_NOENT);
+  g_assert (!ret);
+  g_clear_error (&error);
+  g_free (name);
+
+#ifdef G_OS_UNIX
+  /* Renaming a file over a directory fails; files after it are left
+   * untouched and their temporary files are removed.
+   */
+  name = g_build_filename (dir, "first", NULL);
+  ret = g_file_write_batch_add (batch, name, "first", -1, &error);
+  g_assert_no_error (error);
+  g_assert (ret);
+  g_free (name);
+
+  name = g_build_filename (dir, "subdir", NULL);
+  g_assert_cmpint (g_mkdir (name, 0700), ==, 0);
+  ret = g_file_write_batch_add (batch, name, "a", -1, &error);
+  g_assert_no_error (error);
+  g_assert (ret);
+  g_free (name);
+
+  name = g_build_filename (dir, "last", NULL);
+  ret = g_file_write_batch_add (batch, name, "last", -1, &error);
+  g_assert_no_error (error);
+  g_assert (ret);
+
+  ret = g_file_write_batch_commit (batch, &error);
+  g_assert_error (error, G_FILE_ERROR, G_FILE_ERROR_ISDIR);
+  g_assert (!ret);
+  g_clear_error (&error);
+
+  g_assert (!g_file_test (name, G_FILE_TEST_EXISTS));
+  g_free (name);
+  assert_n_files (dir, 2);
+
+  name = g_build_filename (dir, "first", NULL);
+  ret = g_file_get_contents (name, &buf, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpstr (buf, ==, "first");
+  g_free (buf);
+  g_remove (name);
+  g_free (name);
+
+  name = g_build_filename (dir, "subdir", NULL);
+  g_rmdir (name);
+  g_free (name);
+
+  /* The batch is reusable after a failed commit */
+  name = g_build_filename (dir, "again", NULL);
+  ret = g_file_write_batch_add (batch, name, "again", -1, &error);
+  g_assert_no_error (error);
+  g_assert (ret);
+  ret = g_file_write_batch_commit (batch, &error);
+  g_assert_no_error (error);
+  g_assert (ret);
+  g_remove (name);
+  g_free (name);
+#endif
+
+  g_file_write_batch_free (batch);
+
+  g_rmdir (dir);
+  g_free (dir);
+}
+
 static void
 test_read_link (void)
 {
@@ -919,6 +1193,10 @@ main (int   argc,
   g_test_add_func ("/fileutils/mkstemp", test_mkstemp);
   g_test_add_func ("/fileutils/mkdtemp", test_mkdtemp);
   g_test_add_func ("/fileutils/set-contents", test_set_contents);
+  g_test_add_func ("/fileutils/get-bytes", test_get_bytes);
+  g_test_add_data_func ("/fileutils/write-batch/small", GUINT_TO_POINTER (4), test_write_batch);
+  g_test_add_data_func ("/fileutils/write-batch/large", GUINT_TO_POINTER (40), test_write_batch);
+  g_test_add_func ("/fileutils/write-batch/errors", test_write_batch_errors);
   g_test_add_func ("/fileutils/read-link", test_read_link);
   g_test_add_func ("/fileutils/stdio-wrappers", test_stdio_wrappers);
 
@@ -1313,6 +1313,152 @@ test_strftime (void)
 #endif
 }
 
+static void
+test_formatter (void)
+{
+  const gchar *formats[] = {
+    "a%a A%A b%b B%B c%c C%C d%d e%e F%F g%g G%G h%h H%H I%I j%j m%m M%M "
+    "n%n p%p P%P r%r R%R s%s S%S t%t T%T u%u V%V w%w x%x X%X y%y Y%Y Z%Z %%",
+    "%Y-%m-%dT%H:%M:%S%z",
+    "%:z %::z %:::z",
+    "%-d %_H %0e %-j %_m %Oy %OH",
+    "%k %l %I %P",
+    "plain text",
+    ""
+  };
+  const gchar *zones[] = {
+    "UTC",
+    "EST5EDT,M3.2.0,M11.1.0",
+    "+05:30",
+    "-00:30",
+    "America/Toronto"
+  };
+  gint f, z, i;
+
+  for (f = 0; f < G_N_ELEMENTS (formats); f++)
+    {
+      GDateTimeFormatter *formatter;
+
+      formatter = g_date_time_formatter_new (formats[f]);
+      g_assert (formatter != NULL);
+
+      for (z = 0; z < G_N_ELEMENTS (zones); z++)
+        {
+          GTimeZone *tz = g_time_zone_new (zones[z]);
+          gint64 t = 0;
+
+          for (i = 0; i < 2000; i++)
+            {
+              GDateTime *utc, *dt;
+              gchar buffer[512];
+              gchar *expected;
+              gssize len;
+
+              /* Mix repeated and neighbouring seconds with jumps
+               * anywhere in the range of GDateTime. */
+              if (i % 4 == 0)
+                t = (gint64) g_test_rand_double_range (-62135596800.0, 253402214400.0);
+              else if (i % 4 == 2)
+                t += g_test_rand_int_range (0, 100000);
+
+              utc = g_date_time_new_from_unix_utc (t);
+              dt = g_date_time_to_timezone (utc, tz);
+              expected = g_date_time_format (dt, formats[f]);
+              len = g_date_time_formatter_format_unix (formatter, tz, t, buffer, sizeof buffer);
+
+              g_assert_cmpstr (buffer, ==, expected);
+              g_assert_cmpint (len, ==, strlen (expected));
+
+              g_free (expected);
+              g_date_time_unref (dt);
+              g_date_time_unref (utc);
+            }
+
+          g_time_zone_unref (tz);
+        }
+
+      g_date_time_formatter_free (formatter);
+    }
+}
+
+static void
+test_formatter_errors (void)
+{
+  GDateTimeFormatter *formatter;
+  GTimeZone *tz;
+  gchar buffer[20];
+
+  g_assert (g_date_time_formatter_new ("%Q") == NULL);
+  g_assert (g_date_time_formatter_new ("%:H") == NULL);
+  g_assert (g_date_time_formatter_new ("%::::z") == NULL);
+
+  tz = g_time_zone_new_utc ();
+  formatter = g_date_time_formatter_new ("%F %T");
+
+  g_assert_cmpint (g_date_time_formatter_format_unix (formatter, tz, 0, buffer, sizeof buffer), ==, 19);
+  g_assert_cmpstr (buffer, ==, "1970-01-01 00:00:00");
+
+  /* Too small, with and without the cached result */
+  g_assert_cmpint (g_date_time_formatter_format_unix (formatter, tz, 0, buffer, 19), ==, -1);
+  g_assert_cmpstr (buffer, ==, "");
+  g_assert_cmpint (g_date_time_formatter_format_unix (formatter, tz, 1, buffer, 19), ==, -1);
+  g_assert_cmpstr (buffer, ==, "");
+
+  /* Out of range */
+  g_assert_cmpint (g_date_time_formatter_format_unix (formatter, tz, G_GINT64_CONSTANT (-62135596801), buffer, sizeof buffer), ==, -1);
+  g_assert_cmpint (g_date_time_formatter_format_unix (formatter, tz, G_GINT64_CONSTANT (253402300800), buffer, sizeof buffer), ==, -1);
+  g_assert_cmpint (g_date_time_formatter_format_unix (formatter, tz, G_MININT64, buffer, sizeof buffer), ==, -1);
+  g_assert_cmpint (g_date_time_formatter_format_unix (formatter, tz, G_MAXINT64, buffer, sizeof buffer), ==, -1);
+
+  g_assert_cmpint (g_date_time_formatter_format_unix (formatter, tz, G_GINT64_CONSTANT (253402300799), buffer, sizeof buffer), ==, 19);
+  g_assert_cmpstr (buffer, ==, "9999-12-31 23:59:59");
+
+  g_date_time_formatter_free (formatter);
+  g_time_zone_unref (tz);
+}
+
+static void
+test_formatter_perf (void)
+{
+  GDateTimeFormatter *formatter;
+  GTimeZone *tz;
+  GTimer *timer;
+  gchar buffer[64];
+  gdouble formatter_time, format_time;
+  gint64 t;
+  gint i;
+
+  tz = g_time_zone_new ("EST5EDT,M3.2.0,M11.1.0");
+  formatter = g_date_time_formatter_new ("%Y-%m-%dT%H:%M:%S%z");
+  timer = g_timer_new ();
+
+  /* A log writer sees a few timestamps per second */
+  t = 1400000000;
+  g_timer_start (timer);
+  for (i = 0; i < 1000000; i++)
+    g_date_time_formatter_format_unix (formatter, tz, t + i / 4, buffer, sizeof buffer);
+  formatter_time = g_timer_elapsed (timer, NULL);
+
+  g_timer_start (timer);
+  for (i = 0; i < 1000000; i++)
+    {
+      GDateTime *utc = g_date_time_new_from_unix_utc (t + i / 4);
+      GDateTime *dt = g_date_time_to_timezone (utc, tz);
+      g_free (g_date_time_format (dt, "%Y-%m-%dT%H:%M:%S%z"));
+      g_date_time_unref (dt);
+      g_date_time_unref (utc);
+    }
+  format_time = g_timer_elapsed (timer, NULL);
+
+  g_test_minimized_result (formatter_time * 1000,
+                           "%.0f ns per formatted timestamp (g_date_time_format: %.0f ns)",
+                           formatter_time * 1000, format_time * 1000);
+
+  g_timer_destroy (timer);
+  g_date_time_formatter_free (formatter);
+  g_time_zone_unref (tz);
+}
+
 static void
 test_find_interval (void)
 {
@@ -1385,6 +1531,98 @@ test_adjust_time (void)
   g_time_zone_unref (tz);
 }
 
+static void
+check_interval_lookup (GTimeZone *tz)
+{
+  const gint64 step = 6 * 3600;
+  gint64 u, samples[4096];
+  gint intervals[4096];
+  gint i, prev, n_samples;
+
+  /* Sweep from 1800 to 2300, which also covers times outside the
+   * range of the per-zone year table. */
+  prev = 0;
+  n_samples = 0;
+  for (u = G_GINT64_CONSTANT (-5364662400);
+       u < G_GINT64_CONSTANT (10413792000);
+       u += step)
+    {
+      gint64 u2 = u;
+
+      i = g_time_zone_find_interval (tz, G_TIME_TYPE_UNIVERSAL, u);
+      g_assert_cmpint (i, >=, prev);
+      g_assert_cmpint (g_time_zone_adjust_time (tz, G_TIME_TYPE_UNIVERSAL, &u2), ==, i);
+      g_assert (u2 == u);
+
+      if (i != prev || (u / step) % 499 == 0)
+        {
+          if (n_samples < G_N_ELEMENTS (samples))
+            {
+              samples[n_samples] = u;
+              intervals[n_samples] = i;
+              n_samples++;
+            }
+        }
+
+      prev = i;
+    }
+
+  /* Random order defeats the last-interval hint */
+  for (i = 0; i < 4 * n_samples; i++)
+    {
+      gint j = g_test_rand_int_range (0, n_samples);
+
+      g_assert_cmpint (g_time_zone_find_interval (tz, G_TIME_TYPE_UNIVERSAL, samples[j]), ==, intervals[j]);
+    }
+}
+
+static void
+test_interval_lookup (void)
+{
+  GTimeZone *tz;
+
+  tz = g_time_zone_new ("EST5EDT,M3.2.0,M11.1.0");
+  check_interval_lookup (tz);
+  g_time_zone_unref (tz);
+
+#ifdef G_OS_UNIX
+  tz = g_time_zone_new ("America/Toronto");
+#elif defined G_OS_WIN32
+  tz = g_time_zone_new ("Eastern Standard Time");
+#endif
+  check_interval_lookup (tz);
+  g_time_zone_unref (tz);
+
+  tz = g_time_zone_new ("UTC");
+  check_interval_lookup (tz);
+  g_time_zone_unref (tz);
+}
+
+static void
+test_interval_lookup_perf (void)
+{
+  GTimeZone *tz;
+  GTimer *timer;
+  gint64 u;
+  gint n;
+  gdouble elapsed;
+
+  tz = g_time_zone_new ("EST5EDT,M3.2.0,M11.1.0");
+
+  timer = g_timer_new ();
+  for (n = 0; n < 1000000; n++)
+    {
+      u = g_test_rand_int_range (-1000000000, 2000000000);
+      g_time_zone_find_interval (tz, G_TIME_TYPE_STANDARD, u);
+    }
+  elapsed = g_timer_elapsed (timer, NULL);
+
+  g_test_minimized_result (elapsed * 1000, "%.0f ns per random local time lookup", elapsed * 1000);
+
+  g_timer_destroy (timer);
+  g_time_zone_unref (tz);
+}
+
 static void
 test_no_header (void)
 {
@@ -1627,8 +1865,15 @@ main (gint   argc,
   g_test_add_func ("/GDateTime/dst", test_GDateTime_dst);
   g_test_add_func ("/GDateTime/test_z", test_z);
   g_test_add_func ("/GDateTime/test-all-dates", test_all_dates);
+  g_test_add_func ("/GDateTime/formatter", test_formatter);
+  g_test_add_func ("/GDateTime/formatter-errors", test_formatter_errors);
+  if (g_test_perf ())
+    g_test_add_func ("/GDateTime/formatter-perf", test_formatter_perf);
   g_test_add_func ("/GTimeZone/find-interval", test_find_interval);
   g_test_add_func ("/GTimeZone/adjust-time", test_adjust_time);
+  g_test_add_func ("/GTimeZone/interval-lookup", test_interval_lookup);
+  if (g_test_perf ())
+    g_test_add_func ("/GTimeZone/interval-lookup-perf", test_interval_lookup_perf);
   g_test_add_func ("/GTimeZone/no-header", test_no_header);
   g_test_add_func ("/GTimeZone/posix-parse", test_posix_parse);
 
@@ -3527,6 +3527,107 @@ test_builder_memory (void)
   g_variant_type_info_assert_no_infos ();
 }
 
+static void
+check_builder_serialised (const gchar *type_string,
+                          GVariant   **children,
+                          gsize        n_children)
+{
+  GVariantBuilder builder;
+  GVariant *built, *expected;
+  gsize i;
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE (type_string));
+  for (i = 0; i < n_children; i++)
+    g_variant_builder_add_value (&builder, children[i]);
+  built = g_variant_ref_sink (g_variant_builder_end (&builder));
+
+  expected = g_variant_ref_sink (g_variant_new_array (g_variant_type_element (G_VARIANT_TYPE (type_string)),
+                                                      children, n_children));
+
+  g_assert_cmpstr (g_variant_get_type_string (built), ==, type_string);
+  g_assert_cmpuint (g_variant_n_children (built), ==, n_children);
+  g_assert_cmpuint (g_variant_get_size (built), ==, g_variant_get_size (expected));
+  g_assert (memcmp (g_variant_get_data (built), g_variant_get_data (expected),
+                    g_variant_get_size (built)) == 0);
+  g_assert (g_variant_is_normal_form (built));
+
+  g_variant_unref (expected);
+  g_variant_unref (built);
+}
+
+static void
+test_builder_serialised (void)
+{
+  GVariant *children[1000];
+  GVariantBuilder builder;
+  GVariant *value;
+  gchar *str;
+  gsize n;
+  gsize i;
+
+  /* fixed-sized elements, including padding inside the element */
+  for (i = 0; i < G_N_ELEMENTS (children); i++)
+    children[i] = g_variant_ref_sink (g_variant_new ("(yt)", (guchar) i, (guint64) i * 3));
+  check_builder_serialised ("a(yt)", children, G_N_ELEMENTS (children));
+  for (i = 0; i < G_N_ELEMENTS (children); i++)
+    g_variant_unref (children[i]);
+
+  /* variable-sized elements, with every offset size */
+  for (n = 0; n <= G_N_ELEMENTS (children); n = n ? n * 10 : 1)
+    {
+      for (i = 0; i < n; i++)
+        {
+          str = g_strnfill (i % 100, 'x');
+          children[i] = g_variant_ref_sink (g_variant_new ("(sq)", str, (guint16) i));
+          g_free (str);
+        }
+      check_builder_serialised ("a(sq)", children, n);
+      for (i = 0; i < n; i++)
+        g_variant_unref (children[i]);
+    }
+
+  value = g_variant_ref_sink (g_variant_new_string ("a long string value that will need wide offsets"));
+  for (i = 0; i < 100; i++)
+    children[i] = value;
+  for (i = 0; i < 100; i++)
+    children[100 + i] = g_variant_ref_sink (g_variant_new_array (G_VARIANT_TYPE_STRING, children, i + 1));
+  check_builder_serialised ("aas", children + 100, 100);
+  for (i = 0; i < 100; i++)
+    g_variant_unref (children[100 + i]);
+  g_variant_unref (value);
+
+  /* nested builders, including empty sub-arrays */
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("aa{sv}"));
+  g_variant_builder_open (&builder, G_VARIANT_TYPE ("a{sv}"));
+  g_variant_builder_add (&builder, "{sv}", "one", g_variant_new_int32 (1));
+  g_variant_builder_close (&builder);
+  g_variant_builder_open (&builder, G_VARIANT_TYPE ("a{sv}"));
+  g_variant_builder_close (&builder);
+  value = g_variant_builder_end (&builder);
+  str = g_variant_print (value, FALSE);
+  g_assert_cmpstr (str, ==, "[{'one': <1>}, {}]");
+  g_variant_unref (value);
+  g_free (str);
+
+  /* an untrusted child makes for an untrusted array */
+  value = g_variant_new_from_data (G_VARIANT_TYPE_STRING, "abc", 3, FALSE, NULL, NULL);
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("as"));
+  g_variant_builder_add_value (&builder, value);
+  value = g_variant_builder_end (&builder);
+  g_assert (!g_variant_is_normal_form (value));
+  str = g_variant_print (value, FALSE);
+  g_assert_cmpstr (str, ==, "['']");
+  g_variant_unref (value);
+  g_free (str);
+
+  /* abandoning a partially-built array */
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("as"));
+  g_variant_builder_add (&builder, "s", "some value");
+  g_variant_builder_clear (&builder);
+
+  g_variant_type_info_assert_no_infos ();
+}
+
 static void
 test_hashing (void)
 {
@@ -3647,6 +3748,81 @@ test_gv_byteswap (void)
   g_free (string);
 }
 
+static void
+test_gv_byteswap_fixed_array (void)
+{
+  guint16 data16[1000];
+  guint32 data32[1000];
+  guint64 data64[1000];
+  const guint16 *swapped16;
+  const guint32 *swapped32;
+  const guint64 *swapped64;
+  GVariant *value, *swapped, *restored;
+  gsize n_elements;
+  gsize i;
+
+  for (i = 0; i < G_N_ELEMENTS (data16); i++)
+    {
+      data16[i] = g_test_rand_int ();
+      data32[i] = g_test_rand_int ();
+      data64[i] = ((guint64) g_test_rand_int () << 32) | g_test_rand_int ();
+    }
+
+  value = g_variant_new_fixed_array (G_VARIANT_TYPE_UINT16, data16,
+                                     G_N_ELEMENTS (data16), sizeof (guint16));
+  g_variant_ref_sink (value);
+  swapped = g_variant_byteswap (value);
+  swapped16 = g_variant_get_fixed_array (swapped, &n_elements, sizeof (guint16));
+  g_assert_cmpuint (n_elements, ==, G_N_ELEMENTS (data16));
+  for (i = 0; i < n_elements; i++)
+    g_assert_cmpuint (swapped16[i], ==, GUINT16_SWAP_LE_BE (data16[i]));
+  restored = g_variant_byteswap (swapped);
+  g_assert (g_variant_equal (value, restored));
+  g_variant_unref (restored);
+  g_variant_unref (swapped);
+  g_variant_unref (value);
+
+  value = g_variant_new_fixed_array (G_VARIANT_TYPE_INT32, data32,
+                                     G_N_ELEMENTS (data32), sizeof (guint32));
+  g_variant_ref_sink (value);
+  swapped = g_variant_byteswap (value);
+  swapped32 = g_variant_get_fixed_array (swapped, &n_elements, sizeof (guint32));
+  g_assert_cmpuint (n_elements, ==, G_N_ELEMENTS (data32));
+  for (i = 0; i < n_elements; i++)
+    g_assert_cmpuint (swapped32[i], ==, GUINT32_SWAP_LE_BE (data32[i]));
+  restored = g_variant_byteswap (swapped);
+  g_assert (g_variant_equal (value, restored));
+  g_variant_unref (restored);
+  g_variant_unref (swapped);
+  g_variant_unref (value);
+
+  value = g_variant_new_fixed_array (G_VARIANT_TYPE_UINT64, data64,
+                                     G_N_ELEMENTS (data64), sizeof (guint64));
+  g_variant_ref_sink (value);
+  swapped = g_variant_byteswap (value);
+  swapped64 = g_variant_get_fixed_array (swapped, &n_elements, sizeof (guint64));
+  g_assert_cmpuint (n_elements, ==, G_N_ELEMENTS (data64));
+  for (i = 0; i < n_elements; i++)
+    g_assert_cmpuint (swapped64[i], ==, GUINT64_SWAP_LE_BE (data64[i]));
+  restored = g_variant_byteswap (swapped);
+  g_assert (g_variant_equal (value, restored));
+  g_variant_unref (restored);
+  g_variant_unref (swapped);
+  g_variant_unref (value);
+
+  /* an array of single-item tuples has the same layout */
+  value = g_variant_new_from_data (G_VARIANT_TYPE ("a(u)"), data32,
+                                   sizeof data32, TRUE, NULL, NULL);
+  g_variant_ref_sink (value);
+  swapped = g_variant_byteswap (value);
+  swapped32 = g_variant_get_data (swapped);
+  g_assert_cmpuint (g_variant_get_size (swapped), ==, sizeof data32);
+  for (i = 0; i < G_N_ELEMENTS (data32); i++)
+    g_assert_cmpuint (swapped32[i], ==, GUINT32_SWAP_LE_BE (data32[i]));
+  g_variant_unref (swapped);
+  g_variant_unref (value);
+}
+
 static void
 test_parser (void)
 {
@@ -3792,6 +3968,94 @@ test_parses (void)
   g_variant_type_info_assert_no_infos ();
 }
 
+static void
+test_parse_known_type (void)
+{
+  const gchar *test[] = {
+    "ai",        "[1, -2, 0, 2147483647, -2147483648]", "[1, -2, 0, 2147483647, -2147483648]",
+    "ay",        "[0, 255]",                            "[byte 0x00, 0xff]",
+    "at",        "[18446744073709551615]",              "[uint64 18446744073709551615]",
+    "ad",        "[1, -2.5, 1e10, .5]",                 "[1.0, -2.5, 10000000000.0, 0.5]",
+    "ab",        "[true, false]",                       "[true, false]",
+    "as",        "['a', \"b'\", 'c\\n\\u00e9']",        "['a', \"b'\", 'c\\né']",
+    "ao",        "['/', '/a/b']",                       "[objectpath '/', '/a/b']",
+    "ag",        "['', 'a{sv}']",                       "[signature '', 'a{sv}']",
+    "a{ss}",     "{'a': 'b', 'c': 'd'}",                "{'a': 'b', 'c': 'd'}",
+    "a{ss}",     "{}",                                  "@a{ss} {}",
+    "(iai(s))",  "(1, [], ('x',))",                     "(1, @ai [], ('x',))",
+    "()",        "()",                                  "()",
+    "{sq}",      "{'a', 1}",                            "{'a', uint16 1}",
+    "aa(nq)",    " [ [ (1 , 2) ] , [] ] ",              "[[(int16 1, uint16 2)], []]",
+    /* things that the fast path leaves to the full parser */
+    "ai",        "[0x10, 010, +1]",                     "[16, 8, 1]",
+    "ay",        "b'ab'",                               "b'ab'",
+    "mi",        "just 5",                              "@mi 5",
+    "av",        "[<1>]",                               "[<1>]",
+    "a{ss}",     "[{'a', 'b'}]",                        "{'a': 'b'}",
+    "ad",        "[inf, int32 5]",                      "[inf, 5.0]"
+  };
+  const gchar *failures[] = {
+    "ai",        "[1, 2,]",       "6:",     "expected value",
+    "ai",        "[1 2]",         "3:",     "expected ',' or ']'",
+    "ay",        "[256]",         "1-4:",   "out of range for type",
+    "ai",        "[07758]",       "5-6:",   "invalid character",
+    "(ii)",      "(1 2)",         "3:",     "expected ','",
+    "(ii)",      "(1, 2, 3)",     "0-9:",   "can not parse as",
+    "s",         "'abc",          "0-4:",   "unterminated string",
+    "o",         "'foo'",         "0-5:",   "object path",
+    "a{ss}",     "{'a' 'b'}",     "5:",     "expected ':' or ','",
+    "ai",        "[1, 2] x",      "7:",     "expected end of input"
+  };
+  const gchar *end;
+  GVariant *value;
+  gchar *printed;
+  gint i;
+
+  for (i = 0; i < G_N_ELEMENTS (test); i += 3)
+    {
+      GError *error = NULL;
+
+      value = g_variant_parse (G_VARIANT_TYPE (test[i]), test[i + 1], NULL, NULL, &error);
+      g_assert_no_error (error);
+      g_assert_cmpstr (g_variant_get_type_string (value), ==, test[i]);
+      g_assert (!g_variant_is_floating (value));
+      printed = g_variant_print (value, TRUE);
+      g_assert_cmpstr (printed, ==, test[i + 2]);
+      g_variant_unref (value);
+      g_free (printed);
+    }
+
+  for (i = 0; i < G_N_ELEMENTS (failures); i += 4)
+    {
+      GError *error = NULL;
+
+      value = g_variant_parse (G_VARIANT_TYPE (failures[i]), failures[i + 1], NULL, NULL, &error);
+      g_assert (value == NULL);
+
+      if (!strstr (error->message, failures[i + 3]))
+        g_error ("test %d: Can't find '%s' in '%s'", i / 4,
+                 failures[i + 3], error->message);
+
+      if (!g_str_has_prefix (error->message, failures[i + 2]))
+        g_error ("test %d: Expected location '%s' in '%s'", i / 4,
+                 failures[i + 2], error->message);
+
+      g_error_free (error);
+    }
+
+  /* endptr and limit */
+  value = g_variant_parse (G_VARIANT_TYPE ("ai"), "[1, 2] [3]", NULL, &end, NULL);
+  g_assert_cmpstr (end, ==, " [3]");
+  g_variant_unref (value);
+
+  end = "[1, 2] [3]";
+  value = g_variant_parse (G_VARIANT_TYPE ("ai"), end, end + 7, NULL, NULL);
+  g_assert (value != NULL);
+  g_variant_unref (value);
+  value = g_variant_parse (G_VARIANT_TYPE ("ai"), end, end + 5, NULL, NULL);
+  g_assert (value == NULL);
+}
+
 static void
 test_parse_failures (void)
 {
@@ -4534,6 +4798,75 @@ G_GNUC_BEGIN_IGNORE_DEPRECATIONS
 G_GNUC_END_IGNORE_DEPRECATIONS
 }
 
+static void
+construct_values (gint n_values)
+{
+  const gchar *strv[] = { "one", "two", "three", NULL };
+  gint i;
+
+  for (i = 0; i < n_values; i++)
+    {
+      GVariantBuilder builder;
+      GVariant *value;
+
+      g_variant_builder_init (&builder, G_VARIANT_TYPE_VARDICT);
+      g_variant_builder_add (&builder, "{sv}", "name", g_variant_new_string ("value"));
+      g_variant_builder_add (&builder, "{sv}", "list", g_variant_new_strv (strv, -1));
+      g_variant_builder_add (&builder, "{sv}", "pair", g_variant_new ("(ii)", i, -i));
+      value = g_variant_ref_sink (g_variant_builder_end (&builder));
+      g_assert_cmpuint (g_variant_n_children (value), ==, 3);
+      g_variant_unref (value);
+    }
+}
+
+static gpointer
+construct_thread (gpointer data)
+{
+  construct_values (GPOINTER_TO_INT (data));
+
+  return NULL;
+}
+
+static void
+test_threaded_construction (void)
+{
+  GThread *threads[8];
+  gint i;
+
+  for (i = 0; i < G_N_ELEMENTS (threads); i++)
+    threads[i] = g_thread_new ("construct", construct_thread, GINT_TO_POINTER (10000));
+
+  for (i = 0; i < G_N_ELEMENTS (threads); i++)
+    g_thread_join (threads[i]);
+}
+
+#define CONSTRUCT_COUNT 200000
+
+static void
+test_construction_perf (gconstpointer data)
+{
+  gint n_threads = GPOINTER_TO_INT (data);
+  GThread *threads[64];
+  gint64 start_time;
+  gdouble rate;
+  gint i;
+
+  start_time = g_get_monotonic_time ();
+
+  for (i = 0; i < n_threads - 1; i++)
+    threads[i] = g_thread_new ("construct", construct_thread, GINT_TO_POINTER (CONSTRUCT_COUNT));
+
+  construct_values (CONSTRUCT_COUNT);
+
+  for (i = 0; i < n_threads - 1; i++)
+    g_thread_join (threads[i]);
+
+  rate = g_get_monotonic_time () - start_time;
+  rate = n_threads * (gdouble) CONSTRUCT_COUNT / rate;
+
+  g_test_maximized_result (rate, "%f values/us", rate);
+}
+
 int
 main (int argc, char **argv)
 {
@@ -4569,9 +4902,12 @@ main (int argc, char **argv)
   g_test_add_func ("/gvariant/varargs/subprocess/empty-array", test_varargs_empty_array);
   g_test_add_func ("/gvariant/valist", test_valist);
   g_test_add_func ("/gvariant/builder-memory", test_builder_memory);
+  g_test_add_func ("/gvariant/builder-serialised", test_builder_serialised);
   g_test_add_func ("/gvariant/hashing", test_hashing);
   g_test_add_func ("/gvariant/byteswap", test_gv_byteswap);
+  g_test_add_func ("/gvariant/byteswap/fixed-array", test_gv_byteswap_fixed_array);
   g_test_add_func ("/gvariant/parser", test_parses);
+  g_test_add_func ("/gvariant/parse/known-type", test_parse_known_type);
   g_test_add_func ("/gvariant/parse-failures", test_parse_failures);
   g_test_add_func ("/gvariant/parse-positional", test_parse_positional);
   g_test_add_func ("/gvariant/parse/subprocess/bad-format-char", test_parse_bad_format_char);
@@ -4592,6 +4928,19 @@ main (int argc, char **argv)
   g_test_add_func ("/gvariant/gbytes", test_gbytes);
   g_test_add_func ("/gvariant/print-context", test_print_context);
   g_test_add_func ("/gvariant/error-quark", test_error_quark);
+  g_test_add_func ("/gvariant/threaded-construction", test_threaded_construction);
+
+  if (g_test_perf ())
+    {
+      for (i = 1; i <= 64; i *= 2)
+        {
+          gchar *testname;
+
+          testname = g_strdup_printf ("/gvariant/perf/construction/%d", i);
+          g_test_add_data_func (testname, GINT_TO_POINTER (i), test_construction_perf);
+          g_free (testname);
+        }
+    }
 
   return g_test_run ();
 }
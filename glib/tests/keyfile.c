@@ -1419,6 +1419,62 @@ test_load_fail (void)
   g_key_file_free (file);
 }
 
+/* Changing the file after it was loaded must not affect the keyfile,
+ * not even groups that are only parsed once they are looked up.
+ */
+static void
+test_load_snapshot (void)
+{
+  const gchar *data =
+    "[first]\n"
+    "a=1\n"
+    "[second]\n"
+    "b=2\n"
+    "[third]\n"
+    "c=3\n";
+  GKeyFile *kf;
+  GError *error = NULL;
+  gchar *file, *value;
+  FILE *f;
+  int fd;
+
+  file = g_strdup ("key_file_XXXXXX");
+  fd = g_mkstemp (file);
+  g_assert (fd != -1);
+  g_close (fd, NULL);
+  g_file_set_contents (file, data, -1, &error);
+  g_assert_no_error (error);
+
+  kf = g_key_file_new ();
+  g_key_file_load_from_file (kf, file, G_KEY_FILE_NONE, &error);
+  g_assert_no_error (error);
+
+  /* Rewrite in place, keeping the inode and the size */
+  f = fopen (file, "r+");
+  g_assert (f != NULL);
+  fputs ("[first]\na=7\n[second]\nb=8\n[third]\nc=9\n", f);
+  fclose (f);
+
+  value = g_key_file_get_value (kf, "second", "b", &error);
+  g_assert_no_error (error);
+  g_assert_cmpstr (value, ==, "2");
+  g_free (value);
+
+  /* Truncate it */
+  f = fopen (file, "w");
+  g_assert (f != NULL);
+  fclose (f);
+
+  value = g_key_file_get_value (kf, "third", "c", &error);
+  g_assert_no_error (error);
+  g_assert_cmpstr (value, ==, "3");
+  g_free (value);
+
+  g_key_file_free (kf);
+  g_unlink (file);
+  g_free (file);
+}
+
 static void
 test_non_utf8 (void)
 {
@@ -1635,6 +1691,174 @@ test_roundtrip (void)
   g_key_file_free (kf);
 }
 
+static GKeyFile *
+load_file_contents (const gchar    *data,
+                    GKeyFileFlags   flags,
+                    GError        **error)
+{
+  GKeyFile *kf;
+  gchar *file;
+  gboolean ok;
+  int fd;
+
+  file = g_strdup ("key_file_XXXXXX");
+  fd = g_mkstemp (file);
+  g_assert (fd != -1);
+  g_close (fd, NULL);
+  ok = g_file_set_contents (file, data, -1, NULL);
+  g_assert (ok);
+
+  kf = g_key_file_new ();
+  ok = g_key_file_load_from_file (kf, file, flags, error);
+  g_unlink (file);
+  g_free (file);
+
+  if (!ok)
+    {
+      g_key_file_free (kf);
+      return NULL;
+    }
+
+  return kf;
+}
+
+static void
+test_load_mapped (void)
+{
+  const gchar *data[] = {
+    "# top comment\n"
+    "[first]\n"
+    "Encoding=UTF-8\n"
+    "a=1\n"
+    "\n"
+    "# comment for second\n"
+    "[second]\n"
+    "  b = 2 \n"
+    "b[de]=zwei\n"
+    "b[fr]=deux\n"
+    "# comment for c\n"
+    "c=x==y\n"
+    "[third]\n"
+    "[first]\n"
+    "d=4\n",
+    "[first]\r\n"
+    "a=1\r\n"
+    "\r\n"
+    "[second]\r\n"
+    "b=2\r\r\n"
+    "c=\r\n",
+    "[first]\n"
+    "a=1\n"
+    "[second]\n"
+    "b=2\n"
+    "[second]\n"
+    "c=3",
+    "[first]\n"
+    "[second]\n"
+    "b=2\n"
+    "b=3\n"
+    "[third]\n"
+    "c=3",
+  };
+  const gchar *invalid[] = {
+    "[first]\n"
+    "[second]\n"
+    "a=1\n"
+    "this is not a key\n",
+    "[first]\n"
+    "[second]\n"
+    "a=1\n"
+    " b[=1\n",
+    "[first]\n"
+    "[second]\n"
+    "a=1\n"
+    "[third\n",
+    "[first]\n"
+    "[second]\n"
+    "a=1\n"
+    "=b",
+  };
+  GKeyFileFlags flags[] = {
+    G_KEY_FILE_NONE,
+    G_KEY_FILE_KEEP_COMMENTS | G_KEY_FILE_KEEP_TRANSLATIONS,
+  };
+  GKeyFile *kf, *expected;
+  GError *error = NULL;
+  gchar *str, *expected_str;
+  gchar **keys;
+  gsize i, j, n_keys;
+
+  for (i = 0; i < G_N_ELEMENTS (data); i++)
+    for (j = 0; j < G_N_ELEMENTS (flags); j++)
+      {
+        expected = g_key_file_new ();
+        g_key_file_load_from_data (expected, data[i], -1, flags[j], &error);
+        g_assert_no_error (error);
+
+        kf = load_file_contents (data[i], flags[j], &error);
+        g_assert_no_error (error);
+
+        /* looking up a key before the whole file is written out */
+        keys = g_key_file_get_keys (kf, "second", &n_keys, &error);
+        g_assert_no_error (error);
+        g_strfreev (keys);
+        keys = g_key_file_get_keys (expected, "second", &n_keys, &error);
+        g_assert_no_error (error);
+        g_strfreev (keys);
+
+        str = g_key_file_get_comment (kf, "second", NULL, NULL);
+        expected_str = g_key_file_get_comment (expected, "second", NULL, NULL);
+        g_assert_cmpstr (str, ==, expected_str);
+        g_free (str);
+        g_free (expected_str);
+
+        str = g_key_file_to_data (kf, NULL, NULL);
+        expected_str = g_key_file_to_data (expected, NULL, NULL);
+        g_assert_cmpstr (str, ==, expected_str);
+        g_free (str);
+        g_free (expected_str);
+
+        g_key_file_free (kf);
+        g_key_file_free (expected);
+      }
+
+  kf = load_file_contents (data[0], G_KEY_FILE_NONE, &error);
+  g_assert_no_error (error);
+  expected = g_key_file_new ();
+  g_key_file_load_from_data (expected, data[0], -1, G_KEY_FILE_NONE, &error);
+  g_assert_no_error (error);
+  g_assert (g_key_file_has_group (kf, "third"));
+  check_string_value (kf, "second", "b", "2 ");
+  check_string_value (kf, "second", "c", "x==y");
+  check_string_value (kf, "first", "d", "4");
+  g_key_file_set_value (kf, "second", "b", "two");
+  g_key_file_set_value (expected, "second", "b", "two");
+  check_string_value (kf, "second", "b", "two");
+  g_key_file_remove_key (kf, "second", "c", &error);
+  g_assert_no_error (error);
+  g_key_file_remove_key (expected, "second", "c", &error);
+  g_assert_no_error (error);
+  g_key_file_remove_group (kf, "third", &error);
+  g_assert_no_error (error);
+  g_key_file_remove_group (expected, "third", &error);
+  g_assert_no_error (error);
+  str = g_key_file_to_data (kf, NULL, NULL);
+  expected_str = g_key_file_to_data (expected, NULL, NULL);
+  g_assert_cmpstr (str, ==, expected_str);
+  g_free (str);
+  g_free (expected_str);
+  g_key_file_free (kf);
+  g_key_file_free (expected);
+
+  for (i = 0; i < G_N_ELEMENTS (invalid); i++)
+    {
+      kf = load_file_contents (invalid[i], G_KEY_FILE_NONE, &error);
+      g_assert (kf == NULL);
+      g_assert_error (error, G_KEY_FILE_ERROR, G_KEY_FILE_ERROR_PARSE);
+      g_clear_error (&error);
+    }
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -1669,6 +1893,8 @@ main (int argc, char *argv[])
   g_test_add_func ("/keyfile/load", test_load);
   g_test_add_func ("/keyfile/save", test_save);
   g_test_add_func ("/keyfile/load-fail", test_load_fail);
+  g_test_add_func ("/keyfile/load-mapped", test_load_mapped);
+  g_test_add_func ("/keyfile/load-snapshot", test_load_snapshot);
   g_test_add_func ("/keyfile/non-utf8", test_non_utf8);
   g_test_add_func ("/keyfile/page-boundary", test_page_boundary);
   g_test_add_func ("/keyfile/ref", test_ref);
@@ -1,5 +1,13 @@
 #include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
 #include <glib.h>
+#include <glib/gstdio.h>
+
+#ifdef G_OS_UNIX
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 /* Test g_warn macros */
 static void
@@ -294,6 +302,162 @@ test_gibberish (void)
   g_test_trap_assert_stderr ("*bla bla \\x9e\\x9f\\u000190*");
 }
 
+#ifdef G_OS_UNIX
+#define ASYNC_THREADS  4
+#define ASYNC_MESSAGES 1000
+
+static gpointer
+async_log_thread (gpointer data)
+{
+  gint i;
+
+  for (i = 0; i < ASYNC_MESSAGES; i++)
+    g_log ("async", G_LOG_LEVEL_DEBUG, "thread %d message %d",
+           GPOINTER_TO_INT (data), i);
+
+  return NULL;
+}
+
+static void
+test_async (void)
+{
+  if (g_test_subprocess ())
+    {
+      GThread *threads[ASYNC_THREADS];
+      gint next[ASYNC_THREADS] = { 0, };
+      gchar *name, *contents, **lines;
+      gint fd, i;
+
+      g_log_set_default_handler (g_log_default_handler, NULL);
+      g_setenv ("G_MESSAGES_DEBUG", "all", TRUE);
+
+      fd = g_file_open_tmp (NULL, &name, NULL);
+      g_assert (fd >= 0);
+      dup2 (fd, 1);
+      close (fd);
+
+      g_log_async_enable (1024 * 1024);
+
+      for (i = 0; i < ASYNC_THREADS; i++)
+        threads[i] = g_thread_new ("logger", async_log_thread, GINT_TO_POINTER (i));
+      for (i = 0; i < ASYNC_THREADS; i++)
+        g_thread_join (threads[i]);
+
+      g_log_async_flush ();
+      g_assert_cmpuint (g_log_async_get_dropped (), ==, 0);
+
+      /* Every message is there, in order for each thread */
+      g_assert (g_file_get_contents (name, &contents, NULL, NULL));
+      lines = g_strsplit (contents, "\n", -1);
+      for (i = 0; lines[i] && lines[i][0]; i++)
+        {
+          const gchar *text;
+          gint thread, message;
+
+          text = strstr (lines[i], "async-DEBUG: ");
+          g_assert (text != NULL);
+          g_assert (sscanf (text, "async-DEBUG: thread %d message %d",
+                            &thread, &message) == 2);
+          g_assert_cmpint (message, ==, next[thread]);
+          next[thread]++;
+        }
+      for (i = 0; i < ASYNC_THREADS; i++)
+        g_assert_cmpint (next[i], ==, ASYNC_MESSAGES);
+
+      g_strfreev (lines);
+      g_free (contents);
+      g_unlink (name);
+      g_free (name);
+      return;
+    }
+
+  g_test_trap_subprocess (NULL, 0, 0);
+  g_test_trap_assert_passed ();
+}
+
+static void
+test_async_fatal (void)
+{
+  if (g_test_subprocess ())
+    {
+      gint i;
+
+      g_log_set_default_handler (g_log_default_handler, NULL);
+      g_log_async_enable (0);
+      g_log_set_always_fatal (G_LOG_LEVEL_CRITICAL);
+
+      for (i = 0; i < 100; i++)
+        g_message ("queued %d", i);
+      g_critical ("fatal");
+      return;
+    }
+
+  g_test_trap_subprocess (NULL, 0, 0);
+  g_test_trap_assert_failed ();
+  g_test_trap_assert_stderr ("*queued 0\n*queued 99\n*CRITICAL*fatal*");
+}
+
+static gpointer
+count_lines (gpointer data)
+{
+  gint fd = GPOINTER_TO_INT (data);
+  guint n_lines = 0;
+  gchar buf[4096];
+  gssize len, i;
+
+  while ((len = read (fd, buf, sizeof buf)) > 0)
+    for (i = 0; i < len; i++)
+      if (buf[i] == '\n')
+        n_lines++;
+
+  return GUINT_TO_POINTER (n_lines);
+}
+
+static void
+test_async_dropped (void)
+{
+  if (g_test_subprocess ())
+    {
+      GThread *reader;
+      guint n_lines;
+      gint fds[2];
+      gint i;
+
+      g_log_set_default_handler (g_log_default_handler, NULL);
+      g_setenv ("G_MESSAGES_DEBUG", "all", TRUE);
+
+      /* Nobody reads the pipe yet, so the writer gets stuck once it
+       * is full and the small buffer overflows.
+       */
+      g_assert (pipe (fds) == 0);
+      dup2 (fds[1], 1);
+      close (fds[1]);
+
+      g_log_async_enable (256);
+
+      for (i = 0; i < 10000; i++)
+        g_debug ("message %d", i);
+      g_assert_cmpuint (g_log_async_get_dropped (), >, 0);
+
+      reader = g_thread_new ("reader", count_lines, GINT_TO_POINTER (fds[0]));
+      g_log_async_flush ();
+
+      /* Close the write end so the reader sees EOF */
+      i = open ("/dev/null", O_WRONLY);
+      dup2 (i, 1);
+      close (i);
+
+      n_lines = GPOINTER_TO_UINT (g_thread_join (reader));
+      g_assert_cmpuint (n_lines + g_log_async_get_dropped (), ==, 10000);
+      return;
+    }
+
+  g_test_trap_subprocess (NULL, 0, 0);
+  g_test_trap_assert_passed ();
+  g_test_trap_assert_stderr ("*log messages were dropped*");
+}
+#endif
+
 int
 main (int argc, char *argv[])
 {
@@ -319,6 +483,11 @@ main (int argc, char *argv[])
   g_test_add_func ("/logging/printerr-handler", test_printerr_handler);
   g_test_add_func ("/logging/653052", bug653052);
   g_test_add_func ("/logging/gibberish", test_gibberish);
+#ifdef G_OS_UNIX
+  g_test_add_func ("/logging/async/order", test_async);
+  g_test_add_func ("/logging/async/fatal", test_async_fatal);
+  g_test_add_func ("/logging/async/dropped", test_async_dropped);
+#endif
 
   return g_test_run ();
 }
@@ -184,6 +184,86 @@ test_gbytes (void)
   g_bytes_unref (bytes);
 }
 
+static void
+test_range (void)
+{
+  GMappedFileFlags flags[] = {
+    G_MAPPED_FILE_FLAGS_NONE,
+    G_MAPPED_FILE_FLAGS_POPULATE | G_MAPPED_FILE_FLAGS_SEQUENTIAL,
+    G_MAPPED_FILE_FLAGS_WILL_NEED | G_MAPPED_FILE_FLAGS_RANDOM,
+    G_MAPPED_FILE_FLAGS_HUGE_PAGES
+  };
+  gsize offsets[] = { 0, 1, 4095, 4096, 4097, 10000, 65535 };
+  GMappedFile *file;
+  GBytes *bytes;
+  GError *error = NULL;
+  gchar *tmp_path;
+  gchar *data;
+  gsize size = 3 * 65536 + 123;
+  gsize i, j;
+
+  tmp_path = g_build_filename (g_get_user_runtime_dir (), "glib-test-mapped-range", NULL);
+
+  data = g_malloc (size);
+  for (i = 0; i < size; i++)
+    data[i] = (i * 7 + i / 251) & 0xff;
+  g_file_set_contents (tmp_path, data, size, &error);
+  g_assert_no_error (error);
+
+  for (i = 0; i < G_N_ELEMENTS (offsets); i++)
+    for (j = 0; j < G_N_ELEMENTS (flags); j++)
+      {
+        gsize length = (i % 2) ? 5000 : size - offsets[i];
+
+        file = g_mapped_file_new_full (tmp_path, flags[j], offsets[i],
+                                       (i % 2) ? 5000 : -1, &error);
+        g_assert_no_error (error);
+
+        g_assert_cmpuint (g_mapped_file_get_length (file), ==, length);
+        g_assert (memcmp (g_mapped_file_get_contents (file), data + offsets[i], length) == 0);
+
+        bytes = g_mapped_file_get_bytes (file);
+        g_mapped_file_unref (file);
+
+        g_assert_cmpuint (g_bytes_get_size (bytes), ==, length);
+        g_assert (memcmp (g_bytes_get_data (bytes, NULL), data + offsets[i], length) == 0);
+        g_bytes_unref (bytes);
+      }
+
+  /* Writable ranges are private copies */
+  file = g_mapped_file_new_full (tmp_path, G_MAPPED_FILE_FLAGS_WRITABLE, 4097, 10, &error);
+  g_assert_no_error (error);
+  memset (g_mapped_file_get_contents (file), 'x', 10);
+  g_mapped_file_unref (file);
+
+  /* An empty range at the end of the file */
+  file = g_mapped_file_new_full (tmp_path, G_MAPPED_FILE_FLAGS_NONE, size, -1, &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (g_mapped_file_get_length (file), ==, 0);
+  g_assert (g_mapped_file_get_contents (file) == NULL);
+  g_mapped_file_unref (file);
+
+  /* Ranges beyond the end */
+  file = g_mapped_file_new_full (tmp_path, G_MAPPED_FILE_FLAGS_NONE, size + 1, -1, &error);
+  g_assert_error (error, G_FILE_ERROR, G_FILE_ERROR_INVAL);
+  g_assert (file == NULL);
+  g_clear_error (&error);
+
+  file = g_mapped_file_new_full (tmp_path, G_MAPPED_FILE_FLAGS_NONE, 100, size - 99, &error);
+  g_assert_error (error, G_FILE_ERROR, G_FILE_ERROR_INVAL);
+  g_assert (file == NULL);
+  g_clear_error (&error);
+
+  g_free (data);
+  g_file_get_contents (tmp_path, &data, NULL, &error);
+  g_assert_no_error (error);
+  g_assert (data[4097] != 'x' || data[4098] != 'x');
+  g_free (data);
+
+  g_unlink (tmp_path);
+  g_free (tmp_path);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -198,6 +278,7 @@ main (int argc, char *argv[])
   g_test_add_func ("/mappedfile/writable", test_writable);
   g_test_add_func ("/mappedfile/writable_fd", test_writable_fd);
   g_test_add_func ("/mappedfile/gbytes", test_gbytes);
+  g_test_add_func ("/mappedfile/range", test_range);
 
   return g_test_run ();
 }
@@ -272,6 +272,20 @@ test_parse (gconstpointer d)
 
   g_string_free (string, TRUE);
 
+  /* Text slices and interned names must not change the output */
+  depth = 0;
+  string = g_string_sized_new (0);
+
+  res = test_file (filename, G_MARKUP_NO_COPY);
+  g_assert_cmpint (res, ==, valid_input ? 0 : 1);
+
+  g_file_get_contents (expected_file, &expected, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpstr (string->str, ==, expected);
+  g_free (expected);
+
+  g_string_free (string, TRUE);
+
   g_free (expected_file);
 
   expected_file = get_expected_filename (filename, G_MARKUP_TREAT_CDATA_AS_TEXT);
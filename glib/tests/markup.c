@@ -21,6 +21,7 @@
  * Author: Matthias Clasen
  */
 
+#include <string.h>
 #include "glib.h"
 
 typedef struct {
@@ -87,12 +88,151 @@ test_markup_stack (void)
   g_markup_parse_context_free (context);
 }
 
+typedef struct {
+  const gchar *buffer;
+  gsize buffer_len;
+  GString *result;
+  gint subparser_depth;
+} NoCopyData;
+
+static void
+no_copy_text (GMarkupParseContext  *context,
+              const gchar          *text,
+              gsize                 text_len,
+              gpointer              user_data,
+              GError              **error)
+{
+  NoCopyData *data = user_data;
+
+  if (strncmp (text, "slice", text_len) == 0)
+    g_assert (text >= data->buffer && text + text_len <= data->buffer + data->buffer_len);
+
+  g_string_append_printf (data->result, "'%.*s'", (int) text_len, text);
+}
+
+static void
+no_copy_sub_start (GMarkupParseContext  *context,
+                   const gchar          *element_name,
+                   const gchar         **attribute_names,
+                   const gchar         **attribute_values,
+                   gpointer              user_data,
+                   GError              **error)
+{
+  NoCopyData *data = user_data;
+
+  data->subparser_depth++;
+  g_string_append_printf (data->result, "{%s}", element_name);
+}
+
+static void
+no_copy_sub_end (GMarkupParseContext  *context,
+                 const gchar          *element_name,
+                 gpointer              user_data,
+                 GError              **error)
+{
+  NoCopyData *data = user_data;
+
+  data->subparser_depth--;
+  g_string_append_printf (data->result, "{/%s}", element_name);
+}
+
+static const GMarkupParser no_copy_subparser = {
+  no_copy_sub_start,
+  no_copy_sub_end,
+  no_copy_text,
+  NULL,
+  NULL
+};
+
+static void
+no_copy_start (GMarkupParseContext  *context,
+               const gchar          *element_name,
+               const gchar         **attribute_names,
+               const gchar         **attribute_values,
+               gpointer              user_data,
+               GError              **error)
+{
+  NoCopyData *data = user_data;
+
+  g_assert (element_name == g_intern_string (element_name));
+  g_assert (g_markup_parse_context_get_element (context) == element_name);
+
+  g_string_append_printf (data->result, "<%s>", element_name);
+
+  if (strcmp (element_name, "a") == 0)
+    g_markup_parse_context_push (context, &no_copy_subparser, data);
+}
+
+static void
+no_copy_end (GMarkupParseContext  *context,
+             const gchar          *element_name,
+             gpointer              user_data,
+             GError              **error)
+{
+  NoCopyData *data = user_data;
+
+  g_assert (element_name == g_intern_string (element_name));
+
+  if (strcmp (element_name, "a") == 0)
+    {
+      /* Only the outer <a> may end the subparser, although the
+       * nested one has the same (interned) name.
+       */
+      g_assert_cmpint (data->subparser_depth, ==, 0);
+      g_markup_parse_context_pop (context);
+    }
+
+  g_string_append_printf (data->result, "</%s>", element_name);
+}
+
+static void
+test_markup_no_copy (void)
+{
+  GMarkupParser parser = {
+    no_copy_start,
+    no_copy_end,
+    no_copy_text,
+    NULL,
+    NULL
+  };
+  const gchar doc[] =
+    "<doc>slice<a><a>x&amp;y</a>\n<b>slice</b></a><c>r\r\nn</c></doc>";
+  GMarkupParseContext *context;
+  NoCopyData data;
+  gboolean res;
+  GError *error = NULL;
+  gint line, col;
+
+  data.buffer = doc;
+  data.buffer_len = strlen (doc);
+  data.result = g_string_new (NULL);
+  data.subparser_depth = 0;
+
+  context = g_markup_parse_context_new (&parser, G_MARKUP_NO_COPY, &data, NULL);
+  res = g_markup_parse_context_parse (context, doc, -1, &error);
+  g_assert_no_error (error);
+  g_assert (res);
+  g_markup_parse_context_get_position (context, &line, &col);
+  g_assert_cmpint (line, ==, 3);
+  g_assert_cmpint (col, ==, 13);
+  res = g_markup_parse_context_end_parse (context, &error);
+  g_assert_no_error (error);
+  g_assert (res);
+  g_markup_parse_context_free (context);
+
+  g_assert_cmpstr (data.result->str, ==,
+                   "<doc>'slice'<a>''{a}'x&y'{/a}'\n'{b}'slice'{/b}''</a>''"
+                   "<c>'r\nn'</c>''</doc>");
+  g_string_free (data.result, TRUE);
+}
+
 int
 main (int argc, char *argv[])
 {
   g_test_init (&argc, &argv, NULL);
 
   g_test_add_func ("/markup/stack", test_markup_stack);
+  g_test_add_func ("/markup/no-copy", test_markup_no_copy);
 
   return g_test_run ();
 }
@@ -208,6 +208,68 @@ test_mutex_perf (gconstpointer data)
   g_test_maximized_result (rate, "%f mips", rate);
 }
 
+/* Throughput of a critical section that is only a few nanoseconds
+ * long, as found in gsignal.c or GAsyncQueue, with a varying number of
+ * threads hammering on the same lock for a fixed amount of time.
+ */
+typedef struct
+{
+  GMutex  lock;
+  guint64 counter;
+  gint    running;
+  gint    stop;
+} ScalingData;
+
+static gpointer
+scaling_thread (gpointer user_data)
+{
+  ScalingData *data = user_data;
+  gsize n = 0;
+
+  while (!g_atomic_int_get (&data->running))
+    g_thread_yield ();
+
+  while (!g_atomic_int_get (&data->stop))
+    {
+      g_mutex_lock (&data->lock);
+      data->counter++;
+      g_mutex_unlock (&data->lock);
+      n++;
+    }
+
+  return GSIZE_TO_POINTER (n);
+}
+
+static void
+test_mutex_scaling (gconstpointer user_data)
+{
+  gint n_threads = GPOINTER_TO_INT (user_data);
+  ScalingData data = { { 0 }, 0, FALSE, FALSE };
+  GThread **threads;
+  gint64 start_time;
+  gdouble rate;
+  gsize total = 0;
+  gint i;
+
+  threads = g_new (GThread *, n_threads);
+  for (i = 0; i < n_threads; i++)
+    threads[i] = g_thread_new ("scaling", scaling_thread, &data);
+
+  start_time = g_get_monotonic_time ();
+  g_atomic_int_set (&data.running, TRUE);
+  g_usleep (G_USEC_PER_SEC / 2);
+  g_atomic_int_set (&data.stop, TRUE);
+
+  for (i = 0; i < n_threads; i++)
+    total += GPOINTER_TO_SIZE (g_thread_join (threads[i]));
+  rate = total / (gdouble) (g_get_monotonic_time () - start_time);
+  g_free (threads);
+
+  g_assert_cmpuint (data.counter, ==, total);
+
+  g_test_maximized_result (rate, "%d threads: %.2f M locks/s", n_threads, rate);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -231,6 +293,13 @@ main (int argc, char *argv[])
           sprintf (name, "/thread/mutex/perf/contended/%d", i);
           g_test_add_data_func (name, GINT_TO_POINTER (i), test_mutex_perf);
         }
+
+      for (i = 1; i <= 64; i *= 2)
+        {
+          gchar name[80];
+          sprintf (name, "/thread/mutex/perf/scaling/%d", i);
+          g_test_add_data_func (name, GINT_TO_POINTER (i), test_mutex_scaling);
+        }
     }
 
   return g_test_run ();
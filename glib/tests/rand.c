@@ -19,7 +19,10 @@
  * if advised of the possibility of such damage.
  */
 
+#include <string.h>
+
 #include "glib.h"
+#include "glib-private.h"
 
 /* Outputs tested against the reference implementation mt19937ar.c from
  * http://www.math.sci.hiroshima-u.ac.jp/~m-mat/MT/MT2002/emt19937ar.html
@@ -162,6 +165,219 @@ test_double_range (void)
   g_assert (d < G_MAXDOUBLE);
 }
 
+/* Outputs (upper 32 bits) checked against the reference implementations
+ * of xoshiro256** and PCG64, seeded from seed_array through splitmix64 */
+static const guint32 xoshiro_outputs[] =
+{
+  0x274c1007, 0xbb084cfd, 0xa23d864b, 0x8a909a42,
+  0x5b7f97d9, 0xb6e6792e, 0x28bcc0aa, 0x4c00037b
+};
+
+static const guint32 xoshiro_jump_outputs[] =
+{
+  0xda8e0a2a, 0x2e6059b4, 0xbddc555b, 0xe5b97f7a
+};
+
+static const guint32 pcg64_outputs[] =
+{
+  0x6804529a, 0x9ee9a713, 0xde0cacd5, 0x9812162a,
+  0xc655b6a6, 0x870d4646, 0xdb6386d1, 0xa9a72bf4
+};
+
+static const guint32 pcg64_jump_outputs[] =
+{
+  0x95543a7b, 0x7a80913d, 0xb55c30d1, 0x14775f2b
+};
+
+static void
+test_algorithm (gconstpointer data)
+{
+  GRandAlgorithm algorithm = GPOINTER_TO_INT (data);
+  const guint32 *outputs, *jump_outputs;
+  GRand *rand, *copy;
+  guint n;
+
+  if (algorithm == G_RAND_ALGORITHM_XOSHIRO256SS)
+    {
+      outputs = xoshiro_outputs;
+      jump_outputs = xoshiro_jump_outputs;
+    }
+  else
+    {
+      outputs = pcg64_outputs;
+      jump_outputs = pcg64_jump_outputs;
+    }
+
+  rand = g_rand_new_full (algorithm, seed_array, G_N_ELEMENTS (seed_array));
+  g_assert_cmpint (g_rand_get_algorithm (rand), ==, algorithm);
+
+  for (n = 0; n < G_N_ELEMENTS (xoshiro_outputs); n++)
+    g_assert_cmphex (g_rand_int (rand), ==, outputs[n]);
+
+  g_rand_set_seed_array (rand, seed_array, G_N_ELEMENTS (seed_array));
+  g_rand_jump (rand);
+  for (n = 0; n < G_N_ELEMENTS (xoshiro_jump_outputs); n++)
+    g_assert_cmphex (g_rand_int (rand), ==, jump_outputs[n]);
+
+  copy = g_rand_copy (rand);
+  g_assert_cmpint (g_rand_get_algorithm (copy), ==, algorithm);
+  for (n = 0; n < 100; n++)
+    g_assert (g_rand_int (copy) == g_rand_int (rand));
+
+  for (n = 0; n < 100000; n++)
+    {
+      gint32 i;
+      gdouble d;
+
+      i = g_rand_int_range (rand, 8, 16);
+      g_assert (i >= 8 && i < 16);
+
+      d = g_rand_double (rand);
+      g_assert (d >= 0 && d < 1);
+    }
+
+  g_rand_free (rand);
+  g_rand_free (copy);
+
+  /* Generators seeded from /dev/urandom differ */
+  rand = g_rand_new_full (algorithm, NULL, 0);
+  copy = g_rand_new_full (algorithm, NULL, 0);
+  g_assert (g_rand_double (rand) != g_rand_double (copy));
+  g_rand_free (rand);
+  g_rand_free (copy);
+}
+
+static void
+test_fill (gconstpointer data)
+{
+  GRandAlgorithm algorithm = GPOINTER_TO_INT (data);
+  GRand *rand, *copy;
+  guint32 ints[1500];
+  gdouble doubles[1500];
+  gsize n, i;
+
+  rand = g_rand_new_full (algorithm, seed_array, G_N_ELEMENTS (seed_array));
+  copy = g_rand_copy (rand);
+
+  /* Odd sizes, to cross the Mersenne Twister's regeneration points */
+  for (n = 0; n < sizeof ints / sizeof ints[0]; n += 1 + n * 2)
+    {
+      g_rand_fill_int (rand, ints, n);
+      for (i = 0; i < n; i++)
+        g_assert_cmphex (ints[i], ==, g_rand_int (copy));
+
+      g_rand_fill_double (rand, doubles, n);
+      for (i = 0; i < n; i++)
+        {
+          g_assert (doubles[i] >= 0 && doubles[i] < 1);
+          g_assert (doubles[i] == g_rand_double (copy));
+        }
+    }
+
+  g_assert (g_rand_int (rand) == g_rand_int (copy));
+
+  g_rand_free (rand);
+  g_rand_free (copy);
+}
+
+static gpointer
+random_thread (gpointer data)
+{
+  guint32 *first = data;
+  gint n;
+
+  *first = g_random_int ();
+  for (n = 0; n < 10000; n++)
+    g_assert_cmpint (g_random_int_range (0, 10), <, 10);
+
+  return NULL;
+}
+
+static void
+test_random_threads (void)
+{
+  GThread *threads[4];
+  guint32 first[4];
+  guint32 values[2];
+  gint i;
+
+  for (i = 0; i < G_N_ELEMENTS (threads); i++)
+    threads[i] = g_thread_new ("random", random_thread, &first[i]);
+  for (i = 0; i < G_N_ELEMENTS (threads); i++)
+    g_thread_join (threads[i]);
+
+  /* Each thread is seeded separately */
+  g_assert (first[0] != first[1] || first[1] != first[2] || first[2] != first[3]);
+
+  /* Seeding still makes the calling thread's sequence reproducible */
+  g_random_set_seed (first_numbers[0]);
+  values[0] = g_random_int ();
+  values[1] = g_random_int ();
+  g_assert_cmphex (values[0], ==, first_numbers[1]);
+  g_assert_cmphex (values[1], ==, first_numbers[2]);
+}
+
+static void
+test_fill_perf (void)
+{
+  GRandAlgorithm algorithms[] = {
+    G_RAND_ALGORITHM_MT19937,
+    G_RAND_ALGORITHM_XOSHIRO256SS,
+    G_RAND_ALGORITHM_PCG64
+  };
+  const gchar *names[] = { "mt19937", "xoshiro256**", "pcg64" };
+  gdouble *values;
+  GTimer *timer;
+  gsize n_values = 1 << 20;
+  gint i, j;
+
+  values = g_new (gdouble, n_values);
+  timer = g_timer_new ();
+
+  for (i = 0; i < G_N_ELEMENTS (algorithms); i++)
+    {
+      GRand *rand = g_rand_new_full (algorithms[i], seed_array, G_N_ELEMENTS (seed_array));
+      gdouble single, bulk;
+
+      g_timer_start (timer);
+      for (j = 0; j < n_values; j++)
+        values[j] = g_rand_double (rand);
+      single = g_timer_elapsed (timer, NULL);
+
+      g_timer_start (timer);
+      g_rand_fill_double (rand, values, n_values);
+      bulk = g_timer_elapsed (timer, NULL);
+
+      g_test_minimized_result (bulk * 1e9 / n_values,
+                               "%s: %.2f ns per double (g_rand_double: %.2f ns)",
+                               names[i], bulk * 1e9 / n_values, single * 1e9 / n_values);
+
+      g_rand_free (rand);
+    }
+
+  g_timer_destroy (timer);
+  g_free (values);
+}
+
+static void
+test_random_seed (void)
+{
+  guint32 seed_a[4], seed_b[4];
+  gint i;
+
+  /* Fill with two different patterns first, so that a word which is
+   * not written by g_get_random_seed() can not go unnoticed.
+   */
+  memset (seed_a, 0x55, sizeof seed_a);
+  memset (seed_b, 0xaa, sizeof seed_b);
+
+  GLIB_PRIVATE_CALL (g_get_random_seed) (seed_a);
+  GLIB_PRIVATE_CALL (g_get_random_seed) (seed_b);
+
+  for (i = 0; i < 4; i++)
+    g_assert (seed_a[i] != 0x55555555 || seed_b[i] != 0xaaaaaaaa);
+}
+
 int
 main (int   argc,
       char *argv[])
@@ -171,6 +387,15 @@ main (int   argc,
 
   g_test_add_func ("/rand/test-rand", test_rand);
   g_test_add_func ("/rand/double-range", test_double_range);
+  g_test_add_data_func ("/rand/xoshiro256ss", GINT_TO_POINTER (G_RAND_ALGORITHM_XOSHIRO256SS), test_algorithm);
+  g_test_add_data_func ("/rand/pcg64", GINT_TO_POINTER (G_RAND_ALGORITHM_PCG64), test_algorithm);
+  g_test_add_data_func ("/rand/fill/mt19937", GINT_TO_POINTER (G_RAND_ALGORITHM_MT19937), test_fill);
+  g_test_add_data_func ("/rand/fill/xoshiro256ss", GINT_TO_POINTER (G_RAND_ALGORITHM_XOSHIRO256SS), test_fill);
+  g_test_add_data_func ("/rand/fill/pcg64", GINT_TO_POINTER (G_RAND_ALGORITHM_PCG64), test_fill);
+  g_test_add_func ("/rand/random-threads", test_random_threads);
+  g_test_add_func ("/rand/random-seed", test_random_seed);
+  if (g_test_perf ())
+    g_test_add_func ("/rand/fill-perf", test_fill_perf);
 
   return g_test_run();
 }
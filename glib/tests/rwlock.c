@@ -245,12 +245,16 @@ reader_func (gpointer data)
  * even values
  */
 static void
-test_rwlock8 (void)
+test_rwlock8 (gconstpointer data)
 {
+  gboolean big_reader = GPOINTER_TO_INT (data);
   gint i;
 
   even = 0;
-  g_rw_lock_init (&even_lock);
+  if (big_reader)
+    g_rw_lock_init_big_reader (&even_lock);
+  else
+    g_rw_lock_init (&even_lock);
 
   for (i = 0; i < 2; i++)
     writers[i] = g_thread_new ("a", writer_func, GINT_TO_POINTER (i));
@@ -269,6 +273,127 @@ test_rwlock8 (void)
   g_rw_lock_clear (&even_lock);
 }
 
+static gint big_reader_state;
+
+static gpointer
+big_reader_blocked_reader (gpointer data)
+{
+  GRWLock *lock = data;
+
+  g_rw_lock_reader_lock (lock);
+  g_assert_cmpint (g_atomic_int_get (&big_reader_state), ==, 1);
+  g_rw_lock_reader_unlock (lock);
+
+  return NULL;
+}
+
+static void
+test_big_reader (void)
+{
+  GRWLock lock;
+  GThread *thread;
+
+  g_rw_lock_init_big_reader (&lock);
+
+  /* Any number of readers, but no writer while they hold it */
+  g_assert (g_rw_lock_reader_trylock (&lock));
+  g_assert (g_rw_lock_reader_trylock (&lock));
+  g_assert (!g_rw_lock_writer_trylock (&lock));
+  g_rw_lock_reader_unlock (&lock);
+  g_assert (!g_rw_lock_writer_trylock (&lock));
+  g_rw_lock_reader_unlock (&lock);
+
+  /* No readers or other writers while a writer holds it */
+  g_assert (g_rw_lock_writer_trylock (&lock));
+  g_assert (!g_rw_lock_reader_trylock (&lock));
+  g_assert (!g_rw_lock_writer_trylock (&lock));
+  g_rw_lock_writer_unlock (&lock);
+
+  /* A reader blocks until the writer is gone */
+  g_rw_lock_writer_lock (&lock);
+  thread = g_thread_new ("reader", big_reader_blocked_reader, &lock);
+  g_usleep (G_USEC_PER_SEC / 20);
+  g_atomic_int_set (&big_reader_state, 1);
+  g_rw_lock_writer_unlock (&lock);
+  g_thread_join (thread);
+
+  g_rw_lock_reader_lock (&lock);
+  g_rw_lock_reader_unlock (&lock);
+  g_rw_lock_writer_lock (&lock);
+  g_rw_lock_writer_unlock (&lock);
+
+  g_rw_lock_clear (&lock);
+}
+
+/* Read-side scalability: a number of threads take a read lock around a
+ * tiny critical section for a fixed time, compared between a plain
+ * GRWLock and a big reader one.
+ */
+typedef struct
+{
+  GRWLock lock;
+  gint    value;
+  gint    running;
+  gint    stop;
+} ScalingData;
+
+static gpointer
+scaling_reader (gpointer user_data)
+{
+  ScalingData *data = user_data;
+  gsize n = 0;
+
+  while (!g_atomic_int_get (&data->running))
+    g_thread_yield ();
+
+  while (!g_atomic_int_get (&data->stop))
+    {
+      g_rw_lock_reader_lock (&data->lock);
+      g_assert_cmpint (data->value, ==, 42);
+      g_rw_lock_reader_unlock (&data->lock);
+      n++;
+    }
+
+  return GSIZE_TO_POINTER (n);
+}
+
+static void
+test_rwlock_scaling (gconstpointer user_data)
+{
+  gint n_threads = GPOINTER_TO_INT (user_data) & 0xff;
+  gboolean big_reader = GPOINTER_TO_INT (user_data) >> 8;
+  ScalingData data = { { 0 }, 42, FALSE, FALSE };
+  GThread **threads;
+  gint64 start_time;
+  gdouble rate;
+  gsize total = 0;
+  gint i;
+
+  if (big_reader)
+    g_rw_lock_init_big_reader (&data.lock);
+  else
+    g_rw_lock_init (&data.lock);
+
+  threads = g_new (GThread *, n_threads);
+  for (i = 0; i < n_threads; i++)
+    threads[i] = g_thread_new ("scaling", scaling_reader, &data);
+
+  start_time = g_get_monotonic_time ();
+  g_atomic_int_set (&data.running, TRUE);
+  g_usleep (G_USEC_PER_SEC / 2);
+  g_atomic_int_set (&data.stop, TRUE);
+
+  for (i = 0; i < n_threads; i++)
+    total += GPOINTER_TO_SIZE (g_thread_join (threads[i]));
+  rate = total / (gdouble) (g_get_monotonic_time () - start_time);
+  g_free (threads);
+
+  g_rw_lock_clear (&data.lock);
+
+  g_test_maximized_result (rate, "%s, %d threads: %.2f M read locks/s",
+                           big_reader ? "big reader" : "plain", n_threads, rate);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -281,7 +406,27 @@ main (int argc, char *argv[])
   g_test_add_func ("/thread/rwlock5", test_rwlock5);
   g_test_add_func ("/thread/rwlock6", test_rwlock6);
   g_test_add_func ("/thread/rwlock7", test_rwlock7);
-  g_test_add_func ("/thread/rwlock8", test_rwlock8);
+  g_test_add_data_func ("/thread/rwlock8", GINT_TO_POINTER (FALSE), test_rwlock8);
+  g_test_add_data_func ("/thread/rwlock/big-reader/even", GINT_TO_POINTER (TRUE), test_rwlock8);
+  g_test_add_func ("/thread/rwlock/big-reader/basic", test_big_reader);
+
+  if (g_test_perf ())
+    {
+      gint i;
+
+      for (i = 1; i <= 64; i *= 2)
+        {
+          gchar *name;
+
+          name = g_strdup_printf ("/thread/rwlock/perf/plain/%d", i);
+          g_test_add_data_func (name, GINT_TO_POINTER (i), test_rwlock_scaling);
+          g_free (name);
+
+          name = g_strdup_printf ("/thread/rwlock/perf/big-reader/%d", i);
+          g_test_add_data_func (name, GINT_TO_POINTER (i | 1 << 8), test_rwlock_scaling);
+          g_free (name);
+        }
+    }
 
   return g_test_run ();
 }
@@ -26,6 +26,12 @@
 #include <glib.h>
 #include <string.h>
 
+#ifdef G_OS_UNIX
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 #ifdef G_OS_WIN32
 #define LINEEND "\r\n"
 #else
@@ -200,6 +206,122 @@ test_spawn_script (void)
   g_ptr_array_free (argv, TRUE);
 }
 
+static void
+test_spawn_errors (void)
+{
+  GError *error = NULL;
+  gchar *argv[] = { "/nonexistent/glib-test-program", NULL };
+  gchar *path_argv[] = { "nonexistent-glib-test-program", NULL };
+  GPid pid;
+  gboolean ret;
+
+  ret = g_spawn_async (NULL, argv, NULL, G_SPAWN_DO_NOT_REAP_CHILD,
+                       NULL, NULL, &pid, &error);
+  g_assert_error (error, G_SPAWN_ERROR, G_SPAWN_ERROR_NOENT);
+  g_assert (!ret);
+  g_clear_error (&error);
+
+  ret = g_spawn_async (NULL, path_argv, NULL,
+                       G_SPAWN_DO_NOT_REAP_CHILD | G_SPAWN_SEARCH_PATH,
+                       NULL, NULL, &pid, &error);
+  g_assert_error (error, G_SPAWN_ERROR, G_SPAWN_ERROR_NOENT);
+  g_assert (!ret);
+  g_clear_error (&error);
+}
+
+#ifdef G_OS_UNIX
+static void
+noop_child_setup (gpointer user_data)
+{
+}
+
+/* Whether the child is started with posix_spawn() or with fork() must
+ * not make a difference to which descriptors it inherits.
+ */
+static void
+test_spawn_close_descriptors (void)
+{
+  GSpawnChildSetupFunc child_setups[] = { NULL, noop_child_setup };
+  GError *error = NULL;
+  gchar *argv[] = { "/bin/sh", "-c", NULL, NULL };
+  gint status;
+  gint fd;
+  gsize i;
+
+  /* Not close-on-exec */
+  fd = open ("/dev/null", O_WRONLY);
+  g_assert_cmpint (fd, >=, 3);
+  argv[2] = g_strdup_printf ("echo x >&%d", fd);
+
+  for (i = 0; i < G_N_ELEMENTS (child_setups); i++)
+    {
+      g_spawn_sync (NULL, argv, NULL, G_SPAWN_STDERR_TO_DEV_NULL,
+                    child_setups[i], NULL, NULL, NULL, &status, &error);
+      g_assert_no_error (error);
+      g_assert (!g_spawn_check_exit_status (status, NULL));
+
+      g_spawn_sync (NULL, argv, NULL,
+                    G_SPAWN_STDERR_TO_DEV_NULL | G_SPAWN_LEAVE_DESCRIPTORS_OPEN,
+                    child_setups[i], NULL, NULL, NULL, &status, &error);
+      g_assert_no_error (error);
+      g_assert (g_spawn_check_exit_status (status, NULL));
+    }
+
+  g_free (argv[2]);
+  close (fd);
+}
+
+static gdouble
+time_spawns (GSpawnChildSetupFunc child_setup,
+             guint                n_spawns)
+{
+  gchar *argv[] = { echo_prog_path, NULL };
+  GError *error = NULL;
+  GTimer *timer;
+  gdouble elapsed;
+  GPid pid;
+  gint status;
+  guint i;
+
+  timer = g_timer_new ();
+  for (i = 0; i < n_spawns; i++)
+    {
+      g_spawn_async (NULL, argv, NULL,
+                     G_SPAWN_DO_NOT_REAP_CHILD | G_SPAWN_STDOUT_TO_DEV_NULL,
+                     child_setup, NULL, &pid, &error);
+      g_assert_no_error (error);
+      waitpid (pid, &status, 0);
+      g_assert (WIFEXITED (status) && WEXITSTATUS (status) == 0);
+    }
+  elapsed = g_timer_elapsed (timer, NULL);
+  g_timer_destroy (timer);
+
+  return elapsed / n_spawns;
+}
+
+static void
+test_spawn_large_rss (void)
+{
+  gsize size = 1024 * 1024 * 1024;
+  gdouble fast, forked;
+  gchar *block;
+
+  /* Touch every page so that fork() has page tables to copy */
+  block = g_malloc (size);
+  memset (block, 1, size);
+
+  fast = time_spawns (NULL, 100);
+  /* A child setup function forces the fork() path */
+  forked = time_spawns (noop_child_setup, 100);
+
+  g_test_message ("spawn from a 1 GiB parent: %.1f us without child setup, "
+                  "%.1f us with fork()", fast * 1e6, forked * 1e6);
+  g_test_minimized_result (fast, "spawn from a 1 GiB parent: %.1f us", fast * 1e6);
+
+  g_free (block);
+}
+#endif
+
 int
 main (int   argc,
       char *argv[])
@@ -230,6 +352,12 @@ main (int   argc,
   g_test_add_func ("/gthread/spawn-single-sync", test_spawn_sync);
   g_test_add_func ("/gthread/spawn-single-async", test_spawn_async);
   g_test_add_func ("/gthread/spawn-script", test_spawn_script);
+  g_test_add_func ("/gthread/spawn-errors", test_spawn_errors);
+#ifdef G_OS_UNIX
+  g_test_add_func ("/gthread/spawn-close-descriptors", test_spawn_close_descriptors);
+  if (g_test_perf ())
+    g_test_add_func ("/gthread/spawn-large-rss", test_spawn_large_rss);
+#endif
 
   ret = g_test_run();
 
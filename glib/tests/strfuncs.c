@@ -619,6 +619,22 @@ test_strstr (void)
   g_assert (res == haystack + 3);
   g_assert_cmpstr (res, ==, "BarFooBarFoo");
 
+  res = g_strstr_len (haystack, 15, "BarFoo");
+  g_assert (res == haystack + 3);
+
+  res = g_strstr_len (haystack, 15, "Foo");
+  g_assert (res == haystack);
+
+  res = g_strstr_len (haystack, 14, "BarFoo");
+  g_assert (res == haystack + 3);
+
+  res = g_strstr_len (haystack + 10, 5, "rFoo");
+  g_assert (res == haystack + 11);
+
+  /* The search stops at a nul */
+  res = g_strstr_len ("Foo\0Bar", 7, "Bar");
+  g_assert (res == NULL);
+
   /* strrstr */
   res = g_strrstr (haystack, "xxx");
   g_assert (res == NULL);
@@ -822,6 +838,40 @@ test_strsplit (void)
   strv_check (g_strsplit (",,x,,y,,z,,", ",,", 2), "", "x,,y,,z,,", NULL);
 }
 
+static void
+test_strsplit_inplace (void)
+{
+  const gchar *strings[] = {
+    "", "x", "x,y", "x,y,", ",x,y", ",x,y,", "x,y,z", ",,x,,y,,z,,",
+    "a,b,c,d,e,f,g,h,i,j,k,l,m,n,o,p,q,r,s,t"
+  };
+  const gchar *delimiters[] = { ",", ",,", "y," };
+  gchar **expected, **tokens;
+  gchar *copy;
+  gint i, j, max_tokens;
+  guint k;
+
+  for (i = 0; i < G_N_ELEMENTS (strings); i++)
+    for (j = 0; j < G_N_ELEMENTS (delimiters); j++)
+      for (max_tokens = 0; max_tokens < 4; max_tokens++)
+        {
+          expected = g_strsplit (strings[i], delimiters[j], max_tokens);
+          copy = g_strdup (strings[i]);
+          tokens = g_strsplit_inplace (copy, delimiters[j], max_tokens);
+
+          g_assert_cmpuint (g_strv_length (tokens), ==, g_strv_length (expected));
+          for (k = 0; expected[k]; k++)
+            {
+              g_assert (tokens[k] >= copy && tokens[k] <= copy + strlen (strings[i]));
+              g_assert_cmpstr (tokens[k], ==, expected[k]);
+            }
+
+          g_free (tokens);
+          g_free (copy);
+          g_strfreev (expected);
+        }
+}
+
 static void
 test_strsplit_set (void)
 {
@@ -1044,6 +1094,66 @@ test_strtod (void)
 #endif
 }
 
+static void
+check_dtostr (gdouble      num,
+              const gchar *str)
+{
+  gchar buf[G_ASCII_DTOSTR_BUF_SIZE];
+  int l;
+
+  for (l = 0; l < G_N_ELEMENTS (locales); l++)
+    {
+      setlocale (LC_ALL, locales[l]);
+      g_ascii_dtostr (buf, sizeof (buf), num);
+      g_assert_cmpstr (buf, ==, str);
+    }
+}
+
+static void
+test_dtostr (void)
+{
+  gchar buf[G_ASCII_DTOSTR_BUF_SIZE];
+  gchar *end;
+  gdouble d;
+  int i;
+
+  /* Short values use as few digits as possible, in the %.17g layout */
+  check_dtostr (0.0, "0");
+  check_dtostr (-0.0, "-0");
+  check_dtostr (1.0, "1");
+  check_dtostr (-2.5, "-2.5");
+  check_dtostr (0.1, "0.1");
+  check_dtostr (0.3, "0.3");
+  check_dtostr (123.456, "123.456");
+  check_dtostr (0.0001, "0.0001");
+  check_dtostr (0.00001, "1e-05");
+  check_dtostr (1e16, "10000000000000000");
+  check_dtostr (1e17, "1e+17");
+  check_dtostr (1e22, "1e+22");
+  check_dtostr (1.5e300, "1.5e+300");
+  check_dtostr (5e-324, "5e-324");
+  check_dtostr (G_MAXDOUBLE, "1.7976931348623157e+308");
+  check_dtostr (0.1 + 0.2, "0.30000000000000004");
+
+  /* Truncation works like snprintf() */
+  g_ascii_dtostr (buf, 4, 123.456);
+  g_assert_cmpstr (buf, ==, "123");
+
+  for (i = 0; i < 100000; i++)
+    {
+      d = g_test_rand_double_range (-1e10, 1e10);
+      if (i % 2)
+        d = floor (d * 1000) / 1000;
+      if (i % 3 == 0)
+        d = ldexp (d, g_test_rand_int_range (-1070, 990));
+
+      g_ascii_dtostr (buf, sizeof (buf), d);
+      g_assert (g_ascii_strtod (buf, &end) == d);
+      g_assert (*end == '\0');
+      g_assert (strtod (buf, NULL) == d);
+    }
+}
+
 static void
 check_uint64 (const gchar *str,
 	      const gchar *end,
@@ -1104,6 +1214,64 @@ test_strtoll (void)
   check_int64 ("-32768", "", 10, -32768, 0);
   check_int64 ("001", "", 10, 1, 0);
   check_int64 ("-001", "", 10, -1, 0);
+  check_int64 (" +42 ", " ", 10, 42, 0);
+  check_int64 ("-123456789012345678", "", 10, G_GINT64_CONSTANT (-123456789012345678), 0);
+  check_int64 ("123", "", 0, 123, 0);
+  check_int64 ("0123", "", 0, 0123, 0);
+  check_int64 ("0x1f", "", 0, 0x1f, 0);
+  check_int64 ("", "", 10, 0, 0);
+  check_int64 ("-x", "-x", 10, 0, 0);
+}
+
+#define NUMBERS_N_ITERATIONS 1000000
+
+static void
+test_numbers_perf (void)
+{
+  static const gdouble values[] = {
+    0.0, 1.0, -2.5, 0.1, 3.14159, 1e-5, 123456.789, 6.02214076e23,
+    0.30000000000000004, 1.0 / 3.0
+  };
+  gchar strings[G_N_ELEMENTS (values)][G_ASCII_DTOSTR_BUF_SIZE];
+  gchar buf[G_ASCII_DTOSTR_BUF_SIZE];
+  gdouble sum, ascii_sum, elapsed;
+  int i;
+
+  for (i = 0; i < G_N_ELEMENTS (values); i++)
+    g_ascii_dtostr (strings[i], sizeof (strings[i]), values[i]);
+
+  /* What g_ascii_dtostr() used to do */
+  g_test_timer_start ();
+  for (i = 0; i < NUMBERS_N_ITERATIONS; i++)
+    g_ascii_formatd (buf, sizeof (buf), "%.17g", values[i % G_N_ELEMENTS (values)]);
+  elapsed = g_test_timer_elapsed ();
+  g_test_minimized_result (elapsed, "formatd %%.17g: %.0f ns/value",
+                           elapsed * 1e9 / NUMBERS_N_ITERATIONS);
+
+  g_test_timer_start ();
+  for (i = 0; i < NUMBERS_N_ITERATIONS; i++)
+    g_ascii_dtostr (buf, sizeof (buf), values[i % G_N_ELEMENTS (values)]);
+  elapsed = g_test_timer_elapsed ();
+  g_test_minimized_result (elapsed, "dtostr: %.0f ns/value",
+                           elapsed * 1e9 / NUMBERS_N_ITERATIONS);
+
+  sum = 0;
+  g_test_timer_start ();
+  for (i = 0; i < NUMBERS_N_ITERATIONS; i++)
+    sum += strtod (strings[i % G_N_ELEMENTS (values)], NULL);
+  elapsed = g_test_timer_elapsed ();
+  g_test_minimized_result (elapsed, "strtod: %.0f ns/value",
+                           elapsed * 1e9 / NUMBERS_N_ITERATIONS);
+
+  ascii_sum = 0;
+  g_test_timer_start ();
+  for (i = 0; i < NUMBERS_N_ITERATIONS; i++)
+    ascii_sum += g_ascii_strtod (strings[i % G_N_ELEMENTS (values)], NULL);
+  elapsed = g_test_timer_elapsed ();
+  g_test_minimized_result (elapsed, "ascii_strtod: %.0f ns/value",
+                           elapsed * 1e9 / NUMBERS_N_ITERATIONS);
+
+  g_assert_cmpfloat (sum, ==, ascii_sum);
 }
 
 static void
@@ -1343,6 +1511,53 @@ test_strsignal (void)
     }
 }
 
+static void
+test_ascii_case (void)
+{
+  gchar str[300], *up, *down;
+  gint i, offset;
+
+  /* Every byte value except nul, then letters */
+  for (i = 0; i < 255; i++)
+    str[i] = (gchar) (i + 1);
+  for (i = 255; i < 299; i++)
+    str[i] = 'A' + i % 58;
+  str[299] = '\0';
+
+  /* Different lengths and alignments for the word-at-a-time loop */
+  for (offset = 0; offset < 9; offset++)
+    {
+      up = g_ascii_strup (str + offset, 299 - offset - offset % 3);
+      down = g_ascii_strdown (str + offset, 299 - offset - offset % 3);
+
+      for (i = 0; i < 299 - offset - offset % 3; i++)
+        {
+          g_assert_cmpint (up[i], ==, g_ascii_toupper (str[offset + i]));
+          g_assert_cmpint (down[i], ==, g_ascii_tolower (str[offset + i]));
+        }
+      g_assert_cmpint (up[i], ==, '\0');
+      g_assert_cmpint (down[i], ==, '\0');
+
+      g_assert_cmpint (g_ascii_strcasecmp (up, down), ==, 0);
+      g_assert_cmpint (g_ascii_strncasecmp (up, down, 1000), ==, 0);
+
+      g_free (up);
+      g_free (down);
+    }
+
+  /* Characters after an embedded nul are not copied */
+  up = g_ascii_strup ("ab\0cdefghijk", 12);
+  g_assert_cmpstr (up, ==, "AB");
+  for (i = 2; i <= 12; i++)
+    g_assert_cmpint (up[i], ==, '\0');
+  g_free (up);
+
+  g_assert_cmpint (g_ascii_strcasecmp ("abc", "ABD"), <, 0);
+  g_assert_cmpint (g_ascii_strcasecmp ("[", "a"), <, 0);
+  g_assert_cmpint (g_ascii_strcasecmp ("a", "["), >, 0);
+  g_assert_cmpint (g_ascii_strncasecmp ("abcX", "ABCy", 3), ==, 0);
+}
+
 static void
 test_strup (void)
 {
@@ -1487,14 +1702,19 @@ main (int   argc,
   g_test_add_func ("/strfuncs/has-suffix", test_has_suffix);
   g_test_add_func ("/strfuncs/strsplit", test_strsplit);
   g_test_add_func ("/strfuncs/strsplit-set", test_strsplit_set);
+  g_test_add_func ("/strfuncs/strsplit-inplace", test_strsplit_inplace);
   g_test_add_func ("/strfuncs/strv-length", test_strv_length);
   g_test_add_func ("/strfuncs/strtod", test_strtod);
   g_test_add_func ("/strfuncs/strtoull-strtoll", test_strtoll);
+  g_test_add_func ("/strfuncs/dtostr", test_dtostr);
+  if (g_test_perf ())
+    g_test_add_func ("/strfuncs/perf/numbers", test_numbers_perf);
   g_test_add_func ("/strfuncs/bounds-check", test_bounds);
   g_test_add_func ("/strfuncs/strip-context", test_strip_context);
   g_test_add_func ("/strfuncs/strerror", test_strerror);
   g_test_add_func ("/strfuncs/strsignal", test_strsignal);
   g_test_add_func ("/strfuncs/strup", test_strup);
+  g_test_add_func ("/strfuncs/ascii-case", test_ascii_case);
   g_test_add_func ("/strfuncs/transliteration", test_transliteration);
 
   return g_test_run();
@@ -75,6 +75,81 @@ test_string_chunk_insert (void)
   g_string_chunk_free (chunk);
 }
 
+static void
+test_string_chunk_insert_const_len (void)
+{
+  const gchar buffer[] = "foo bar foo baz bar";
+  GStringChunk *chunk;
+  gchar *foo, *bar, *baz, *s;
+  gchar key[16];
+  gsize allocated, used, saved;
+  gint i;
+
+  chunk = g_string_chunk_new (64);
+
+  foo = g_string_chunk_insert_const_len (chunk, buffer, 3);
+  bar = g_string_chunk_insert_const_len (chunk, buffer + 4, 3);
+  g_assert_cmpstr (foo, ==, "foo");
+  g_assert_cmpstr (bar, ==, "bar");
+  g_assert (g_string_chunk_insert_const_len (chunk, buffer + 8, 3) == foo);
+  baz = g_string_chunk_insert_const_len (chunk, buffer + 12, 3);
+  g_assert_cmpstr (baz, ==, "baz");
+  g_assert (g_string_chunk_insert_const_len (chunk, buffer + 16, 3) == bar);
+
+  /* A prefix is a different string */
+  s = g_string_chunk_insert_const_len (chunk, buffer, 2);
+  g_assert_cmpstr (s, ==, "fo");
+  g_assert (g_string_chunk_insert_const (chunk, "fo") == s);
+
+  /* All the variants share the same table */
+  g_assert (g_string_chunk_insert_const (chunk, "foo") == foo);
+  g_assert (g_string_chunk_insert_const_with_hash (chunk, "bar", -1,
+                                                   g_str_hash ("bar")) == bar);
+  g_assert (g_string_chunk_insert_const_with_hash (chunk, buffer + 12, 3,
+                                                   g_str_hash ("baz")) == baz);
+
+  /* Non-ASCII bytes hash like g_str_hash() too */
+  s = g_string_chunk_insert_const_len (chunk, "\xc3\xa9t\xc3\xa9 summer", 5);
+  g_assert_cmpstr (s, ==, "\xc3\xa9t\xc3\xa9");
+  g_assert (g_string_chunk_insert_const_with_hash (chunk, "\xc3\xa9t\xc3\xa9", 5,
+                                                   g_str_hash ("\xc3\xa9t\xc3\xa9")) == s);
+
+  g_string_chunk_get_usage (chunk, &allocated, &used, &saved);
+  g_assert_cmpuint (used, ==, 4 + 4 + 4 + 3 + 6);
+  g_assert_cmpuint (saved, ==, 4 + 4 + 3 + 4 + 4 + 4 + 6);
+  g_assert_cmpuint (allocated, >=, used);
+
+  /* Grow the table well past its initial size */
+  for (i = 0; i < 1000; i++)
+    {
+      g_snprintf (key, sizeof key, "key%d", i);
+      s = g_string_chunk_insert_const (chunk, key);
+      g_assert_cmpstr (s, ==, key);
+    }
+  for (i = 0; i < 1000; i++)
+    {
+      g_snprintf (key, sizeof key, "key%d", i);
+      s = g_string_chunk_insert_const (chunk, key);
+      g_assert_cmpstr (s, ==, key);
+      g_assert (s != key);
+    }
+  g_assert (g_string_chunk_insert_const (chunk, "foo") == foo);
+
+  g_string_chunk_clear (chunk);
+  g_string_chunk_get_usage (chunk, &allocated, &used, &saved);
+  g_assert_cmpuint (allocated, ==, 0);
+  g_assert_cmpuint (used, ==, 0);
+  g_assert_cmpuint (saved, ==, 0);
+
+  s = g_string_chunk_insert_const (chunk, "foo");
+  g_assert_cmpstr (s, ==, "foo");
+  g_assert (g_string_chunk_insert_const_len (chunk, "foo", 3) == s);
+  g_string_chunk_get_usage (chunk, NULL, &used, NULL);
+  g_assert_cmpuint (used, ==, 4);
+
+  g_string_chunk_free (chunk);
+}
+
 static void
 test_string_new (void)
 {
@@ -495,6 +570,264 @@ test_string_to_bytes (void)
   g_bytes_unref (bytes);
 }
 
+/* Random edits, checked against a plain buffer */
+static void
+test_string_random_edits (void)
+{
+  GString *string;
+  gchar *model, *segment;
+  gsize model_len, pos, len;
+  GBytes *bytes;
+  gint i, round;
+
+  for (round = 0; round < 20; round++)
+    {
+      string = g_string_new (NULL);
+      model = g_malloc (1);
+      model_len = 0;
+
+      for (i = 0; i < 500; i++)
+        {
+          gchar text[40];
+
+          len = g_test_rand_int_range (1, sizeof text);
+          memset (text, 'a' + i % 26, len);
+          pos = g_test_rand_int_range (0, model_len + 1);
+
+          switch (g_test_rand_int_range (0, 6))
+            {
+            case 0:
+              g_string_prepend_len (string, text, len);
+              pos = 0;
+              break;
+            case 1:
+              g_string_append_len (string, text, len);
+              pos = model_len;
+              break;
+            case 2:
+              g_string_insert_len (string, pos, text, len);
+              break;
+            case 3:
+              len = 1;
+              g_string_insert_c (string, pos, text[0]);
+              break;
+            case 4:
+              len = g_test_rand_int_range (0, model_len - pos + 1);
+              g_string_erase (string, pos, len);
+              memmove (model + pos, model + pos + len, model_len - pos - len);
+              model_len -= len;
+              continue;
+            case 5:
+              len = MIN (model_len - pos, 3);
+              g_string_erase (string, pos, len);
+              memmove (model + pos, model + pos + len, model_len - pos - len);
+              model_len -= len;
+              continue;
+            }
+
+          model = g_realloc (model, model_len + len + 1);
+          memmove (model + pos + len, model + pos, model_len - pos);
+          memcpy (model + pos, text, len);
+          model_len += len;
+
+          g_assert_cmpuint (string->len, ==, model_len);
+          g_assert (string->len < string->allocated_len);
+          g_assert_cmpint (string->str[string->len], ==, '\0');
+          g_assert (memcmp (string->str, model, model_len) == 0);
+        }
+
+      g_assert_cmpuint (string->len, ==, model_len);
+      g_assert (memcmp (string->str, model, model_len) == 0);
+
+      if (round % 2)
+        {
+          segment = g_string_free (string, FALSE);
+          g_assert (memcmp (segment, model, model_len) == 0);
+          g_assert_cmpint (segment[model_len], ==, '\0');
+          segment = g_realloc (segment, model_len + 100);
+          g_free (segment);
+        }
+      else
+        {
+          bytes = g_string_free_to_bytes (string);
+          g_assert_cmpuint (g_bytes_get_size (bytes), ==, model_len);
+          g_assert (memcmp (g_bytes_get_data (bytes, NULL), model, model_len) == 0);
+          g_bytes_unref (bytes);
+        }
+
+      g_free (model);
+    }
+}
+
+/* Random edits on a GStringBuilder, checked against a GString */
+static void
+test_string_builder (void)
+{
+  GStringBuilder *builder;
+  GString *model, *result;
+  GBytes *bytes;
+  gsize pos, len;
+  gint i, round;
+
+  for (round = 0; round < 20; round++)
+    {
+      builder = g_string_builder_new ();
+      model = g_string_new (NULL);
+
+      for (i = 0; i < 2000; i++)
+        {
+          gchar text[6000];
+
+          /* Mostly short pieces, sometimes longer than a chunk */
+          len = g_test_rand_int_range (0, 10) ? g_test_rand_int_range (1, 40)
+                                              : g_test_rand_int_range (1, sizeof text);
+          memset (text, 'a' + i % 26, len);
+          pos = g_test_rand_int_range (0, model->len + 1);
+
+          switch (g_test_rand_int_range (0, 5))
+            {
+            case 0:
+              g_string_builder_prepend_len (builder, text, len);
+              g_string_prepend_len (model, text, len);
+              break;
+            case 1:
+              g_string_builder_append_len (builder, text, len);
+              g_string_append_len (model, text, len);
+              break;
+            case 2:
+              g_string_builder_insert_len (builder, pos, text, len);
+              g_string_insert_len (model, pos, text, len);
+              break;
+            case 3:
+              len = g_test_rand_int_range (0, model->len - pos + 1);
+              g_string_builder_erase (builder, pos, len);
+              g_string_erase (model, pos, len);
+              break;
+            case 4:
+              len = MIN (model->len - pos, 3);
+              g_string_builder_erase (builder, pos, len);
+              g_string_erase (model, pos, len);
+              break;
+            }
+
+          g_assert_cmpuint (g_string_builder_get_length (builder), ==, model->len);
+        }
+
+      if (round % 2)
+        {
+          result = g_string_builder_free_to_string (builder);
+          g_assert_cmpuint (result->len, ==, model->len);
+          g_assert (memcmp (result->str, model->str, model->len) == 0);
+          g_assert_cmpint (result->str[result->len], ==, '\0');
+          g_string_free (result, TRUE);
+        }
+      else
+        {
+          bytes = g_string_builder_free_to_bytes (builder);
+          g_assert_cmpuint (g_bytes_get_size (bytes), ==, model->len);
+          g_assert (memcmp (g_bytes_get_data (bytes, NULL), model->str, model->len) == 0);
+          g_bytes_unref (bytes);
+        }
+
+      g_string_free (model, TRUE);
+    }
+
+  builder = g_string_builder_new ();
+  g_string_builder_append (builder, "world");
+  g_string_builder_prepend (builder, "hello");
+  g_string_builder_insert (builder, 5, ", ");
+  g_string_builder_insert (builder, -1, "!");
+  result = g_string_builder_free_to_string (builder);
+  g_assert_cmpstr (result->str, ==, "hello, world!");
+  g_string_free (result, TRUE);
+
+  builder = g_string_builder_new ();
+  g_string_builder_free (builder);
+}
+
+#define STRING_PERF_N 100000
+
+static void
+test_string_perf (void)
+{
+  GString *string;
+  gdouble elapsed;
+  gint i;
+
+  g_test_timer_start ();
+  for (i = 0; i < STRING_PERF_N * 10; i++)
+    {
+      string = g_string_new ("tiny");
+      g_string_append_c (string, 'x');
+      g_string_free (string, TRUE);
+    }
+  elapsed = g_test_timer_elapsed ();
+  g_test_minimized_result (elapsed, "tiny strings: %.0f ns each",
+                           elapsed * 1e9 / (STRING_PERF_N * 10));
+
+  string = g_string_new (NULL);
+  g_test_timer_start ();
+  for (i = 0; i < STRING_PERF_N; i++)
+    g_string_append (string, "appended line\n");
+  elapsed = g_test_timer_elapsed ();
+  g_test_minimized_result (elapsed, "append: %.1f ms", elapsed * 1e3);
+  g_string_free (string, TRUE);
+
+  string = g_string_new (NULL);
+  g_test_timer_start ();
+  for (i = 0; i < STRING_PERF_N; i++)
+    g_string_prepend (string, "prepended line\n");
+  elapsed = g_test_timer_elapsed ();
+  g_test_minimized_result (elapsed, "prepend: %.1f ms", elapsed * 1e3);
+  g_string_free (string, TRUE);
+
+  string = g_string_new (NULL);
+  g_test_timer_start ();
+  for (i = 0; i < STRING_PERF_N; i++)
+    g_string_insert (string, string->len / 4, "inserted line\n");
+  elapsed = g_test_timer_elapsed ();
+  g_test_minimized_result (elapsed, "insert at 1/4: %.1f ms", elapsed * 1e3);
+
+  g_test_timer_start ();
+  while (string->len > 0)
+    g_string_erase (string, 0, MIN (string->len, 14));
+  elapsed = g_test_timer_elapsed ();
+  g_test_minimized_result (elapsed, "erase from front: %.1f ms", elapsed * 1e3);
+  g_string_free (string, TRUE);
+}
+
+static void
+test_string_builder_perf (void)
+{
+  GStringBuilder *builder;
+  GString *string;
+  gdouble elapsed;
+  gint i;
+
+  builder = g_string_builder_new ();
+  g_test_timer_start ();
+  for (i = 0; i < STRING_PERF_N; i++)
+    g_string_builder_prepend (builder, "prepended line\n");
+  string = g_string_builder_free_to_string (builder);
+  elapsed = g_test_timer_elapsed ();
+  g_test_minimized_result (elapsed, "builder prepend: %.1f ms", elapsed * 1e3);
+  g_string_free (string, TRUE);
+
+  builder = g_string_builder_new ();
+  g_test_timer_start ();
+  for (i = 0; i < STRING_PERF_N; i++)
+    g_string_builder_insert (builder, g_string_builder_get_length (builder) / 4, "inserted line\n");
+  elapsed = g_test_timer_elapsed ();
+  g_test_minimized_result (elapsed, "builder insert at 1/4: %.1f ms", elapsed * 1e3);
+
+  g_test_timer_start ();
+  while (g_string_builder_get_length (builder) > 0)
+    g_string_builder_erase (builder, 0, MIN (g_string_builder_get_length (builder), 14));
+  elapsed = g_test_timer_elapsed ();
+  g_test_minimized_result (elapsed, "builder erase from front: %.1f ms", elapsed * 1e3);
+  g_string_builder_free (builder);
+}
+
 int
 main (int   argc,
       char *argv[])
@@ -503,6 +836,7 @@ main (int   argc,
 
   g_test_add_func ("/string/test-string-chunks", test_string_chunks);
   g_test_add_func ("/string/test-string-chunk-insert", test_string_chunk_insert);
+  g_test_add_func ("/string/test-string-chunk-insert-const-len", test_string_chunk_insert_const_len);
   g_test_add_func ("/string/test-string-new", test_string_new);
   g_test_add_func ("/string/test-string-printf", test_string_printf);
   g_test_add_func ("/string/test-string-assign", test_string_assign);
@@ -519,6 +853,13 @@ main (int   argc,
   g_test_add_func ("/string/test-string-up-down", test_string_up_down);
   g_test_add_func ("/string/test-string-set-size", test_string_set_size);
   g_test_add_func ("/string/test-string-to-bytes", test_string_to_bytes);
+  g_test_add_func ("/string/test-string-random-edits", test_string_random_edits);
+  g_test_add_func ("/string/builder", test_string_builder);
+  if (g_test_perf ())
+    {
+      g_test_add_func ("/string/perf", test_string_perf);
+      g_test_add_func ("/string/builder-perf", test_string_builder_perf);
+    }
 
   return g_test_run();
 }
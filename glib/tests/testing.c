@@ -700,6 +700,64 @@ test_skip_all (void)
   g_ptr_array_unref (argv);
 }
 
+static guint bench_calls;
+static guint64 bench_iterations;
+
+static void
+test_benchmark_subject (gconstpointer data,
+                        guint64       n_iterations)
+{
+  volatile guint sum = 0;
+  guint64 i;
+
+  g_assert (data == (gconstpointer) 0xbe7c);
+
+  for (i = 0; i < n_iterations; i++)
+    sum += i;
+
+  bench_calls++;
+  bench_iterations += n_iterations;
+}
+
+static void
+test_benchmark (void)
+{
+  GPtrArray *argv;
+  GError *error = NULL;
+  gchar *output;
+  int status;
+
+  /* Without -m perf, the benchmark only runs once */
+  if (!g_test_perf () && bench_calls > 0)
+    {
+      g_assert_cmpuint (bench_calls, ==, 1);
+      g_assert_cmpuint (bench_iterations, ==, 1);
+    }
+
+  argv = g_ptr_array_new ();
+  g_ptr_array_add (argv, (char *) argv0);
+  g_ptr_array_add (argv, "-m");
+  g_ptr_array_add (argv, "perf");
+  g_ptr_array_add (argv, "--verbose");
+  g_ptr_array_add (argv, "-p");
+  g_ptr_array_add (argv, "/misc/benchmark/subject");
+  g_ptr_array_add (argv, NULL);
+
+  g_spawn_sync (NULL, (char **) argv->pdata, NULL,
+                G_SPAWN_STDERR_TO_DEV_NULL,
+                NULL, NULL, &output, NULL, &status,
+                &error);
+  g_assert_no_error (error);
+
+  g_spawn_check_exit_status (status, &error);
+  g_assert_no_error (error);
+
+  g_assert (g_pattern_match_simple ("*(BENCHMARK:median * per iteration (p10 *, p90 *, stddev *; * samples of * iterations)*", output));
+
+  g_free (output);
+  g_ptr_array_unref (argv);
+}
+
 int
 main (int   argc,
       char *argv[])
@@ -769,5 +827,8 @@ main (int   argc,
   g_test_add_func ("/misc/incomplete", test_incomplete);
   g_test_add_func ("/misc/timeout", test_subprocess_timed_out);
 
+  g_test_add_benchmark ("/misc/benchmark/subject", (gconstpointer) 0xbe7c, test_benchmark_subject);
+  g_test_add_func ("/misc/benchmark/check", test_benchmark);
+
   return g_test_run();
 }
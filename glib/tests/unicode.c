@@ -410,6 +410,106 @@ test_cases (void)
   g_assert_cmphex (g_unichar_toupper (0x1FB2), ==, 0x1FB2);
 }
 
+static void
+check_case_mapping (const gchar *str,
+                    gssize       len,
+                    const gchar *upper,
+                    const gchar *lower,
+                    const gchar *folded)
+{
+  gchar *s;
+
+  s = g_utf8_strup (str, len);
+  g_assert_cmpstr (s, ==, upper);
+  g_free (s);
+
+  s = g_utf8_strdown (str, len);
+  g_assert_cmpstr (s, ==, lower);
+  g_free (s);
+
+  s = g_utf8_casefold (str, len);
+  g_assert_cmpstr (s, ==, folded);
+  g_free (s);
+}
+
+static void
+test_strup_strdown_ascii (void)
+{
+  check_case_mapping ("", -1, "", "", "");
+  check_case_mapping ("Hello, World! 123", -1,
+                      "HELLO, WORLD! 123", "hello, world! 123",
+                      "hello, world! 123");
+  check_case_mapping ("Hello, World! 123", 5, "HELLO", "hello", "hello");
+  check_case_mapping ("ab\0cd", 5, "AB", "ab", "ab");
+
+  /* ASCII runs around characters that go through the tables */
+  check_case_mapping ("Gr\xc3\xbc\xc3\x9f Gott, Stra\xc3\x9f" "e and More Text", -1,
+                      "GR\xc3\x9cSS GOTT, STRASSE AND MORE TEXT",
+                      "gr\xc3\xbc\xc3\x9f gott, stra\xc3\x9f" "e and more text",
+                      "gr\xc3\xbcss gott, strasse and more text");
+  check_case_mapping ("\xce\xa3\xce\xb1\xce\xa3 abcDEF \xce\xa3", -1,
+                      "\xce\xa3\xce\x91\xce\xa3 ABCDEF \xce\xa3",
+                      "\xcf\x83\xce\xb1\xcf\x82 abcdef \xcf\x82",
+                      "\xcf\x83\xce\xb1\xcf\x83 abcdef \xcf\x83");
+  check_case_mapping ("\xc3\x80" "BCDEFGHIJ", 2, "\xc3\x80", "\xc3\xa0", "\xc3\xa0");
+}
+
+static void
+check_normalize (const gchar    *str,
+                 gssize          len,
+                 GNormalizeMode  mode,
+                 const gchar    *expected)
+{
+  gchar *s;
+
+  s = g_utf8_normalize (str, len, mode);
+  g_assert_cmpstr (s, ==, expected);
+  g_free (s);
+}
+
+static void
+test_normalize_quick (void)
+{
+  GNormalizeMode modes[] = { G_NORMALIZE_NFD, G_NORMALIZE_NFC,
+                             G_NORMALIZE_NFKD, G_NORMALIZE_NFKC };
+  const gchar ascii[] = "The quick brown fox jumps over the lazy dog.";
+  gint i;
+
+  for (i = 0; i < G_N_ELEMENTS (modes); i++)
+    {
+      check_normalize (ascii, -1, modes[i], ascii);
+      check_normalize (ascii, 9, modes[i], "The quick");
+      check_normalize ("ab\0cd", 5, modes[i], "ab");
+      check_normalize ("", -1, modes[i], "");
+      /* Invalid UTF-8 */
+      check_normalize ("abc\xc3", -1, modes[i], NULL);
+      check_normalize ("abc\xff", -1, modes[i], NULL);
+    }
+
+  /* Latin-1 with canonical decompositions */
+  check_normalize ("caf\xc3\xa9", -1, G_NORMALIZE_NFC, "caf\xc3\xa9");
+  check_normalize ("caf\xc3\xa9", -1, G_NORMALIZE_NFD, "cafe\xcc\x81");
+  check_normalize ("cafe\xcc\x81", -1, G_NORMALIZE_NFC, "caf\xc3\xa9");
+  check_normalize ("cafe\xcc\x81", -1, G_NORMALIZE_NFD, "cafe\xcc\x81");
+
+  /* Latin-1 with compatibility decompositions */
+  check_normalize ("x\xc2\xb2", -1, G_NORMALIZE_NFC, "x\xc2\xb2");
+  check_normalize ("x\xc2\xb2", -1, G_NORMALIZE_NFKC, "x2");
+  check_normalize ("x\xc2\xb2", -1, G_NORMALIZE_NFD, "x\xc2\xb2");
+  check_normalize ("x\xc2\xb2", -1, G_NORMALIZE_NFKD, "x2");
+
+  /* A precomposed character followed by a combining mark */
+  check_normalize ("\xc3\xaa\xcc\x81", -1, G_NORMALIZE_NFC, "\xe1\xba\xbf");
+
+  /* Combining marks out of canonical order: dot below (220) goes first */
+  check_normalize ("a\xcc\x81\xcc\xa3", -1, G_NORMALIZE_NFD, "a\xcc\xa3\xcc\x81");
+  check_normalize ("a\xcc\xa3\xcc\x81", -1, G_NORMALIZE_NFD, "a\xcc\xa3\xcc\x81");
+
+  /* Hangul syllables decompose algorithmically */
+  check_normalize ("\xea\xb0\x80", -1, G_NORMALIZE_NFD, "\xe1\x84\x80\xe1\x85\xa1");
+  check_normalize ("\xe1\x84\x80\xe1\x85\xa1", -1, G_NORMALIZE_NFC, "\xea\xb0\x80");
+}
+
 static void
 test_defined (void)
 {
@@ -903,6 +1003,8 @@ main (int   argc,
   g_test_add_func ("/unicode/fully-decompose-len", test_fully_decompose_len);
   g_test_add_func ("/unicode/iso15924", test_iso15924);
   g_test_add_func ("/unicode/cases", test_cases);
+  g_test_add_func ("/unicode/strup-strdown-ascii", test_strup_strdown_ascii);
+  g_test_add_func ("/unicode/normalize-quick", test_normalize_quick);
 
   return g_test_run();
 }